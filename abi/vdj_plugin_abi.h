@@ -24,10 +24,19 @@ typedef int32_t HRESULT;
 typedef uint32_t DWORD;
 typedef uint32_t ULONG;
 
+/* The platform headers the VirtualDJ SDK includes may define these first */
+#ifndef S_OK
 #define S_OK            0x00000000L
+#endif
+#ifndef S_FALSE
 #define S_FALSE         0x00000001L
+#endif
+#ifndef E_NOTIMPL
 #define E_NOTIMPL       0x80004001L
+#endif
+#ifndef E_FAIL
 #define E_FAIL          0x80004005L
+#endif
 
 /* Plugin parameter types */
 #define VDJPARAM_BUTTON             0
@@ -67,7 +76,9 @@ typedef uint32_t ULONG;
 #define VDJFLAG_VIDEO_FORRECORDING         0x1000000
 #define VDJFLAG_VIDEOTRANSITION_CONTINOUS  0x100000
 
-/* Video engines */
+/* Video engines; the same as the SDK's vdjVideo8.h, whose definition is used
+   when it is included first (the shim does) */
+#ifndef VdjVideo8H
 typedef enum {
     VdjVideoEngineAny = 0,
     VdjVideoEngineDirectX9 = 1,
@@ -77,6 +88,7 @@ typedef enum {
     VdjVideoEngineMetal = 5,
     VdjVideoEngineAnyPtr = 6,
 } EVdjVideoEngine;
+#endif
 
 /* ============================================================================
    Opaque Plugin Handles
@@ -232,6 +244,845 @@ int vdj_plugin_dsp_get_song_bpm(VdjPluginDsp *plugin);
  */
 double vdj_plugin_dsp_get_song_pos_beats(VdjPluginDsp *plugin);
 
+/* ============================================================================
+   DSP Beat Grid Events
+   ============================================================================ */
+
+/* Maximum number of grid events reported for a single OnProcessSamples block */
+#define VDJ_BEAT_EVENTS_MAX         256
+
+/* Beat event flags (a bar boundary is also a beat and a subdivision boundary) */
+#define VDJ_BEAT_EVENT_SUBDIVISION  0x1
+#define VDJ_BEAT_EVENT_BEAT         0x2
+#define VDJ_BEAT_EVENT_BAR          0x4
+
+/**
+ * A beat-grid boundary falling inside the current block
+ */
+typedef struct {
+    int32_t offset;     /* frame offset inside the block (0..nb-1) */
+    uint32_t flags;     /* VDJ_BEAT_EVENT_* */
+    double beat;        /* grid position of the boundary, in beats */
+} VdjBeatEvent;
+
+/**
+ * Configure the beat grid (defaults: 4 beats per bar, 1 subdivision per beat)
+ */
+HRESULT vdj_plugin_dsp_set_beat_grid(VdjPluginDsp *plugin, int beats_per_bar, int subdivisions);
+
+/**
+ * Get the grid events computed for the last OnProcessSamples block.
+ * The returned array stays valid until the next block is processed.
+ */
+const VdjBeatEvent* vdj_plugin_dsp_get_beat_events(VdjPluginDsp *plugin, int *count);
+
+/* ============================================================================
+   DSP Parameter Smoothing Ramps
+   ============================================================================ */
+
+/* Ramp shapes */
+#define VDJ_RAMP_LINEAR             0   /* constant rate, reaches the target after time_ms */
+#define VDJ_RAMP_EXPONENTIAL        1   /* constant ratio (positive values only, else linear) */
+#define VDJ_RAMP_ONEPOLE            2   /* one-pole lowpass, time_ms is the time constant */
+
+#define VDJ_RAMP_MAX_PARAMETERS     32
+#define VDJ_RAMP_MAX_FRAMES         4096
+
+/**
+ * Smoothed values of one parameter for the current block. A block longer than
+ * VDJ_RAMP_MAX_FRAMES gets values for its first VDJ_RAMP_MAX_FRAMES frames
+ * only, but the ramp still advances by the whole block, so it reaches its
+ * target after time_ms whatever the block size.
+ */
+typedef struct {
+    const float *values;    /* one value per frame, 64-byte aligned; NULL when static */
+    int count;              /* number of frames in values (at most VDJ_RAMP_MAX_FRAMES) */
+    int is_static;          /* non-zero when the parameter did not move in this block */
+    float value;            /* smoothed value at the end of the block */
+} VdjParamRamp;
+
+/**
+ * Smooth a declared slider or ColorFX parameter. `parameter` is the storage
+ * passed to DeclareParameter. Call while declaring parameters, not from the
+ * audio thread.
+ */
+HRESULT vdj_plugin_dsp_declare_smoothed_parameter(VdjPluginDsp *plugin, int id, const float *parameter,
+                                                  int mode, float time_ms);
+
+/**
+ * Get the ramp generated for a smoothed parameter in the current block
+ */
+HRESULT vdj_plugin_dsp_get_parameter_ramp(VdjPluginDsp *plugin, int id, VdjParamRamp *ramp);
+
+/* ============================================================================
+   Position DSP Pattern Engine
+   ============================================================================ */
+
+/* Pattern step flags */
+#define VDJ_PATTERN_REVERSE         0x1 /* play the step (or its repeated slice) backwards */
+#define VDJ_PATTERN_MUTE            0x2 /* gate the step closed */
+
+#define VDJ_PATTERN_MAX_STEPS       256
+#define VDJ_PATTERN_MAX_BEATS       64  /* longest pattern cycle */
+#define VDJ_PATTERN_SLOTS_PER_BEAT  64  /* table resolution; lengths are rounded to it */
+
+/**
+ * One step of a position pattern. Steps play back to back and the pattern
+ * repeats every sum(length_beats), aligned to beat 0 of the song.
+ */
+typedef struct {
+    double length_beats;    /* duration of the step */
+    double repeat_beats;    /* loop the first repeat_beats of the step (0 plays it through) */
+    float volume;           /* volume multiplier for the step */
+    uint32_t flags;         /* VDJ_PATTERN_* flags */
+} VdjPatternStep;
+
+/**
+ * Compile a pattern and apply it in OnTransformPosition (count 0 clears it).
+ * Call from a UI or worker thread; the audio thread picks the new table up
+ * at its next transform without locking.
+ */
+HRESULT vdj_plugin_position_dsp_set_pattern(VdjPluginPositionDsp *plugin, const VdjPatternStep *steps, int count);
+
+/* ============================================================================
+   DSP Silence Bypass
+   ============================================================================ */
+
+/**
+ * Bypass the plugin on silent input. After silent_blocks consecutive silent
+ * blocks and tail_ms of silence (the plugin's reverb/delay tail), the shim
+ * returns from OnProcessSamples without processing; plugins declaring
+ * VDJFLAG_PROCESSAFTERSTOP in plugin_flags return E_FAIL so the host stops
+ * calling them. Any non-silent block wakes the plugin immediately.
+ * silent_blocks 0 disables the bypass.
+ */
+HRESULT vdj_plugin_dsp_set_silence_bypass(VdjPluginDsp *plugin, int silent_blocks, float tail_ms, uint32_t plugin_flags);
+
+/**
+ * Non-zero while the plugin is bypassed for silence
+ */
+int vdj_plugin_dsp_is_idle(VdjPluginDsp *plugin);
+
+/* ============================================================================
+   Callback Latency Histograms
+   ============================================================================ */
+
+/* Instrumented entry points */
+#define VDJ_PROFILE_PROCESS_SAMPLES     0   /* DSP and position DSP OnProcessSamples */
+#define VDJ_PROFILE_GET_SONG_BUFFER     1
+#define VDJ_PROFILE_TRANSFORM_POSITION  2
+#define VDJ_PROFILE_DRAW                3   /* video FX and transition OnDraw */
+#define VDJ_PROFILE_AUDIO_SAMPLES       4   /* video FX OnAudioSamples */
+#define VDJ_PROFILE_PARAMETER           5   /* OnParameter, OnGetParameterString */
+#define VDJ_PROFILE_START               6
+#define VDJ_PROFILE_STOP                7
+#define VDJ_PROFILE_DEVICE              8   /* OnDeviceInit, OnDeviceClose */
+#define VDJ_PROFILE_ONLINE_SOURCE       9   /* login, logout and search */
+#define VDJ_PROFILE_LOAD                10  /* OnLoad, OnGetPluginInfo */
+#define VDJ_PROFILE_CALLBACK_COUNT      11
+
+/**
+ * Latency summary of one entry point, in nanoseconds. Percentiles are
+ * accurate to about 6% (the histogram bucket width).
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t overruns;      /* audio calls slower than the block they processed (nb / SampleRate) */
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+} VdjLatencyStats;
+
+/*
+ * The functions below take any plugin handle cast to VdjPlugin*. Profiling
+ * is off by default; while off, an entry point costs one relaxed load.
+ */
+
+/**
+ * Start or stop recording callback durations (allocates on first enable)
+ */
+HRESULT vdj_plugin_set_profiling(VdjPlugin *plugin, int enabled);
+
+/**
+ * Read the latency summary of one VDJ_PROFILE_* entry point from any thread.
+ * Returns S_FALSE with zeroed stats if profiling was never enabled.
+ */
+HRESULT vdj_plugin_get_latency_stats(VdjPlugin *plugin, int callback, VdjLatencyStats *stats);
+
+/**
+ * Clear all histograms
+ */
+HRESULT vdj_plugin_reset_latency_stats(VdjPlugin *plugin);
+
+/**
+ * Write the summaries and non-empty histogram buckets to a text file
+ */
+HRESULT vdj_plugin_dump_latency_histograms(VdjPlugin *plugin, const char *path);
+
+/* ============================================================================
+   Callback Trace Recorder
+   ============================================================================ */
+
+/**
+ * Start recording a span for every instrumented entry point call of every
+ * plugin instance in the process, written to `path` as Chrome trace JSON
+ * (open in chrome://tracing or ui.perfetto.dev). Spans carry the calling
+ * thread and the plugin instance ID. Fails if a trace is already running.
+ * Spans are written out by a shim thread that runs while a plugin instance
+ * lives, so releasing the last instance writes out the spans so far.
+ */
+HRESULT vdj_plugin_trace_start(const char *path);
+
+/**
+ * Stop recording, flush the remaining spans and close the file
+ */
+HRESULT vdj_plugin_trace_stop(void);
+
+/**
+ * Spans dropped because a thread's ring was full or too many threads traced
+ */
+uint64_t vdj_plugin_trace_dropped_spans(void);
+
+/**
+ * Process-unique ID of a plugin instance, as shown in traces (any handle
+ * cast to VdjPlugin*)
+ */
+uint32_t vdj_plugin_get_instance_id(VdjPlugin *plugin);
+
+/* ============================================================================
+   Realtime-Safety Checker
+   ============================================================================ */
+
+/* Violation kinds */
+#define VDJ_RT_VIOLATION_ALLOC      0   /* malloc, calloc, realloc, aligned allocations */
+#define VDJ_RT_VIOLATION_FREE       1
+#define VDJ_RT_VIOLATION_LOCK       2   /* pthread_mutex_lock, pthread_cond_wait */
+#define VDJ_RT_VIOLATION_SYSCALL    3   /* read, write, sleeps */
+#define VDJ_RT_VIOLATION_KINDS      4
+
+/* Checker flags */
+#define VDJ_RT_CHECK_ABORT          0x1 /* print a backtrace and abort on the first violation */
+#define VDJ_RT_CHECK_BACKTRACE      0x2 /* keep backtraces of the first violations for the dump */
+
+typedef struct {
+    uint64_t counts[VDJ_RT_VIOLATION_KINDS];
+} VdjRtViolations;
+
+/**
+ * Start or stop counting violations made while a thread runs a realtime
+ * callback (OnProcessSamples, OnGetSongBuffer, OnTransformPosition). The
+ * interposed malloc/lock/syscall hooks exist only in shims built with
+ * VDJ_SHIM_RT_CHECK on Linux; elsewhere this returns S_FALSE and only
+ * violations passed to vdj_plugin_rt_report_violation are counted.
+ */
+HRESULT vdj_plugin_rt_check_enable(int enabled, uint32_t flags);
+
+/**
+ * Mark the calling thread as inside a realtime callback, for hosts and test
+ * harnesses that drive plugin code without going through the shim's entry
+ * points. Calls nest.
+ */
+void vdj_plugin_rt_enter(void);
+void vdj_plugin_rt_leave(void);
+
+/**
+ * Count a violation detected outside the shim (e.g. by a Rust global
+ * allocator); ignored unless the calling thread is inside a realtime callback
+ */
+void vdj_plugin_rt_report_violation(int kind);
+
+HRESULT vdj_plugin_rt_check_get_violations(VdjRtViolations *violations);
+HRESULT vdj_plugin_rt_check_reset(void);
+
+/**
+ * Write the violation counts and captured backtraces to a file (NULL writes
+ * to stderr)
+ */
+HRESULT vdj_plugin_rt_check_dump(const char *path);
+
+/* ============================================================================
+   Realtime-Safe Logger
+   ============================================================================ */
+
+/* Log levels */
+#define VDJ_LOG_ERROR           0
+#define VDJ_LOG_WARN            1
+#define VDJ_LOG_INFO            2
+#define VDJ_LOG_DEBUG           3
+#define VDJ_LOG_TRACE           4
+
+#define VDJ_LOG_MAX_ARGS        6
+#define VDJ_LOG_MAX_FORMATS     1024
+
+/* One numeric argument; the conversion in the format string picks the member
+   (d/i/u/x/X/o/c read i, f/F/e/E/g/G/a/A read f) */
+typedef union {
+    int64_t i;
+    double f;
+} VdjLogArg;
+
+/**
+ * Register a printf-style format string and return its ID (-1 if the format
+ * uses %s, %p, %n, '*' widths or more than VDJ_LOG_MAX_ARGS conversions, or
+ * the table is full). The string is copied. Allocates: call it while loading,
+ * not from a callback.
+ */
+int vdj_plugin_log_register_format(const char *format);
+
+/**
+ * Start the background writer, appending to a file (NULL writes to stderr).
+ * Records above max_level are filtered out when written. The writer runs
+ * while a plugin instance lives; releasing the last one writes out the
+ * records so far and the log stays open for the next.
+ */
+HRESULT vdj_plugin_log_open(const char *path, int max_level);
+
+/**
+ * Write the records still queued and stop the background writer
+ */
+HRESULT vdj_plugin_log_close(void);
+
+/**
+ * Queue a log record; wait-free, safe on audio and render threads. Returns
+ * S_FALSE when the logger is closed, the level is filtered out or the
+ * calling thread's ring is full (counted as a drop).
+ */
+HRESULT vdj_plugin_log_write(int level, int format_id, const VdjLogArg *args, int arg_count);
+
+/**
+ * Records dropped because a thread's ring was full since the logger opened
+ */
+uint64_t vdj_plugin_log_dropped_records(void);
+
+/* ============================================================================
+   Deferred Command Queue
+   ============================================================================ */
+
+#define VDJ_COMMAND_QUEUE_SIZE      256     /* queued commands per instance, power of two */
+#define VDJ_COMMAND_MAX_INTERNED    256     /* interned command strings per instance */
+#define VDJ_COMMAND_POLL_MS         1       /* dispatcher polling period */
+
+typedef struct {
+    uint64_t queued;
+    uint64_t dropped;           /* queue was full */
+    uint64_t dispatched;        /* SendCommand returned S_OK */
+    uint64_t failed;
+    uint64_t max_latency_ns;    /* from enqueue to SendCommand */
+    uint64_t mean_latency_ns;
+} VdjCommandStats;
+
+/**
+ * Intern a VDJ script command (e.g. "deck 1 loop 4") for this instance and
+ * return its ID, or -1. Interning the same string again returns the same ID.
+ * Allocates: call it while loading, not from a callback.
+ */
+int vdj_plugin_intern_command(VdjPlugin *plugin, const char *command);
+
+/**
+ * Queue an interned command; lock-free and safe on the audio thread. A shim
+ * thread sends it through the plugin's SendCommand callback within about
+ * VDJ_COMMAND_POLL_MS. Returns S_FALSE when the queue is full (counted as a
+ * drop).
+ */
+HRESULT vdj_plugin_queue_command(VdjPlugin *plugin, int command_id);
+
+/**
+ * Send every queued command now, on the calling (non-realtime) thread
+ */
+HRESULT vdj_plugin_flush_commands(VdjPlugin *plugin);
+
+HRESULT vdj_plugin_get_command_stats(VdjPlugin *plugin, VdjCommandStats *stats);
+
+/* ============================================================================
+   Callback Recorder
+   ============================================================================ */
+
+/* A recording is a VdjReplayFileHeader followed by records, each a
+   VdjReplayRecordHeader and `size` bytes of payload. All fields are little
+   endian. */
+#define VDJ_REPLAY_MAGIC            0x524A4456u     /* "VDJR" */
+#define VDJ_REPLAY_VERSION          1
+
+/* Record kinds */
+#define VDJ_REPLAY_START                0   /* no payload */
+#define VDJ_REPLAY_STOP                 1   /* no payload */
+#define VDJ_REPLAY_PARAMETER            2   /* VdjReplayParameter */
+#define VDJ_REPLAY_PROCESS_SAMPLES      3   /* VdjReplayBlock, then the input samples */
+#define VDJ_REPLAY_TRANSFORM_POSITION   4   /* VdjReplayPosition */
+#define VDJ_REPLAY_GET_SONG_BUFFER      5   /* VdjReplayBlock */
+#define VDJ_REPLAY_GET_INFO             6   /* VdjReplayQuery, then the command */
+#define VDJ_REPLAY_GET_STRING_INFO      7   /* VdjReplayQuery, then the command and the result */
+#define VDJ_REPLAY_SONG_AUDIO           8   /* VdjReplaySongAudio, then the int16 samples GetSongBuffer returned */
+
+/* Record flags */
+/* Samples are compressed: each float's bits are XORed with the previous
+   sample of the same channel, split into byte planes (most significant
+   first) and the planes run-length coded: a control byte c < 128 is followed
+   by c + 1 literal bytes, c >= 128 stands for c - 127 zero bytes. */
+#define VDJ_REPLAY_FLAG_COMPRESSED      0x1
+
+#define VDJ_REPLAY_PARAMETER_UNKNOWN    -1  /* value of a parameter the shim did not see declared */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t instance_id;
+    uint32_t reserved;
+} VdjReplayFileHeader;
+
+typedef struct {
+    uint16_t kind;
+    uint16_t flags;
+    uint32_t size;      /* payload bytes */
+    uint64_t time_ns;   /* since the recording started */
+} VdjReplayRecordHeader;
+
+typedef struct {
+    int32_t id;
+    int32_t type;       /* VDJPARAM_*, or VDJ_REPLAY_PARAMETER_UNKNOWN */
+    double value;
+} VdjReplayParameter;
+
+typedef struct {
+    int32_t nb;
+    int32_t sample_rate;
+    int32_t song_bpm;       /* samples per beat */
+    int32_t song_pos;       /* buffer DSP only */
+    double song_pos_beats;
+} VdjReplayBlock;
+
+typedef struct {
+    double song_pos;
+    double video_pos;
+    float volume;
+    float src_volume;
+    double song_pos_beats;
+    int32_t song_bpm;
+    int32_t sample_rate;
+} VdjReplayPosition;
+
+typedef struct {
+    int32_t hr;
+    uint32_t command_size;  /* bytes, without terminator */
+    uint32_t result_size;   /* GetStringInfo result bytes */
+    uint32_t reserved;
+    double value;           /* GetInfo result */
+} VdjReplayQuery;
+
+typedef struct {
+    int32_t hr;
+    int32_t pos;
+    int32_t nb;
+    uint32_t reserved;
+} VdjReplaySongAudio;
+
+/**
+ * Record every inbound call of one plugin instance, and the host queries it
+ * makes, to a file. Callbacks copy their inputs into per-thread rings
+ * without locking; a background thread compresses and writes them. Only one
+ * recording runs at a time; releasing the recorded instance stops it.
+ */
+HRESULT vdj_plugin_replay_record_start(VdjPlugin *plugin, const char *path);
+HRESULT vdj_plugin_replay_record_stop(void);
+
+/**
+ * Records dropped because a ring was full since the recording started
+ */
+uint64_t vdj_plugin_replay_dropped_records(void);
+
+/* ============================================================================
+   Instance Memory
+   ============================================================================ */
+
+/* Every instance is allocated on its own cache lines, so host-written fields
+   (SampleRate, SongPosBeats...) of two instances never share one */
+#define VDJ_CACHE_LINE_SIZE         64
+
+/* State region flags */
+#define VDJ_STATE_LOCK              0x1     /* lock the region in RAM (mlock, VirtualLock) */
+
+typedef struct {
+    uint64_t instance_bytes;    /* shim wrapper, rounded up to cache lines */
+    uint64_t state_bytes;       /* plugin state region, rounded up to pages */
+    uint64_t locked_bytes;      /* part of the state region locked in RAM */
+    uint64_t facility_bytes;    /* profiler histograms, command queue and scratch arena, allocated on first use */
+} VdjMemoryStats;
+
+/**
+ * Reserve a zeroed region of at least `bytes` for the plugin's own state
+ * (delay lines, tables), page-aligned and freed when the instance is
+ * released. Every page is touched here, so the first blocks after the effect
+ * is enabled take no page faults. Call once, from the thread that created the
+ * instance, before its first callback. With VDJ_STATE_LOCK the pages are also
+ * locked in RAM; if the OS refuses (e.g. RLIMIT_MEMLOCK) the region is still
+ * returned, unlocked, and the call returns S_FALSE.
+ */
+HRESULT vdj_plugin_reserve_state(VdjPlugin *plugin, uint64_t bytes, uint32_t flags, void **region);
+
+/**
+ * Memory held by an instance. Call from any non-realtime thread, but not
+ * while vdj_plugin_reserve_state runs.
+ */
+HRESULT vdj_plugin_get_memory_stats(VdjPlugin *plugin, VdjMemoryStats *stats);
+
+/* ============================================================================
+   Scratch Arena
+   ============================================================================ */
+
+/* Scratch allocations are multiples of this size and start on this boundary */
+#define VDJ_SCRATCH_ALIGN           16
+
+/* Largest arena the shim grows to; demand beyond it is not reserved */
+#define VDJ_SCRATCH_MAX_BYTES       ((uint64_t)1 << 30)
+
+/**
+ * Temporary memory for one audio or render callback. The plugin allocates by
+ * advancing `used` and adds every request to `demand`, served or not; the
+ * shim rewinds both when vdj_plugin_dsp_on_process_samples,
+ * vdj_plugin_position_dsp_on_process_samples or the video on_draw functions
+ * return, so nothing allocated may outlive the callback. Only that callback's
+ * thread may touch the arena.
+ */
+typedef struct {
+    uint8_t *base;              /* VDJ_CACHE_LINE_SIZE aligned, null until first grown */
+    uint64_t capacity;
+    uint64_t used;              /* bytes handed out in this callback */
+    uint64_t demand;            /* bytes asked for in this callback, failed requests included */
+} VdjScratchArena;
+
+/**
+ * The instance's arena; the pointer stays valid until the instance is
+ * released, but base and capacity may change between callbacks. Starts empty.
+ */
+VdjScratchArena* vdj_plugin_get_scratch(VdjPlugin *plugin);
+
+/**
+ * Grow the arena to hold at least `bytes`, and the largest demand of any
+ * callback so far, without allocating on the audio thread: the new block is
+ * allocated and pre-faulted here and swapped in when the next callback
+ * returns. The shim also grows it to the recorded demand in on_start and
+ * on_parameter. Call from a non-realtime thread; E_FAIL when out of memory
+ * or `bytes` exceeds VDJ_SCRATCH_MAX_BYTES.
+ */
+HRESULT vdj_plugin_reserve_scratch(VdjPlugin *plugin, uint64_t bytes);
+
+/* ============================================================================
+   Parameter Snapshots
+   ============================================================================ */
+
+/*
+ * A snapshot holds the values of every declared parameter (buttons excepted)
+ * and an opaque block of plugin state, laid out so it can be used in place:
+ *
+ *     VdjSnapshotHeader
+ *     param_count x { VdjSnapshotParam, value bytes padded to 8 }
+ *     opaque state at opaque_offset, 8-aligned
+ *
+ * All fields are little-endian, as on every VirtualDJ platform, so presets
+ * move between machines as they are. Readers accept any version up to
+ * their own and skip parameters they do not know; a preset bank is snapshots
+ * back to back, each total_size long.
+ */
+#define VDJ_SNAPSHOT_MAGIC          0x534A4456  /* "VDJS" */
+#define VDJ_SNAPSHOT_VERSION        1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t param_count;
+    uint32_t reserved;
+    uint64_t opaque_offset;     /* from the start of the snapshot */
+    uint64_t opaque_size;
+    uint64_t total_size;        /* whole snapshot, a multiple of 8 */
+} VdjSnapshotHeader;
+
+typedef struct {
+    int32_t id;
+    int32_t type;               /* VDJPARAM_* */
+    uint32_t size;              /* value bytes that follow, before padding */
+    uint32_t reserved;
+} VdjSnapshotParam;
+
+/**
+ * Write a snapshot of the declared parameters followed by `opaque` into
+ * `out`. `*size` receives the bytes needed; when `out` is null or
+ * `capacity` is smaller nothing is written and S_FALSE is returned. Call
+ * from a non-realtime thread.
+ */
+HRESULT vdj_plugin_save_snapshot(VdjPlugin *plugin, const void *opaque, uint64_t opaque_size,
+                                 void *out, uint64_t capacity, uint64_t *size);
+
+/**
+ * Validate and copy a snapshot, then hand it to the instance: it is applied
+ * to the declared parameters at the start of the next audio block (DSP and
+ * buffer callbacks, on_transform_position for position plugins) or frame
+ * (video on_draw), so a recall never lands in the middle of one. A snapshot
+ * staged before the previous one was applied replaces it. Call from a
+ * non-realtime thread; E_FAIL if the snapshot is invalid or out of memory.
+ */
+HRESULT vdj_plugin_stage_snapshot(VdjPlugin *plugin, const void *data, uint64_t size);
+
+/**
+ * From the callback that applied a staged snapshot, return it (valid until
+ * the callback returns) so the plugin can restore its opaque state. Returns
+ * S_FALSE in every other callback. Realtime-safe.
+ */
+HRESULT vdj_plugin_applied_snapshot(VdjPlugin *plugin, const void **data, uint64_t *size);
+
+/* ============================================================================
+   Preset Morphing
+   ============================================================================ */
+
+#define VDJ_MORPH_MAX_SNAPSHOTS     16
+
+/*
+ * Parameters a morph wrote at the start of the current callback. Continuous
+ * parameters (slider, ColorFX, beats, release and transition FX) come first,
+ * then discrete ones, each group in declaration order.
+ */
+typedef struct {
+    const int32_t *ids;         /* valid until the callback returns */
+    int32_t count;
+    float position;             /* morph position the values were taken at, 0..1 */
+} VdjMorphChanges;
+
+/**
+ * Morph the declared parameters between `count` snapshots spaced evenly over
+ * the 0..1 range of float parameter `position_id`. Whenever the position has
+ * moved at the start of an audio block or video frame (after any staged
+ * snapshot is applied), parameters held by every snapshot are written in
+ * place: continuous ones interpolated between the two snapshots around the
+ * position, the others snapped to the nearer one. OnParameter is not called;
+ * read the change set with vdj_plugin_get_morph_changes. A count of 0 turns
+ * morphing off. Call from a non-realtime thread; E_FAIL if the position is
+ * not a declared float parameter, a snapshot is invalid, count is above
+ * VDJ_MORPH_MAX_SNAPSHOTS or out of memory.
+ */
+HRESULT vdj_plugin_set_morph(VdjPlugin *plugin, int position_id, const void *const *snapshots,
+                             const uint64_t *sizes, int count);
+
+/**
+ * The parameters the morph changed at the start of the current callback.
+ * Returns S_FALSE, with a count of 0, when it changed none. Realtime-safe.
+ */
+HRESULT vdj_plugin_get_morph_changes(VdjPlugin *plugin, VdjMorphChanges *changes);
+
+/* ============================================================================
+   Shared Parameter Blobs
+   ============================================================================ */
+
+/*
+ * Large custom parameter payloads (wavetables, step patterns, sample slices)
+ * held once per process: publishing a payload identical to one any instance
+ * already holds shares it, and an edit copies it first, so running the same
+ * heavy effect on every deck costs its memory once.
+ */
+#define VDJ_SHARED_BLOB_SLOTS       16      /* parameter ids per instance */
+
+typedef struct {
+    uint64_t blobs;             /* distinct payloads held */
+    uint64_t bytes;             /* payload bytes held */
+    uint64_t references;        /* held by instances, including blobs on their way in or out */
+    uint64_t shared_bytes;      /* bytes identical payloads did not allocate */
+} VdjSharedBlobStats;
+
+/**
+ * Publish `size` bytes of `data` as the payload of parameter `id` of this
+ * instance, usually the contents of a DeclareParameterCustom buffer read in
+ * on_parameter. The instance swaps it in at the start of its next audio
+ * block or video frame; the payload it replaces is released off the audio
+ * thread. Call from a non-realtime thread; E_FAIL when out of memory or
+ * when the instance already uses VDJ_SHARED_BLOB_SLOTS other ids.
+ */
+HRESULT vdj_plugin_set_shared_blob(VdjPlugin *plugin, int id, const void *data, uint64_t size);
+
+/**
+ * Publish a copy of the newest payload of `id` with `size` bytes at `offset`
+ * replaced by `data`; instances sharing the old payload keep it unchanged.
+ * Call from a non-realtime thread; E_FAIL when nothing was published for
+ * `id`, the range does not fit in the payload or out of memory.
+ */
+HRESULT vdj_plugin_edit_shared_blob(VdjPlugin *plugin, int id, uint64_t offset, const void *data,
+                                    uint64_t size);
+
+/**
+ * The payload of `id` for the current callback, cache-line aligned and
+ * valid until the callback returns. S_FALSE when none was swapped in yet.
+ * Realtime-safe; call from the instance's audio or render callbacks.
+ */
+HRESULT vdj_plugin_get_shared_blob(VdjPlugin *plugin, int id, const void **data, uint64_t *size);
+
+/**
+ * Process-wide statistics of the shared payloads
+ */
+HRESULT vdj_plugin_get_shared_blob_stats(VdjSharedBlobStats *stats);
+
+/* ============================================================================
+   Lookup Tables
+   ============================================================================ */
+
+/*
+ * Tables of common DSP functions, generated when the shim is compiled and
+ * kept in its read-only data, so every plugin in the process reads the same
+ * pages and none builds them at startup. Each holds VDJ_LUT_SIZE values of
+ * the function at evenly spaced points from min to max, both included;
+ * lookups interpolate linearly and clamp to the range, or wrap around it
+ * for VDJ_LUT_WRAP tables.
+ */
+#define VDJ_LUT_SIZE                1025
+
+#define VDJ_LUT_SINE                0   /* sin(2 pi x), x in cycles, wraps */
+#define VDJ_LUT_DB_TO_GAIN          1   /* 10^(x / 20), x from -144 to +24 dB */
+#define VDJ_LUT_LOG2                2   /* log2(x), x from 1 to 2; gain to dB with the exponent */
+#define VDJ_LUT_TANH                3   /* tanh(x), x from -8 to 8 */
+#define VDJ_LUT_HANN                4   /* Hann window, x from 0 to 1 */
+#define VDJ_LUT_BLACKMAN            5   /* Blackman window, x from 0 to 1 */
+#define VDJ_LUT_NOTE_TO_FREQ        6   /* 440 * 2^((x - 69) / 12) Hz, x from MIDI note 0 to 128 */
+#define VDJ_LUT_COUNT               7
+
+#define VDJ_LUT_WRAP                0x1
+
+typedef struct {
+    const float *values;        /* VDJ_LUT_SIZE values, cache-line aligned, never freed */
+    float min;
+    float max;
+    float scale;                /* (VDJ_LUT_SIZE - 1) / (max - min) */
+    uint32_t flags;             /* VDJ_LUT_* */
+} VdjLut;
+
+/**
+ * Describe table `table` (VDJ_LUT_*). E_FAIL for an unknown table.
+ * Realtime-safe; the values stay valid for the life of the process.
+ */
+HRESULT vdj_lut_get(int table, VdjLut *lut);
+
+/**
+ * Interpolated lookup of `count` inputs in table `table`; `out` may be
+ * `in`. E_FAIL for an unknown table. Realtime-safe.
+ */
+HRESULT vdj_lut_lookup(int table, const float *in, float *out, int count);
+
+/* ============================================================================
+   Fast Math
+   ============================================================================ */
+
+/*
+ * Vectorized approximations for per-sample math, over blocks of floats. The
+ * shim picks the widest instruction set the CPU supports on first use (AVX2
+ * with FMA on x86, else SSE2; NEON on ARM); results can differ between
+ * instruction sets by a few ulp, always within these bounds, measured
+ * against double-precision libm by benches/fast_math.cpp:
+ *
+ *                 VDJ_MATH_FAST           VDJ_MATH_PRECISE
+ *   exp           2e-5 relative           3e-7 relative       x in [-87, 88]
+ *   log           3e-5 absolute           2e-7 absolute       x > 0
+ *   pow           1e-4 relative           2e-6 relative       |y ln x| <= 16
+ *   sin           6e-6 absolute           3e-7 absolute       |x| <= 1000
+ *   tanh          1e-4 absolute           3e-7 absolute       any x
+ *
+ * log errors are relative where |ln x| > 1. exp gives 0 below -87 and
+ * +inf above 88.3; log gives -inf for 0 and subnormals and NaN for negative
+ * inputs; pow is exp(y ln x), NaN for negative bases. NaN inputs give
+ * unspecified results. Every function is realtime-safe, `out` may alias an
+ * input, and E_FAIL reports an unknown tier or null buffers with a positive
+ * count.
+ */
+#define VDJ_MATH_FAST               0
+#define VDJ_MATH_PRECISE            1
+
+#define VDJ_MATH_ISA_SCALAR         0
+#define VDJ_MATH_ISA_SSE2           1
+#define VDJ_MATH_ISA_NEON           2
+#define VDJ_MATH_ISA_AVX2           3   /* with FMA */
+
+typedef struct {
+    int32_t isa;                /* VDJ_MATH_ISA_* in use */
+    int32_t width;              /* floats per vector */
+} VdjMathInfo;
+
+HRESULT vdj_math_exp(const float *in, float *out, int count, int tier);
+HRESULT vdj_math_log(const float *in, float *out, int count, int tier);
+HRESULT vdj_math_sin(const float *in, float *out, int count, int tier);
+HRESULT vdj_math_tanh(const float *in, float *out, int count, int tier);
+HRESULT vdj_math_pow(const float *base, const float *exponent, float *out, int count, int tier);
+
+/** The instruction set in use */
+HRESULT vdj_math_get_info(VdjMathInfo *info);
+
+/**
+ * Use isa (VDJ_MATH_ISA_*) instead of the detected one, for tests and
+ * benchmarks. E_FAIL when it is not built or the CPU lacks it.
+ */
+HRESULT vdj_math_select_isa(int isa);
+
+/* ============================================================================
+   Sample Conversion
+   ============================================================================ */
+
+/*
+ * Vectorized conversion between the int16 stereo buffers of buffer DSP
+ * plugins and float, scaled so that 32768 is 1.0. Float to int16 rounds to
+ * nearest and saturates, and with a VdjDither adds triangular (TPDF) dither
+ * of +-1 LSB before rounding. All functions are realtime-safe.
+ */
+typedef struct {
+    uint32_t state[8];          /* generator lanes, nonzero; see vdj_dither_init */
+} VdjDither;
+
+/** Seed a dither generator; give each channel or instance its own seed */
+HRESULT vdj_dither_init(VdjDither *dither, uint32_t seed);
+
+HRESULT vdj_convert_int16_to_float(const int16_t *in, float *out, int count);
+
+/**
+ * Convert count samples, dithered when dither is not null. NaN gives 0.
+ * E_FAIL for null buffers with a positive count.
+ */
+HRESULT vdj_convert_float_to_int16(const float *in, int16_t *out, int count, VdjDither *dither);
+
+/* ============================================================================
+   Resampler
+   ============================================================================ */
+
+/*
+ * Reads the song of a buffer DSP plugin at a fractional, time-varying
+ * speed, for brakes, tape stops and pitch bends. Each output frame is a
+ * VDJ_RESAMPLER_TAPS-tap Kaiser-windowed sinc of the source, from
+ * VDJ_RESAMPLER_PHASES phases interpolated linearly; above a speed of 1 the
+ * cutoff drops in steps up to a speed of 2, and faster reads alias. Speeds
+ * are clamped to +-VDJ_RESAMPLER_MAX_RATIO; negative speeds play backwards.
+ */
+#define VDJ_RESAMPLER_TAPS          32
+#define VDJ_RESAMPLER_PHASES        128
+#define VDJ_RESAMPLER_MAX_RATIO     16
+
+typedef struct VdjResampler VdjResampler;
+
+/**
+ * A resampler for blocks of up to max_frames output frames, reading from
+ * song frame 0. Allocates: call outside the audio thread. Null on failure.
+ */
+VdjResampler* vdj_resampler_create(int max_frames);
+void vdj_resampler_release(VdjResampler *resampler);
+
+/** Move the read position to a fractional song frame. E_FAIL if not finite. */
+HRESULT vdj_resampler_set_position(VdjResampler *resampler, double frame);
+double vdj_resampler_get_position(const VdjResampler *resampler);
+
+/**
+ * Write nb interleaved stereo frames to out (2 * nb floats), reading the
+ * song at a speed ramping linearly from ratio_start to ratio_end across the
+ * block, and advance the position. Blocks longer than max_frames are
+ * fetched in several chunks. On a failed fetch the rest of out is silent
+ * and its HRESULT is returned. Realtime-safe.
+ */
+HRESULT vdj_resampler_process_song(VdjResampler *resampler, VdjPluginBufferDsp *plugin, float ratio_start,
+                                   float ratio_end, float *out, int nb);
+
 /* ============================================================================
    Buffer DSP Plugin Functions
    ============================================================================ */
@@ -243,6 +1094,13 @@ HRESULT vdj_plugin_buffer_dsp_on_start(VdjPluginBufferDsp *plugin);
 HRESULT vdj_plugin_buffer_dsp_on_stop(VdjPluginBufferDsp *plugin);
 int16_t* vdj_plugin_buffer_dsp_on_get_song_buffer(VdjPluginBufferDsp *plugin, int song_pos, int nb);
 HRESULT vdj_plugin_buffer_dsp_get_song_buffer(VdjPluginBufferDsp *plugin, int pos, int nb, int16_t **buffer);
+
+/**
+ * GetSongBuffer converted to float: `out` receives 2 * nb interleaved
+ * stereo samples. Saves the plugin a crossing and a scalar loop per block.
+ */
+HRESULT vdj_plugin_buffer_dsp_get_song_buffer_float(VdjPluginBufferDsp *plugin, int pos, int nb, float *out);
+
 int vdj_plugin_buffer_dsp_get_sample_rate(VdjPluginBufferDsp *plugin);
 int vdj_plugin_buffer_dsp_get_song_bpm(VdjPluginBufferDsp *plugin);
 int vdj_plugin_buffer_dsp_get_song_pos(VdjPluginBufferDsp *plugin);
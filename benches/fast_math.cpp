@@ -0,0 +1,184 @@
+/**
+ * VirtualDJ Rust SDK - Fast Math Accuracy and Throughput
+ *
+ * Checks every vdj_math_* function against double-precision libm over its
+ * documented range, for each tier and each instruction set the CPU runs,
+ * and times it against the float libm call it replaces. Exits with 1 when
+ * an error exceeds the bound documented in abi/vdj_plugin_abi.h, so it can
+ * gate changes to the approximations.
+ *
+ * Build against the shim sources, with the platform defines of the shim
+ * build, e.g.:
+ *
+ *     c++ -O2 -std=c++17 benches/fast_math.cpp vdj_plugin_shim/[a-z]*.cpp -o fast_math
+ *     ./fast_math
+ */
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static const int points = 1 << 20;
+static const int blockSize = 512;
+
+/* ===== Functions ===== */
+
+enum ErrorKind {
+    Absolute,
+    Relative,
+    AbsoluteBelowOne,   /* relative where the result exceeds 1 in magnitude */
+};
+
+struct Function {
+    const char *name;
+    HRESULT (*unary)(const float*, float*, int, int);
+    double (*reference)(double);
+    float (*libm)(float);
+    ErrorKind kind;
+    double bounds[2];           /* VDJ_MATH_FAST, VDJ_MATH_PRECISE */
+    float min, max;
+    bool logSpaced;
+};
+
+static double Exp(double x) { return std::exp(x); }
+static double Log(double x) { return std::log(x); }
+static double Sin(double x) { return std::sin(x); }
+static double Tanh(double x) { return std::tanh(x); }
+static float ExpF(float x) { return std::exp(x); }
+static float LogF(float x) { return std::log(x); }
+static float SinF(float x) { return std::sin(x); }
+static float TanhF(float x) { return std::tanh(x); }
+
+/* The bounds of the ABI header */
+static const Function functions[] = {
+    { "exp", vdj_math_exp, Exp, ExpF, Relative, { 2e-5, 3e-7 }, -87.0f, 88.0f, false },
+    { "log", vdj_math_log, Log, LogF, AbsoluteBelowOne, { 3e-5, 2e-7 }, 1.2e-38f, 3.4e38f, true },
+    { "sin", vdj_math_sin, Sin, SinF, Absolute, { 6e-6, 3e-7 }, -1000.0f, 1000.0f, false },
+    { "tanh", vdj_math_tanh, Tanh, TanhF, Absolute, { 1e-4, 3e-7 }, -10.0f, 10.0f, false },
+};
+
+static const double powBounds[2] = { 1e-4, 2e-6 };
+
+static const char *tierNames[2] = { "fast", "precise" };
+
+static const char* IsaName(int isa) {
+    switch (isa) {
+    case VDJ_MATH_ISA_SSE2: return "sse2";
+    case VDJ_MATH_ISA_NEON: return "neon";
+    case VDJ_MATH_ISA_AVX2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+static double Error(ErrorKind kind, float value, double reference) {
+    const double diff = std::fabs((double)value - reference);
+    switch (kind) {
+    case Relative: return diff / std::fabs(reference);
+    case AbsoluteBelowOne: return diff / std::max(1.0, std::fabs(reference));
+    default: return diff;
+    }
+}
+
+/* Evenly spaced points, or spaced evenly in log for positive ranges */
+static std::vector<float> Inputs(float min, float max, bool logSpaced) {
+    std::vector<float> x(points);
+    for (int i = 0; i < points; i++) {
+        const double t = (double)i / (points - 1);
+        x[i] = logSpaced ? (float)std::exp(std::log(min) + t * (std::log(max) - std::log(min)))
+                         : (float)(min + t * ((double)max - min));
+    }
+    return x;
+}
+
+/* ===== Measurement ===== */
+
+static volatile float keepSink;
+
+template <typename F>
+static double NsPerValue(F f) {
+    std::vector<double> times;
+    for (int run = 0; run < 7; run++) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::nano>(end - start).count() / points);
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+template <typename Call>
+static double TimeBlocks(const std::vector<float> &x, std::vector<float> &y, Call call) {
+    return NsPerValue([&] {
+        for (int i = 0; i < points; i += blockSize) call(&x[i], &y[i], blockSize);
+        keepSink = y[points / 2];
+    });
+}
+
+/* ===== Main ===== */
+
+int main() {
+    int failures = 0;
+    std::vector<float> y(points);
+
+    printf("%-6s %-6s %-8s %12s %10s %10s %10s\n", "isa", "func", "tier", "max error", "bound", "ns/value", "libm");
+    for (int isa : { VDJ_MATH_ISA_SCALAR, VDJ_MATH_ISA_SSE2, VDJ_MATH_ISA_NEON, VDJ_MATH_ISA_AVX2 }) {
+        if (vdj_math_select_isa(isa) != S_OK) continue;
+
+        for (const Function &f : functions) {
+            const std::vector<float> x = Inputs(f.min, f.max, f.logSpaced);
+            const double libm = NsPerValue([&] {
+                for (int i = 0; i < points; i++) y[i] = f.libm(x[i]);
+                keepSink = y[points / 2];
+            });
+            for (int tier : { VDJ_MATH_FAST, VDJ_MATH_PRECISE }) {
+                f.unary(x.data(), y.data(), points, tier);
+                double worst = 0.0;
+                for (int i = 0; i < points; i++) worst = std::max(worst, Error(f.kind, y[i], f.reference(x[i])));
+                const double ns = TimeBlocks(x, y, [&](const float *in, float *out, int n) { f.unary(in, out, n, tier); });
+                const bool ok = worst <= f.bounds[tier];
+                failures += !ok;
+                printf("%-6s %-6s %-8s %12.3g %10.3g %10.3f %10.3f%s\n", IsaName(isa), f.name, tierNames[tier],
+                       worst, f.bounds[tier], ns, libm, ok ? "" : "  FAIL");
+            }
+        }
+
+        // pow over bases 2^-8..2^8 and exponents keeping |y ln x| <= 16
+        std::vector<float> base(points), exponent(points);
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> octaves(-8.0f, 8.0f), power(-2.8f, 2.8f);
+        for (int i = 0; i < points; i++) {
+            base[i] = std::exp2(octaves(random));
+            exponent[i] = power(random);
+        }
+        const double libm = NsPerValue([&] {
+            for (int i = 0; i < points; i++) y[i] = std::pow(base[i], exponent[i]);
+            keepSink = y[points / 2];
+        });
+        for (int tier : { VDJ_MATH_FAST, VDJ_MATH_PRECISE }) {
+            vdj_math_pow(base.data(), exponent.data(), y.data(), points, tier);
+            double worst = 0.0;
+            for (int i = 0; i < points; i++) {
+                worst = std::max(worst, Error(Relative, y[i], std::pow((double)base[i], (double)exponent[i])));
+            }
+            const double ns = NsPerValue([&] {
+                for (int i = 0; i < points; i += blockSize) {
+                    vdj_math_pow(&base[i], &exponent[i], &y[i], blockSize, tier);
+                }
+                keepSink = y[points / 2];
+            });
+            const bool ok = worst <= powBounds[tier];
+            failures += !ok;
+            printf("%-6s %-6s %-8s %12.3g %10.3g %10.3f %10.3f%s\n", IsaName(isa), "pow", tierNames[tier],
+                   worst, powBounds[tier], ns, libm, ok ? "" : "  FAIL");
+        }
+    }
+
+    if (failures) printf("%d functions exceed their documented bound\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * VirtualDJ Rust SDK - FFI Crossing Microbenchmarks
+ *
+ * Times every hot C ABI entry point of abi/vdj_plugin_abi.h from the host
+ * side: the vdj_plugin_* function, the shim's per-call scopes and the C++
+ * virtual behind it, per block size, with profiling off and on. A plain
+ * virtual call is measured as the floor. Results are printed and written in
+ * the baseline format read by the Rust `baseline` module.
+ *
+ * Build against the shim sources, with the platform defines of the shim
+ * build, e.g.:
+ *
+ *     c++ -O2 -std=c++17 benches/ffi_crossing.cpp vdj_plugin_shim/[a-z]*.cpp -o ffi_crossing
+ *     ./ffi_crossing target/baselines/ffi_crossing_cpp.json
+ */
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const int blockSizes[] = { 32, 128, 512, 1024, 4096 };
+static const int samples = 15;
+
+/* ===== Stub Host ===== */
+
+static HRESULT StubSendCommand(VdjPlugin*, const char*) { return S_OK; }
+
+static HRESULT StubGetInfo(VdjPlugin*, const char*, double *result) {
+    *result = 128.0;
+    return S_OK;
+}
+
+static HRESULT StubGetStringInfo(VdjPlugin*, const char*, char *result, int size) {
+    snprintf(result, size, "Artist - Title");
+    return S_OK;
+}
+
+static HRESULT StubDeclareParameter(VdjPlugin*, void*, int, int, const char*, const char*, float) { return S_OK; }
+
+static HRESULT StubGetSongBuffer(VdjPlugin*, int, int, int16_t**) { return E_NOTIMPL; }
+
+static const VdjCallbacks stubCallbacks = {
+    StubSendCommand, StubGetInfo, StubGetStringInfo, StubDeclareParameter, StubGetSongBuffer
+};
+
+/* ===== Measurement ===== */
+
+/* Results are stored here so the compiler cannot discard the calls */
+static volatile intptr_t keepSink;
+
+static inline void Keep(int value) { keepSink = value; }
+static inline void Keep(const void *value) { keepSink = (intptr_t)value; }
+
+/**
+ * Median cost of one call of f in nanoseconds, over batches sized to take
+ * about 2 ms each
+ */
+template <typename F>
+static double MeasureNs(F &&f) {
+    using Clock = std::chrono::steady_clock;
+    uint64_t batch = 1;
+    for (;;) {
+        const auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; i++) f();
+        if (Clock::now() - start >= std::chrono::milliseconds(2) || batch >= (1ull << 30)) break;
+        batch *= 2;
+    }
+
+    std::vector<double> times;
+    for (int s = 0; s < samples; s++) {
+        const auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; i++) f();
+        const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        times.push_back(ns / (double)batch);
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+struct Metric {
+    std::string name;
+    double ns;
+};
+
+static std::vector<Metric> results;
+
+static void Record(const std::string &name, double ns) {
+    printf("%-40s %10.2f ns\n", name.c_str(), ns);
+    results.push_back({ name, ns });
+}
+
+static bool Save(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "{\n  \"suite\": \"ffi_crossing_cpp\",\n  \"metrics\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        fprintf(file, "    {\"name\": \"%s\", \"value\": %.3f, \"unit\": \"ns\"}%s\n",
+                results[i].name.c_str(), results[i].ns, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+/* ===== Floor ===== */
+
+struct FloorBase {
+    virtual ~FloorBase() = default;
+    virtual HRESULT OnProcessSamples(float *buffer, int nb) = 0;
+};
+
+struct Floor : FloorBase {
+    HRESULT OnProcessSamples(float*, int) override { return S_OK; }
+};
+
+/* ===== Benchmarks ===== */
+
+static void BenchDsp() {
+    VdjPluginDsp *dsp = vdj_plugin_dsp_create();
+    vdj_plugin_dsp_init(dsp, &stubCallbacks);
+    VdjPlugin *generic = reinterpret_cast<VdjPlugin*>(dsp);
+    vdj_plugin_dsp_on_start(dsp);
+
+    Record("dsp/on_parameter", MeasureNs([&] { Keep(vdj_plugin_on_parameter(generic, 1)); }));
+    Record("dsp/get_sample_rate", MeasureNs([&] { Keep(vdj_plugin_dsp_get_sample_rate(dsp)); }));
+    for (int nb : blockSizes) {
+        std::vector<float> buffer(nb * 2, 0.25f);
+        Record("dsp/process_samples/" + std::to_string(nb),
+               MeasureNs([&] { Keep(vdj_plugin_dsp_on_process_samples(dsp, buffer.data(), nb)); }));
+    }
+
+    vdj_plugin_dsp_on_stop(dsp);
+    vdj_plugin_dsp_release(dsp);
+}
+
+static void BenchPositionDsp() {
+    VdjPluginPositionDsp *position = vdj_plugin_position_dsp_create();
+    vdj_plugin_position_dsp_init(position, &stubCallbacks);
+    vdj_plugin_position_dsp_on_start(position);
+
+    Record("position_dsp/transform_position", MeasureNs([&] {
+        double songPos = 1000.0, videoPos = 1000.0;
+        float volume = 1.0f, srcVolume = 1.0f;
+        Keep(vdj_plugin_position_dsp_on_transform_position(position, &songPos, &videoPos, &volume, &srcVolume));
+    }));
+    for (int nb : blockSizes) {
+        std::vector<float> buffer(nb * 2, 0.25f);
+        Record("position_dsp/process_samples/" + std::to_string(nb),
+               MeasureNs([&] { Keep(vdj_plugin_position_dsp_on_process_samples(position, buffer.data(), nb)); }));
+    }
+
+    vdj_plugin_position_dsp_on_stop(position);
+    vdj_plugin_position_dsp_release(position);
+}
+
+static void BenchBufferDsp() {
+    VdjPluginBufferDsp *buffer = vdj_plugin_buffer_dsp_create();
+    vdj_plugin_buffer_dsp_init(buffer, &stubCallbacks);
+    vdj_plugin_buffer_dsp_on_start(buffer);
+
+    for (int nb : blockSizes) {
+        Record("buffer_dsp/get_song_buffer/" + std::to_string(nb),
+               MeasureNs([&] { Keep(vdj_plugin_buffer_dsp_on_get_song_buffer(buffer, 4096, nb)); }));
+    }
+
+    vdj_plugin_buffer_dsp_on_stop(buffer);
+    vdj_plugin_buffer_dsp_release(buffer);
+}
+
+static void BenchVideoFx() {
+    VdjPluginVideoFx *video = vdj_plugin_video_fx_create();
+    vdj_plugin_video_fx_on_start(video);
+
+    for (int nb : blockSizes) {
+        std::vector<float> buffer(nb * 2, 0.25f);
+        Record("video_fx/audio_samples/" + std::to_string(nb),
+               MeasureNs([&] { Keep(vdj_plugin_video_fx_on_audio_samples(video, buffer.data(), nb)); }));
+    }
+
+    vdj_plugin_video_fx_on_stop(video);
+    vdj_plugin_video_fx_release(video);
+}
+
+int main(int argc, char **argv) {
+    Floor floor;
+    FloorBase *volatile base = &floor;
+    float sample[2] = { 0.0f, 0.0f };
+    Record("floor/virtual_call", MeasureNs([&] { Keep(base->OnProcessSamples(sample, 1)); }));
+
+    Record("lifecycle/dsp_create_release", MeasureNs([] {
+        VdjPluginDsp *dsp = vdj_plugin_dsp_create();
+        vdj_plugin_dsp_init(dsp, &stubCallbacks);
+        vdj_plugin_dsp_release(dsp);
+    }));
+
+    BenchDsp();
+    {
+        // Profiling is per instance; measure a profiled instance separately
+        VdjPluginDsp *dsp = vdj_plugin_dsp_create();
+        vdj_plugin_dsp_init(dsp, &stubCallbacks);
+        vdj_plugin_set_profiling(reinterpret_cast<VdjPlugin*>(dsp), 1);
+        std::vector<float> buffer(512 * 2, 0.25f);
+        Record("dsp/process_samples_profiled/512",
+               MeasureNs([&] { Keep(vdj_plugin_dsp_on_process_samples(dsp, buffer.data(), 512)); }));
+        vdj_plugin_dsp_release(dsp);
+    }
+    BenchPositionDsp();
+    BenchBufferDsp();
+    BenchVideoFx();
+
+    if (argc > 1) {
+        if (!Save(argv[1])) {
+            fprintf(stderr, "cannot write %s\n", argv[1]);
+            return 1;
+        }
+        printf("\nsaved %s\n", argv[1]);
+    }
+    return 0;
+}
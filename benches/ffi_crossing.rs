@@ -0,0 +1,326 @@
+//! FFI crossing benchmarks
+//!
+//! Measures what a call costs on each side of the C ABI in
+//! `abi/vdj_plugin_abi.h`, so a release that slows the hot path shows up as
+//! a number:
+//!
+//! - `host/*`: plugin-to-host queries through `PluginContext` and the
+//!   `VdjCallbacks` function pointers, against a stub host (`raw` is the bare
+//!   function-pointer call, the floor for the others)
+//! - `<type>/*/direct/<nb>`: the Rust trait call alone, per block size
+//! - `<type>/*/ffi/<nb>`: the same call through an `extern "C"` entry point
+//!   taking raw pointers, as the shim's wrappers make it
+//!
+//! The C ABI to C++ virtual part is measured by `benches/ffi_crossing.cpp`.
+//!
+//! ```text
+//! cargo bench --bench ffi_crossing -- --save target/baselines/ffi_crossing.json
+//! cargo bench --bench ffi_crossing -- --baseline target/baselines/ffi_crossing.json
+//! ```
+
+use std::ffi::c_void;
+use std::hint::black_box;
+
+use virtualdj_plugin_sdk::baseline::{measure_ns, Baseline, Metric};
+use virtualdj_plugin_sdk::{
+    ffi, BufferDspPlugin, DspPlugin, PluginBase, PluginContext, PositionDspPlugin, Result,
+};
+
+const BLOCK_SIZES: [usize; 5] = [32, 128, 512, 1024, 4096];
+const SAMPLES: usize = 15;
+
+/* Stub host */
+
+extern "C" fn stub_send_command(_plugin: *mut ffi::VdjPlugin, _command: *const u8) -> ffi::HRESULT {
+    ffi::S_OK
+}
+
+extern "C" fn stub_get_info(
+    _plugin: *mut ffi::VdjPlugin,
+    _command: *const u8,
+    result: *mut f64,
+) -> ffi::HRESULT {
+    unsafe { *result = 128.0 };
+    ffi::S_OK
+}
+
+extern "C" fn stub_get_string_info(
+    _plugin: *mut ffi::VdjPlugin,
+    _command: *const u8,
+    result: *mut u8,
+    size: i32,
+) -> ffi::HRESULT {
+    let text = b"Artist - Title\0";
+    let n = text.len().min(size as usize);
+    unsafe { std::ptr::copy_nonoverlapping(text.as_ptr(), result, n) };
+    ffi::S_OK
+}
+
+extern "C" fn stub_declare_parameter(
+    _plugin: *mut ffi::VdjPlugin,
+    _parameter: *mut c_void,
+    _param_type: i32,
+    _id: i32,
+    _name: *const u8,
+    _short_name: *const u8,
+    _default_value: f32,
+) -> ffi::HRESULT {
+    ffi::S_OK
+}
+
+extern "C" fn stub_get_song_buffer(
+    _plugin: *mut ffi::VdjPlugin,
+    _pos: i32,
+    _nb: i32,
+    _buffer: *mut *mut i16,
+) -> ffi::HRESULT {
+    ffi::E_NOTIMPL
+}
+
+static STUB_CALLBACKS: ffi::VdjCallbacks = ffi::VdjCallbacks {
+    send_command: stub_send_command,
+    get_info: stub_get_info,
+    get_string_info: stub_get_string_info,
+    declare_parameter: stub_declare_parameter,
+    get_song_buffer: stub_get_song_buffer,
+};
+
+/* Reference plugins */
+
+#[derive(Default)]
+struct Gain {
+    gain: f32,
+}
+
+impl PluginBase for Gain {
+    fn on_parameter(&mut self, id: i32) -> Result<()> {
+        self.gain = id as f32 * 0.01;
+        Ok(())
+    }
+}
+
+impl DspPlugin for Gain {
+    fn on_process_samples(&mut self, buffer: &mut [f32]) -> Result<()> {
+        buffer.iter_mut().for_each(|s| *s *= self.gain);
+        Ok(())
+    }
+}
+
+impl PositionDspPlugin for Gain {
+    fn on_transform_position(
+        &mut self,
+        song_pos: &mut f64,
+        _video_pos: &mut f64,
+        volume: &mut f32,
+        _src_volume: &mut f32,
+    ) -> Result<()> {
+        *song_pos += 1.0;
+        *volume *= self.gain;
+        Ok(())
+    }
+}
+
+struct Scratch {
+    buffer: Vec<i16>,
+}
+
+impl PluginBase for Scratch {}
+
+impl BufferDspPlugin for Scratch {
+    fn on_get_song_buffer(&mut self, song_pos: i32, nb: i32) -> Option<&[i16]> {
+        let n = (nb.max(0) as usize * 2).min(self.buffer.len());
+        self.buffer[0] = song_pos as i16;
+        Some(&self.buffer[..n])
+    }
+}
+
+/* extern "C" entry points shaped like the shim's */
+
+fn hresult(result: Result<()>) -> ffi::HRESULT {
+    match result {
+        Ok(()) => ffi::S_OK,
+        Err(_) => ffi::E_FAIL,
+    }
+}
+
+extern "C" fn dsp_on_process_samples(
+    plugin: *mut c_void,
+    buffer: *mut f32,
+    nb: i32,
+) -> ffi::HRESULT {
+    let plugin = unsafe { &mut *(plugin as *mut Box<dyn DspPlugin>) };
+    let buffer = unsafe { std::slice::from_raw_parts_mut(buffer, nb as usize * 2) };
+    hresult(plugin.on_process_samples(buffer))
+}
+
+extern "C" fn dsp_on_parameter(plugin: *mut c_void, id: i32) -> ffi::HRESULT {
+    let plugin = unsafe { &mut *(plugin as *mut Box<dyn DspPlugin>) };
+    hresult(plugin.on_parameter(id))
+}
+
+extern "C" fn position_on_transform(
+    plugin: *mut c_void,
+    song_pos: *mut f64,
+    video_pos: *mut f64,
+    volume: *mut f32,
+    src_volume: *mut f32,
+) -> ffi::HRESULT {
+    let plugin = unsafe { &mut *(plugin as *mut Box<dyn PositionDspPlugin>) };
+    unsafe {
+        hresult(plugin.on_transform_position(
+            &mut *song_pos,
+            &mut *video_pos,
+            &mut *volume,
+            &mut *src_volume,
+        ))
+    }
+}
+
+extern "C" fn buffer_on_get_song_buffer(plugin: *mut c_void, song_pos: i32, nb: i32) -> *const i16 {
+    let plugin = unsafe { &mut *(plugin as *mut Box<dyn BufferDspPlugin>) };
+    plugin
+        .on_get_song_buffer(song_pos, nb)
+        .map_or(std::ptr::null(), |b| b.as_ptr())
+}
+
+fn main() {
+    let args: Vec<String> = std::env::args().collect();
+    let option = |name: &str| {
+        args.iter()
+            .position(|a| a == name)
+            .and_then(|i| args.get(i + 1))
+    };
+    let mut results = Baseline::new("ffi_crossing");
+    let mut record = |name: String, ns: f64| {
+        println!("{:<36} {:>10.2} ns", name, ns);
+        results.push(Metric::new(name, ns, "ns"));
+    };
+
+    // Plugin to host
+    let host = 1usize as *mut ffi::VdjPlugin;
+    let context = PluginContext::new(host, &STUB_CALLBACKS);
+    let get_info = black_box(STUB_CALLBACKS.get_info);
+    record(
+        "host/get_info/raw".into(),
+        measure_ns(SAMPLES, || {
+            let mut v = 0.0;
+            black_box(get_info(host, b"get_bpm\0".as_ptr(), &mut v));
+        }),
+    );
+    record(
+        "host/get_info_double".into(),
+        measure_ns(SAMPLES, || {
+            black_box(context.get_info_double(black_box("deck 1 get_bpm")).ok());
+        }),
+    );
+    record(
+        "host/get_info_string".into(),
+        measure_ns(SAMPLES, || {
+            black_box(context.get_info_string(black_box("deck 1 get_title")).ok());
+        }),
+    );
+    record(
+        "host/send_command".into(),
+        measure_ns(SAMPLES, || {
+            black_box(context.send_command(black_box("deck 1 play")).ok());
+        }),
+    );
+
+    // Host to plugin, per block size
+    let mut dsp: Box<dyn DspPlugin> = Box::new(Gain { gain: 0.5 });
+    let dsp_handle = &mut dsp as *mut Box<dyn DspPlugin> as *mut c_void;
+    let process = black_box(
+        dsp_on_process_samples as extern "C" fn(*mut c_void, *mut f32, i32) -> ffi::HRESULT,
+    );
+    let on_parameter =
+        black_box(dsp_on_parameter as extern "C" fn(*mut c_void, i32) -> ffi::HRESULT);
+    record(
+        "dsp/on_parameter/ffi".into(),
+        measure_ns(SAMPLES, || {
+            black_box(on_parameter(dsp_handle, black_box(50)));
+        }),
+    );
+    for nb in BLOCK_SIZES {
+        let mut buffer = vec![0.25f32; nb * 2];
+        record(
+            format!("dsp/process_samples/direct/{}", nb),
+            measure_ns(SAMPLES, || {
+                let plugin = unsafe { &mut *(dsp_handle as *mut Box<dyn DspPlugin>) };
+                black_box(
+                    plugin
+                        .on_process_samples(black_box(&mut buffer[..]))
+                        .is_ok(),
+                );
+            }),
+        );
+        record(
+            format!("dsp/process_samples/ffi/{}", nb),
+            measure_ns(SAMPLES, || {
+                black_box(process(
+                    dsp_handle,
+                    black_box(buffer.as_mut_ptr()),
+                    nb as i32,
+                ));
+            }),
+        );
+    }
+
+    let mut position: Box<dyn PositionDspPlugin> = Box::new(Gain { gain: 0.5 });
+    let position_handle = &mut position as *mut Box<dyn PositionDspPlugin> as *mut c_void;
+    let transform = black_box(
+        position_on_transform
+            as extern "C" fn(*mut c_void, *mut f64, *mut f64, *mut f32, *mut f32) -> ffi::HRESULT,
+    );
+    record(
+        "position/transform_position/ffi".into(),
+        measure_ns(SAMPLES, || {
+            let (mut pos, mut video, mut volume, mut src) = (1000.0, 1000.0, 1.0f32, 1.0f32);
+            black_box(transform(
+                position_handle,
+                &mut pos,
+                &mut video,
+                &mut volume,
+                &mut src,
+            ));
+        }),
+    );
+
+    let mut scratch: Box<dyn BufferDspPlugin> = Box::new(Scratch {
+        buffer: vec![0; *BLOCK_SIZES.last().unwrap() * 2],
+    });
+    let scratch_handle = &mut scratch as *mut Box<dyn BufferDspPlugin> as *mut c_void;
+    let get_song_buffer =
+        black_box(buffer_on_get_song_buffer as extern "C" fn(*mut c_void, i32, i32) -> *const i16);
+    for nb in BLOCK_SIZES {
+        record(
+            format!("buffer_dsp/get_song_buffer/ffi/{}", nb),
+            measure_ns(SAMPLES, || {
+                black_box(get_song_buffer(scratch_handle, black_box(4096), nb as i32));
+            }),
+        );
+    }
+
+    if let Some(path) = option("--baseline") {
+        match Baseline::load(path) {
+            Ok(baseline) => {
+                println!("\nagainst {}:", path);
+                for c in results.compare(&baseline) {
+                    println!(
+                        "{:<36} {:>10.2} -> {:>10.2} ns  {:>+7.1}%",
+                        c.name,
+                        c.baseline,
+                        c.current,
+                        c.regression * 100.0
+                    );
+                }
+            }
+            Err(e) => eprintln!("{}: {}", path, e),
+        }
+    }
+    if let Some(path) = option("--save") {
+        match results.save(path) {
+            Ok(()) => println!("\nsaved {}", path),
+            Err(e) => eprintln!("{}: {}", path, e),
+        }
+    }
+}
@@ -0,0 +1,181 @@
+/**
+ * VirtualDJ Rust SDK - Resampler Quality and Throughput
+ *
+ * Drives vdj_resampler_process_song through a buffer DSP plugin whose
+ * host callback serves a synthetic song of pure tones, and compares each
+ * output frame with the tone evaluated exactly at the fractional read
+ * position, for fixed speeds, ramps and reverse play. Exits with 1 when
+ * the signal to error ratio of an in-band tone falls below the bound, so
+ * it can gate changes to the filter tables. Then times 512-frame blocks
+ * against the linear interpolation it replaces.
+ *
+ * Build against the shim sources, with the platform defines of the shim
+ * build, e.g.:
+ *
+ *     c++ -O2 -std=c++17 benches/resampler.cpp vdj_plugin_shim/[a-z]*.cpp -o resampler
+ *     ./resampler
+ */
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static const double sampleRate = 44100.0;
+static const double amplitude = 0.5;
+static const int songFrames = 1 << 20;
+static const int blockSize = 512;
+
+/* Lowest signal to error ratio accepted for tones well inside the passband */
+static const double minSnrDb = 70.0;
+
+/* ===== Synthetic Song ===== */
+
+static std::vector<int16_t> song;
+static double songFreq;
+
+/* Left a sine and right a cosine, so both channels and their phase are checked */
+static void MakeSong(double freq) {
+    songFreq = freq;
+    song.resize(2 * (size_t)songFrames);
+    for (int i = 0; i < songFrames; i++) {
+        const double phase = 2.0 * M_PI * freq * i / sampleRate;
+        song[2 * i] = (int16_t)std::lrint(32768.0 * amplitude * std::sin(phase));
+        song[2 * i + 1] = (int16_t)std::lrint(32768.0 * amplitude * std::cos(phase));
+    }
+}
+
+static HRESULT SongBuffer(VdjPlugin*, int pos, int nb, int16_t **buffer) {
+    if (pos < 0 || nb < 0 || pos > songFrames - nb) return E_FAIL;
+    *buffer = song.data() + 2 * (size_t)pos;
+    return S_OK;
+}
+
+static HRESULT StubSendCommand(VdjPlugin*, const char*) { return S_OK; }
+static HRESULT StubGetInfo(VdjPlugin*, const char*, double*) { return E_NOTIMPL; }
+static HRESULT StubGetStringInfo(VdjPlugin*, const char*, char*, int) { return E_NOTIMPL; }
+static HRESULT StubDeclareParameter(VdjPlugin*, void*, int, int, const char*, const char*, float) { return S_OK; }
+
+static const VdjCallbacks callbacks = {
+    StubSendCommand, StubGetInfo, StubGetStringInfo, StubDeclareParameter, SongBuffer
+};
+
+/* ===== Quality ===== */
+
+struct Case {
+    const char *name;
+    double freq;
+    float ratioStart, ratioEnd;
+    double start;               /* first read position, fractional */
+};
+
+static const Case cases[] = {
+    { "1 kHz, speed 1",             1000.0,  1.0f,  1.0f, 1000.25 },
+    { "1 kHz, speed 0.7",           1000.0,  0.7f,  0.7f, 1000.1 },
+    { "1 kHz, speed 1.5",           1000.0,  1.5f,  1.5f, 1000.6 },
+    { "1 kHz, speed 3.9",           1000.0,  3.9f,  3.9f, 1000.9 },
+    { "1 kHz, brake 1 to 0",        1000.0,  1.0f,  0.0f, 1000.3 },
+    { "1 kHz, reverse -1.3",        1000.0, -1.3f, -0.2f, 500000.7 },
+    { "1 kHz, turn 1 to -1",        1000.0,  1.0f, -1.0f, 100000.5 },
+    { "5 kHz, speed 2",             5000.0,  2.0f,  2.0f, 1000.4 },
+    { "8 kHz, speed 0.8",           8000.0,  0.8f,  0.8f, 1000.4 },
+    { "16 kHz, speed 0.9",         16000.0,  0.9f,  0.9f, 1000.4 },
+};
+
+/* Signal to error ratio in dB over blocks blocks of the case */
+static double Snr(VdjPluginBufferDsp *plugin, const Case &c, int blocks) {
+    if (songFreq != c.freq) MakeSong(c.freq);
+    VdjResampler *resampler = vdj_resampler_create(blockSize);
+    vdj_resampler_set_position(resampler, c.start);
+    std::vector<float> out(2 * blockSize);
+    double position = c.start, signal = 0.0, error = 0.0;
+    for (int b = 0; b < blocks; b++) {
+        if (vdj_resampler_process_song(resampler, plugin, c.ratioStart, c.ratioEnd, out.data(), blockSize) != S_OK) {
+            vdj_resampler_release(resampler);
+            return 0.0;
+        }
+        const double slope = ((double)c.ratioEnd - c.ratioStart) / blockSize;
+        for (int i = 0; i < blockSize; i++) {
+            const double phase = 2.0 * M_PI * c.freq * position / sampleRate;
+            const double left = amplitude * std::sin(phase), right = amplitude * std::cos(phase);
+            signal += left * left + right * right;
+            error += (out[2 * i] - left) * (out[2 * i] - left) + (out[2 * i + 1] - right) * (out[2 * i + 1] - right);
+            position += c.ratioStart + slope * i;
+        }
+    }
+    vdj_resampler_release(resampler);
+    return 10.0 * std::log10(signal / error);
+}
+
+/* ===== Throughput ===== */
+
+static volatile float keepSink;
+
+/* Median output frames per microsecond of f, which produces one block */
+template <typename F>
+static double Rate(F f) {
+    std::vector<double> rates;
+    for (int run = 0; run < 9; run++) {
+        int calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::micro> elapsed {};
+        do {
+            f();
+            calls++;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed.count() < 2e3);
+        rates.push_back((double)blockSize * calls / elapsed.count());
+    }
+    std::sort(rates.begin(), rates.end());
+    return rates[rates.size() / 2];
+}
+
+/* ===== Main ===== */
+
+int main() {
+    VdjPluginBufferDsp *plugin = vdj_plugin_buffer_dsp_create();
+    vdj_plugin_buffer_dsp_init(plugin, &callbacks);
+
+    bool failed = false;
+    printf("%-28s %10s\n", "case", "SNR dB");
+    for (const Case &c : cases) {
+        const double snr = Snr(plugin, c, 64);
+        const bool bad = snr < minSnrDb;
+        failed |= bad;
+        printf("%-28s %10.1f%s\n", c.name, snr, bad ? "  FAILED" : "");
+    }
+
+    MakeSong(1000.0);
+    std::vector<float> out(2 * blockSize);
+    VdjResampler *resampler = vdj_resampler_create(blockSize);
+    const double sinc = Rate([&] {
+        if (vdj_resampler_get_position(resampler) > songFrames / 2) vdj_resampler_set_position(resampler, 100.5);
+        vdj_resampler_process_song(resampler, plugin, 0.9f, 1.1f, out.data(), blockSize);
+        keepSink = out[blockSize];
+    });
+    vdj_resampler_release(resampler);
+
+    double position = 100.5;
+    const double linear = Rate([&] {
+        if (position > songFrames / 2) position = 100.5;
+        for (int i = 0; i < blockSize; i++) {
+            const int base = (int)position;
+            const float frac = (float)(position - base);
+            const int16_t *a = song.data() + 2 * (size_t)base;
+            out[2 * i] = (a[0] + frac * (a[2] - a[0])) * (1.0f / 32768.0f);
+            out[2 * i + 1] = (a[1] + frac * (a[3] - a[1])) * (1.0f / 32768.0f);
+            position += 0.9 + 0.2 * i / blockSize;
+        }
+        keepSink = out[blockSize];
+    });
+
+    printf("\n%-28s %10s %10s\n", "frames/us, 512-frame blocks", "rate", "decks");
+    printf("%-28s %10.1f %10.0f\n", "32-tap sinc", sinc, sinc * 1e6 / sampleRate);
+    printf("%-28s %10.1f %10.0f\n", "linear interpolation", linear, linear * 1e6 / sampleRate);
+
+    vdj_plugin_buffer_dsp_release(plugin);
+    return failed ? 1 : 0;
+}
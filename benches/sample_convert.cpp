@@ -0,0 +1,99 @@
+/**
+ * VirtualDJ Rust SDK - Sample Conversion Bandwidth
+ *
+ * Times vdj_convert_int16_to_float and vdj_convert_float_to_int16, plain
+ * and dithered, against the per-sample loops they replace and against
+ * memcpy of the same bytes, for a block that fits in cache and one that
+ * does not. Conversions should stay close to the memcpy rate.
+ *
+ * Build against the shim sources, with the platform defines of the shim
+ * build, e.g.:
+ *
+ *     c++ -O2 -std=c++17 benches/sample_convert.cpp vdj_plugin_shim/[a-z]*.cpp -o sample_convert
+ *     ./sample_convert
+ */
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* Stereo samples per call: a 4096-frame block, and 8 MB of int16 */
+static const int sizes[] = { 2 * 4096, 4 << 20 };
+
+/* ===== Measurement ===== */
+
+static volatile int keepSink;
+
+/* Median bytes per nanosecond (GB/s) moving `bytes` per call of f */
+template <typename F>
+static double Rate(double bytes, F f) {
+    std::vector<double> rates;
+    for (int run = 0; run < 9; run++) {
+        int calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::nano> elapsed {};
+        do {
+            f();
+            calls++;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed.count() < 2e6);
+        rates.push_back(bytes * calls / elapsed.count());
+    }
+    std::sort(rates.begin(), rates.end());
+    return rates[rates.size() / 2];
+}
+
+/* ===== Main ===== */
+
+int main() {
+    VdjDither dither;
+    vdj_dither_init(&dither, 1);
+
+    printf("%-28s %10s %10s\n", "GB/s (int16 + float bytes)", "block", "8 MB");
+    const char *names[] = { "memcpy", "int16 to float", "  scalar loop", "float to int16",
+                            "  dithered", "  scalar loop" };
+    double rates[6][2];
+    for (int s = 0; s < 2; s++) {
+        const int n = sizes[s];
+        std::vector<int16_t> pcm(n), back(n);
+        std::vector<float> samples(n), copy(n);
+        for (int i = 0; i < n; i++) pcm[i] = (int16_t)(i * 7919);
+        const double bytes = (double)n * (sizeof(int16_t) + sizeof(float));
+
+        // 3 bytes copied per sample move as much memory as a conversion
+        rates[0][s] = Rate(bytes, [&] {
+            memcpy(copy.data(), samples.data(), (size_t)n * 3);
+            keepSink = (int)copy[n / 2];
+        });
+        rates[1][s] = Rate(bytes, [&] {
+            vdj_convert_int16_to_float(pcm.data(), samples.data(), n);
+            keepSink = (int)samples[n / 2];
+        });
+        rates[2][s] = Rate(bytes, [&] {
+            for (int i = 0; i < n; i++) samples[i] = pcm[i] / 32768.0f;
+            keepSink = (int)samples[n / 2];
+        });
+        rates[3][s] = Rate(bytes, [&] {
+            vdj_convert_float_to_int16(samples.data(), back.data(), n, nullptr);
+            keepSink = back[n / 2];
+        });
+        rates[4][s] = Rate(bytes, [&] {
+            vdj_convert_float_to_int16(samples.data(), back.data(), n, &dither);
+            keepSink = back[n / 2];
+        });
+        rates[5][s] = Rate(bytes, [&] {
+            for (int i = 0; i < n; i++) {
+                const float x = std::min(std::max(samples[i] * 32768.0f, -32768.0f), 32767.0f);
+                back[i] = (int16_t)std::lrint(x);
+            }
+            keepSink = back[n / 2];
+        });
+    }
+    for (int i = 0; i < 6; i++) printf("%-28s %10.2f %10.2f\n", names[i], rates[i][0], rates[i][1]);
+    return 0;
+}
@@ -0,0 +1,532 @@
+/**
+ * VirtualDJ Rust SDK - Shim Concurrency Stress Harness
+ *
+ * Calls shim instances from the threads VirtualDJ uses, all at once: an audio
+ * thread runs the sample callbacks of every instance, a UI thread calls
+ * OnParameter/OnGetParameterString, swaps position patterns and reads stats,
+ * a render thread calls OnDraw, and a churn thread keeps releasing instances
+ * and creating new ones while the others run (unless there is only one,
+ * which would leave the others without an instance most of the time). Profiling, the command queue
+ * and (with --trace) tracing are on, so their lock-free paths are contended.
+ * Each instance also reserves a locked state region, and the memory held per
+ * instance is reported. The sample and draw callbacks take buffers of varying
+ * size from the scratch arena, so it keeps growing while it is in use, and
+ * the UI thread stages parameter snapshots that DSP instances apply at their
+ * next block.
+ *
+ * For each instance count the harness prints callbacks per second per thread
+ * and the cost of one audio callback, timed around the callbacks so passes
+ * over slots the churn thread emptied do not count; a lock-free path that
+ * scales keeps that cost flat as the count grows. Afterwards it checks that the counters the
+ * shim kept agree with the calls made, and exits non-zero if not.
+ *
+ * Build against the shim sources; add -fsanitize=thread to check for data
+ * races:
+ *
+ *     c++ -O1 -g -std=c++17 -fsanitize=thread benches/shim_stress.cpp vdj_plugin_shim/[a-z]*.cpp -o shim_stress
+ *     TSAN_OPTIONS=halt_on_error=1 ./shim_stress --seconds 1 --instances 1,16,128,512
+ */
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int blockFrames = 512;
+static const uint64_t stateBytes = 64 * 1024;
+
+/* ===== Stub Host ===== */
+
+static std::atomic<uint64_t> hostCommands { 0 };
+
+static HRESULT StubSendCommand(VdjPlugin*, const char*) {
+    hostCommands.fetch_add(1, std::memory_order_relaxed);
+    return S_OK;
+}
+
+static HRESULT StubGetInfo(VdjPlugin*, const char*, double *result) {
+    *result = 128.0;
+    return S_OK;
+}
+
+static HRESULT StubGetStringInfo(VdjPlugin*, const char*, char *result, int size) {
+    snprintf(result, size, "Artist - Title");
+    return S_OK;
+}
+
+static HRESULT StubDeclareParameter(VdjPlugin*, void*, int, int, const char*, const char*, float) { return S_OK; }
+
+static HRESULT StubGetSongBuffer(VdjPlugin*, int, int, int16_t**) { return E_NOTIMPL; }
+
+static const VdjCallbacks stubCallbacks = {
+    StubSendCommand, StubGetInfo, StubGetStringInfo, StubDeclareParameter, StubGetSongBuffer
+};
+
+static HRESULT StubDrawDeck(VdjPlugin*) { return S_OK; }
+static HRESULT StubGetDevice(VdjPlugin*, EVdjVideoEngine, void**) { return E_NOTIMPL; }
+static HRESULT StubGetTexture(VdjPlugin*, EVdjVideoEngine, void**, void**) { return E_NOTIMPL; }
+
+static const VdjVideoCallbacks stubVideoCallbacks = { StubDrawDeck, StubGetDevice, StubGetTexture };
+
+/* ===== Instances ===== */
+
+enum InstanceKind { KIND_DSP, KIND_POSITION, KIND_BUFFER, KIND_VIDEO, KIND_COUNT };
+
+static const char *const kindNames[KIND_COUNT] = { "dsp", "position_dsp", "buffer_dsp", "video_fx" };
+
+/**
+ * One live plugin and the calls the harness made on it, compared with the
+ * shim's own counters before it is released
+ */
+struct Instance {
+    InstanceKind kind;
+    void *handle;
+    VdjPlugin *plugin;
+    int commandId = -1;
+    std::atomic<uint64_t> audioCalls { 0 };
+    std::atomic<uint64_t> commandsQueued { 0 };
+    std::atomic<uint64_t> snapshotsStaged { 0 };
+    uint64_t lastApplied = 0;   /* audio thread; sequence number of the last snapshot applied */
+};
+
+static Instance* CreateInstance(InstanceKind kind) {
+    Instance *instance = new Instance();
+    instance->kind = kind;
+    switch (kind) {
+    case KIND_DSP: {
+        VdjPluginDsp *dsp = vdj_plugin_dsp_create();
+        vdj_plugin_dsp_init(dsp, &stubCallbacks);
+        vdj_plugin_dsp_set_beat_grid(dsp, 4, 4);
+        vdj_plugin_dsp_set_silence_bypass(dsp, 8, 50.0f, 0);
+        vdj_plugin_dsp_on_start(dsp);
+        instance->handle = dsp;
+        break;
+    }
+    case KIND_POSITION: {
+        VdjPluginPositionDsp *position = vdj_plugin_position_dsp_create();
+        vdj_plugin_position_dsp_init(position, &stubCallbacks);
+        vdj_plugin_position_dsp_on_start(position);
+        instance->handle = position;
+        break;
+    }
+    case KIND_BUFFER: {
+        VdjPluginBufferDsp *buffer = vdj_plugin_buffer_dsp_create();
+        vdj_plugin_buffer_dsp_init(buffer, &stubCallbacks);
+        vdj_plugin_buffer_dsp_on_start(buffer);
+        instance->handle = buffer;
+        break;
+    }
+    default: {
+        VdjPluginVideoFx *video = vdj_plugin_video_fx_create();
+        vdj_plugin_video_fx_init(video, &stubCallbacks, &stubVideoCallbacks);
+        vdj_plugin_video_fx_on_start(video);
+        instance->handle = video;
+        break;
+    }
+    }
+    instance->plugin = static_cast<VdjPlugin*>(instance->handle);
+    void *state = nullptr;
+    vdj_plugin_reserve_state(instance->plugin, stateBytes, VDJ_STATE_LOCK, &state);
+    vdj_plugin_set_profiling(instance->plugin, 1);
+    instance->commandId = vdj_plugin_intern_command(instance->plugin, "deck 1 effect_slider 1 50%");
+    return instance;
+}
+
+static void ReleaseInstance(Instance *instance) {
+    switch (instance->kind) {
+    case KIND_DSP:
+        vdj_plugin_dsp_on_stop(static_cast<VdjPluginDsp*>(instance->handle));
+        vdj_plugin_dsp_release(static_cast<VdjPluginDsp*>(instance->handle));
+        break;
+    case KIND_POSITION:
+        vdj_plugin_position_dsp_on_stop(static_cast<VdjPluginPositionDsp*>(instance->handle));
+        vdj_plugin_position_dsp_release(static_cast<VdjPluginPositionDsp*>(instance->handle));
+        break;
+    case KIND_BUFFER:
+        vdj_plugin_buffer_dsp_on_stop(static_cast<VdjPluginBufferDsp*>(instance->handle));
+        vdj_plugin_buffer_dsp_release(static_cast<VdjPluginBufferDsp*>(instance->handle));
+        break;
+    default:
+        vdj_plugin_video_fx_on_stop(static_cast<VdjPluginVideoFx*>(instance->handle));
+        vdj_plugin_video_fx_release(static_cast<VdjPluginVideoFx*>(instance->handle));
+        break;
+    }
+    delete instance;
+}
+
+/* ===== Checks ===== */
+
+static std::atomic<int> failures { 0 };
+
+static void Fail(const char *what, const Instance &instance, uint64_t expected, uint64_t actual) {
+    if (failures.fetch_add(1, std::memory_order_relaxed) < 10) {
+        fprintf(stderr, "FAIL %s (%s instance %u): expected %llu, shim counted %llu\n", what,
+                kindNames[instance.kind], vdj_plugin_get_instance_id(instance.plugin),
+                (unsigned long long)expected, (unsigned long long)actual);
+    }
+}
+
+/**
+ * Compare the shim's counters with the calls made. Runs once no other
+ * thread can reach the instance.
+ */
+static void CheckInstance(const Instance &instance) {
+    static const int audioCallback[KIND_COUNT] = {
+        VDJ_PROFILE_PROCESS_SAMPLES, VDJ_PROFILE_PROCESS_SAMPLES, VDJ_PROFILE_GET_SONG_BUFFER, VDJ_PROFILE_AUDIO_SAMPLES
+    };
+    VdjLatencyStats stats;
+    vdj_plugin_get_latency_stats(instance.plugin, audioCallback[instance.kind], &stats);
+    const uint64_t calls = instance.audioCalls.load(std::memory_order_relaxed);
+    if (stats.count != calls) Fail("audio callbacks profiled", instance, calls, stats.count);
+
+    VdjCommandStats commands;
+    vdj_plugin_flush_commands(instance.plugin);
+    vdj_plugin_get_command_stats(instance.plugin, &commands);
+    const uint64_t queued = instance.commandsQueued.load(std::memory_order_relaxed);
+    if (commands.queued != queued) Fail("commands queued", instance, queued, commands.queued);
+    if (commands.dispatched + commands.failed != commands.queued) {
+        Fail("commands sent after flush", instance, commands.queued, commands.dispatched + commands.failed);
+    }
+
+    const uint64_t staged = instance.snapshotsStaged.load(std::memory_order_relaxed);
+    if (instance.lastApplied > staged) Fail("snapshots applied", instance, staged, instance.lastApplied);
+}
+
+/**
+ * Snapshots carry their sequence number as opaque state; applying them in
+ * any order but staging order, or an unstaged one, is a failure
+ */
+static void StageSnapshot(Instance &instance) {
+    const uint64_t sequence = instance.snapshotsStaged.load(std::memory_order_relaxed) + 1;
+    uint64_t snapshot[16];
+    uint64_t size = 0;
+    if (vdj_plugin_save_snapshot(instance.plugin, &sequence, sizeof(sequence), snapshot, sizeof(snapshot), &size) != S_OK) {
+        Fail("snapshot saved", instance, sizeof(snapshot), size);
+        return;
+    }
+    instance.snapshotsStaged.store(sequence, std::memory_order_relaxed);
+    if (vdj_plugin_stage_snapshot(instance.plugin, snapshot, size) != S_OK) Fail("snapshot staged", instance, 1, 0);
+}
+
+static void CheckAppliedSnapshot(Instance &instance) {
+    const void *data;
+    uint64_t size;
+    if (vdj_plugin_applied_snapshot(instance.plugin, &data, &size) != S_OK) return;
+    const VdjSnapshotHeader *header = static_cast<const VdjSnapshotHeader*>(data);
+    uint64_t sequence;
+    memcpy(&sequence, static_cast<const char*>(data) + header->opaque_offset, sizeof(sequence));
+    if (sequence <= instance.lastApplied) Fail("snapshot order", instance, instance.lastApplied + 1, sequence);
+    instance.lastApplied = sequence;
+}
+
+/**
+ * Every instance publishes the same table, so they share one payload; edits
+ * give an instance a copy of its own without the others noticing
+ */
+static float sharedTable[4096];
+
+static void ShareTable(Instance &instance, uint64_t pass) {
+    if (pass & 8) {
+        const float value = (float)(pass & 1);
+        vdj_plugin_edit_shared_blob(instance.plugin, 1, 0, &value, sizeof(value));
+    } else if (vdj_plugin_set_shared_blob(instance.plugin, 1, sharedTable, sizeof(sharedTable)) != S_OK) {
+        Fail("shared table published", instance, 1, 0);
+    }
+}
+
+static void CheckSharedTable(const Instance &instance) {
+    const void *data;
+    uint64_t size;
+    if (vdj_plugin_get_shared_blob(instance.plugin, 1, &data, &size) != S_OK) return;
+    const float *table = static_cast<const float*>(data);
+    if (size != sizeof(sharedTable) || table[1] != sharedTable[1]) Fail("shared table read", instance, sizeof(sharedTable), size);
+}
+
+/* ===== Threads ===== */
+
+enum ThreadRole { THREAD_AUDIO, THREAD_UI, THREAD_RENDER, THREAD_COUNT };
+
+static const char *const threadNames[THREAD_COUNT] = { "audio", "ui", "render" };
+
+/**
+ * Instances are published in slots. A thread loads each slot once per pass
+ * and bumps its pass counter when done, so the churn thread knows an
+ * unpublished instance is unreachable once every thread finished a pass.
+ */
+struct Stress {
+    explicit Stress(int count) : count(count), slots(new std::atomic<Instance*>[count]) {
+        for (int i = 0; i < count; i++) slots[i].store(CreateInstance((InstanceKind)(i % KIND_COUNT)));
+    }
+
+    ~Stress() {
+        for (int i = 0; i < count; i++) {
+            Instance *instance = slots[i].load();
+            CheckInstance(*instance);
+            ReleaseInstance(instance);
+        }
+    }
+
+    const int count;
+    std::unique_ptr<std::atomic<Instance*>[]> slots;
+    std::atomic<bool> running { true };
+    std::atomic<uint64_t> passes[THREAD_COUNT] = {};
+    std::atomic<uint64_t> calls[THREAD_COUNT] = {};
+    std::atomic<uint64_t> audioNanos { 0 };    /* spent inside audio callbacks */
+    std::atomic<uint64_t> churned { 0 };
+};
+
+/**
+ * Take and write a buffer from the instance's scratch arena, as a plugin
+ * callback does; the shim rewinds it when the callback returns
+ */
+static void UseScratch(VdjPlugin *plugin, uint64_t block) {
+    VdjScratchArena *arena = vdj_plugin_get_scratch(plugin);
+    const uint64_t bytes = (1 + block % 4) * blockFrames * 2 * sizeof(float);
+    arena->demand += bytes;
+    if (arena->capacity - arena->used < bytes) return;
+    memset(arena->base + arena->used, 0, (size_t)bytes);
+    arena->used += bytes;
+}
+
+static void AudioThread(Stress &s) {
+    std::vector<float> buffer(blockFrames * 2);
+    uint64_t block = 0, calls = 0;
+    std::chrono::steady_clock::duration busy {};
+    while (s.running.load(std::memory_order_relaxed)) {
+        // Every fourth block is silent, so the silence gate keeps switching
+        const float level = (block & 3) == 3 ? 0.0f : 0.25f;
+        for (int i = 0; i < s.count; i++) {
+            Instance *instance = s.slots[i].load(std::memory_order_acquire);
+            if (!instance) continue;
+            std::fill(buffer.begin(), buffer.end(), level);
+            const auto start = std::chrono::steady_clock::now();
+            switch (instance->kind) {
+            case KIND_DSP:
+                UseScratch(instance->plugin, block);
+                vdj_plugin_dsp_on_process_samples(static_cast<VdjPluginDsp*>(instance->handle), buffer.data(), blockFrames);
+                CheckAppliedSnapshot(*instance);
+                CheckSharedTable(*instance);
+                break;
+            case KIND_POSITION: {
+                VdjPluginPositionDsp *position = static_cast<VdjPluginPositionDsp*>(instance->handle);
+                double songPos = (double)(block * blockFrames), videoPos = songPos;
+                float volume = 1.0f, srcVolume = 1.0f;
+                vdj_plugin_position_dsp_on_transform_position(position, &songPos, &videoPos, &volume, &srcVolume);
+                UseScratch(instance->plugin, block);
+                vdj_plugin_position_dsp_on_process_samples(position, buffer.data(), blockFrames);
+                break;
+            }
+            case KIND_BUFFER:
+                vdj_plugin_buffer_dsp_on_get_song_buffer(static_cast<VdjPluginBufferDsp*>(instance->handle),
+                                                         (int)(block * blockFrames), blockFrames);
+                break;
+            default:
+                vdj_plugin_video_fx_on_audio_samples(static_cast<VdjPluginVideoFx*>(instance->handle), buffer.data(), blockFrames);
+                break;
+            }
+            instance->audioCalls.fetch_add(1, std::memory_order_relaxed);
+            if ((block + i) % 16 == 0 && vdj_plugin_queue_command(instance->plugin, instance->commandId) == S_OK) {
+                instance->commandsQueued.fetch_add(1, std::memory_order_relaxed);
+            }
+            busy += std::chrono::steady_clock::now() - start;
+            calls++;
+        }
+        block++;
+        s.calls[THREAD_AUDIO].store(calls, std::memory_order_relaxed);
+        s.audioNanos.store((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(),
+                           std::memory_order_relaxed);
+        s.passes[THREAD_AUDIO].fetch_add(1, std::memory_order_release);
+    }
+}
+
+static void UiThread(Stress &s) {
+    static const VdjPatternStep patterns[2][2] = {
+        { { 1.0, 0.0, 1.0f, 0 }, { 1.0, 0.25, 0.5f, VDJ_PATTERN_REVERSE } },
+        { { 0.5, 0.0, 1.0f, 0 }, { 0.5, 0.0, 0.0f, VDJ_PATTERN_MUTE } },
+    };
+    char text[64];
+    uint64_t pass = 0, calls = 0;
+    while (s.running.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < s.count; i++) {
+            Instance *instance = s.slots[i].load(std::memory_order_acquire);
+            if (!instance) continue;
+            vdj_plugin_on_parameter(instance->plugin, (int)(pass & 7));
+            vdj_plugin_on_get_parameter_string(instance->plugin, (int)(pass & 7), text, sizeof(text));
+            VdjLatencyStats latency;
+            vdj_plugin_get_latency_stats(instance->plugin, VDJ_PROFILE_PARAMETER, &latency);
+            VdjCommandStats commands;
+            vdj_plugin_get_command_stats(instance->plugin, &commands);
+            if (instance->kind == KIND_DSP) {
+                vdj_plugin_dsp_is_idle(static_cast<VdjPluginDsp*>(instance->handle));
+                if ((pass + i) % 4 == 0) StageSnapshot(*instance);
+                if ((pass + i) % 4 == 2) ShareTable(*instance, pass);
+            } else if (instance->kind == KIND_POSITION && (pass + i) % 8 == 0) {
+                vdj_plugin_position_dsp_set_pattern(static_cast<VdjPluginPositionDsp*>(instance->handle),
+                                                    patterns[pass & 1], 2);
+            }
+            calls++;
+        }
+        pass++;
+        s.calls[THREAD_UI].store(calls, std::memory_order_relaxed);
+        s.passes[THREAD_UI].fetch_add(1, std::memory_order_release);
+    }
+}
+
+static void RenderThread(Stress &s) {
+    uint64_t calls = 0;
+    while (s.running.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < s.count; i++) {
+            Instance *instance = s.slots[i].load(std::memory_order_acquire);
+            if (!instance || instance->kind != KIND_VIDEO) continue;
+            UseScratch(instance->plugin, calls + i);
+            vdj_plugin_video_fx_on_draw(static_cast<VdjPluginVideoFx*>(instance->handle));
+            calls++;
+        }
+        s.calls[THREAD_RENDER].store(calls, std::memory_order_relaxed);
+        s.passes[THREAD_RENDER].fetch_add(1, std::memory_order_release);
+    }
+}
+
+/**
+ * Release a random instance and publish a fresh one in its slot, over and
+ * over, as a user loading and unloading effects does
+ */
+static void ChurnThread(Stress &s) {
+    uint32_t random = 12345;
+    while (s.running.load(std::memory_order_relaxed)) {
+        random = random * 1664525u + 1013904223u;
+        const int slot = (int)((random >> 8) % (uint32_t)s.count);
+        Instance *old = s.slots[slot].exchange(nullptr, std::memory_order_acq_rel);
+
+        // Wait until every thread finished the pass that may have loaded it
+        uint64_t seen[THREAD_COUNT];
+        for (int t = 0; t < THREAD_COUNT; t++) seen[t] = s.passes[t].load(std::memory_order_acquire);
+        for (int t = 0; t < THREAD_COUNT; t++) {
+            while (s.passes[t].load(std::memory_order_acquire) == seen[t] && s.running.load(std::memory_order_relaxed)) {
+                std::this_thread::yield();
+            }
+        }
+        if (!s.running.load(std::memory_order_relaxed)) {
+            // The other threads may be exiting without finishing their pass
+            s.slots[slot].store(old, std::memory_order_release);
+            break;
+        }
+
+        CheckInstance(*old);
+        const InstanceKind kind = old->kind;
+        ReleaseInstance(old);
+        s.slots[slot].store(CreateInstance(kind), std::memory_order_release);
+        s.churned.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/* ===== Driver ===== */
+
+static std::vector<int> ParseCounts(const char *list) {
+    std::vector<int> counts;
+    for (const char *p = list; *p;) {
+        char *end;
+        const long n = strtol(p, &end, 10);
+        if (end == p || n <= 0) return {};
+        counts.push_back((int)n);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return counts;
+}
+
+static void Run(int count, double seconds) {
+    uint64_t calls[THREAD_COUNT] = {};
+    uint64_t churned = 0, footprint = 0, audioNanos = 0;
+    double elapsed = 0.0;
+    {
+        Stress s(count);
+        for (int i = 0; i < count; i++) {
+            VdjMemoryStats memory;
+            vdj_plugin_get_memory_stats(s.slots[i].load()->plugin, &memory);
+            footprint += memory.instance_bytes + memory.state_bytes + memory.facility_bytes;
+        }
+        std::vector<std::thread> threads;
+        threads.emplace_back(AudioThread, std::ref(s));
+        threads.emplace_back(UiThread, std::ref(s));
+        threads.emplace_back(RenderThread, std::ref(s));
+        if (count > 1) threads.emplace_back(ChurnThread, std::ref(s));
+
+        const auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        s.running.store(false);
+        for (std::thread &thread : threads) thread.join();
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (int t = 0; t < THREAD_COUNT; t++) calls[t] = s.calls[t].load();
+        churned = s.churned.load();
+        audioNanos = s.audioNanos.load();
+    }
+
+    printf("%9d", count);
+    for (int t = 0; t < THREAD_COUNT; t++) printf(" %12.0f", (double)calls[t] / elapsed);
+    printf(" %10.0f %14.1f %12.1f\n", (double)churned / elapsed,
+           calls[THREAD_AUDIO] ? (double)audioNanos / (double)calls[THREAD_AUDIO] : 0.0,
+           (double)footprint / count / 1024.0);
+}
+
+int main(int argc, char **argv) {
+    double seconds = 1.0;
+    std::vector<int> counts = { 1, 4, 16, 64, 128, 256, 512 };
+    const char *tracePath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--instances") && i + 1 < argc) {
+            counts = ParseCounts(argv[++i]);
+        } else if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else {
+            counts.clear();
+            break;
+        }
+    }
+    for (size_t i = 0; i < sizeof(sharedTable) / sizeof(sharedTable[0]); i++) sharedTable[i] = (float)i;
+    if (counts.empty() || seconds <= 0.0) {
+        fprintf(stderr, "usage: shim_stress [--seconds S] [--instances N,N,...] [--trace out.json]\n");
+        return 2;
+    }
+
+    if (tracePath && vdj_plugin_trace_start(tracePath) != S_OK) {
+        fprintf(stderr, "cannot trace to %s\n", tracePath);
+        return 1;
+    }
+
+    printf("%9s", "instances");
+    for (int t = 0; t < THREAD_COUNT; t++) printf(" %10s/s", threadNames[t]);
+    printf(" %8s/s %14s %12s\n", "churn", "ns/audio call", "KB/instance");
+    for (int count : counts) Run(count, seconds);
+
+    if (tracePath) {
+        vdj_plugin_trace_stop();
+        printf("\ntrace written to %s (%llu spans dropped)\n", tracePath,
+               (unsigned long long)vdj_plugin_trace_dropped_spans());
+    }
+    printf("%llu commands reached the host\n", (unsigned long long)hostCommands.load());
+
+    VdjSharedBlobStats blobs;
+    vdj_plugin_get_shared_blob_stats(&blobs);
+    if (blobs.blobs || blobs.references) {
+        fprintf(stderr, "FAIL shared blobs: %llu still held after every instance was released\n",
+                (unsigned long long)blobs.blobs);
+        failures.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const int failed = failures.load();
+    if (failed) {
+        fprintf(stderr, "%d check(s) failed\n", failed);
+        return 1;
+    }
+    return 0;
+}
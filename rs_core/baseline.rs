@@ -0,0 +1,422 @@
+//! VirtualDJ Rust SDK - Performance Baselines
+//!
+//! Benchmarks record their results as named metrics in a small JSON file so
+//! a later run, on the same machine, can be compared against it. The C++
+//! microbenchmarks in `benches/` write the same format.
+//!
+//! ```json
+//! {
+//!   "suite": "ffi_crossing",
+//!   "metrics": [
+//!     {"name": "dsp/process_samples/512", "value": 41.2, "unit": "ns"}
+//!   ]
+//! }
+//! ```
+//!
+//! Units ending in `ns` are costs (lower is better); any other unit, such as
+//! `x` for a realtime multiple, is a throughput (higher is better).
+
+use std::hint::black_box;
+use std::io;
+use std::path::Path;
+use std::time::Instant;
+
+/// One measured value
+#[derive(Debug, Clone, PartialEq)]
+pub struct Metric {
+    pub name: String,
+    pub value: f64,
+    pub unit: String,
+}
+
+impl Metric {
+    pub fn new(name: impl Into<String>, value: f64, unit: &str) -> Self {
+        Metric {
+            name: name.into(),
+            value,
+            unit: unit.to_string(),
+        }
+    }
+
+    /// True when a smaller value is an improvement
+    pub fn lower_is_better(&self) -> bool {
+        self.unit.ends_with("ns")
+    }
+}
+
+/// A metric of the current run next to its baseline value
+#[derive(Debug, Clone, PartialEq)]
+pub struct Comparison {
+    pub name: String,
+    pub baseline: f64,
+    pub current: f64,
+    /// Relative slowdown: 0.1 is 10% worse, negative values are improvements
+    pub regression: f64,
+}
+
+/// A set of metrics from one benchmark run
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct Baseline {
+    pub suite: String,
+    pub metrics: Vec<Metric>,
+}
+
+impl Baseline {
+    pub fn new(suite: &str) -> Self {
+        Baseline {
+            suite: suite.to_string(),
+            metrics: Vec::new(),
+        }
+    }
+
+    pub fn push(&mut self, metric: Metric) {
+        self.metrics.push(metric);
+    }
+
+    pub fn get(&self, name: &str) -> Option<&Metric> {
+        self.metrics.iter().find(|m| m.name == name)
+    }
+
+    /// Compare every metric of `self` that also exists in `baseline`
+    pub fn compare(&self, baseline: &Baseline) -> Vec<Comparison> {
+        self.metrics
+            .iter()
+            .filter_map(|m| {
+                let base = baseline.get(&m.name)?;
+                let regression = if base.value <= 0.0 || m.value <= 0.0 {
+                    0.0
+                } else if m.lower_is_better() {
+                    m.value / base.value - 1.0
+                } else {
+                    base.value / m.value - 1.0
+                };
+                Some(Comparison {
+                    name: m.name.clone(),
+                    baseline: base.value,
+                    current: m.value,
+                    regression,
+                })
+            })
+            .collect()
+    }
+
+    pub fn to_json(&self) -> String {
+        let mut out = format!(
+            "{{\n  \"suite\": {},\n  \"metrics\": [\n",
+            quote(&self.suite)
+        );
+        for (i, m) in self.metrics.iter().enumerate() {
+            out.push_str(&format!(
+                "    {{\"name\": {}, \"value\": {}, \"unit\": {}}}{}\n",
+                quote(&m.name),
+                m.value,
+                quote(&m.unit),
+                if i + 1 < self.metrics.len() { "," } else { "" }
+            ));
+        }
+        out.push_str("  ]\n}\n");
+        out
+    }
+
+    /// Parse the baseline format; unknown keys are ignored
+    pub fn parse_json(text: &str) -> io::Result<Self> {
+        let root = Json::parse(text)?;
+        let mut baseline = Baseline::new(root.field("suite").and_then(Json::as_str).unwrap_or(""));
+        let metrics = match root.field("metrics") {
+            Some(Json::Array(items)) => items,
+            _ => return Err(invalid("missing metrics array")),
+        };
+        for item in metrics {
+            let name = item.field("name").and_then(Json::as_str);
+            let value = item.field("value").and_then(Json::as_f64);
+            match (name, value) {
+                (Some(name), Some(value)) => baseline.push(Metric::new(
+                    name,
+                    value,
+                    item.field("unit").and_then(Json::as_str).unwrap_or("ns"),
+                )),
+                _ => return Err(invalid("metric without name or value")),
+            }
+        }
+        Ok(baseline)
+    }
+
+    pub fn load<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+        Self::parse_json(&std::fs::read_to_string(path)?)
+    }
+
+    pub fn save<P: AsRef<Path>>(&self, path: P) -> io::Result<()> {
+        if let Some(dir) = path.as_ref().parent() {
+            std::fs::create_dir_all(dir)?;
+        }
+        std::fs::write(path, self.to_json())
+    }
+}
+
+/// Median cost of one call of `f`, in nanoseconds
+///
+/// Runs `f` in `samples` timed batches sized to take about 2 ms each, after a
+/// warm-up batch, and returns the median per-call time of the batches.
+pub fn measure_ns<F: FnMut()>(samples: usize, mut f: F) -> f64 {
+    let mut batch = 1u64;
+    loop {
+        let start = Instant::now();
+        for _ in 0..batch {
+            f();
+        }
+        if start.elapsed().as_micros() >= 2000 || batch >= 1 << 30 {
+            break;
+        }
+        batch *= 2;
+    }
+
+    let mut times: Vec<f64> = (0..samples.max(1))
+        .map(|_| {
+            let start = Instant::now();
+            for _ in 0..batch {
+                f();
+            }
+            black_box(start.elapsed().as_nanos() as f64 / batch as f64)
+        })
+        .collect();
+    times.sort_by(|a, b| a.total_cmp(b));
+    times[times.len() / 2]
+}
+
+fn invalid(what: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, format!("baseline: {}", what))
+}
+
+fn quote(s: &str) -> String {
+    let mut out = String::with_capacity(s.len() + 2);
+    out.push('"');
+    for c in s.chars() {
+        match c {
+            '"' => out.push_str("\\\""),
+            '\\' => out.push_str("\\\\"),
+            c if (c as u32) < 0x20 => out.push_str(&format!("\\u{:04x}", c as u32)),
+            c => out.push(c),
+        }
+    }
+    out.push('"');
+    out
+}
+
+/// Just enough JSON to read baselines back
+#[derive(Debug, Clone, PartialEq)]
+enum Json {
+    Null,
+    Bool(bool),
+    Number(f64),
+    String(String),
+    Array(Vec<Json>),
+    Object(Vec<(String, Json)>),
+}
+
+impl Json {
+    fn parse(text: &str) -> io::Result<Json> {
+        let mut parser = JsonParser {
+            bytes: text.as_bytes(),
+            pos: 0,
+        };
+        let value = parser.value()?;
+        parser.skip_space();
+        if parser.pos != parser.bytes.len() {
+            return Err(invalid("trailing characters"));
+        }
+        Ok(value)
+    }
+
+    fn field(&self, key: &str) -> Option<&Json> {
+        match self {
+            Json::Object(fields) => fields.iter().find(|(k, _)| k == key).map(|(_, v)| v),
+            _ => None,
+        }
+    }
+
+    fn as_str(&self) -> Option<&str> {
+        match self {
+            Json::String(s) => Some(s),
+            _ => None,
+        }
+    }
+
+    fn as_f64(&self) -> Option<f64> {
+        match self {
+            Json::Number(n) => Some(*n),
+            _ => None,
+        }
+    }
+}
+
+struct JsonParser<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> JsonParser<'a> {
+    fn skip_space(&mut self) {
+        while self.pos < self.bytes.len() && self.bytes[self.pos].is_ascii_whitespace() {
+            self.pos += 1;
+        }
+    }
+
+    fn expect(&mut self, c: u8) -> io::Result<()> {
+        self.skip_space();
+        if self.bytes.get(self.pos) == Some(&c) {
+            self.pos += 1;
+            Ok(())
+        } else {
+            Err(invalid(&format!(
+                "expected '{}' at byte {}",
+                c as char, self.pos
+            )))
+        }
+    }
+
+    /// Consume `c` if it is the next non-space byte
+    fn accept(&mut self, c: u8) -> bool {
+        self.skip_space();
+        if self.bytes.get(self.pos) == Some(&c) {
+            self.pos += 1;
+            true
+        } else {
+            false
+        }
+    }
+
+    fn value(&mut self) -> io::Result<Json> {
+        self.skip_space();
+        match self.bytes.get(self.pos) {
+            Some(b'{') => {
+                self.pos += 1;
+                let mut fields = Vec::new();
+                if !self.accept(b'}') {
+                    loop {
+                        self.skip_space();
+                        let key = self.string()?;
+                        self.expect(b':')?;
+                        fields.push((key, self.value()?));
+                        if self.accept(b'}') {
+                            break;
+                        }
+                        self.expect(b',')?;
+                    }
+                }
+                Ok(Json::Object(fields))
+            }
+            Some(b'[') => {
+                self.pos += 1;
+                let mut items = Vec::new();
+                if !self.accept(b']') {
+                    loop {
+                        items.push(self.value()?);
+                        if self.accept(b']') {
+                            break;
+                        }
+                        self.expect(b',')?;
+                    }
+                }
+                Ok(Json::Array(items))
+            }
+            Some(b'"') => Ok(Json::String(self.string()?)),
+            Some(_) => self.literal(),
+            None => Err(invalid("unexpected end of input")),
+        }
+    }
+
+    fn literal(&mut self) -> io::Result<Json> {
+        let start = self.pos;
+        while self.pos < self.bytes.len() && !b",]} \t\r\n".contains(&self.bytes[self.pos]) {
+            self.pos += 1;
+        }
+        let word = std::str::from_utf8(&self.bytes[start..self.pos]).unwrap_or("");
+        match word {
+            "null" => Ok(Json::Null),
+            "true" => Ok(Json::Bool(true)),
+            "false" => Ok(Json::Bool(false)),
+            _ => word
+                .parse()
+                .map(Json::Number)
+                .map_err(|_| invalid(&format!("bad value '{}'", word))),
+        }
+    }
+
+    fn string(&mut self) -> io::Result<String> {
+        if self.bytes.get(self.pos) != Some(&b'"') {
+            return Err(invalid(&format!("expected string at byte {}", self.pos)));
+        }
+        self.pos += 1;
+        let mut out = Vec::new();
+        loop {
+            let c = *self
+                .bytes
+                .get(self.pos)
+                .ok_or_else(|| invalid("unterminated string"))?;
+            self.pos += 1;
+            match c {
+                b'"' => break,
+                b'\\' => {
+                    let e = *self
+                        .bytes
+                        .get(self.pos)
+                        .ok_or_else(|| invalid("bad escape"))?;
+                    self.pos += 1;
+                    match e {
+                        b'n' => out.push(b'\n'),
+                        b't' => out.push(b'\t'),
+                        b'r' => out.push(b'\r'),
+                        b'u' => {
+                            let hex = self
+                                .bytes
+                                .get(self.pos..self.pos + 4)
+                                .ok_or_else(|| invalid("bad escape"))?;
+                            self.pos += 4;
+                            let code = std::str::from_utf8(hex)
+                                .ok()
+                                .and_then(|h| u32::from_str_radix(h, 16).ok())
+                                .and_then(char::from_u32)
+                                .ok_or_else(|| invalid("bad escape"))?;
+                            let mut buf = [0u8; 4];
+                            out.extend_from_slice(code.encode_utf8(&mut buf).as_bytes());
+                        }
+                        other => out.push(other),
+                    }
+                }
+                c => out.push(c),
+            }
+        }
+        String::from_utf8(out).map_err(|_| invalid("string is not UTF-8"))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_json_round_trip() {
+        let mut baseline = Baseline::new("ffi \"crossing\"");
+        baseline.push(Metric::new("dsp/process_samples/512", 41.25, "ns"));
+        baseline.push(Metric::new("render/gain", 812.0, "x"));
+        assert_eq!(Baseline::parse_json(&baseline.to_json()).unwrap(), baseline);
+        assert!(Baseline::parse_json("{\"suite\": \"x\"}").is_err());
+        assert!(Baseline::parse_json("{\"metrics\": [}").is_err());
+    }
+
+    #[test]
+    fn test_regressions_follow_unit_direction() {
+        let mut base = Baseline::new("s");
+        base.push(Metric::new("cost", 100.0, "ns"));
+        base.push(Metric::new("speed", 100.0, "x"));
+        let mut now = Baseline::new("s");
+        now.push(Metric::new("cost", 120.0, "ns"));
+        now.push(Metric::new("speed", 80.0, "x"));
+        now.push(Metric::new("new", 1.0, "ns"));
+
+        let cmp = now.compare(&base);
+        assert_eq!(cmp.len(), 2);
+        assert!((cmp[0].regression - 0.2).abs() < 1e-12);
+        assert!((cmp[1].regression - 0.25).abs() < 1e-12);
+    }
+}
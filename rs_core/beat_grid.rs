@@ -0,0 +1,180 @@
+//! VirtualDJ Rust SDK - Beat Grid Events
+//!
+//! The shim computes the beat, bar and subdivision boundaries of every
+//! `OnProcessSamples` block once, from `SongPosBeats` and `SongBpm`. Tempo-synced
+//! effects read them as a slice and split the block at each event instead of
+//! testing every sample for a boundary.
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Number of interleaved channels in a DSP buffer
+const CHANNELS: usize = 2;
+
+/// A beat-grid boundary inside the current block
+pub type BeatEvent = ffi::VdjBeatEvent;
+
+impl BeatEvent {
+    /// True for every grid boundary (beats and bars are subdivisions too)
+    pub fn is_subdivision(&self) -> bool {
+        self.flags & ffi::VDJ_BEAT_EVENT_SUBDIVISION != 0
+    }
+
+    /// True when the boundary starts a beat
+    pub fn is_beat(&self) -> bool {
+        self.flags & ffi::VDJ_BEAT_EVENT_BEAT != 0
+    }
+
+    /// True when the boundary starts a bar
+    pub fn is_bar(&self) -> bool {
+        self.flags & ffi::VDJ_BEAT_EVENT_BAR != 0
+    }
+}
+
+/// Configure the beat grid of a DSP plugin
+///
+/// # Arguments
+/// * `beats_per_bar` - Beats in a bar (bar events are flagged every N beats)
+/// * `subdivisions` - Grid steps per beat (1 reports beats only)
+///
+/// # Safety
+/// `plugin` must be a valid handle returned by `vdj_plugin_dsp_create`.
+pub unsafe fn set_beat_grid(
+    plugin: *mut ffi::VdjPluginDsp,
+    beats_per_bar: i32,
+    subdivisions: i32,
+) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_dsp_set_beat_grid(plugin, beats_per_bar, subdivisions) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Get the grid events of the block currently being processed
+///
+/// # Safety
+/// `plugin` must be a valid handle, and the returned slice must not be used
+/// after the next `OnProcessSamples` call.
+pub unsafe fn beat_events<'a>(plugin: *mut ffi::VdjPluginDsp) -> &'a [BeatEvent] {
+    if plugin.is_null() {
+        return &[];
+    }
+    let mut count: i32 = 0;
+    let events = ffi::vdj_plugin_dsp_get_beat_events(plugin, &mut count);
+    if events.is_null() || count <= 0 {
+        return &[];
+    }
+    std::slice::from_raw_parts(events, count as usize)
+}
+
+/// Split an interleaved stereo buffer at the given grid events
+///
+/// Yields `(event, samples)` pairs: the first pair has no event when the block
+/// does not start on a boundary, every following pair starts at its event and
+/// runs up to the next one.
+///
+/// # Example
+///
+/// ```ignore
+/// for (event, samples) in beat_grid::segments(buffer, events) {
+///     if event.map_or(false, |e| e.is_beat()) {
+///         self.gate_open = !self.gate_open;
+///     }
+///     let gain = if self.gate_open { 1.0 } else { 0.0 };
+///     samples.iter_mut().for_each(|s| *s *= gain);
+/// }
+/// ```
+pub fn segments<'a, 'e>(buffer: &'a mut [f32], events: &'e [BeatEvent]) -> Segments<'a, 'e> {
+    Segments {
+        rest: buffer,
+        events,
+        frame: 0,
+    }
+}
+
+/// Iterator returned by [`segments`]
+pub struct Segments<'a, 'e> {
+    rest: &'a mut [f32],
+    events: &'e [BeatEvent],
+    frame: usize,
+}
+
+impl<'a, 'e> Iterator for Segments<'a, 'e> {
+    type Item = (Option<&'e BeatEvent>, &'a mut [f32]);
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.rest.is_empty() {
+            return None;
+        }
+
+        let mut event = None;
+        if let Some((first, tail)) = self.events.split_first() {
+            if first.offset.max(0) as usize <= self.frame {
+                event = Some(first);
+                self.events = tail;
+            }
+        }
+
+        let frames = self.rest.len() / CHANNELS;
+        let end = self
+            .events
+            .first()
+            .map_or(self.frame + frames, |e| e.offset.max(0) as usize)
+            .clamp(self.frame, self.frame + frames);
+
+        let rest = std::mem::take(&mut self.rest);
+        let (head, tail) = if end == self.frame + frames {
+            (rest, &mut [][..])
+        } else {
+            rest.split_at_mut((end - self.frame) * CHANNELS)
+        };
+        self.rest = tail;
+        self.frame = end;
+        Some((event, head))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn event(offset: i32, flags: u32) -> BeatEvent {
+        BeatEvent {
+            offset,
+            flags,
+            beat: 0.0,
+        }
+    }
+
+    #[test]
+    fn test_segments_split_at_events() {
+        let mut buffer = [0.0f32; 16];
+        let events = [
+            event(3, ffi::VDJ_BEAT_EVENT_SUBDIVISION | ffi::VDJ_BEAT_EVENT_BEAT),
+            event(6, ffi::VDJ_BEAT_EVENT_SUBDIVISION),
+        ];
+
+        let parts: Vec<(Option<i32>, usize)> = segments(&mut buffer, &events)
+            .map(|(e, s)| (e.map(|e| e.offset), s.len()))
+            .collect();
+
+        assert_eq!(parts, vec![(None, 6), (Some(3), 6), (Some(6), 4)]);
+        assert!(events[0].is_beat());
+        assert!(!events[1].is_bar());
+    }
+
+    #[test]
+    fn test_segments_event_on_first_frame() {
+        let mut buffer = [0.0f32; 8];
+        let events = [event(0, ffi::VDJ_BEAT_EVENT_BAR)];
+
+        let parts: Vec<(Option<i32>, usize)> = segments(&mut buffer, &events)
+            .map(|(e, s)| (e.map(|e| e.offset), s.len()))
+            .collect();
+
+        assert_eq!(parts, vec![(Some(0), 8)]);
+    }
+}
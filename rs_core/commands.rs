@@ -0,0 +1,115 @@
+//! VirtualDJ Rust SDK - Deferred Command Queue
+//!
+//! `send_command` runs VDJ script on the calling thread and can block, so it
+//! must not be called from `on_process_samples`. Intern the commands while
+//! loading, then queue them by ID from the audio thread: a shim thread sends
+//! them to VirtualDJ within about a millisecond.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // in on_load
+//! self.loop_cmd = commands::intern_command(handle, "deck 1 loop 4")?;
+//!
+//! // in on_process_samples, on a bar boundary
+//! commands::queue_command(handle, self.loop_cmd);
+//! ```
+//!
+//! All functions take a generic plugin handle: cast DSP, video and other
+//! handles with `handle as *mut ffi::VdjPlugin`.
+
+use std::ffi::CString;
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Delivery counters of a plugin's command queue
+pub type CommandStats = ffi::VdjCommandStats;
+
+impl CommandStats {
+    /// Commands queued but not sent yet
+    pub fn pending(&self) -> u64 {
+        self.queued.saturating_sub(self.dispatched + self.failed)
+    }
+}
+
+/// An interned command
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct CommandId(i32);
+
+/// Intern a VDJ script command and return its ID
+///
+/// Interning the same command again returns the same ID. Allocates, so call
+/// it while loading.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn intern_command(plugin: *mut ffi::VdjPlugin, command: &str) -> Result<CommandId> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let c_command = CString::new(command).map_err(|_| PluginError::Fail)?;
+    match ffi::vdj_plugin_intern_command(plugin, c_command.as_ptr() as *const u8) {
+        id if id >= 0 => Ok(CommandId(id)),
+        _ => Err(PluginError::Fail),
+    }
+}
+
+/// Queue an interned command; lock-free and safe on the audio thread
+///
+/// Returns false when the command was dropped because the queue is full.
+///
+/// # Safety
+/// `plugin` must be the valid plugin handle the command was interned with.
+pub unsafe fn queue_command(plugin: *mut ffi::VdjPlugin, command: CommandId) -> bool {
+    !plugin.is_null() && ffi::vdj_plugin_queue_command(plugin, command.0) == ffi::S_OK
+}
+
+/// Send every queued command now, on the calling thread
+///
+/// Useful in `on_stop` or tests; never call it from the audio thread.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn flush_commands(plugin: *mut ffi::VdjPlugin) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_flush_commands(plugin) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Read the delivery counters and latency of a plugin's command queue
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn command_stats(plugin: *mut ffi::VdjPlugin) -> Result<CommandStats> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let mut stats = CommandStats::default();
+    match ffi::vdj_plugin_get_command_stats(plugin, &mut stats) {
+        ffi::S_OK => Ok(stats),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_pending_commands() {
+        let stats = CommandStats {
+            queued: 10,
+            dropped: 3,
+            dispatched: 6,
+            failed: 1,
+            ..Default::default()
+        };
+        assert_eq!(stats.pending(), 3);
+        assert_eq!(CommandStats::default().pending(), 0);
+    }
+}
@@ -0,0 +1,163 @@
+//! VirtualDJ Rust SDK - Fast Math
+//!
+//! Vectorized exp, log, pow, sin and tanh over blocks of samples, for
+//! per-sample math that `f32::exp` and friends make too slow on the audio
+//! thread. [`Tier::Fast`] trades accuracy for speed and [`Tier::Precise`]
+//! stays within a few ulp; the error bounds of both are documented in
+//! `abi/vdj_plugin_abi.h` and checked by `benches/fast_math.cpp`. The shim
+//! runs the widest instruction set the CPU supports (AVX2 with FMA, SSE2 or
+//! NEON), picked once per process.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // in on_process_samples: a tanh saturator with drive
+//! for (x, s) in self.driven.iter_mut().zip(buffer.iter()) {
+//!     *x = s * self.drive;
+//! }
+//! fast_math::map_in_place(Function::Tanh, &mut self.driven, Tier::Fast)?;
+//! ```
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Accuracy tier of the approximations
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Tier {
+    /// Errors around 1e-5, for modulation, envelopes and saturation
+    Fast,
+    /// Errors around 1e-7, close to the float libm functions
+    Precise,
+}
+
+impl Tier {
+    fn to_ffi(self) -> i32 {
+        match self {
+            Tier::Fast => ffi::VDJ_MATH_FAST,
+            Tier::Precise => ffi::VDJ_MATH_PRECISE,
+        }
+    }
+}
+
+/// The single-input functions
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Function {
+    Exp,
+    /// Natural logarithm
+    Log,
+    Sin,
+    Tanh,
+}
+
+/// Instruction set the kernels run on
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Isa {
+    Scalar,
+    Sse2,
+    Neon,
+    /// AVX2 with FMA
+    Avx2,
+}
+
+impl Isa {
+    pub fn from_ffi(isa: i32) -> Option<Self> {
+        match isa {
+            ffi::VDJ_MATH_ISA_SCALAR => Some(Isa::Scalar),
+            ffi::VDJ_MATH_ISA_SSE2 => Some(Isa::Sse2),
+            ffi::VDJ_MATH_ISA_NEON => Some(Isa::Neon),
+            ffi::VDJ_MATH_ISA_AVX2 => Some(Isa::Avx2),
+            _ => None,
+        }
+    }
+
+    fn to_ffi(self) -> i32 {
+        match self {
+            Isa::Scalar => ffi::VDJ_MATH_ISA_SCALAR,
+            Isa::Sse2 => ffi::VDJ_MATH_ISA_SSE2,
+            Isa::Neon => ffi::VDJ_MATH_ISA_NEON,
+            Isa::Avx2 => ffi::VDJ_MATH_ISA_AVX2,
+        }
+    }
+}
+
+/// The instruction set in use and its vector width in floats
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct MathInfo {
+    pub isa: Isa,
+    pub width: usize,
+}
+
+fn check(hr: ffi::HRESULT) -> Result<()> {
+    match hr {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+fn unary(
+    function: Function,
+) -> unsafe extern "C" fn(*const f32, *mut f32, i32, i32) -> ffi::HRESULT {
+    match function {
+        Function::Exp => ffi::vdj_math_exp,
+        Function::Log => ffi::vdj_math_log,
+        Function::Sin => ffi::vdj_math_sin,
+        Function::Tanh => ffi::vdj_math_tanh,
+    }
+}
+
+/// `function` of every input; stops at the shorter slice. Realtime-safe.
+pub fn map(function: Function, input: &[f32], output: &mut [f32], tier: Tier) -> Result<()> {
+    let count = input.len().min(output.len()) as i32;
+    check(unsafe { unary(function)(input.as_ptr(), output.as_mut_ptr(), count, tier.to_ffi()) })
+}
+
+/// `function` of every value of `buffer`, in place. Realtime-safe.
+pub fn map_in_place(function: Function, buffer: &mut [f32], tier: Tier) -> Result<()> {
+    let data = buffer.as_mut_ptr();
+    check(unsafe { unary(function)(data, data, buffer.len() as i32, tier.to_ffi()) })
+}
+
+/// `base^exponent` per sample, NaN for negative bases; stops at the shortest
+/// slice. Realtime-safe.
+pub fn pow(base: &[f32], exponent: &[f32], output: &mut [f32], tier: Tier) -> Result<()> {
+    let count = base.len().min(exponent.len()).min(output.len()) as i32;
+    check(unsafe {
+        ffi::vdj_math_pow(
+            base.as_ptr(),
+            exponent.as_ptr(),
+            output.as_mut_ptr(),
+            count,
+            tier.to_ffi(),
+        )
+    })
+}
+
+/// The instruction set the shim picked for this CPU
+pub fn info() -> Result<MathInfo> {
+    let mut raw = ffi::VdjMathInfo::default();
+    check(unsafe { ffi::vdj_math_get_info(&mut raw) })?;
+    Ok(MathInfo {
+        isa: Isa::from_ffi(raw.isa).ok_or(PluginError::Fail)?,
+        width: raw.width as usize,
+    })
+}
+
+/// Run every later call on `isa`, for tests and benchmarks comparing
+/// instruction sets. Fails when the shim or the CPU lacks it.
+pub fn select_isa(isa: Isa) -> Result<()> {
+    check(unsafe { ffi::vdj_math_select_isa(isa.to_ffi()) })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_isa_round_trip() {
+        for isa in [Isa::Scalar, Isa::Sse2, Isa::Neon, Isa::Avx2] {
+            assert_eq!(Isa::from_ffi(isa.to_ffi()), Some(isa));
+        }
+        assert_eq!(Isa::from_ffi(42), None);
+        assert_ne!(Tier::Fast.to_ffi(), Tier::Precise.to_ffi());
+    }
+}
@@ -189,6 +189,529 @@ extern "C" {
     pub fn vdj_plugin_dsp_get_song_pos_beats(plugin: *mut VdjPluginDsp) -> f64;
 }
 
+/* ============================================================================
+   DSP Beat Grid Events
+   ============================================================================ */
+
+pub const VDJ_BEAT_EVENTS_MAX: usize = 256;
+
+pub const VDJ_BEAT_EVENT_SUBDIVISION: u32 = 0x1;
+pub const VDJ_BEAT_EVENT_BEAT: u32 = 0x2;
+pub const VDJ_BEAT_EVENT_BAR: u32 = 0x4;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub struct VdjBeatEvent {
+    pub offset: i32,
+    pub flags: u32,
+    pub beat: f64,
+}
+
+extern "C" {
+    pub fn vdj_plugin_dsp_set_beat_grid(plugin: *mut VdjPluginDsp, beats_per_bar: i32, subdivisions: i32) -> HRESULT;
+    pub fn vdj_plugin_dsp_get_beat_events(plugin: *mut VdjPluginDsp, count: *mut i32) -> *const VdjBeatEvent;
+}
+
+/* ============================================================================
+   DSP Parameter Smoothing Ramps
+   ============================================================================ */
+
+pub const VDJ_RAMP_LINEAR: i32 = 0;
+pub const VDJ_RAMP_EXPONENTIAL: i32 = 1;
+pub const VDJ_RAMP_ONEPOLE: i32 = 2;
+
+pub const VDJ_RAMP_MAX_PARAMETERS: usize = 32;
+pub const VDJ_RAMP_MAX_FRAMES: usize = 4096;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct VdjParamRamp {
+    pub values: *const f32,
+    pub count: i32,
+    pub is_static: i32,
+    pub value: f32,
+}
+
+extern "C" {
+    pub fn vdj_plugin_dsp_declare_smoothed_parameter(plugin: *mut VdjPluginDsp, id: i32, parameter: *const f32, mode: i32, time_ms: f32) -> HRESULT;
+    pub fn vdj_plugin_dsp_get_parameter_ramp(plugin: *mut VdjPluginDsp, id: i32, ramp: *mut VdjParamRamp) -> HRESULT;
+}
+
+/* ============================================================================
+   Position DSP Pattern Engine
+   ============================================================================ */
+
+pub const VDJ_PATTERN_REVERSE: u32 = 0x1;
+pub const VDJ_PATTERN_MUTE: u32 = 0x2;
+
+pub const VDJ_PATTERN_MAX_STEPS: usize = 256;
+pub const VDJ_PATTERN_MAX_BEATS: usize = 64;
+pub const VDJ_PATTERN_SLOTS_PER_BEAT: usize = 64;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub struct VdjPatternStep {
+    pub length_beats: f64,
+    pub repeat_beats: f64,
+    pub volume: f32,
+    pub flags: u32,
+}
+
+extern "C" {
+    pub fn vdj_plugin_position_dsp_set_pattern(plugin: *mut VdjPluginPositionDsp, steps: *const VdjPatternStep, count: i32) -> HRESULT;
+}
+
+/* ============================================================================
+   DSP Silence Bypass
+   ============================================================================ */
+
+extern "C" {
+    pub fn vdj_plugin_dsp_set_silence_bypass(plugin: *mut VdjPluginDsp, silent_blocks: i32, tail_ms: f32, plugin_flags: u32) -> HRESULT;
+    pub fn vdj_plugin_dsp_is_idle(plugin: *mut VdjPluginDsp) -> i32;
+}
+
+/* ============================================================================
+   Callback Latency Histograms
+   ============================================================================ */
+
+pub const VDJ_PROFILE_PROCESS_SAMPLES: i32 = 0;
+pub const VDJ_PROFILE_GET_SONG_BUFFER: i32 = 1;
+pub const VDJ_PROFILE_TRANSFORM_POSITION: i32 = 2;
+pub const VDJ_PROFILE_DRAW: i32 = 3;
+pub const VDJ_PROFILE_AUDIO_SAMPLES: i32 = 4;
+pub const VDJ_PROFILE_PARAMETER: i32 = 5;
+pub const VDJ_PROFILE_START: i32 = 6;
+pub const VDJ_PROFILE_STOP: i32 = 7;
+pub const VDJ_PROFILE_DEVICE: i32 = 8;
+pub const VDJ_PROFILE_ONLINE_SOURCE: i32 = 9;
+pub const VDJ_PROFILE_LOAD: i32 = 10;
+pub const VDJ_PROFILE_CALLBACK_COUNT: i32 = 11;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjLatencyStats {
+    pub count: u64,
+    pub overruns: u64,
+    pub min_ns: u64,
+    pub max_ns: u64,
+    pub mean_ns: u64,
+    pub p50_ns: u64,
+    pub p90_ns: u64,
+    pub p99_ns: u64,
+    pub p999_ns: u64,
+}
+
+extern "C" {
+    pub fn vdj_plugin_set_profiling(plugin: *mut VdjPlugin, enabled: i32) -> HRESULT;
+    pub fn vdj_plugin_get_latency_stats(plugin: *mut VdjPlugin, callback: i32, stats: *mut VdjLatencyStats) -> HRESULT;
+    pub fn vdj_plugin_reset_latency_stats(plugin: *mut VdjPlugin) -> HRESULT;
+    pub fn vdj_plugin_dump_latency_histograms(plugin: *mut VdjPlugin, path: *const u8) -> HRESULT;
+}
+
+/* ============================================================================
+   Callback Trace Recorder
+   ============================================================================ */
+
+extern "C" {
+    pub fn vdj_plugin_trace_start(path: *const u8) -> HRESULT;
+    pub fn vdj_plugin_trace_stop() -> HRESULT;
+    pub fn vdj_plugin_trace_dropped_spans() -> u64;
+    pub fn vdj_plugin_get_instance_id(plugin: *mut VdjPlugin) -> u32;
+}
+
+/* ============================================================================
+   Realtime-Safety Checker
+   ============================================================================ */
+
+pub const VDJ_RT_VIOLATION_ALLOC: i32 = 0;
+pub const VDJ_RT_VIOLATION_FREE: i32 = 1;
+pub const VDJ_RT_VIOLATION_LOCK: i32 = 2;
+pub const VDJ_RT_VIOLATION_SYSCALL: i32 = 3;
+pub const VDJ_RT_VIOLATION_KINDS: usize = 4;
+
+pub const VDJ_RT_CHECK_ABORT: u32 = 0x1;
+pub const VDJ_RT_CHECK_BACKTRACE: u32 = 0x2;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjRtViolations {
+    pub counts: [u64; VDJ_RT_VIOLATION_KINDS],
+}
+
+extern "C" {
+    pub fn vdj_plugin_rt_check_enable(enabled: i32, flags: u32) -> HRESULT;
+    pub fn vdj_plugin_rt_enter();
+    pub fn vdj_plugin_rt_leave();
+    pub fn vdj_plugin_rt_report_violation(kind: i32);
+    pub fn vdj_plugin_rt_check_get_violations(violations: *mut VdjRtViolations) -> HRESULT;
+    pub fn vdj_plugin_rt_check_reset() -> HRESULT;
+    pub fn vdj_plugin_rt_check_dump(path: *const u8) -> HRESULT;
+}
+
+/* ============================================================================
+   Realtime-Safe Logger
+   ============================================================================ */
+
+pub const VDJ_LOG_ERROR: i32 = 0;
+pub const VDJ_LOG_WARN: i32 = 1;
+pub const VDJ_LOG_INFO: i32 = 2;
+pub const VDJ_LOG_DEBUG: i32 = 3;
+pub const VDJ_LOG_TRACE: i32 = 4;
+
+pub const VDJ_LOG_MAX_ARGS: usize = 6;
+pub const VDJ_LOG_MAX_FORMATS: usize = 1024;
+
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub union VdjLogArg {
+    pub i: i64,
+    pub f: f64,
+}
+
+extern "C" {
+    pub fn vdj_plugin_log_register_format(format: *const u8) -> i32;
+    pub fn vdj_plugin_log_open(path: *const u8, max_level: i32) -> HRESULT;
+    pub fn vdj_plugin_log_close() -> HRESULT;
+    pub fn vdj_plugin_log_write(level: i32, format_id: i32, args: *const VdjLogArg, arg_count: i32) -> HRESULT;
+    pub fn vdj_plugin_log_dropped_records() -> u64;
+}
+
+/* ============================================================================
+   Deferred Command Queue
+   ============================================================================ */
+
+pub const VDJ_COMMAND_QUEUE_SIZE: usize = 256;
+pub const VDJ_COMMAND_MAX_INTERNED: usize = 256;
+pub const VDJ_COMMAND_POLL_MS: u32 = 1;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjCommandStats {
+    pub queued: u64,
+    pub dropped: u64,
+    pub dispatched: u64,
+    pub failed: u64,
+    pub max_latency_ns: u64,
+    pub mean_latency_ns: u64,
+}
+
+extern "C" {
+    pub fn vdj_plugin_intern_command(plugin: *mut VdjPlugin, command: *const u8) -> i32;
+    pub fn vdj_plugin_queue_command(plugin: *mut VdjPlugin, command_id: i32) -> HRESULT;
+    pub fn vdj_plugin_flush_commands(plugin: *mut VdjPlugin) -> HRESULT;
+    pub fn vdj_plugin_get_command_stats(plugin: *mut VdjPlugin, stats: *mut VdjCommandStats) -> HRESULT;
+}
+
+/* ============================================================================
+   Callback Recorder
+   ============================================================================ */
+
+pub const VDJ_REPLAY_MAGIC: u32 = 0x524A4456;
+pub const VDJ_REPLAY_VERSION: u32 = 1;
+
+pub const VDJ_REPLAY_START: u16 = 0;
+pub const VDJ_REPLAY_STOP: u16 = 1;
+pub const VDJ_REPLAY_PARAMETER: u16 = 2;
+pub const VDJ_REPLAY_PROCESS_SAMPLES: u16 = 3;
+pub const VDJ_REPLAY_TRANSFORM_POSITION: u16 = 4;
+pub const VDJ_REPLAY_GET_SONG_BUFFER: u16 = 5;
+pub const VDJ_REPLAY_GET_INFO: u16 = 6;
+pub const VDJ_REPLAY_GET_STRING_INFO: u16 = 7;
+pub const VDJ_REPLAY_SONG_AUDIO: u16 = 8;
+
+pub const VDJ_REPLAY_FLAG_COMPRESSED: u16 = 0x1;
+
+pub const VDJ_REPLAY_PARAMETER_UNKNOWN: i32 = -1;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjReplayFileHeader {
+    pub magic: u32,
+    pub version: u32,
+    pub instance_id: u32,
+    pub reserved: u32,
+}
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjReplayRecordHeader {
+    pub kind: u16,
+    pub flags: u16,
+    pub size: u32,
+    pub time_ns: u64,
+}
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct VdjReplayParameter {
+    pub id: i32,
+    pub param_type: i32,
+    pub value: f64,
+}
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct VdjReplayBlock {
+    pub nb: i32,
+    pub sample_rate: i32,
+    pub song_bpm: i32,
+    pub song_pos: i32,
+    pub song_pos_beats: f64,
+}
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct VdjReplayPosition {
+    pub song_pos: f64,
+    pub video_pos: f64,
+    pub volume: f32,
+    pub src_volume: f32,
+    pub song_pos_beats: f64,
+    pub song_bpm: i32,
+    pub sample_rate: i32,
+}
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct VdjReplayQuery {
+    pub hr: HRESULT,
+    pub command_size: u32,
+    pub result_size: u32,
+    pub reserved: u32,
+    pub value: f64,
+}
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct VdjReplaySongAudio {
+    pub hr: HRESULT,
+    pub pos: i32,
+    pub nb: i32,
+    pub reserved: u32,
+}
+
+extern "C" {
+    pub fn vdj_plugin_replay_record_start(plugin: *mut VdjPlugin, path: *const u8) -> HRESULT;
+    pub fn vdj_plugin_replay_record_stop() -> HRESULT;
+    pub fn vdj_plugin_replay_dropped_records() -> u64;
+}
+
+/* ============================================================================
+   Instance Memory
+   ============================================================================ */
+
+pub const VDJ_CACHE_LINE_SIZE: usize = 64;
+
+pub const VDJ_STATE_LOCK: u32 = 0x1;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjMemoryStats {
+    pub instance_bytes: u64,
+    pub state_bytes: u64,
+    pub locked_bytes: u64,
+    pub facility_bytes: u64,
+}
+
+extern "C" {
+    pub fn vdj_plugin_reserve_state(plugin: *mut VdjPlugin, bytes: u64, flags: u32, region: *mut *mut c_void) -> HRESULT;
+    pub fn vdj_plugin_get_memory_stats(plugin: *mut VdjPlugin, stats: *mut VdjMemoryStats) -> HRESULT;
+}
+
+/* ============================================================================
+   Scratch Arena
+   ============================================================================ */
+
+pub const VDJ_SCRATCH_ALIGN: usize = 16;
+pub const VDJ_SCRATCH_MAX_BYTES: u64 = 1 << 30;
+
+#[repr(C)]
+#[derive(Debug)]
+pub struct VdjScratchArena {
+    pub base: *mut u8,
+    pub capacity: u64,
+    pub used: u64,
+    pub demand: u64,
+}
+
+extern "C" {
+    pub fn vdj_plugin_get_scratch(plugin: *mut VdjPlugin) -> *mut VdjScratchArena;
+    pub fn vdj_plugin_reserve_scratch(plugin: *mut VdjPlugin, bytes: u64) -> HRESULT;
+}
+
+/* ============================================================================
+   Parameter Snapshots
+   ============================================================================ */
+
+pub const VDJ_SNAPSHOT_MAGIC: u32 = 0x534A4456;
+pub const VDJ_SNAPSHOT_VERSION: u32 = 1;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjSnapshotHeader {
+    pub magic: u32,
+    pub version: u32,
+    pub param_count: u32,
+    pub reserved: u32,
+    pub opaque_offset: u64,
+    pub opaque_size: u64,
+    pub total_size: u64,
+}
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjSnapshotParam {
+    pub id: i32,
+    pub param_type: i32,
+    pub size: u32,
+    pub reserved: u32,
+}
+
+extern "C" {
+    pub fn vdj_plugin_save_snapshot(plugin: *mut VdjPlugin, opaque: *const c_void, opaque_size: u64, out: *mut c_void, capacity: u64, size: *mut u64) -> HRESULT;
+    pub fn vdj_plugin_stage_snapshot(plugin: *mut VdjPlugin, data: *const c_void, size: u64) -> HRESULT;
+    pub fn vdj_plugin_applied_snapshot(plugin: *mut VdjPlugin, data: *mut *const c_void, size: *mut u64) -> HRESULT;
+}
+
+/* ============================================================================
+   Preset Morphing
+   ============================================================================ */
+
+pub const VDJ_MORPH_MAX_SNAPSHOTS: usize = 16;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct VdjMorphChanges {
+    pub ids: *const i32,
+    pub count: i32,
+    pub position: f32,
+}
+
+extern "C" {
+    pub fn vdj_plugin_set_morph(plugin: *mut VdjPlugin, position_id: i32, snapshots: *const *const c_void, sizes: *const u64, count: i32) -> HRESULT;
+    pub fn vdj_plugin_get_morph_changes(plugin: *mut VdjPlugin, changes: *mut VdjMorphChanges) -> HRESULT;
+}
+
+/* ============================================================================
+   Shared Parameter Blobs
+   ============================================================================ */
+
+pub const VDJ_SHARED_BLOB_SLOTS: usize = 16;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct VdjSharedBlobStats {
+    pub blobs: u64,
+    pub bytes: u64,
+    pub references: u64,
+    pub shared_bytes: u64,
+}
+
+extern "C" {
+    pub fn vdj_plugin_set_shared_blob(plugin: *mut VdjPlugin, id: i32, data: *const c_void, size: u64) -> HRESULT;
+    pub fn vdj_plugin_edit_shared_blob(plugin: *mut VdjPlugin, id: i32, offset: u64, data: *const c_void, size: u64) -> HRESULT;
+    pub fn vdj_plugin_get_shared_blob(plugin: *mut VdjPlugin, id: i32, data: *mut *const c_void, size: *mut u64) -> HRESULT;
+    pub fn vdj_plugin_get_shared_blob_stats(stats: *mut VdjSharedBlobStats) -> HRESULT;
+}
+
+/* ============================================================================
+   Lookup Tables
+   ============================================================================ */
+
+pub const VDJ_LUT_SIZE: usize = 1025;
+
+pub const VDJ_LUT_SINE: i32 = 0;
+pub const VDJ_LUT_DB_TO_GAIN: i32 = 1;
+pub const VDJ_LUT_LOG2: i32 = 2;
+pub const VDJ_LUT_TANH: i32 = 3;
+pub const VDJ_LUT_HANN: i32 = 4;
+pub const VDJ_LUT_BLACKMAN: i32 = 5;
+pub const VDJ_LUT_NOTE_TO_FREQ: i32 = 6;
+pub const VDJ_LUT_COUNT: i32 = 7;
+
+pub const VDJ_LUT_WRAP: u32 = 0x1;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct VdjLut {
+    pub values: *const f32,
+    pub min: f32,
+    pub max: f32,
+    pub scale: f32,
+    pub flags: u32,
+}
+
+extern "C" {
+    pub fn vdj_lut_get(table: i32, lut: *mut VdjLut) -> HRESULT;
+    pub fn vdj_lut_lookup(table: i32, input: *const f32, output: *mut f32, count: i32) -> HRESULT;
+}
+
+/* ============================================================================
+   Fast Math
+   ============================================================================ */
+
+pub const VDJ_MATH_FAST: i32 = 0;
+pub const VDJ_MATH_PRECISE: i32 = 1;
+
+pub const VDJ_MATH_ISA_SCALAR: i32 = 0;
+pub const VDJ_MATH_ISA_SSE2: i32 = 1;
+pub const VDJ_MATH_ISA_NEON: i32 = 2;
+pub const VDJ_MATH_ISA_AVX2: i32 = 3;
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default)]
+pub struct VdjMathInfo {
+    pub isa: i32,
+    pub width: i32,
+}
+
+extern "C" {
+    pub fn vdj_math_exp(input: *const f32, output: *mut f32, count: i32, tier: i32) -> HRESULT;
+    pub fn vdj_math_log(input: *const f32, output: *mut f32, count: i32, tier: i32) -> HRESULT;
+    pub fn vdj_math_sin(input: *const f32, output: *mut f32, count: i32, tier: i32) -> HRESULT;
+    pub fn vdj_math_tanh(input: *const f32, output: *mut f32, count: i32, tier: i32) -> HRESULT;
+    pub fn vdj_math_pow(base: *const f32, exponent: *const f32, output: *mut f32, count: i32, tier: i32) -> HRESULT;
+    pub fn vdj_math_get_info(info: *mut VdjMathInfo) -> HRESULT;
+    pub fn vdj_math_select_isa(isa: i32) -> HRESULT;
+}
+
+/* ============================================================================
+   Sample Conversion
+   ============================================================================ */
+
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default)]
+pub struct VdjDither {
+    pub state: [u32; 8],
+}
+
+extern "C" {
+    pub fn vdj_dither_init(dither: *mut VdjDither, seed: u32) -> HRESULT;
+    pub fn vdj_convert_int16_to_float(input: *const i16, output: *mut f32, count: i32) -> HRESULT;
+    pub fn vdj_convert_float_to_int16(input: *const f32, output: *mut i16, count: i32, dither: *mut VdjDither) -> HRESULT;
+}
+
+/* ============================================================================
+   Resampler
+   ============================================================================ */
+
+pub const VDJ_RESAMPLER_TAPS: i32 = 32;
+pub const VDJ_RESAMPLER_PHASES: i32 = 128;
+pub const VDJ_RESAMPLER_MAX_RATIO: i32 = 16;
+
+#[repr(C)]
+pub struct VdjResampler {
+    _priv: [u8; 0],
+}
+
+extern "C" {
+    pub fn vdj_resampler_create(max_frames: i32) -> *mut VdjResampler;
+    pub fn vdj_resampler_release(resampler: *mut VdjResampler);
+    pub fn vdj_resampler_set_position(resampler: *mut VdjResampler, frame: f64) -> HRESULT;
+    pub fn vdj_resampler_get_position(resampler: *const VdjResampler) -> f64;
+    pub fn vdj_resampler_process_song(resampler: *mut VdjResampler, plugin: *mut VdjPluginBufferDsp, ratio_start: f32, ratio_end: f32, output: *mut f32, nb: i32) -> HRESULT;
+}
+
 /* ============================================================================
    Buffer DSP Plugin FFI Functions
    ============================================================================ */
@@ -201,6 +724,7 @@ extern "C" {
     pub fn vdj_plugin_buffer_dsp_on_stop(plugin: *mut VdjPluginBufferDsp) -> HRESULT;
     pub fn vdj_plugin_buffer_dsp_on_get_song_buffer(plugin: *mut VdjPluginBufferDsp, song_pos: i32, nb: i32) -> *mut i16;
     pub fn vdj_plugin_buffer_dsp_get_song_buffer(plugin: *mut VdjPluginBufferDsp, pos: i32, nb: i32, buffer: *mut *mut i16) -> HRESULT;
+    pub fn vdj_plugin_buffer_dsp_get_song_buffer_float(plugin: *mut VdjPluginBufferDsp, pos: i32, nb: i32, output: *mut f32) -> HRESULT;
     pub fn vdj_plugin_buffer_dsp_get_sample_rate(plugin: *mut VdjPluginBufferDsp) -> i32;
     pub fn vdj_plugin_buffer_dsp_get_song_bpm(plugin: *mut VdjPluginBufferDsp) -> i32;
     pub fn vdj_plugin_buffer_dsp_get_song_pos(plugin: *mut VdjPluginBufferDsp) -> i32;
@@ -0,0 +1,131 @@
+//! VirtualDJ Rust SDK - Stand-In Host
+//!
+//! Drives plugin trait implementations the way VirtualDJ does (start, a
+//! stream of fixed-size blocks, stop) without VirtualDJ, for tests, CI and
+//! offline tools. Every audio callback runs inside an
+//! [`rt_check::RealtimeScope`](crate::rt_check::RealtimeScope), so a binary
+//! installing `RtCheckAllocator` sees allocations made on the audio path.
+
+use std::time::Instant;
+
+use crate::rt_check::{self, RealtimeScope, RtViolations};
+use crate::{DspPlugin, PositionDspPlugin, Result};
+
+/// Number of interleaved channels in a host buffer
+pub const CHANNELS: usize = 2;
+
+/// Summary of a host run
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct HostReport {
+    pub blocks: u64,
+    pub frames: u64,
+    /// Slowest audio callback, in nanoseconds
+    pub max_block_ns: u64,
+    /// Allocator violations made by audio callbacks of this run
+    pub violations: RtViolations,
+}
+
+/// A minimal host driving plugins block by block
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StandInHost {
+    pub sample_rate: i32,
+    /// Frames per block (VirtualDJ uses 32 to 1024 depending on the driver)
+    pub block_frames: usize,
+}
+
+impl StandInHost {
+    pub fn new(sample_rate: i32, block_frames: usize) -> Self {
+        StandInHost {
+            sample_rate,
+            block_frames: block_frames.max(1),
+        }
+    }
+
+    /// Interleaved samples in one block
+    pub fn block_samples(&self) -> usize {
+        self.block_frames * CHANNELS
+    }
+
+    /// Run one DSP callback in a realtime scope
+    pub fn process_dsp_block<P: DspPlugin + ?Sized>(
+        &self,
+        plugin: &mut P,
+        block: &mut [f32],
+    ) -> Result<()> {
+        let _realtime = RealtimeScope::enter();
+        plugin.on_process_samples(block)
+    }
+
+    /// Start a DSP plugin, process `buffer` in blocks and stop it
+    ///
+    /// The last block is shorter when `buffer` is not a multiple of the block
+    /// size, as at the end of a track.
+    pub fn run_dsp<P: DspPlugin + ?Sized>(
+        &self,
+        plugin: &mut P,
+        buffer: &mut [f32],
+    ) -> Result<HostReport> {
+        let before = rt_check::thread_violations();
+        let mut report = HostReport::default();
+
+        DspPlugin::on_start(plugin)?;
+        for block in buffer.chunks_mut(self.block_samples()) {
+            let start = Instant::now();
+            self.process_dsp_block(plugin, block)?;
+            report.max_block_ns = report.max_block_ns.max(start.elapsed().as_nanos() as u64);
+            report.blocks += 1;
+            report.frames += (block.len() / CHANNELS) as u64;
+        }
+        DspPlugin::on_stop(plugin)?;
+
+        report.violations = rt_check::thread_violations().since(&before);
+        Ok(report)
+    }
+
+    /// Start a position DSP plugin and play `blocks` blocks from
+    /// `song_pos` (in samples), returning the transformed position of each
+    ///
+    /// `positions` is filled with one transformed position per block; it is
+    /// cleared first and should have capacity for `blocks` entries so the
+    /// audio path does not allocate.
+    pub fn run_position_dsp<P: PositionDspPlugin + ?Sized>(
+        &self,
+        plugin: &mut P,
+        song_pos: f64,
+        blocks: usize,
+        positions: &mut Vec<f64>,
+    ) -> Result<HostReport> {
+        let before = rt_check::thread_violations();
+        let mut report = HostReport::default();
+        let mut scratch = vec![0.0f32; self.block_samples()];
+        positions.clear();
+        positions.reserve(blocks);
+
+        PositionDspPlugin::on_start(plugin)?;
+        for i in 0..blocks {
+            let start = Instant::now();
+            {
+                let _realtime = RealtimeScope::enter();
+                let mut pos = song_pos + (i * self.block_frames) as f64;
+                let mut video_pos = pos;
+                let mut volume = 1.0f32;
+                let mut src_volume = 1.0f32;
+                plugin.on_transform_position(
+                    &mut pos,
+                    &mut video_pos,
+                    &mut volume,
+                    &mut src_volume,
+                )?;
+                PositionDspPlugin::on_process_samples(plugin, &mut scratch)?;
+                positions.push(pos);
+            }
+            report.max_block_ns = report.max_block_ns.max(start.elapsed().as_nanos() as u64);
+            report.blocks += 1;
+            report.frames += self.block_frames as u64;
+        }
+        PositionDspPlugin::on_stop(plugin)?;
+
+        report.violations = rt_check::thread_violations().since(&before);
+        Ok(report)
+    }
+}
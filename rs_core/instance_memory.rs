@@ -0,0 +1,176 @@
+//! VirtualDJ Rust SDK - Instance Memory
+//!
+//! The shim gives every plugin instance cache lines of its own, so the
+//! host-written fields of two instances never share a line, and can reserve a
+//! page-aligned region for the plugin's own state. Every page of the region is
+//! touched when it is reserved, and optionally locked in RAM, so delay lines
+//! and tables carved from it never page-fault on the audio thread, including
+//! in the first blocks after the effect is enabled.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // right after creating the instance, before its first callback
+//! let mut state = unsafe { instance_memory::reserve_state(handle, 1 << 20, true)? };
+//! self.delay = state.take::<f32>(48000 * 2).ok_or(PluginError::Fail)?;
+//! self.window = state.take::<f32>(4096).ok_or(PluginError::Fail)?;
+//! ```
+//!
+//! All functions take a generic plugin handle: cast DSP, video and other
+//! handles with `handle as *mut ffi::VdjPlugin`.
+
+use std::ffi::c_void;
+use std::mem::{align_of, size_of};
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Memory held by one instance, in bytes
+pub type MemoryStats = ffi::VdjMemoryStats;
+
+impl MemoryStats {
+    /// Everything the instance holds
+    pub fn total_bytes(&self) -> u64 {
+        self.instance_bytes + self.state_bytes + self.facility_bytes
+    }
+}
+
+/// Memory to carve plugin state from
+///
+/// Each [`take`](StateRegion::take) starts on a cache line, so buffers
+/// written by different threads never share one.
+#[derive(Debug)]
+pub struct StateRegion<'a> {
+    memory: &'a mut [u8],
+    locked: bool,
+}
+
+impl<'a> StateRegion<'a> {
+    /// Carve from any byte buffer (the shim's region is used by
+    /// [`reserve_state`])
+    pub fn new(memory: &'a mut [u8]) -> Self {
+        StateRegion {
+            memory,
+            locked: false,
+        }
+    }
+
+    /// True when the region is locked in RAM
+    pub fn locked(&self) -> bool {
+        self.locked
+    }
+
+    /// Bytes left, before alignment
+    pub fn remaining(&self) -> usize {
+        self.memory.len()
+    }
+
+    /// Take `count` values filled with `T::default()`, or `None` when the
+    /// region is exhausted
+    pub fn take<T: Copy + Default>(&mut self, count: usize) -> Option<&'a mut [T]> {
+        assert!(align_of::<T>() <= ffi::VDJ_CACHE_LINE_SIZE);
+        let bytes = count.checked_mul(size_of::<T>())?;
+        let offset = self.memory.as_ptr().align_offset(ffi::VDJ_CACHE_LINE_SIZE);
+        if offset.checked_add(bytes)? > self.memory.len() {
+            return None;
+        }
+
+        let memory = std::mem::take(&mut self.memory);
+        let (head, tail) = memory[offset..].split_at_mut(bytes);
+        self.memory = tail;
+        let values = head.as_mut_ptr() as *mut T;
+        // SAFETY: head is `bytes` long, aligned for T and not borrowed
+        // elsewhere; every value is written before the slice is made, as the
+        // bytes need not be a valid T
+        unsafe {
+            for i in 0..count {
+                values.add(i).write(T::default());
+            }
+            Some(std::slice::from_raw_parts_mut(values, count))
+        }
+    }
+}
+
+/// Reserve a zeroed, pre-faulted region of at least `bytes` for the plugin's
+/// state, freed when the instance is released
+///
+/// Call once, right after creating the instance and before its first
+/// callback. With `lock` the pages are also locked in RAM; if the OS refuses
+/// the region is still returned and [`StateRegion::locked`] is false.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type, and neither the region
+/// nor anything taken from it may be used after the instance is released.
+pub unsafe fn reserve_state<'a>(
+    plugin: *mut ffi::VdjPlugin,
+    bytes: usize,
+    lock: bool,
+) -> Result<StateRegion<'a>> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let flags = if lock { ffi::VDJ_STATE_LOCK } else { 0 };
+    let mut region: *mut c_void = std::ptr::null_mut();
+    match ffi::vdj_plugin_reserve_state(plugin, bytes as u64, flags, &mut region) {
+        hr @ (ffi::S_OK | ffi::S_FALSE) if !region.is_null() => Ok(StateRegion {
+            memory: std::slice::from_raw_parts_mut(region as *mut u8, bytes),
+            locked: lock && hr == ffi::S_OK,
+        }),
+        ffi::S_OK | ffi::S_FALSE => Err(PluginError::Fail),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Read how much memory an instance holds
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn memory_stats(plugin: *mut ffi::VdjPlugin) -> Result<MemoryStats> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let mut stats = MemoryStats::default();
+    match ffi::vdj_plugin_get_memory_stats(plugin, &mut stats) {
+        ffi::S_OK => Ok(stats),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_take_aligns_and_fills() {
+        let mut buffer = vec![0xffu8; 4096];
+        let mut region = StateRegion::new(&mut buffer);
+        let a = region.take::<f32>(3).unwrap();
+        let b = region.take::<i16>(100).unwrap();
+        assert_eq!(a, &[0.0; 3]);
+        assert!(b.iter().all(|&s| s == 0));
+        assert_eq!(a.as_ptr() as usize % ffi::VDJ_CACHE_LINE_SIZE, 0);
+        assert_eq!(b.as_ptr() as usize % ffi::VDJ_CACHE_LINE_SIZE, 0);
+        // b starts on the cache line after a's 12 bytes
+        assert_eq!(
+            b.as_ptr() as usize - a.as_ptr() as usize,
+            ffi::VDJ_CACHE_LINE_SIZE
+        );
+        a[2] = 1.0;
+        b[99] = -1;
+
+        assert!(region.take::<f64>(4096).is_none());
+        assert!(region.take::<u8>(usize::MAX).is_none());
+        assert!(region.take::<u8>(region.remaining() - 64).is_some());
+    }
+
+    #[test]
+    fn test_total_bytes() {
+        let stats = MemoryStats {
+            instance_bytes: 6528,
+            state_bytes: 1 << 20,
+            locked_bytes: 1 << 20,
+            facility_bytes: 58692,
+        };
+        assert_eq!(stats.total_bytes(), 6528 + (1 << 20) + 58692);
+    }
+}
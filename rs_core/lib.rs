@@ -4,6 +4,29 @@
 //! It wraps the low-level FFI bindings with proper error handling and memory safety.
 
 pub mod ffi;
+pub mod baseline;
+pub mod beat_grid;
+pub mod commands;
+pub mod fast_math;
+pub mod host;
+pub mod instance_memory;
+pub mod lut;
+pub mod modulation;
+pub mod morph;
+pub mod param_ramp;
+pub mod position_pattern;
+pub mod presets;
+pub mod profiling;
+pub mod render;
+pub mod replay;
+pub mod resampler;
+pub mod rt_check;
+pub mod rt_log;
+pub mod sample_convert;
+pub mod scratch;
+pub mod shared_blob;
+pub mod silence;
+pub mod trace;
 
 use std::ffi::{CStr, CString};
 use std::fmt;
@@ -148,8 +171,35 @@ impl PluginContext {
         }
     }
 
+    /// Read `nb` frames of the song's interleaved stereo audio from `pos`
+    ///
+    /// For buffer DSP plugins; the samples stay valid until the callback
+    /// returns.
+    pub fn get_song_buffer(&self, pos: i32, nb: i32) -> Result<&[i16]> {
+        if self.plugin.is_null() || self.callbacks.is_null() {
+            return Err(PluginError::NullPointer);
+        }
+        if nb < 0 {
+            return Err(PluginError::Fail);
+        }
+
+        let mut buffer: *mut i16 = std::ptr::null_mut();
+        let hr = unsafe { ((*self.callbacks).get_song_buffer)(self.plugin, pos, nb, &mut buffer) };
+
+        if hr != ffi::S_OK {
+            Err(PluginError::from(hr))
+        } else if buffer.is_null() {
+            Err(PluginError::NullPointer)
+        } else {
+            Ok(unsafe { std::slice::from_raw_parts(buffer, nb as usize * 2) })
+        }
+    }
+
     /// Send a command to VirtualDJ
     /// 
+    /// Runs the script on the calling thread and may block: from the audio
+    /// thread, queue an interned command with `commands::queue_command`.
+    /// 
     /// # Arguments
     /// * `command` - The VDJ script command (e.g., "deck 1 play")
     /// 
@@ -0,0 +1,239 @@
+//! VirtualDJ Rust SDK - Lookup Tables
+//!
+//! Sine, dB to gain, log2, tanh, Hann and Blackman windows and MIDI note to
+//! frequency, as tables the shim generates at compile time and keeps in its
+//! read-only data. Every plugin in the process reads the same pages, nothing
+//! is computed at startup, and [`Lut::lookup`] is an inlined interpolation
+//! over a `'static` slice, without crossing the FFI boundary per sample.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // when loading
+//! let sine = lut::lut(Table::Sine)?;
+//! let db = lut::lut(Table::DbToGain)?;
+//!
+//! // in on_process_samples
+//! let gain = db.lookup(self.gain_db);
+//! for (i, sample) in buffer.iter_mut().enumerate() {
+//!     *sample *= gain * sine.lookup(self.phase + i as f32 * self.step);
+//! }
+//! ```
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// The tables the shim provides
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Table {
+    /// `sin(2 pi x)`, x in cycles, wrapping
+    Sine,
+    /// `10^(x / 20)`, x from -144 to +24 dB
+    DbToGain,
+    /// `log2(x)`, x from 1 to 2; see [`gain_to_db`]
+    Log2,
+    /// `tanh(x)`, x from -8 to 8
+    Tanh,
+    /// Hann window, x from 0 to 1
+    Hann,
+    /// Blackman window, x from 0 to 1
+    Blackman,
+    /// `440 * 2^((x - 69) / 12)` Hz, x from MIDI note 0 to 128
+    NoteToFreq,
+}
+
+impl Table {
+    fn to_ffi(self) -> i32 {
+        match self {
+            Table::Sine => ffi::VDJ_LUT_SINE,
+            Table::DbToGain => ffi::VDJ_LUT_DB_TO_GAIN,
+            Table::Log2 => ffi::VDJ_LUT_LOG2,
+            Table::Tanh => ffi::VDJ_LUT_TANH,
+            Table::Hann => ffi::VDJ_LUT_HANN,
+            Table::Blackman => ffi::VDJ_LUT_BLACKMAN,
+            Table::NoteToFreq => ffi::VDJ_LUT_NOTE_TO_FREQ,
+        }
+    }
+}
+
+/// A table of values at evenly spaced points from `min` to `max`
+#[derive(Debug, Clone, Copy)]
+pub struct Lut {
+    values: &'static [f32],
+    min: f32,
+    scale: f32,
+    wrap: bool,
+}
+
+impl Lut {
+    /// Look up any table laid out like the shim's: at least two values from
+    /// `min` to `max`, both included
+    pub fn from_values(values: &'static [f32], min: f32, max: f32, wrap: bool) -> Self {
+        assert!(values.len() >= 2 && max > min);
+        Lut {
+            values,
+            min,
+            scale: (values.len() - 1) as f32 / (max - min),
+            wrap,
+        }
+    }
+
+    /// # Safety
+    /// `lut.values` must point to `VDJ_LUT_SIZE` values that are never freed.
+    pub unsafe fn from_ffi(lut: &ffi::VdjLut) -> Self {
+        Lut {
+            values: std::slice::from_raw_parts(lut.values, ffi::VDJ_LUT_SIZE),
+            min: lut.min,
+            scale: lut.scale,
+            wrap: lut.flags & ffi::VDJ_LUT_WRAP != 0,
+        }
+    }
+
+    pub fn values(&self) -> &'static [f32] {
+        self.values
+    }
+
+    /// The function at `x`, interpolated linearly, with `x` clamped to the
+    /// table's range or wrapped around it
+    #[inline]
+    pub fn lookup(&self, x: f32) -> f32 {
+        let last = (self.values.len() - 1) as f32;
+        let mut pos = (x - self.min) * self.scale;
+        if self.wrap {
+            pos -= (pos / last).floor() * last;
+        }
+        // Clamp, sending NaN to the first point
+        pos = if pos > 0.0 { pos.min(last) } else { 0.0 };
+        let i = (pos as usize).min(self.values.len() - 2);
+        let a = self.values[i];
+        a + (self.values[i + 1] - a) * (pos - i as f32)
+    }
+
+    /// [`lookup`](Self::lookup) of every input; stops at the shorter slice
+    pub fn lookup_block(&self, input: &[f32], output: &mut [f32]) {
+        for (out, &x) in output.iter_mut().zip(input) {
+            *out = self.lookup(x);
+        }
+    }
+
+    /// Fill `window` with this table sampled from 0 to 1, as for the window
+    /// tables
+    pub fn fill_window(&self, window: &mut [f32]) {
+        let step = 1.0 / window.len().saturating_sub(1).max(1) as f32;
+        for (i, w) in window.iter_mut().enumerate() {
+            *w = self.lookup(i as f32 * step);
+        }
+    }
+}
+
+/// `20 log10(gain)` with the [`Table::Log2`] table: the exponent comes from
+/// the float's bits and the table covers the mantissa. Gains of zero or
+/// less give `-inf`.
+#[inline]
+pub fn gain_to_db(log2: &Lut, gain: f32) -> f32 {
+    const DB_PER_OCTAVE: f32 = 20.0 * std::f32::consts::LOG10_2;
+    if gain.is_nan() || gain <= 0.0 {
+        return f32::NEG_INFINITY;
+    }
+    if gain.is_infinite() {
+        return f32::INFINITY;
+    }
+    // Scale subnormals into the normal range first
+    let (gain, offset) = if gain < f32::MIN_POSITIVE {
+        (gain * (1u64 << 32) as f32, -32)
+    } else {
+        (gain, 0)
+    };
+    let bits = gain.to_bits();
+    let exponent = ((bits >> 23) & 0xff) as i32 - 127 + offset;
+    let mantissa = f32::from_bits((bits & 0x007f_ffff) | 0x3f80_0000);
+    DB_PER_OCTAVE * (exponent as f32 + log2.lookup(mantissa))
+}
+
+/// The shim's table `table`
+pub fn lut(table: Table) -> Result<Lut> {
+    let mut raw = ffi::VdjLut {
+        values: std::ptr::null(),
+        min: 0.0,
+        max: 0.0,
+        scale: 0.0,
+        flags: 0,
+    };
+    match unsafe { ffi::vdj_lut_get(table.to_ffi(), &mut raw) } {
+        ffi::S_OK if !raw.values.is_null() => Ok(unsafe { Lut::from_ffi(&raw) }),
+        ffi::S_OK => Err(PluginError::Fail),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn table(min: f64, max: f64, wrap: bool, f: impl Fn(f64) -> f64) -> Lut {
+        let values: Vec<f32> = (0..ffi::VDJ_LUT_SIZE)
+            .map(|i| f(min + (max - min) * i as f64 / (ffi::VDJ_LUT_SIZE - 1) as f64) as f32)
+            .collect();
+        Lut::from_values(
+            Box::leak(values.into_boxed_slice()),
+            min as f32,
+            max as f32,
+            wrap,
+        )
+    }
+
+    #[test]
+    fn test_lookup_interpolates_and_clamps() {
+        let tanh = table(-8.0, 8.0, false, f64::tanh);
+        for i in 0..1000 {
+            let x = -8.0 + 16.0 * (i as f32 + 0.37) / 1000.0;
+            assert!((tanh.lookup(x) - x.tanh()).abs() < 5e-5, "tanh({})", x);
+        }
+        assert_eq!(tanh.lookup(100.0), tanh.values()[ffi::VDJ_LUT_SIZE - 1]);
+        assert_eq!(tanh.lookup(-100.0), tanh.values()[0]);
+        assert_eq!(tanh.lookup(f32::NAN), tanh.values()[0]);
+    }
+
+    #[test]
+    fn test_sine_wraps() {
+        let sine = table(0.0, 1.0, true, |x| (2.0 * std::f64::consts::PI * x).sin());
+        assert!((sine.lookup(1.25) - 1.0).abs() < 1e-6);
+        assert!((sine.lookup(-0.75) - 1.0).abs() < 1e-6);
+        assert!((sine.lookup(7.5)).abs() < 1e-5);
+
+        let input = [0.0, 0.25, 0.5, 0.75];
+        let mut output = [9.0; 4];
+        sine.lookup_block(&input, &mut output);
+        for (y, expected) in output.iter().zip([0.0, 1.0, 0.0, -1.0]) {
+            assert!((y - expected).abs() < 1e-6);
+        }
+    }
+
+    #[test]
+    fn test_gain_to_db() {
+        let log2 = table(1.0, 2.0, false, f64::log2);
+        for gain in [1.0f32, 0.5, 2.0, 0.001, 3.7, 1e-40] {
+            let db = gain_to_db(&log2, gain);
+            assert!(
+                (db - 20.0 * gain.log10()).abs() < 1e-3,
+                "{} -> {}",
+                gain,
+                db
+            );
+        }
+        assert_eq!(gain_to_db(&log2, 0.0), f32::NEG_INFINITY);
+        assert_eq!(gain_to_db(&log2, -1.0), f32::NEG_INFINITY);
+    }
+
+    #[test]
+    fn test_fill_window() {
+        let hann = table(0.0, 1.0, false, |x| {
+            (std::f64::consts::PI * x).sin().powi(2)
+        });
+        let mut window = [1.0; 5];
+        hann.fill_window(&mut window);
+        for (w, expected) in window.iter().zip([0.0, 0.5, 1.0, 0.5, 0.0]) {
+            assert!((w - expected).abs() < 1e-6);
+        }
+    }
+}
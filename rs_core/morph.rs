@@ -0,0 +1,215 @@
+//! VirtualDJ Rust SDK - Preset Morphing
+//!
+//! Sweeps the declared parameters between two or more snapshots with a
+//! single slider, the morph position. The shim compiles the snapshots once,
+//! then at the start of every block where the position moved it
+//! interpolates the continuous parameters (slider, ColorFX, beats, release
+//! and transition FX) with vectorized kernels, snaps the others to the
+//! nearer snapshot, and writes them in place. `on_parameter` is not called
+//! for them: the block's callback reads the ids that changed from
+//! [`morph_changes`], so a macro knob over thirty parameters costs one pass
+//! and one change set.
+//!
+//! Opaque state is not morphed; [`segment`] tells the plugin which two
+//! snapshots the position lies between if it wants to blend its own.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // control thread: parameter 100 is the "Morph" slider
+//! let presets = [bank.get(0).unwrap(), bank.get(1).unwrap(), bank.get(2).unwrap()];
+//! unsafe { morph::set_morph(handle, 100, &presets)? };
+//!
+//! // in on_process_samples
+//! if let Some(changes) = unsafe { morph::morph_changes(handle) } {
+//!     for &id in changes.ids {
+//!         self.update_coefficients(id);
+//!     }
+//! }
+//! ```
+//!
+//! All functions take a generic plugin handle: cast DSP, video and other
+//! handles with `handle as *mut ffi::VdjPlugin`.
+
+use std::ffi::c_void;
+
+use crate::ffi;
+use crate::presets::Snapshot;
+use crate::{PluginError, Result};
+
+/// The two snapshots around a morph position
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct Segment {
+    pub from: usize,
+    pub to: usize,
+    /// 0 at `from`, 1 at `to`
+    pub amount: f32,
+}
+
+impl Segment {
+    /// The snapshot discrete parameters snap to
+    pub fn nearest(&self) -> usize {
+        if self.amount < 0.5 {
+            self.from
+        } else {
+            self.to
+        }
+    }
+}
+
+/// Where `position` falls among `count` snapshots spaced evenly over 0..1,
+/// computed exactly as the shim does
+pub fn segment(position: f32, count: usize) -> Segment {
+    let last = count.saturating_sub(1);
+    // Clamp, sending NaN to the first snapshot
+    let p = if position > 0.0 {
+        position.min(1.0)
+    } else {
+        0.0
+    };
+    let x = p * last as f32;
+    let from = (x as usize).min(last);
+    let to = if from < last { from + 1 } else { from };
+    Segment {
+        from,
+        to,
+        amount: x - from as f32,
+    }
+}
+
+/// Parameters the morph wrote at the start of the current callback
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct MorphChanges<'a> {
+    /// Continuous parameters first, then discrete ones, each group in
+    /// declaration order
+    pub ids: &'a [i32],
+    /// Morph position the values were taken at, 0..1
+    pub position: f32,
+}
+
+impl<'a> MorphChanges<'a> {
+    /// # Safety
+    /// `changes.ids` must point to `changes.count` ids that outlive `'a`.
+    pub unsafe fn from_ffi(changes: &ffi::VdjMorphChanges) -> Self {
+        let ids = if changes.ids.is_null() || changes.count <= 0 {
+            &[]
+        } else {
+            std::slice::from_raw_parts(changes.ids, changes.count as usize)
+        };
+        MorphChanges {
+            ids,
+            position: changes.position,
+        }
+    }
+}
+
+/// Morph between `snapshots` with the float parameter `position_id`
+///
+/// Only parameters every snapshot holds take part. The snapshots are copied
+/// and compiled on the calling thread; the new morph takes over at the
+/// instance's next block. Call from a non-realtime thread.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn set_morph(
+    plugin: *mut ffi::VdjPlugin,
+    position_id: i32,
+    snapshots: &[Snapshot],
+) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    if snapshots.len() > ffi::VDJ_MORPH_MAX_SNAPSHOTS {
+        return Err(PluginError::Fail);
+    }
+    let mut data = [std::ptr::null::<c_void>(); ffi::VDJ_MORPH_MAX_SNAPSHOTS];
+    let mut sizes = [0u64; ffi::VDJ_MORPH_MAX_SNAPSHOTS];
+    for (i, snapshot) in snapshots.iter().enumerate() {
+        data[i] = snapshot.as_bytes().as_ptr() as *const c_void;
+        sizes[i] = snapshot.as_bytes().len() as u64;
+    }
+    match ffi::vdj_plugin_set_morph(
+        plugin,
+        position_id,
+        data.as_ptr(),
+        sizes.as_ptr(),
+        snapshots.len() as i32,
+    ) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Stop morphing; parameters keep their last values
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn clear_morph(plugin: *mut ffi::VdjPlugin) -> Result<()> {
+    set_morph(plugin, 0, &[])
+}
+
+/// The parameters the morph changed at the start of the current callback,
+/// if any. Realtime-safe.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type, and the ids must not
+/// be used after the callback returns.
+pub unsafe fn morph_changes<'a>(plugin: *mut ffi::VdjPlugin) -> Option<MorphChanges<'a>> {
+    if plugin.is_null() {
+        return None;
+    }
+    let mut changes = ffi::VdjMorphChanges {
+        ids: std::ptr::null(),
+        count: 0,
+        position: 0.0,
+    };
+    match ffi::vdj_plugin_get_morph_changes(plugin, &mut changes) {
+        ffi::S_OK => Some(MorphChanges::from_ffi(&changes)),
+        _ => None,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn at(from: usize, to: usize, amount: f32) -> Segment {
+        Segment { from, to, amount }
+    }
+
+    #[test]
+    fn test_segment_spacing() {
+        assert_eq!(segment(0.0, 3), at(0, 1, 0.0));
+        assert_eq!(segment(0.25, 3), at(0, 1, 0.5));
+        assert_eq!(segment(0.75, 3), at(1, 2, 0.5));
+        assert_eq!(segment(0.3, 3).nearest(), 1);
+        assert_eq!(segment(0.2, 3).nearest(), 0);
+
+        // The ends land exactly on the first and last snapshots
+        assert_eq!(segment(1.0, 3), at(2, 2, 0.0));
+        assert_eq!(segment(7.0, 3), segment(1.0, 3));
+        assert_eq!(segment(-1.0, 3), segment(0.0, 3));
+        assert_eq!(segment(f32::NAN, 3), segment(0.0, 3));
+        assert_eq!(segment(0.6, 1), at(0, 0, 0.0));
+    }
+
+    #[test]
+    fn test_changes_from_ffi() {
+        let ids = [3, 1, 7];
+        let raw = ffi::VdjMorphChanges {
+            ids: ids.as_ptr(),
+            count: 2,
+            position: 0.4,
+        };
+        let changes = unsafe { MorphChanges::from_ffi(&raw) };
+        assert_eq!(changes.ids, &[3, 1]);
+        assert_eq!(changes.position, 0.4);
+
+        let empty = ffi::VdjMorphChanges {
+            ids: std::ptr::null(),
+            count: 0,
+            position: 0.0,
+        };
+        assert!(unsafe { MorphChanges::from_ffi(&empty) }.ids.is_empty());
+    }
+}
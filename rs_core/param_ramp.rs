@@ -0,0 +1,156 @@
+//! VirtualDJ Rust SDK - Parameter Smoothing Ramps
+//!
+//! Slider and ColorFX values jump when the user moves a control, which clicks
+//! when applied directly to the audio. The shim generates a smoothed value per
+//! frame for every declared parameter once per block, with vectorized kernels,
+//! and reports parameters that did not move as static so effects can use a
+//! single gain for the whole block.
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Shape of the ramp toward a new parameter value
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RampMode {
+    /// Constant rate, reaches the new value after the smoothing time
+    Linear,
+    /// Constant ratio, for gains and frequencies (falls back to linear when
+    /// either value is not positive)
+    Exponential,
+    /// One-pole lowpass, the smoothing time is the time constant
+    OnePole,
+}
+
+impl RampMode {
+    fn to_ffi(self) -> i32 {
+        match self {
+            RampMode::Linear => ffi::VDJ_RAMP_LINEAR,
+            RampMode::Exponential => ffi::VDJ_RAMP_EXPONENTIAL,
+            RampMode::OnePole => ffi::VDJ_RAMP_ONEPOLE,
+        }
+    }
+}
+
+/// Smoothed values of one parameter for the current block
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Ramp<'a> {
+    /// The parameter holds this value for the whole block
+    Static(f32),
+    /// One value per frame
+    Moving(&'a [f32]),
+}
+
+impl<'a> Ramp<'a> {
+    pub fn is_static(&self) -> bool {
+        matches!(self, Ramp::Static(_))
+    }
+
+    /// Value at a frame of the block
+    ///
+    /// Frames past the generated values (blocks longer than
+    /// `VDJ_RAMP_MAX_FRAMES`) hold the last value; the ramp itself still
+    /// advances by the whole block.
+    #[inline]
+    pub fn value_at(&self, frame: usize) -> f32 {
+        match *self {
+            Ramp::Static(value) => value,
+            Ramp::Moving(values) => values
+                .get(frame)
+                .or_else(|| values.last())
+                .copied()
+                .unwrap_or(0.0),
+        }
+    }
+
+    fn from_ffi(ramp: &ffi::VdjParamRamp) -> Self {
+        if ramp.is_static != 0 || ramp.values.is_null() || ramp.count <= 0 {
+            Ramp::Static(ramp.value)
+        } else {
+            // SAFETY: the shim guarantees `count` values at `values`
+            Ramp::Moving(unsafe { std::slice::from_raw_parts(ramp.values, ramp.count as usize) })
+        }
+    }
+}
+
+/// Smooth a declared parameter
+///
+/// # Arguments
+/// * `id` - Parameter ID used with `DeclareParameter`
+/// * `parameter` - Storage passed to `DeclareParameter`
+/// * `mode` - Ramp shape
+/// * `time_ms` - Smoothing time in milliseconds (0 disables smoothing)
+///
+/// # Safety
+/// `plugin` must be a valid handle returned by `vdj_plugin_dsp_create`, and
+/// `parameter` must stay valid for the lifetime of the plugin. Allocates, so
+/// call it while declaring parameters, not from the audio thread.
+pub unsafe fn declare_smoothed_parameter(
+    plugin: *mut ffi::VdjPluginDsp,
+    id: i32,
+    parameter: *const f32,
+    mode: RampMode,
+    time_ms: f32,
+) -> Result<()> {
+    if plugin.is_null() || parameter.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_dsp_declare_smoothed_parameter(
+        plugin,
+        id,
+        parameter,
+        mode.to_ffi(),
+        time_ms,
+    ) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Get the ramp of a smoothed parameter for the block currently being processed
+///
+/// # Safety
+/// `plugin` must be a valid handle, and the returned ramp must not be used
+/// after the next `OnProcessSamples` call.
+pub unsafe fn parameter_ramp<'a>(plugin: *mut ffi::VdjPluginDsp, id: i32) -> Result<Ramp<'a>> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let mut ramp = ffi::VdjParamRamp {
+        values: std::ptr::null(),
+        count: 0,
+        is_static: 1,
+        value: 0.0,
+    };
+    match ffi::vdj_plugin_dsp_get_parameter_ramp(plugin, id, &mut ramp) {
+        ffi::S_OK => Ok(Ramp::from_ffi(&ramp)),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_ramp_from_ffi() {
+        let values = [0.1f32, 0.2, 0.3];
+        let moving = Ramp::from_ffi(&ffi::VdjParamRamp {
+            values: values.as_ptr(),
+            count: 3,
+            is_static: 0,
+            value: 0.3,
+        });
+        assert_eq!(moving, Ramp::Moving(&values));
+        assert_eq!(moving.value_at(1), 0.2);
+        assert_eq!(moving.value_at(100), 0.3);
+
+        let fixed = Ramp::from_ffi(&ffi::VdjParamRamp {
+            values: std::ptr::null(),
+            count: 0,
+            is_static: 1,
+            value: 0.5,
+        });
+        assert!(fixed.is_static());
+        assert_eq!(fixed.value_at(7), 0.5);
+    }
+}
@@ -0,0 +1,125 @@
+//! VirtualDJ Rust SDK - Position Pattern Engine
+//!
+//! Loop-roll, stutter and reverse effects describe their pattern once as a
+//! list of steps. The shim compiles it into a table keyed by beat phase and
+//! rewrites the play position in `OnTransformPosition` with a lookup, so the
+//! effect needs no per-call position math and stays locked to the beat grid.
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// One step of a position pattern
+pub type PatternStep = ffi::VdjPatternStep;
+
+impl PatternStep {
+    /// Play `length_beats` of the song unchanged
+    pub fn play(length_beats: f64) -> Self {
+        PatternStep {
+            length_beats,
+            repeat_beats: 0.0,
+            volume: 1.0,
+            flags: 0,
+        }
+    }
+
+    /// Loop the first `repeat_beats` of the step for `length_beats` (stutter)
+    pub fn repeat(length_beats: f64, repeat_beats: f64) -> Self {
+        PatternStep {
+            repeat_beats,
+            ..Self::play(length_beats)
+        }
+    }
+
+    /// Play the step backwards
+    pub fn reverse(length_beats: f64) -> Self {
+        PatternStep {
+            flags: ffi::VDJ_PATTERN_REVERSE,
+            ..Self::play(length_beats)
+        }
+    }
+
+    /// Silence the step
+    pub fn mute(length_beats: f64) -> Self {
+        PatternStep {
+            flags: ffi::VDJ_PATTERN_MUTE,
+            ..Self::play(length_beats)
+        }
+    }
+
+    /// Scale the step volume
+    pub fn with_volume(self, volume: f32) -> Self {
+        PatternStep { volume, ..self }
+    }
+
+    /// Reverse the step (or its repeated slice)
+    pub fn reversed(self) -> Self {
+        PatternStep {
+            flags: self.flags | ffi::VDJ_PATTERN_REVERSE,
+            ..self
+        }
+    }
+}
+
+/// Length of one pattern cycle, in beats
+pub fn pattern_length_beats(steps: &[PatternStep]) -> f64 {
+    steps.iter().map(|s| s.length_beats.max(0.0)).sum()
+}
+
+/// Apply a pattern to a position DSP plugin (an empty slice clears it)
+///
+/// Step lengths are rounded to 1/`VDJ_PATTERN_SLOTS_PER_BEAT` of a beat.
+/// Compiling allocates, so call it from `on_parameter` or a worker thread, not
+/// from `on_transform_position`.
+///
+/// # Example
+///
+/// ```ignore
+/// let roll = [
+///     PatternStep::play(1.0),
+///     PatternStep::repeat(1.0, 0.25),
+///     PatternStep::reverse(1.0),
+///     PatternStep::mute(1.0),
+/// ];
+/// unsafe { position_pattern::set_pattern(plugin, &roll)? };
+/// ```
+///
+/// # Safety
+/// `plugin` must be a valid handle returned by `vdj_plugin_position_dsp_create`.
+pub unsafe fn set_pattern(
+    plugin: *mut ffi::VdjPluginPositionDsp,
+    steps: &[PatternStep],
+) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    if steps.len() > ffi::VDJ_PATTERN_MAX_STEPS
+        || pattern_length_beats(steps) > ffi::VDJ_PATTERN_MAX_BEATS as f64
+    {
+        return Err(PluginError::Fail);
+    }
+    match ffi::vdj_plugin_position_dsp_set_pattern(plugin, steps.as_ptr(), steps.len() as i32) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_step_builders() {
+        let steps = [
+            PatternStep::play(1.0),
+            PatternStep::repeat(1.0, 0.25).reversed(),
+            PatternStep::mute(2.0),
+            PatternStep::play(0.5).with_volume(0.5),
+        ];
+
+        assert_eq!(pattern_length_beats(&steps), 4.5);
+        assert_eq!(steps[1].repeat_beats, 0.25);
+        assert_eq!(steps[1].flags, ffi::VDJ_PATTERN_REVERSE);
+        assert_eq!(steps[2].flags, ffi::VDJ_PATTERN_MUTE);
+        assert_eq!(steps[3].volume, 0.5);
+    }
+}
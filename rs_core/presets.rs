@@ -0,0 +1,591 @@
+//! VirtualDJ Rust SDK - Parameter Snapshots and Presets
+//!
+//! A snapshot holds the values of every parameter the plugin declared
+//! (buttons excepted) plus an opaque block of the plugin's own state, in the
+//! versioned binary format of `abi/vdj_plugin_abi.h`. [`Snapshot`] reads one
+//! in place, without copying or allocating, and [`PresetBank`] holds many,
+//! back to back as they are stored on disk.
+//!
+//! Recalling a preset never stalls the audio thread: [`stage_snapshot`]
+//! validates and copies it on the calling thread, and the shim applies it to
+//! the declared parameters at the start of the next block. The callback that
+//! applied it gets it from [`applied_snapshot`] to restore its opaque state;
+//! state that must be decoded first (large tables, loaded samples) can be
+//! built off the audio thread and handed over with a [`StateSwap`].
+//!
+//! # Example
+//!
+//! ```ignore
+//! // loader thread
+//! let bank = PresetBank::load("/presets/echo.vdjb")?;
+//! unsafe { presets::stage_snapshot(handle, &bank.get(3).unwrap())? };
+//!
+//! // in on_process_samples
+//! if let Some(snapshot) = unsafe { presets::applied_snapshot(handle) } {
+//!     self.restore(snapshot.opaque());
+//! }
+//! ```
+//!
+//! All functions take a generic plugin handle: cast DSP, video and other
+//! handles with `handle as *mut ffi::VdjPlugin`.
+
+use std::ffi::c_void;
+use std::io;
+use std::mem::size_of;
+use std::path::Path;
+use std::ptr;
+use std::sync::atomic::{AtomicPtr, Ordering};
+use std::sync::Mutex;
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+const HEADER_SIZE: usize = size_of::<ffi::VdjSnapshotHeader>();
+const PARAM_SIZE: usize = size_of::<ffi::VdjSnapshotParam>();
+
+fn invalid(what: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, format!("snapshot: {}", what))
+}
+
+fn pad8(size: usize) -> usize {
+    (size + 7) & !7
+}
+
+fn u32_at(bytes: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes(bytes[at..at + 4].try_into().unwrap())
+}
+
+fn u64_at(bytes: &[u8], at: usize) -> u64 {
+    u64::from_le_bytes(bytes[at..at + 8].try_into().unwrap())
+}
+
+/* ============================================================================
+   Snapshots
+   ============================================================================ */
+
+/// One saved parameter value
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct SnapshotParam<'a> {
+    pub id: i32,
+    /// `ffi::VDJPARAM_*`
+    pub param_type: i32,
+    pub value: &'a [u8],
+}
+
+impl<'a> SnapshotParam<'a> {
+    /// Value of a slider, beats or other float parameter
+    pub fn as_f32(&self) -> Option<f32> {
+        Some(f32::from_le_bytes(self.value.try_into().ok()?))
+    }
+
+    /// Value of a switch, radio or other int parameter
+    pub fn as_i32(&self) -> Option<i32> {
+        Some(i32::from_le_bytes(self.value.try_into().ok()?))
+    }
+
+    /// Text of a string or command parameter, up to its terminator
+    pub fn as_str(&self) -> Option<&'a str> {
+        let end = self
+            .value
+            .iter()
+            .position(|&b| b == 0)
+            .unwrap_or(self.value.len());
+        std::str::from_utf8(&self.value[..end]).ok()
+    }
+}
+
+/// A snapshot read in place
+#[derive(Debug, Clone, Copy)]
+pub struct Snapshot<'a> {
+    bytes: &'a [u8],
+    version: u32,
+    param_count: u32,
+    opaque: &'a [u8],
+}
+
+impl<'a> Snapshot<'a> {
+    /// Check the snapshot at the start of `bytes`, which may continue with
+    /// more data (the next snapshot of a bank)
+    pub fn parse(bytes: &'a [u8]) -> io::Result<Self> {
+        if bytes.len() < HEADER_SIZE {
+            return Err(invalid("truncated header"));
+        }
+        if u32_at(bytes, 0) != ffi::VDJ_SNAPSHOT_MAGIC {
+            return Err(invalid("not a snapshot"));
+        }
+        let version = u32_at(bytes, 4);
+        if version == 0 || version > ffi::VDJ_SNAPSHOT_VERSION {
+            return Err(invalid("unsupported version"));
+        }
+        let param_count = u32_at(bytes, 8);
+        let opaque_offset = u64_at(bytes, 16);
+        let opaque_size = u64_at(bytes, 24);
+        let total = u64_at(bytes, 32);
+        if total < HEADER_SIZE as u64 || total > bytes.len() as u64 || total % 8 != 0 {
+            return Err(invalid("truncated"));
+        }
+        let bytes = &bytes[..total as usize];
+
+        let mut offset = HEADER_SIZE;
+        for _ in 0..param_count {
+            if offset > bytes.len() || bytes.len() - offset < PARAM_SIZE {
+                return Err(invalid("truncated parameter"));
+            }
+            let size = pad8(u32_at(bytes, offset + 8) as usize);
+            offset += PARAM_SIZE;
+            if offset > bytes.len() || bytes.len() - offset < size {
+                return Err(invalid("truncated parameter value"));
+            }
+            offset += size;
+        }
+        if opaque_offset < offset as u64
+            || opaque_offset % 8 != 0
+            || opaque_offset > total
+            || opaque_size > total - opaque_offset
+        {
+            return Err(invalid("bad opaque state"));
+        }
+        let opaque_offset = opaque_offset as usize;
+        Ok(Snapshot {
+            bytes,
+            version,
+            param_count,
+            opaque: &bytes[opaque_offset..opaque_offset + opaque_size as usize],
+        })
+    }
+
+    /// The whole snapshot
+    pub fn as_bytes(&self) -> &'a [u8] {
+        self.bytes
+    }
+
+    pub fn version(&self) -> u32 {
+        self.version
+    }
+
+    /// The plugin's own state
+    pub fn opaque(&self) -> &'a [u8] {
+        self.opaque
+    }
+
+    /// Saved parameters, in declaration order
+    pub fn params(&self) -> impl Iterator<Item = SnapshotParam<'a>> + 'a {
+        let bytes = self.bytes;
+        let mut offset = HEADER_SIZE;
+        (0..self.param_count).map(move |_| {
+            let size = u32_at(bytes, offset + 8) as usize;
+            let param = SnapshotParam {
+                id: u32_at(bytes, offset) as i32,
+                param_type: u32_at(bytes, offset + 4) as i32,
+                value: &bytes[offset + PARAM_SIZE..offset + PARAM_SIZE + size],
+            };
+            offset += PARAM_SIZE + pad8(size);
+            param
+        })
+    }
+
+    pub fn param(&self, id: i32) -> Option<SnapshotParam<'a>> {
+        self.params().find(|p| p.id == id)
+    }
+}
+
+/// Builds snapshots outside the shim, e.g. presets shipped with a plugin
+#[derive(Debug, Clone, Default)]
+pub struct SnapshotBuilder {
+    params: Vec<u8>,
+    count: u32,
+}
+
+impl SnapshotBuilder {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Add a parameter with its raw value
+    pub fn param(&mut self, id: i32, param_type: i32, value: &[u8]) -> &mut Self {
+        self.params.extend_from_slice(&id.to_le_bytes());
+        self.params.extend_from_slice(&param_type.to_le_bytes());
+        self.params
+            .extend_from_slice(&(value.len() as u32).to_le_bytes());
+        self.params.extend_from_slice(&0u32.to_le_bytes());
+        self.params.extend_from_slice(value);
+        self.params.resize(pad8(self.params.len()), 0);
+        self.count += 1;
+        self
+    }
+
+    pub fn float(&mut self, id: i32, param_type: i32, value: f32) -> &mut Self {
+        self.param(id, param_type, &value.to_le_bytes())
+    }
+
+    pub fn int(&mut self, id: i32, param_type: i32, value: i32) -> &mut Self {
+        self.param(id, param_type, &value.to_le_bytes())
+    }
+
+    /// A string parameter declared with a `size`-byte buffer
+    pub fn string(&mut self, id: i32, text: &str, size: usize) -> &mut Self {
+        let mut value = vec![0u8; size.max(1)];
+        let n = text.len().min(value.len() - 1);
+        value[..n].copy_from_slice(&text.as_bytes()[..n]);
+        self.param(id, ffi::VDJPARAM_STRING, &value)
+    }
+
+    /// The snapshot, with `opaque` as the plugin state
+    pub fn build(&self, opaque: &[u8]) -> Vec<u8> {
+        let opaque_offset = HEADER_SIZE + self.params.len();
+        let total = opaque_offset + pad8(opaque.len());
+        let mut out = Vec::with_capacity(total);
+        for v in [
+            ffi::VDJ_SNAPSHOT_MAGIC,
+            ffi::VDJ_SNAPSHOT_VERSION,
+            self.count,
+            0,
+        ] {
+            out.extend_from_slice(&v.to_le_bytes());
+        }
+        for v in [opaque_offset, opaque.len(), total] {
+            out.extend_from_slice(&(v as u64).to_le_bytes());
+        }
+        out.extend_from_slice(&self.params);
+        out.extend_from_slice(opaque);
+        out.resize(total, 0);
+        out
+    }
+}
+
+/// Snapshots stored back to back
+#[derive(Debug, Clone, Default)]
+pub struct PresetBank {
+    bytes: Vec<u8>,
+    offsets: Vec<usize>,
+}
+
+impl PresetBank {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Read a bank file; call it off the audio thread
+    pub fn load<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+        Self::from_bytes(std::fs::read(path)?)
+    }
+
+    /// Check every snapshot of a bank
+    pub fn from_bytes(bytes: Vec<u8>) -> io::Result<Self> {
+        let mut offsets = Vec::new();
+        let mut offset = 0;
+        while offset < bytes.len() {
+            offsets.push(offset);
+            offset += Snapshot::parse(&bytes[offset..])?.as_bytes().len();
+        }
+        Ok(PresetBank { bytes, offsets })
+    }
+
+    pub fn push(&mut self, snapshot: &Snapshot) {
+        self.offsets.push(self.bytes.len());
+        self.bytes.extend_from_slice(snapshot.as_bytes());
+    }
+
+    pub fn len(&self) -> usize {
+        self.offsets.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.offsets.is_empty()
+    }
+
+    pub fn get(&self, index: usize) -> Option<Snapshot<'_>> {
+        let offset = *self.offsets.get(index)?;
+        Snapshot::parse(&self.bytes[offset..]).ok()
+    }
+
+    pub fn as_bytes(&self) -> &[u8] {
+        &self.bytes
+    }
+
+    pub fn save<P: AsRef<Path>>(&self, path: P) -> io::Result<()> {
+        std::fs::write(path, &self.bytes)
+    }
+}
+
+/* ============================================================================
+   State Swap
+   ============================================================================ */
+
+/// Hands plugin state built off the audio thread to the audio thread
+///
+/// [`publish`](StateSwap::publish) a boxed state from any thread; the audio
+/// thread swaps the newest one in with [`take`](StateSwap::take) at a block
+/// boundary. Neither side blocks the other, and the audio thread never
+/// allocates or drops a state: the one it replaces is dropped by the next
+/// `publish`, or when the swap is dropped.
+pub struct StateSwap<T> {
+    pending: AtomicPtr<T>,
+    retired: AtomicPtr<T>,
+    publish: Mutex<()>,
+}
+
+unsafe impl<T: Send> Send for StateSwap<T> {}
+unsafe impl<T: Send> Sync for StateSwap<T> {}
+
+impl<T> Default for StateSwap<T> {
+    fn default() -> Self {
+        StateSwap {
+            pending: AtomicPtr::new(ptr::null_mut()),
+            retired: AtomicPtr::new(ptr::null_mut()),
+            publish: Mutex::new(()),
+        }
+    }
+}
+
+fn drop_box<T>(state: *mut T) {
+    if !state.is_null() {
+        // SAFETY: every pointer stored in a swap came from Box::into_raw
+        drop(unsafe { Box::from_raw(state) });
+    }
+}
+
+impl<T> StateSwap<T> {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Hand `state` to the audio thread, replacing a state it has not taken
+    /// yet
+    pub fn publish(&self, state: Box<T>) {
+        let _guard = self.publish.lock().unwrap_or_else(|e| e.into_inner());
+        let state = Box::into_raw(state);
+        loop {
+            let waiting = self.pending.load(Ordering::Acquire);
+            if waiting.is_null() {
+                // `take` retires before it clears `pending`, so with nothing
+                // pending the retired state is ours to drop
+                drop_box(self.retired.swap(ptr::null_mut(), Ordering::Acquire));
+                self.pending.store(state, Ordering::Release);
+                return;
+            }
+            if self
+                .pending
+                .compare_exchange(waiting, state, Ordering::AcqRel, Ordering::Acquire)
+                .is_ok()
+            {
+                drop_box(waiting);
+                return;
+            }
+        }
+    }
+
+    /// Swap the newest published state into `current`; true if there was one
+    ///
+    /// Call it from one thread only, the audio thread. Realtime-safe.
+    pub fn take(&self, current: &mut Box<T>) -> bool {
+        if self.pending.load(Ordering::Acquire).is_null() {
+            return false;
+        }
+        // Only this thread clears `pending`, so it is still set at the swap.
+        // Retiring first means that once `publish` sees nothing pending, the
+        // retired state is visible to it too.
+        let parked: *mut T = &mut **current;
+        self.retired.store(parked, Ordering::Release);
+        let next = self.pending.swap(ptr::null_mut(), Ordering::AcqRel);
+        // SAFETY: `next` came from Box::into_raw and is now ours; the old
+        // state is owned by `retired` from here on
+        let old = std::mem::replace(current, unsafe { Box::from_raw(next) });
+        let _ = Box::into_raw(old);
+        true
+    }
+}
+
+impl<T> Drop for StateSwap<T> {
+    fn drop(&mut self) {
+        drop_box(*self.pending.get_mut());
+        drop_box(*self.retired.get_mut());
+    }
+}
+
+/* ============================================================================
+   Shim Functions
+   ============================================================================ */
+
+/// Snapshot the declared parameters of an instance, with `opaque` as the
+/// plugin state
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn save_snapshot(plugin: *mut ffi::VdjPlugin, opaque: &[u8]) -> Result<Vec<u8>> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let opaque_ptr = opaque.as_ptr() as *const c_void;
+    let mut size = 0u64;
+    match ffi::vdj_plugin_save_snapshot(
+        plugin,
+        opaque_ptr,
+        opaque.len() as u64,
+        ptr::null_mut(),
+        0,
+        &mut size,
+    ) {
+        ffi::S_OK | ffi::S_FALSE => {}
+        hr => return Err(PluginError::from(hr)),
+    }
+    let mut out = vec![0u8; size as usize];
+    match ffi::vdj_plugin_save_snapshot(
+        plugin,
+        opaque_ptr,
+        opaque.len() as u64,
+        out.as_mut_ptr() as *mut c_void,
+        size,
+        &mut size,
+    ) {
+        ffi::S_OK => Ok(out),
+        ffi::S_FALSE => Err(PluginError::Fail),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Recall a snapshot at the start of the instance's next block
+///
+/// The snapshot is copied, so it may be dropped when this returns. Call from
+/// a non-realtime thread.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn stage_snapshot(plugin: *mut ffi::VdjPlugin, snapshot: &Snapshot) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let bytes = snapshot.as_bytes();
+    match ffi::vdj_plugin_stage_snapshot(
+        plugin,
+        bytes.as_ptr() as *const c_void,
+        bytes.len() as u64,
+    ) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// The snapshot applied at the start of the current callback, if any
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type, and the snapshot must
+/// not be used after the callback returns.
+pub unsafe fn applied_snapshot<'a>(plugin: *mut ffi::VdjPlugin) -> Option<Snapshot<'a>> {
+    if plugin.is_null() {
+        return None;
+    }
+    let mut data: *const c_void = ptr::null();
+    let mut size = 0u64;
+    match ffi::vdj_plugin_applied_snapshot(plugin, &mut data, &mut size) {
+        ffi::S_OK if !data.is_null() => {
+            Snapshot::parse(std::slice::from_raw_parts(data as *const u8, size as usize)).ok()
+        }
+        _ => None,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn preset(gain: f32, opaque: &[u8]) -> Vec<u8> {
+        SnapshotBuilder::new()
+            .float(1, ffi::VDJPARAM_SLIDER, gain)
+            .int(2, ffi::VDJPARAM_SWITCH, 1)
+            .string(3, "tape", 16)
+            .build(opaque)
+    }
+
+    #[test]
+    fn test_snapshot_round_trip() {
+        let bytes = preset(0.75, b"state");
+        assert_eq!(bytes.len() % 8, 0);
+        let snapshot = Snapshot::parse(&bytes).unwrap();
+        assert_eq!(snapshot.version(), ffi::VDJ_SNAPSHOT_VERSION);
+        assert_eq!(snapshot.opaque(), b"state");
+        assert_eq!(snapshot.params().count(), 3);
+        assert_eq!(snapshot.param(1).unwrap().as_f32(), Some(0.75));
+        assert_eq!(snapshot.param(2).unwrap().as_i32(), Some(1));
+        assert_eq!(snapshot.param(3).unwrap().as_str(), Some("tape"));
+        assert_eq!(snapshot.param(3).unwrap().value.len(), 16);
+        assert!(snapshot.param(4).is_none());
+
+        // Views point into the input: nothing was copied
+        let opaque = snapshot.opaque().as_ptr() as usize - bytes.as_ptr() as usize;
+        assert_eq!(opaque % 8, 0);
+    }
+
+    #[test]
+    fn test_parse_rejects_bad_snapshots() {
+        let bytes = preset(0.5, &[7; 9]);
+        assert!(Snapshot::parse(&bytes[..bytes.len() - 8]).is_err());
+        assert!(Snapshot::parse(&bytes[..HEADER_SIZE - 1]).is_err());
+
+        let mut newer = bytes.clone();
+        newer[4..8].copy_from_slice(&(ffi::VDJ_SNAPSHOT_VERSION + 1).to_le_bytes());
+        assert!(Snapshot::parse(&newer).is_err());
+
+        let mut huge_param = bytes.clone();
+        huge_param[HEADER_SIZE + 8..HEADER_SIZE + 12].copy_from_slice(&u32::MAX.to_le_bytes());
+        assert!(Snapshot::parse(&huge_param).is_err());
+
+        let mut opaque = bytes.clone();
+        opaque[24..32].copy_from_slice(&1000u64.to_le_bytes());
+        assert!(Snapshot::parse(&opaque).is_err());
+    }
+
+    #[test]
+    fn test_parse_rejects_total_size_inside_header() {
+        // A total size smaller than the header must not let the parameter
+        // bounds checks wrap around
+        let bytes = preset(0.5, b"");
+        for total in [0u64, 8, HEADER_SIZE as u64 - 8] {
+            let mut short = bytes.clone();
+            short[32..40].copy_from_slice(&total.to_le_bytes());
+            assert!(Snapshot::parse(&short).is_err());
+            assert!(Snapshot::parse(&short[..40]).is_err());
+        }
+    }
+
+    #[test]
+    fn test_bank_splits_snapshots() {
+        let mut bytes = preset(0.1, b"a");
+        bytes.extend_from_slice(&preset(0.2, &[1; 100]));
+        bytes.extend_from_slice(&preset(0.3, b""));
+        let bank = PresetBank::from_bytes(bytes.clone()).unwrap();
+        assert_eq!(bank.len(), 3);
+        assert_eq!(bank.get(1).unwrap().opaque(), &[1; 100]);
+        assert_eq!(bank.get(2).unwrap().param(1).unwrap().as_f32(), Some(0.3));
+        assert!(bank.get(3).is_none());
+
+        let mut copy = PresetBank::new();
+        copy.push(&bank.get(0).unwrap());
+        assert_eq!(
+            copy.as_bytes(),
+            &bytes[..bank.get(0).unwrap().as_bytes().len()]
+        );
+
+        bytes.push(0);
+        assert!(PresetBank::from_bytes(bytes).is_err());
+    }
+
+    #[test]
+    fn test_state_swap_hands_over_newest() {
+        let swap = StateSwap::new();
+        let mut current = Box::new(vec![0u8]);
+        assert!(!swap.take(&mut current));
+
+        swap.publish(Box::new(vec![1]));
+        swap.publish(Box::new(vec![2]));
+        assert!(swap.take(&mut current));
+        assert_eq!(*current, vec![2]);
+        assert!(!swap.take(&mut current));
+
+        // The replaced state is dropped by the next publish
+        swap.publish(Box::new(vec![3]));
+        assert!(swap.retired.load(Ordering::Relaxed).is_null());
+        assert!(swap.take(&mut current));
+        assert_eq!(*current, vec![3]);
+    }
+}
@@ -0,0 +1,141 @@
+//! VirtualDJ Rust SDK - Callback Latency Histograms
+//!
+//! The shim can time every plugin entry point into per-instance, lock-free
+//! histograms. Summaries (p50 to p99.9, overruns) can be read from any
+//! non-realtime thread while the plugin runs, or dumped to a file, to decide
+//! whether an effect is cheap enough to run live.
+//!
+//! All functions take a generic plugin handle: cast DSP, video and other
+//! handles with `handle as *mut ffi::VdjPlugin`.
+
+use std::ffi::CString;
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Latency summary of one entry point, in nanoseconds
+pub type LatencyStats = ffi::VdjLatencyStats;
+
+/// Instrumented entry points
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum Callback {
+    ProcessSamples,
+    GetSongBuffer,
+    TransformPosition,
+    Draw,
+    AudioSamples,
+    Parameter,
+    Start,
+    Stop,
+    Device,
+    OnlineSource,
+    Load,
+}
+
+impl Callback {
+    /// Every entry point, in ABI order
+    pub const ALL: [Callback; 11] = [
+        Callback::ProcessSamples,
+        Callback::GetSongBuffer,
+        Callback::TransformPosition,
+        Callback::Draw,
+        Callback::AudioSamples,
+        Callback::Parameter,
+        Callback::Start,
+        Callback::Stop,
+        Callback::Device,
+        Callback::OnlineSource,
+        Callback::Load,
+    ];
+
+    fn to_ffi(self) -> i32 {
+        match self {
+            Callback::ProcessSamples => ffi::VDJ_PROFILE_PROCESS_SAMPLES,
+            Callback::GetSongBuffer => ffi::VDJ_PROFILE_GET_SONG_BUFFER,
+            Callback::TransformPosition => ffi::VDJ_PROFILE_TRANSFORM_POSITION,
+            Callback::Draw => ffi::VDJ_PROFILE_DRAW,
+            Callback::AudioSamples => ffi::VDJ_PROFILE_AUDIO_SAMPLES,
+            Callback::Parameter => ffi::VDJ_PROFILE_PARAMETER,
+            Callback::Start => ffi::VDJ_PROFILE_START,
+            Callback::Stop => ffi::VDJ_PROFILE_STOP,
+            Callback::Device => ffi::VDJ_PROFILE_DEVICE,
+            Callback::OnlineSource => ffi::VDJ_PROFILE_ONLINE_SOURCE,
+            Callback::Load => ffi::VDJ_PROFILE_LOAD,
+        }
+    }
+}
+
+/// Start or stop recording callback durations
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn set_profiling(plugin: *mut ffi::VdjPlugin, enabled: bool) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_set_profiling(plugin, enabled as i32) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Read the latency summary of one entry point
+///
+/// Returns zeroed stats when profiling was never enabled.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn latency_stats(
+    plugin: *mut ffi::VdjPlugin,
+    callback: Callback,
+) -> Result<LatencyStats> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let mut stats = LatencyStats::default();
+    match ffi::vdj_plugin_get_latency_stats(plugin, callback.to_ffi(), &mut stats) {
+        ffi::S_OK | ffi::S_FALSE => Ok(stats),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Clear all histograms of a plugin
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn reset_latency_stats(plugin: *mut ffi::VdjPlugin) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_reset_latency_stats(plugin) {
+        ffi::S_OK | ffi::S_FALSE => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Write summaries and histogram buckets of all entry points to a text file
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn dump_latency_histograms(plugin: *mut ffi::VdjPlugin, path: &str) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let c_path = CString::new(path).map_err(|_| PluginError::Fail)?;
+    match ffi::vdj_plugin_dump_latency_histograms(plugin, c_path.as_ptr() as *const u8) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_callbacks_cover_abi() {
+        let ids: Vec<i32> = Callback::ALL.iter().map(|c| c.to_ffi()).collect();
+        let expected: Vec<i32> = (0..ffi::VDJ_PROFILE_CALLBACK_COUNT).collect();
+        assert_eq!(ids, expected);
+    }
+}
@@ -0,0 +1,604 @@
+//! VirtualDJ Rust SDK - Offline Render
+//!
+//! Streams audio through a DSP plugin as fast as the CPU allows, synthesizing
+//! the beat position VirtualDJ would report for a track at a fixed tempo, and
+//! measures throughput as a multiple of real time. Used to prerender edits and
+//! as a whole-plugin benchmark (see the `offline_render` example).
+//!
+//! WAV files are read as 16/24/32-bit PCM or 32-bit float, mono or stereo, and
+//! always converted to the host's interleaved stereo `f32` layout.
+
+use std::fs::File;
+use std::io::{self, Read};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Mutex;
+use std::time::Instant;
+
+use crate::host::{StandInHost, CHANNELS};
+use crate::modulation::BlockPosition;
+use crate::rt_check::{self, RtViolations};
+use crate::{DspPlugin, Result};
+
+const WAVE_FORMAT_PCM: u16 = 1;
+const WAVE_FORMAT_IEEE_FLOAT: u16 = 3;
+const WAVE_FORMAT_EXTENSIBLE: u16 = 0xFFFE;
+
+/// Interleaved stereo audio
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct Audio {
+    pub sample_rate: i32,
+    pub samples: Vec<f32>,
+}
+
+/// Sample format of a written WAV file
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum WavFormat {
+    Pcm16,
+    Float32,
+}
+
+fn invalid(what: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, format!("wav: {}", what))
+}
+
+fn le_u16(b: &[u8], at: usize) -> u16 {
+    u16::from_le_bytes([b[at], b[at + 1]])
+}
+
+fn le_u32(b: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes([b[at], b[at + 1], b[at + 2], b[at + 3]])
+}
+
+impl Audio {
+    /// Number of stereo frames
+    pub fn frames(&self) -> usize {
+        self.samples.len() / CHANNELS
+    }
+
+    /// Duration in seconds
+    pub fn seconds(&self) -> f64 {
+        if self.sample_rate > 0 {
+            self.frames() as f64 / self.sample_rate as f64
+        } else {
+            0.0
+        }
+    }
+
+    /// Read a WAV file
+    pub fn open<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+        Self::parse_wav(&std::fs::read(path)?)
+    }
+
+    /// Parse a WAV file; mono is duplicated to both channels
+    pub fn parse_wav(bytes: &[u8]) -> io::Result<Self> {
+        let mut audio = Audio::default();
+        audio.load_wav(bytes)?;
+        Ok(audio)
+    }
+
+    /// Parse a WAV file into this buffer, reusing its allocation
+    pub fn load_wav(&mut self, bytes: &[u8]) -> io::Result<()> {
+        if bytes.len() < 12 || &bytes[0..4] != b"RIFF" || &bytes[8..12] != b"WAVE" {
+            return Err(invalid("not a RIFF/WAVE file"));
+        }
+
+        let mut format = None;
+        let mut pos = 12;
+        while pos + 8 <= bytes.len() {
+            let id = &bytes[pos..pos + 4];
+            let size = le_u32(bytes, pos + 4) as usize;
+            let body = &bytes[pos + 8..(pos + 8 + size).min(bytes.len())];
+            match id {
+                b"fmt " if body.len() >= 16 => {
+                    let mut tag = le_u16(body, 0);
+                    if tag == WAVE_FORMAT_EXTENSIBLE && body.len() >= 26 {
+                        tag = le_u16(body, 24);
+                    }
+                    // (tag, channels, sample rate, bits per sample)
+                    format = Some((
+                        tag,
+                        le_u16(body, 2) as usize,
+                        le_u32(body, 4) as i32,
+                        le_u16(body, 14) as usize,
+                    ));
+                }
+                b"data" => {
+                    let (tag, channels, sample_rate, bits) =
+                        format.ok_or_else(|| invalid("data before fmt chunk"))?;
+                    return self.decode(body, tag, channels, sample_rate, bits);
+                }
+                _ => {}
+            }
+            // Chunks are padded to an even size
+            pos += 8 + size + (size & 1);
+        }
+        Err(invalid("no data chunk"))
+    }
+
+    fn decode(
+        &mut self,
+        data: &[u8],
+        tag: u16,
+        channels: usize,
+        sample_rate: i32,
+        bits: usize,
+    ) -> io::Result<()> {
+        if channels == 0 || channels > CHANNELS || sample_rate <= 0 {
+            return Err(invalid("only mono and stereo files are supported"));
+        }
+        let width = bits / 8;
+        let convert: fn(&[u8]) -> f32 = match (tag, bits) {
+            (WAVE_FORMAT_PCM, 16) => |b| i16::from_le_bytes([b[0], b[1]]) as f32 / 32768.0,
+            (WAVE_FORMAT_PCM, 24) => {
+                |b| (i32::from_le_bytes([0, b[0], b[1], b[2]]) >> 8) as f32 / 8_388_608.0
+            }
+            (WAVE_FORMAT_PCM, 32) => {
+                |b| i32::from_le_bytes([b[0], b[1], b[2], b[3]]) as f32 / 2_147_483_648.0
+            }
+            (WAVE_FORMAT_IEEE_FLOAT, 32) => |b| f32::from_le_bytes([b[0], b[1], b[2], b[3]]),
+            _ => return Err(invalid("unsupported sample format")),
+        };
+
+        let frames = data.len() / (width * channels);
+        self.sample_rate = sample_rate;
+        self.samples.clear();
+        self.samples.reserve(frames * CHANNELS);
+        for frame in data.chunks_exact(width * channels) {
+            let left = convert(&frame[..width]);
+            let right = if channels == 2 {
+                convert(&frame[width..])
+            } else {
+                left
+            };
+            self.samples.push(left);
+            self.samples.push(right);
+        }
+        Ok(())
+    }
+
+    /// Encode as a stereo WAV file; PCM output is clipped to [-1, 1]
+    pub fn to_wav(&self, format: WavFormat) -> Vec<u8> {
+        let mut out = Vec::new();
+        self.write_wav(format, &mut out);
+        out
+    }
+
+    /// Encode as a stereo WAV file into `out`, replacing its contents
+    pub fn write_wav(&self, format: WavFormat, out: &mut Vec<u8>) {
+        let (tag, bits) = match format {
+            WavFormat::Pcm16 => (WAVE_FORMAT_PCM, 16u16),
+            WavFormat::Float32 => (WAVE_FORMAT_IEEE_FLOAT, 32u16),
+        };
+        let block_align = CHANNELS as u16 * bits / 8;
+        let data_size = (self.frames() * block_align as usize) as u32;
+
+        out.clear();
+        out.reserve(44 + data_size as usize);
+        out.extend_from_slice(b"RIFF");
+        out.extend_from_slice(&(36 + data_size).to_le_bytes());
+        out.extend_from_slice(b"WAVEfmt ");
+        out.extend_from_slice(&16u32.to_le_bytes());
+        out.extend_from_slice(&tag.to_le_bytes());
+        out.extend_from_slice(&(CHANNELS as u16).to_le_bytes());
+        out.extend_from_slice(&(self.sample_rate as u32).to_le_bytes());
+        out.extend_from_slice(&(self.sample_rate as u32 * block_align as u32).to_le_bytes());
+        out.extend_from_slice(&block_align.to_le_bytes());
+        out.extend_from_slice(&bits.to_le_bytes());
+        out.extend_from_slice(b"data");
+        out.extend_from_slice(&data_size.to_le_bytes());
+        for &s in &self.samples[..self.frames() * CHANNELS] {
+            match format {
+                WavFormat::Pcm16 => {
+                    let v = (s.clamp(-1.0, 1.0) * 32767.0).round() as i16;
+                    out.extend_from_slice(&v.to_le_bytes());
+                }
+                WavFormat::Float32 => out.extend_from_slice(&s.to_le_bytes()),
+            }
+        }
+    }
+
+    /// Write a stereo WAV file
+    pub fn save<P: AsRef<Path>>(&self, path: P, format: WavFormat) -> io::Result<()> {
+        std::fs::write(path, self.to_wav(format))
+    }
+}
+
+/* ============================================================================
+   Renderer
+   ============================================================================ */
+
+/// Throughput of an offline render
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct RenderReport {
+    pub sample_rate: i32,
+    pub blocks: u64,
+    pub frames: u64,
+    /// Wall time spent in the plugin and the position hook
+    pub elapsed_ns: u64,
+    /// Slowest block, in nanoseconds
+    pub max_block_ns: u64,
+    /// Audio duration divided by render time
+    pub realtime_factor: f64,
+    /// Allocator violations made by the plugin's audio callbacks
+    pub violations: RtViolations,
+}
+
+/// Renders audio through a plugin at a fixed tempo
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct OfflineRenderer {
+    pub host: StandInHost,
+    /// Tempo of the synthesized beat grid (0 for a track without one)
+    pub bpm: f64,
+    /// Beat position of the first frame
+    pub start_beats: f64,
+}
+
+impl OfflineRenderer {
+    pub fn new(sample_rate: i32, block_frames: usize, bpm: f64) -> Self {
+        OfflineRenderer {
+            host: StandInHost::new(sample_rate, block_frames),
+            bpm,
+            start_beats: 0.0,
+        }
+    }
+
+    /// `SongBpm`: samples per beat at the render tempo
+    pub fn samples_per_beat(&self) -> i32 {
+        if self.bpm > 0.0 {
+            (self.host.sample_rate as f64 * 60.0 / self.bpm).round() as i32
+        } else {
+            0
+        }
+    }
+
+    /// Beat position VirtualDJ would report for a block starting at `frame`
+    pub fn position_at(&self, frame: u64) -> BlockPosition {
+        let samples_per_beat = self.samples_per_beat();
+        let beats = if samples_per_beat > 0 {
+            self.start_beats + frame as f64 / samples_per_beat as f64
+        } else {
+            0.0
+        };
+        BlockPosition::new(beats, samples_per_beat)
+    }
+
+    /// Start a DSP plugin, process `buffer` in place block by block and stop
+    /// it
+    ///
+    /// `on_block(plugin, position)` runs before each block, so the plugin can
+    /// be handed the synthesized `SongPosBeats`/`SongBpm` the way its shim
+    /// wrapper would. Only the block loop is timed.
+    pub fn render_dsp<P, F>(
+        &self,
+        plugin: &mut P,
+        buffer: &mut [f32],
+        mut on_block: F,
+    ) -> Result<RenderReport>
+    where
+        P: DspPlugin + ?Sized,
+        F: FnMut(&mut P, BlockPosition),
+    {
+        let before = rt_check::thread_violations();
+        let mut report = RenderReport {
+            sample_rate: self.host.sample_rate,
+            ..Default::default()
+        };
+
+        DspPlugin::on_start(plugin)?;
+        let start = Instant::now();
+        for block in buffer.chunks_mut(self.host.block_samples()) {
+            let block_start = Instant::now();
+            on_block(plugin, self.position_at(report.frames));
+            self.host.process_dsp_block(plugin, block)?;
+            report.max_block_ns = report
+                .max_block_ns
+                .max(block_start.elapsed().as_nanos() as u64);
+            report.blocks += 1;
+            report.frames += (block.len() / CHANNELS) as u64;
+        }
+        report.elapsed_ns = start.elapsed().as_nanos() as u64;
+        DspPlugin::on_stop(plugin)?;
+
+        if report.elapsed_ns > 0 && self.host.sample_rate > 0 {
+            let audio_ns = report.frames as f64 * 1e9 / self.host.sample_rate as f64;
+            report.realtime_factor = audio_ns / report.elapsed_ns as f64;
+        }
+        report.violations = rt_check::thread_violations().since(&before);
+        Ok(report)
+    }
+}
+
+/* ============================================================================
+   Batch Rendering
+   ============================================================================ */
+
+/// One file of a batch render
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct BatchJob {
+    pub input: PathBuf,
+    pub output: PathBuf,
+}
+
+/// Outcome of a batch render
+#[derive(Debug)]
+pub struct BatchReport {
+    /// One result per job, in job order whatever thread ran it
+    pub results: Vec<io::Result<RenderReport>>,
+    /// Worker threads used
+    pub threads: usize,
+    /// Wall time of the whole batch, file I/O included
+    pub elapsed_ns: u64,
+    /// Rendered audio, in seconds
+    pub audio_seconds: f64,
+    /// Audio duration divided by batch wall time
+    pub realtime_factor: f64,
+}
+
+impl BatchReport {
+    pub fn failures(&self) -> usize {
+        self.results.iter().filter(|r| r.is_err()).count()
+    }
+}
+
+/// Renders many independent jobs across a pool of worker threads
+///
+/// Workers claim the next job from a shared counter when they finish one, so
+/// long and short files balance out without a scheduler. Every job gets a
+/// fresh plugin instance and runs on one thread; each worker keeps its own
+/// file and sample buffers between jobs.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct BatchRenderer {
+    pub block_frames: usize,
+    pub bpm: f64,
+    pub format: WavFormat,
+    /// Worker threads (defaults to the available cores)
+    pub threads: usize,
+}
+
+impl BatchRenderer {
+    pub fn new(block_frames: usize, bpm: f64) -> Self {
+        BatchRenderer {
+            block_frames,
+            bpm,
+            format: WavFormat::Float32,
+            threads: std::thread::available_parallelism().map_or(1, |n| n.get()),
+        }
+    }
+
+    /// Run `job(worker_state, index)` for `0..count` on the pool, returning
+    /// the results in index order
+    fn run<S, T, I, J>(&self, count: usize, init: I, job: J) -> Vec<T>
+    where
+        T: Send,
+        I: Fn() -> S + Sync,
+        J: Fn(&mut S, usize) -> T + Sync,
+    {
+        let next = AtomicUsize::new(0);
+        let threads = self.threads.clamp(1, count.max(1));
+        let mut done: Vec<(usize, T)> = std::thread::scope(|scope| {
+            let workers: Vec<_> = (0..threads)
+                .map(|_| {
+                    scope.spawn(|| {
+                        let mut state = init();
+                        let mut done = Vec::new();
+                        loop {
+                            let i = next.fetch_add(1, Ordering::Relaxed);
+                            if i >= count {
+                                break done;
+                            }
+                            done.push((i, job(&mut state, i)));
+                        }
+                    })
+                })
+                .collect();
+            workers
+                .into_iter()
+                .flat_map(|w| w.join().expect("batch worker panicked"))
+                .collect()
+        });
+        done.sort_unstable_by_key(|&(i, _)| i);
+        done.into_iter().map(|(_, result)| result).collect()
+    }
+
+    /// Render in-memory audio in place, one plugin per buffer
+    ///
+    /// `make_plugin(index)` creates the instance for buffer `index`; `on_block`
+    /// is the position hook of [`OfflineRenderer::render_dsp`].
+    pub fn render_buffers<P, M, F>(
+        &self,
+        buffers: &mut [Audio],
+        make_plugin: M,
+        on_block: F,
+    ) -> Vec<Result<RenderReport>>
+    where
+        P: DspPlugin,
+        M: Fn(usize) -> P + Sync,
+        F: Fn(&mut P, BlockPosition) + Sync,
+    {
+        let slots: Vec<Mutex<&mut Audio>> = buffers.iter_mut().map(Mutex::new).collect();
+        self.run(
+            slots.len(),
+            || (),
+            |_, i| {
+                let mut audio = slots[i].lock().unwrap();
+                let renderer = OfflineRenderer::new(audio.sample_rate, self.block_frames, self.bpm);
+                renderer.render_dsp(&mut make_plugin(i), &mut audio.samples, &on_block)
+            },
+        )
+    }
+
+    /// Render WAV files, one plugin per file
+    pub fn render_files<P, M, F>(
+        &self,
+        jobs: &[BatchJob],
+        make_plugin: M,
+        on_block: F,
+    ) -> BatchReport
+    where
+        P: DspPlugin,
+        M: Fn(&BatchJob) -> P + Sync,
+        F: Fn(&mut P, BlockPosition) + Sync,
+    {
+        let start = Instant::now();
+        let results = self.run(
+            jobs.len(),
+            || (Vec::new(), Audio::default()),
+            |(bytes, audio): &mut (Vec<u8>, Audio), i| {
+                let job = &jobs[i];
+                bytes.clear();
+                File::open(&job.input)?.read_to_end(bytes)?;
+                audio.load_wav(bytes)?;
+
+                let renderer = OfflineRenderer::new(audio.sample_rate, self.block_frames, self.bpm);
+                let report = renderer
+                    .render_dsp(&mut make_plugin(job), &mut audio.samples, &on_block)
+                    .map_err(|e| io::Error::new(io::ErrorKind::Other, e))?;
+
+                audio.write_wav(self.format, bytes);
+                std::fs::write(&job.output, &bytes)?;
+                Ok(report)
+            },
+        );
+
+        let elapsed_ns = start.elapsed().as_nanos() as u64;
+        let audio_seconds = results
+            .iter()
+            .flatten()
+            .map(|r| r.frames as f64 / r.sample_rate.max(1) as f64)
+            .sum();
+        BatchReport {
+            threads: self.threads.clamp(1, jobs.len().max(1)),
+            elapsed_ns,
+            audio_seconds,
+            realtime_factor: if elapsed_ns > 0 {
+                audio_seconds * 1e9 / elapsed_ns as f64
+            } else {
+                0.0
+            },
+            results,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{PluginBase, PluginInfo};
+
+    struct Gain(f32);
+
+    impl PluginBase for Gain {
+        fn get_info(&self) -> PluginInfo {
+            PluginInfo {
+                name: "Gain".to_string(),
+                author: "Test".to_string(),
+                description: "Gain".to_string(),
+                version: "1.0.0".to_string(),
+                flags: 0,
+            }
+        }
+    }
+
+    impl DspPlugin for Gain {
+        fn on_process_samples(&mut self, buffer: &mut [f32]) -> Result<()> {
+            buffer.iter_mut().for_each(|s| *s *= self.0);
+            Ok(())
+        }
+    }
+
+    #[test]
+    fn test_wav_round_trip() {
+        let audio = Audio {
+            sample_rate: 48000,
+            samples: vec![0.0, 0.5, -0.5, 1.0, -1.0, 0.25],
+        };
+        let parsed = Audio::parse_wav(&audio.to_wav(WavFormat::Float32)).unwrap();
+        assert_eq!(parsed, audio);
+
+        let parsed = Audio::parse_wav(&audio.to_wav(WavFormat::Pcm16)).unwrap();
+        assert_eq!(parsed.sample_rate, 48000);
+        assert!(parsed
+            .samples
+            .iter()
+            .zip(&audio.samples)
+            .all(|(a, b)| (a - b).abs() < 1e-4));
+
+        assert!(Audio::parse_wav(b"RIFF\0\0\0\0WAVE").is_err());
+    }
+
+    #[test]
+    fn test_mono_24_bit_is_widened_to_stereo() {
+        let mut wav = Audio {
+            sample_rate: 44100,
+            samples: vec![],
+        }
+        .to_wav(WavFormat::Pcm16);
+        // Patch the header to mono 24-bit and append two frames
+        wav[22..24].copy_from_slice(&1u16.to_le_bytes());
+        wav[34..36].copy_from_slice(&24u16.to_le_bytes());
+        wav[40..44].copy_from_slice(&6u32.to_le_bytes());
+        wav.extend_from_slice(&[0x00, 0x00, 0x40, 0x00, 0x00, 0xC0]);
+
+        let audio = Audio::parse_wav(&wav).unwrap();
+        assert_eq!(audio.samples, vec![0.5, 0.5, -0.5, -0.5]);
+    }
+
+    #[test]
+    fn test_position_follows_tempo() {
+        let renderer = OfflineRenderer::new(44100, 512, 120.0);
+        assert_eq!(renderer.samples_per_beat(), 22050);
+        assert_eq!(renderer.position_at(44100).song_pos_beats, 2.0);
+        assert_eq!(
+            OfflineRenderer::new(44100, 512, 0.0)
+                .position_at(512)
+                .song_pos_beats,
+            0.0
+        );
+    }
+
+    #[test]
+    fn test_batch_results_keep_job_order() {
+        let mut buffers: Vec<Audio> = (0..24)
+            .map(|i| Audio {
+                sample_rate: 44100,
+                samples: vec![1.0; (i % 5 + 1) * 1000 * CHANNELS],
+            })
+            .collect();
+        let mut batch = BatchRenderer::new(256, 120.0);
+        batch.threads = 4;
+
+        let results = batch.render_buffers(&mut buffers, |i| Gain(i as f32), |_, _| {});
+        for (i, (audio, result)) in buffers.iter().zip(&results).enumerate() {
+            assert!(audio.samples.iter().all(|&s| s == i as f32));
+            assert_eq!(result.unwrap().frames, ((i % 5 + 1) * 1000) as u64);
+        }
+    }
+
+    #[test]
+    fn test_batch_renders_files() {
+        let dir = std::env::temp_dir().join(format!("vdj_batch_{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let jobs: Vec<BatchJob> = (0..3)
+            .map(|i| BatchJob {
+                input: dir.join(format!("in{}.wav", i)),
+                output: dir.join(format!("out{}.wav", i)),
+            })
+            .collect();
+        for job in &jobs[..2] {
+            let audio = Audio {
+                sample_rate: 48000,
+                samples: vec![0.25; 4800 * CHANNELS],
+            };
+            audio.save(&job.input, WavFormat::Float32).unwrap();
+        }
+
+        let report = BatchRenderer::new(512, 0.0).render_files(&jobs, |_| Gain(2.0), |_, _| {});
+        assert_eq!(report.failures(), 1);
+        assert!(report.results[2].is_err());
+        assert!((report.audio_seconds - 0.2).abs() < 1e-9);
+        let rendered = Audio::open(&jobs[1].output).unwrap();
+        assert!(rendered.samples.iter().all(|&s| s == 0.5));
+        std::fs::remove_dir_all(&dir).ok();
+    }
+}
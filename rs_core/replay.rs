@@ -0,0 +1,1113 @@
+//! VirtualDJ Rust SDK - Record and Replay
+//!
+//! The shim can record every inbound call of one plugin instance during a
+//! live set: start/stop, parameter changes with their values, the input
+//! samples and beat position of every block, position transforms and the
+//! answers to the plugin's host queries, including the song audio
+//! `GetSongBuffer` returned to a buffer DSP plugin. [`Recording`] reads such a
+//! file back and [`Replayer`] feeds it to a plugin at full speed, timing every
+//! block, so CPU spikes from a gig can be reproduced and optimized offline.
+//! A replayed plugin queries the host through the context of
+//! [`Recording::answers`].
+//!
+//! # Example
+//!
+//! ```ignore
+//! // during the set
+//! replay::start_recording(handle as *mut ffi::VdjPlugin, "/tmp/set.vdjr")?;
+//! // ...
+//! replay::stop_recording()?;
+//!
+//! // offline
+//! let recording = replay::Recording::open("/tmp/set.vdjr")?;
+//! let report = replay::Replayer::new(&recording).run_dsp(
+//!     &mut MyEffect::default(),
+//!     |fx, id, value| fx.set(id, value as f32),
+//!     |fx, position| fx.position = position,
+//! )?;
+//! println!("p99 {} ns, {} overruns", report.p99_ns, report.overruns);
+//! ```
+
+use std::collections::HashMap;
+use std::ffi::{CStr, CString};
+use std::io;
+use std::path::Path;
+use std::sync::Mutex;
+use std::time::Instant;
+
+use crate::ffi;
+use crate::host::CHANNELS;
+use crate::modulation::BlockPosition;
+use crate::rt_check::{self, RealtimeScope, RtViolations};
+use crate::{BufferDspPlugin, DspPlugin, PluginContext, PluginError, PositionDspPlugin, Result};
+
+/// Inputs of an audio block
+pub type ReplayBlock = ffi::VdjReplayBlock;
+
+/// Inputs of an `OnTransformPosition` call
+pub type ReplayPosition = ffi::VdjReplayPosition;
+
+/// One recorded call
+#[derive(Debug, Clone, PartialEq)]
+pub enum ReplayEvent {
+    Start,
+    Stop,
+    /// `param_type` is a `VDJPARAM_*` value, or
+    /// `ffi::VDJ_REPLAY_PARAMETER_UNKNOWN` when the value was not captured
+    Parameter {
+        id: i32,
+        param_type: i32,
+        value: f64,
+    },
+    /// `samples` holds the interleaved stereo input of the block
+    ProcessSamples {
+        block: ReplayBlock,
+        samples: Vec<f32>,
+    },
+    TransformPosition(ReplayPosition),
+    GetSongBuffer(ReplayBlock),
+    /// Song audio the host returned to a `GetSongBuffer` query; `samples` is
+    /// empty when the query failed
+    SongAudio {
+        pos: i32,
+        nb: i32,
+        hr: ffi::HRESULT,
+        samples: Vec<i16>,
+    },
+    GetInfo {
+        command: String,
+        hr: ffi::HRESULT,
+        value: f64,
+    },
+    GetStringInfo {
+        command: String,
+        hr: ffi::HRESULT,
+        result: String,
+    },
+}
+
+/// A recorded call and when it happened
+#[derive(Debug, Clone, PartialEq)]
+pub struct ReplayRecord {
+    /// Nanoseconds since the recording started
+    pub time_ns: u64,
+    pub event: ReplayEvent,
+}
+
+/// Start recording the calls of a plugin instance to a file
+///
+/// Only one recording runs per process.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn start_recording(plugin: *mut ffi::VdjPlugin, path: &str) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let c_path = CString::new(path).map_err(|_| PluginError::Fail)?;
+    match ffi::vdj_plugin_replay_record_start(plugin, c_path.as_ptr() as *const u8) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Write the queued records and close the recording
+pub fn stop_recording() -> Result<()> {
+    match unsafe { ffi::vdj_plugin_replay_record_stop() } {
+        ffi::S_OK | ffi::S_FALSE => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Records dropped because a callback thread's ring was full
+pub fn dropped_records() -> u64 {
+    unsafe { ffi::vdj_plugin_replay_dropped_records() }
+}
+
+/* ============================================================================
+   Sample Compression
+   ============================================================================ */
+
+/// Compress interleaved stereo samples (`VDJ_REPLAY_FLAG_COMPRESSED`)
+pub fn compress_samples(samples: &[f32], out: &mut Vec<u8>) {
+    let count = samples.len();
+    let mut planes = vec![0u8; count * 4];
+    let mut previous = [0u32; CHANNELS];
+    for (i, s) in samples.iter().enumerate() {
+        let bits = s.to_bits();
+        let x = bits ^ previous[i % CHANNELS];
+        previous[i % CHANNELS] = bits;
+        for b in 0..4 {
+            planes[b * count + i] = (x >> (24 - 8 * b)) as u8;
+        }
+    }
+
+    let n = planes.len();
+    let mut i = 0;
+    while i < n {
+        if planes[i] == 0 {
+            let mut run = 1;
+            while i + run < n && planes[i + run] == 0 && run < 128 {
+                run += 1;
+            }
+            out.push((127 + run) as u8);
+            i += run;
+            continue;
+        }
+        let start = i;
+        while i < n && i - start < 128 && !(planes[i] == 0 && i + 1 < n && planes[i + 1] == 0) {
+            i += 1;
+        }
+        out.push((i - start - 1) as u8);
+        out.extend_from_slice(&planes[start..i]);
+    }
+}
+
+/// Decompress `count` samples, or `None` if the data is truncated
+pub fn decompress_samples(data: &[u8], count: usize) -> Option<Vec<f32>> {
+    let n = count * 4;
+    let mut planes = Vec::with_capacity(n);
+    let mut i = 0;
+    while planes.len() < n {
+        let c = *data.get(i)? as usize;
+        i += 1;
+        if c >= 128 {
+            planes.resize(planes.len() + c - 127, 0);
+        } else {
+            planes.extend_from_slice(data.get(i..i + c + 1)?);
+            i += c + 1;
+        }
+    }
+    if planes.len() != n {
+        return None;
+    }
+
+    let mut previous = [0u32; CHANNELS];
+    let samples = (0..count)
+        .map(|i| {
+            let x = (0..4).fold(0u32, |x, b| {
+                x | (planes[b * count + i] as u32) << (24 - 8 * b)
+            });
+            let bits = x ^ previous[i % CHANNELS];
+            previous[i % CHANNELS] = bits;
+            f32::from_bits(bits)
+        })
+        .collect();
+    Some(samples)
+}
+
+/* ============================================================================
+   Recording Files
+   ============================================================================ */
+
+fn invalid(what: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, format!("replay: {}", what))
+}
+
+/// Little-endian reader over a record payload
+struct Fields<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Fields<'a> {
+    fn new(bytes: &'a [u8]) -> Self {
+        Fields { bytes, pos: 0 }
+    }
+
+    fn take(&mut self, n: usize) -> io::Result<&'a [u8]> {
+        let end = self.pos.checked_add(n).filter(|&e| e <= self.bytes.len());
+        let end = end.ok_or_else(|| invalid("truncated record"))?;
+        let slice = &self.bytes[self.pos..end];
+        self.pos = end;
+        Ok(slice)
+    }
+
+    fn rest(&mut self) -> &'a [u8] {
+        let slice = &self.bytes[self.pos..];
+        self.pos = self.bytes.len();
+        slice
+    }
+
+    fn u16(&mut self) -> io::Result<u16> {
+        Ok(u16::from_le_bytes(self.take(2)?.try_into().unwrap()))
+    }
+
+    fn u32(&mut self) -> io::Result<u32> {
+        Ok(u32::from_le_bytes(self.take(4)?.try_into().unwrap()))
+    }
+
+    fn i32(&mut self) -> io::Result<i32> {
+        Ok(i32::from_le_bytes(self.take(4)?.try_into().unwrap()))
+    }
+
+    fn u64(&mut self) -> io::Result<u64> {
+        Ok(u64::from_le_bytes(self.take(8)?.try_into().unwrap()))
+    }
+
+    fn f32(&mut self) -> io::Result<f32> {
+        Ok(f32::from_le_bytes(self.take(4)?.try_into().unwrap()))
+    }
+
+    fn f64(&mut self) -> io::Result<f64> {
+        Ok(f64::from_le_bytes(self.take(8)?.try_into().unwrap()))
+    }
+
+    fn string(&mut self, n: usize) -> io::Result<String> {
+        Ok(String::from_utf8_lossy(self.take(n)?).into_owned())
+    }
+
+    fn block(&mut self) -> io::Result<ReplayBlock> {
+        Ok(ReplayBlock {
+            nb: self.i32()?,
+            sample_rate: self.i32()?,
+            song_bpm: self.i32()?,
+            song_pos: self.i32()?,
+            song_pos_beats: self.f64()?,
+        })
+    }
+}
+
+fn put_block(out: &mut Vec<u8>, b: &ReplayBlock) {
+    out.extend_from_slice(&b.nb.to_le_bytes());
+    out.extend_from_slice(&b.sample_rate.to_le_bytes());
+    out.extend_from_slice(&b.song_bpm.to_le_bytes());
+    out.extend_from_slice(&b.song_pos.to_le_bytes());
+    out.extend_from_slice(&b.song_pos_beats.to_le_bytes());
+}
+
+fn put_query(out: &mut Vec<u8>, hr: ffi::HRESULT, command: &str, result: &str, value: f64) {
+    out.extend_from_slice(&hr.to_le_bytes());
+    out.extend_from_slice(&(command.len() as u32).to_le_bytes());
+    out.extend_from_slice(&(result.len() as u32).to_le_bytes());
+    out.extend_from_slice(&0u32.to_le_bytes());
+    out.extend_from_slice(&value.to_le_bytes());
+    out.extend_from_slice(command.as_bytes());
+    out.extend_from_slice(result.as_bytes());
+}
+
+/// A recorded call stream
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct Recording {
+    /// Process-unique ID of the recorded instance
+    pub instance_id: u32,
+    pub records: Vec<ReplayRecord>,
+}
+
+impl Recording {
+    /// Read a recording file
+    pub fn open<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+        Self::parse(&std::fs::read(path)?)
+    }
+
+    /// Parse a recording
+    ///
+    /// A record cut short at the end (a recording of a crashed process) ends
+    /// the stream instead of failing.
+    pub fn parse(bytes: &[u8]) -> io::Result<Self> {
+        let mut file = Fields::new(bytes);
+        if file.u32()? != ffi::VDJ_REPLAY_MAGIC {
+            return Err(invalid("not a recording"));
+        }
+        if file.u32()? != ffi::VDJ_REPLAY_VERSION {
+            return Err(invalid("unsupported version"));
+        }
+        let instance_id = file.u32()?;
+        file.u32()?;
+
+        let mut records = Vec::new();
+        while file.pos < bytes.len() {
+            let header = match Self::record_header(&mut file) {
+                Ok(h) => h,
+                Err(_) => break,
+            };
+            let payload = match file.take(header.size as usize) {
+                Ok(p) => p,
+                Err(_) => break,
+            };
+            if let Some(event) = Self::event(&header, payload)? {
+                records.push(ReplayRecord {
+                    time_ns: header.time_ns,
+                    event,
+                });
+            }
+        }
+        Ok(Recording {
+            instance_id,
+            records,
+        })
+    }
+
+    fn record_header(file: &mut Fields) -> io::Result<ffi::VdjReplayRecordHeader> {
+        Ok(ffi::VdjReplayRecordHeader {
+            kind: file.u16()?,
+            flags: file.u16()?,
+            size: file.u32()?,
+            time_ns: file.u64()?,
+        })
+    }
+
+    /// Decode one payload; unknown kinds are skipped
+    fn event(
+        header: &ffi::VdjReplayRecordHeader,
+        payload: &[u8],
+    ) -> io::Result<Option<ReplayEvent>> {
+        let mut f = Fields::new(payload);
+        let event = match header.kind {
+            ffi::VDJ_REPLAY_START => ReplayEvent::Start,
+            ffi::VDJ_REPLAY_STOP => ReplayEvent::Stop,
+            ffi::VDJ_REPLAY_PARAMETER => ReplayEvent::Parameter {
+                id: f.i32()?,
+                param_type: f.i32()?,
+                value: f.f64()?,
+            },
+            ffi::VDJ_REPLAY_PROCESS_SAMPLES => {
+                let block = f.block()?;
+                let count = block.nb.max(0) as usize * CHANNELS;
+                let data = f.rest();
+                let samples = if header.flags & ffi::VDJ_REPLAY_FLAG_COMPRESSED != 0 {
+                    decompress_samples(data, count).ok_or_else(|| invalid("corrupt samples"))?
+                } else {
+                    data.chunks_exact(4)
+                        .take(count)
+                        .map(|b| f32::from_le_bytes(b.try_into().unwrap()))
+                        .collect()
+                };
+                ReplayEvent::ProcessSamples { block, samples }
+            }
+            ffi::VDJ_REPLAY_TRANSFORM_POSITION => ReplayEvent::TransformPosition(ReplayPosition {
+                song_pos: f.f64()?,
+                video_pos: f.f64()?,
+                volume: f.f32()?,
+                src_volume: f.f32()?,
+                song_pos_beats: f.f64()?,
+                song_bpm: f.i32()?,
+                sample_rate: f.i32()?,
+            }),
+            ffi::VDJ_REPLAY_GET_SONG_BUFFER => ReplayEvent::GetSongBuffer(f.block()?),
+            ffi::VDJ_REPLAY_SONG_AUDIO => {
+                let hr = f.i32()?;
+                let pos = f.i32()?;
+                let nb = f.i32()?;
+                f.u32()?;
+                let samples = f
+                    .rest()
+                    .chunks_exact(2)
+                    .map(|b| i16::from_le_bytes(b.try_into().unwrap()))
+                    .collect();
+                ReplayEvent::SongAudio {
+                    pos,
+                    nb,
+                    hr,
+                    samples,
+                }
+            }
+            ffi::VDJ_REPLAY_GET_INFO | ffi::VDJ_REPLAY_GET_STRING_INFO => {
+                let hr = f.i32()?;
+                let command_size = f.u32()? as usize;
+                let result_size = f.u32()? as usize;
+                f.u32()?;
+                let value = f.f64()?;
+                let command = f.string(command_size)?;
+                if header.kind == ffi::VDJ_REPLAY_GET_INFO {
+                    ReplayEvent::GetInfo { command, hr, value }
+                } else {
+                    let result = f.string(result_size)?;
+                    ReplayEvent::GetStringInfo {
+                        command,
+                        hr,
+                        result,
+                    }
+                }
+            }
+            _ => return Ok(None),
+        };
+        Ok(Some(event))
+    }
+
+    /// Encode the recording in the shim's file format
+    ///
+    /// Useful to trim a long recording down to the section around a spike.
+    pub fn to_bytes(&self) -> Vec<u8> {
+        let mut out = Vec::new();
+        for v in [
+            ffi::VDJ_REPLAY_MAGIC,
+            ffi::VDJ_REPLAY_VERSION,
+            self.instance_id,
+            0,
+        ] {
+            out.extend_from_slice(&v.to_le_bytes());
+        }
+
+        let mut payload = Vec::new();
+        for record in &self.records {
+            payload.clear();
+            let mut flags = 0u16;
+            let kind = match &record.event {
+                ReplayEvent::Start => ffi::VDJ_REPLAY_START,
+                ReplayEvent::Stop => ffi::VDJ_REPLAY_STOP,
+                ReplayEvent::Parameter {
+                    id,
+                    param_type,
+                    value,
+                } => {
+                    payload.extend_from_slice(&id.to_le_bytes());
+                    payload.extend_from_slice(&param_type.to_le_bytes());
+                    payload.extend_from_slice(&value.to_le_bytes());
+                    ffi::VDJ_REPLAY_PARAMETER
+                }
+                ReplayEvent::ProcessSamples { block, samples } => {
+                    put_block(&mut payload, block);
+                    compress_samples(samples, &mut payload);
+                    flags = ffi::VDJ_REPLAY_FLAG_COMPRESSED;
+                    ffi::VDJ_REPLAY_PROCESS_SAMPLES
+                }
+                ReplayEvent::TransformPosition(p) => {
+                    payload.extend_from_slice(&p.song_pos.to_le_bytes());
+                    payload.extend_from_slice(&p.video_pos.to_le_bytes());
+                    payload.extend_from_slice(&p.volume.to_le_bytes());
+                    payload.extend_from_slice(&p.src_volume.to_le_bytes());
+                    payload.extend_from_slice(&p.song_pos_beats.to_le_bytes());
+                    payload.extend_from_slice(&p.song_bpm.to_le_bytes());
+                    payload.extend_from_slice(&p.sample_rate.to_le_bytes());
+                    ffi::VDJ_REPLAY_TRANSFORM_POSITION
+                }
+                ReplayEvent::GetSongBuffer(block) => {
+                    put_block(&mut payload, block);
+                    ffi::VDJ_REPLAY_GET_SONG_BUFFER
+                }
+                ReplayEvent::SongAudio {
+                    pos,
+                    nb,
+                    hr,
+                    samples,
+                } => {
+                    payload.extend_from_slice(&hr.to_le_bytes());
+                    payload.extend_from_slice(&pos.to_le_bytes());
+                    payload.extend_from_slice(&nb.to_le_bytes());
+                    payload.extend_from_slice(&0u32.to_le_bytes());
+                    for s in samples {
+                        payload.extend_from_slice(&s.to_le_bytes());
+                    }
+                    ffi::VDJ_REPLAY_SONG_AUDIO
+                }
+                ReplayEvent::GetInfo { command, hr, value } => {
+                    put_query(&mut payload, *hr, command, "", *value);
+                    ffi::VDJ_REPLAY_GET_INFO
+                }
+                ReplayEvent::GetStringInfo {
+                    command,
+                    hr,
+                    result,
+                } => {
+                    put_query(&mut payload, *hr, command, result, 0.0);
+                    ffi::VDJ_REPLAY_GET_STRING_INFO
+                }
+            };
+            out.extend_from_slice(&kind.to_le_bytes());
+            out.extend_from_slice(&flags.to_le_bytes());
+            out.extend_from_slice(&(payload.len() as u32).to_le_bytes());
+            out.extend_from_slice(&record.time_ns.to_le_bytes());
+            out.extend_from_slice(&payload);
+        }
+        out
+    }
+
+    /// Write the recording to a file
+    pub fn save<P: AsRef<Path>>(&self, path: P) -> io::Result<()> {
+        std::fs::write(path, self.to_bytes())
+    }
+
+    /// Number of recorded audio blocks: sample blocks and buffer DSP
+    /// `OnGetSongBuffer` calls
+    pub fn blocks(&self) -> usize {
+        self.records
+            .iter()
+            .filter(|r| {
+                matches!(
+                    r.event,
+                    ReplayEvent::ProcessSamples { .. } | ReplayEvent::GetSongBuffer(_)
+                )
+            })
+            .count()
+    }
+
+    /// Host query answers of the recording, to build a [`PluginContext`]
+    pub fn answers(&self) -> ReplayAnswers {
+        let mut info: HashMap<String, Answers<f64>> = HashMap::new();
+        let mut strings: HashMap<String, Answers<String>> = HashMap::new();
+        let mut song = Answers::default();
+        for record in &self.records {
+            match &record.event {
+                ReplayEvent::GetInfo { command, hr, value } => info
+                    .entry(command.clone())
+                    .or_default()
+                    .values
+                    .push((*hr, *value)),
+                ReplayEvent::GetStringInfo {
+                    command,
+                    hr,
+                    result,
+                } => strings
+                    .entry(command.clone())
+                    .or_default()
+                    .values
+                    .push((*hr, result.clone())),
+                ReplayEvent::SongAudio { hr, samples, .. } => {
+                    song.values.push((*hr, samples.clone()))
+                }
+                _ => {}
+            }
+        }
+        ReplayAnswers {
+            info: Mutex::new(info),
+            strings: Mutex::new(strings),
+            song: Mutex::new(song),
+        }
+    }
+}
+
+/* ============================================================================
+   Host Query Answers
+   ============================================================================ */
+
+/// Recorded answers of one command, returned in recording order
+#[derive(Debug)]
+struct Answers<T> {
+    values: Vec<(ffi::HRESULT, T)>,
+    next: usize,
+}
+
+impl<T> Default for Answers<T> {
+    fn default() -> Self {
+        Answers {
+            values: Vec::new(),
+            next: 0,
+        }
+    }
+}
+
+impl<T> Answers<T> {
+    /// Next answer; the last one repeats once the recording runs out
+    fn next(&mut self) -> Option<&(ffi::HRESULT, T)> {
+        let i = self.next.min(self.values.len().checked_sub(1)?);
+        self.next += 1;
+        self.values.get(i)
+    }
+}
+
+/// Answers host queries from a recording instead of VirtualDJ
+///
+/// Each command gets its recorded answers in order; commands that were never
+/// recorded fail with `E_NOTIMPL` and sent commands are ignored. Song buffer
+/// queries get the recorded song audio in order, whatever position they ask
+/// for.
+#[derive(Debug)]
+pub struct ReplayAnswers {
+    info: Mutex<HashMap<String, Answers<f64>>>,
+    strings: Mutex<HashMap<String, Answers<String>>>,
+    song: Mutex<Answers<Vec<i16>>>,
+}
+
+impl ReplayAnswers {
+    /// A context whose queries are answered from the recording
+    ///
+    /// The context must not outlive `self`.
+    pub fn context(&self) -> PluginContext {
+        PluginContext::new(
+            self as *const ReplayAnswers as *mut ffi::VdjPlugin,
+            &REPLAY_CALLBACKS,
+        )
+    }
+}
+
+static REPLAY_CALLBACKS: ffi::VdjCallbacks = ffi::VdjCallbacks {
+    send_command: replay_send_command,
+    get_info: replay_get_info,
+    get_string_info: replay_get_string_info,
+    declare_parameter: replay_declare_parameter,
+    get_song_buffer: replay_get_song_buffer,
+};
+
+unsafe fn answers_of<'a>(plugin: *mut ffi::VdjPlugin) -> &'a ReplayAnswers {
+    &*(plugin as *const ReplayAnswers)
+}
+
+unsafe fn command_of(command: *const u8) -> String {
+    CStr::from_ptr(command as *const std::ffi::c_char)
+        .to_string_lossy()
+        .into_owned()
+}
+
+extern "C" fn replay_send_command(
+    _plugin: *mut ffi::VdjPlugin,
+    _command: *const u8,
+) -> ffi::HRESULT {
+    ffi::S_OK
+}
+
+extern "C" fn replay_get_info(
+    plugin: *mut ffi::VdjPlugin,
+    command: *const u8,
+    result: *mut f64,
+) -> ffi::HRESULT {
+    if plugin.is_null() || command.is_null() || result.is_null() {
+        return ffi::E_FAIL;
+    }
+    let (answers, command) = unsafe { (answers_of(plugin), command_of(command)) };
+    let mut info = answers.info.lock().unwrap();
+    match info.get_mut(&command).and_then(|a| a.next()) {
+        Some(&(hr, value)) => {
+            unsafe { *result = value };
+            hr
+        }
+        None => ffi::E_NOTIMPL,
+    }
+}
+
+extern "C" fn replay_get_string_info(
+    plugin: *mut ffi::VdjPlugin,
+    command: *const u8,
+    result: *mut u8,
+    size: i32,
+) -> ffi::HRESULT {
+    if plugin.is_null() || command.is_null() || result.is_null() || size <= 0 {
+        return ffi::E_FAIL;
+    }
+    let (answers, command) = unsafe { (answers_of(plugin), command_of(command)) };
+    let mut strings = answers.strings.lock().unwrap();
+    match strings.get_mut(&command).and_then(|a| a.next()) {
+        Some((hr, text)) => {
+            let n = text.len().min(size as usize - 1);
+            unsafe {
+                std::ptr::copy_nonoverlapping(text.as_ptr(), result, n);
+                *result.add(n) = 0;
+            }
+            *hr
+        }
+        None => ffi::E_NOTIMPL,
+    }
+}
+
+extern "C" fn replay_declare_parameter(
+    _plugin: *mut ffi::VdjPlugin,
+    _parameter: *mut std::ffi::c_void,
+    _param_type: i32,
+    _id: i32,
+    _name: *const u8,
+    _short_name: *const u8,
+    _default_value: f32,
+) -> ffi::HRESULT {
+    ffi::S_OK
+}
+
+extern "C" fn replay_get_song_buffer(
+    plugin: *mut ffi::VdjPlugin,
+    _pos: i32,
+    nb: i32,
+    buffer: *mut *mut i16,
+) -> ffi::HRESULT {
+    if plugin.is_null() || buffer.is_null() || nb < 0 {
+        return ffi::E_FAIL;
+    }
+    let answers = unsafe { answers_of(plugin) };
+    let mut song = answers.song.lock().unwrap();
+    match song.next() {
+        Some((hr, _)) if *hr != ffi::S_OK => *hr,
+        // The samples are never modified while `answers` lives
+        Some((hr, samples)) if samples.len() >= nb as usize * CHANNELS => {
+            unsafe { *buffer = samples.as_ptr() as *mut i16 };
+            *hr
+        }
+        Some(_) => ffi::E_FAIL,
+        None => ffi::E_NOTIMPL,
+    }
+}
+
+/* ============================================================================
+   Replay
+   ============================================================================ */
+
+/// Timing of a replay, in nanoseconds
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct ReplayReport {
+    pub blocks: u64,
+    pub frames: u64,
+    pub min_ns: u64,
+    pub max_ns: u64,
+    pub mean_ns: u64,
+    pub p50_ns: u64,
+    pub p99_ns: u64,
+    /// Blocks that took longer than they last at their sample rate
+    pub overruns: u64,
+    /// Audio duration divided by processing time (above 1 is faster than real time)
+    pub realtime_factor: f64,
+    /// Allocator violations made by the plugin's audio callbacks
+    pub violations: RtViolations,
+}
+
+/// Accumulates block timings into a [`ReplayReport`]
+struct Timings {
+    durations: Vec<u64>,
+    audio_ns: f64,
+    overruns: u64,
+    frames: u64,
+}
+
+impl Timings {
+    fn new(blocks: usize) -> Self {
+        Timings {
+            durations: Vec::with_capacity(blocks),
+            audio_ns: 0.0,
+            overruns: 0,
+            frames: 0,
+        }
+    }
+
+    fn add(&mut self, ns: u64, nb: i32, sample_rate: i32) {
+        self.durations.push(ns);
+        self.frames += nb.max(0) as u64;
+        if sample_rate > 0 {
+            let budget = nb as f64 * 1e9 / sample_rate as f64;
+            self.audio_ns += budget;
+            if ns as f64 > budget {
+                self.overruns += 1;
+            }
+        }
+    }
+
+    fn report(mut self, violations: RtViolations) -> ReplayReport {
+        let mut report = ReplayReport {
+            violations,
+            ..Default::default()
+        };
+        if self.durations.is_empty() {
+            return report;
+        }
+        let total: u64 = self.durations.iter().sum();
+        self.durations.sort_unstable();
+        let n = self.durations.len();
+        let percentile = |p: f64| self.durations[((n as f64 * p) as usize).min(n - 1)];
+        report.blocks = n as u64;
+        report.frames = self.frames;
+        report.min_ns = self.durations[0];
+        report.max_ns = self.durations[n - 1];
+        report.mean_ns = total / n as u64;
+        report.p50_ns = percentile(0.5);
+        report.p99_ns = percentile(0.99);
+        report.overruns = self.overruns;
+        report.realtime_factor = if total > 0 {
+            self.audio_ns / total as f64
+        } else {
+            0.0
+        };
+        report
+    }
+}
+
+/// Beat position the host reported for a recorded block
+fn position_of(block: &ReplayBlock) -> BlockPosition {
+    BlockPosition::new(block.song_pos_beats, block.song_bpm)
+}
+
+/// Feeds a recording to a plugin at full speed
+pub struct Replayer<'r> {
+    recording: &'r Recording,
+}
+
+impl<'r> Replayer<'r> {
+    pub fn new(recording: &'r Recording) -> Self {
+        Replayer { recording }
+    }
+
+    /// Replay start/stop, parameter changes and sample blocks into a DSP
+    /// plugin, timing every `on_process_samples` call
+    ///
+    /// `set_parameter(plugin, id, value)` stores a recorded parameter value
+    /// before `on_parameter` is called, as VirtualDJ writes the declared
+    /// storage before notifying. `on_block(plugin, position)` runs before
+    /// each block with the recorded `SongPosBeats`/`SongBpm`, so tempo-synced
+    /// plugins replay the workload of the set; it is not timed.
+    pub fn run_dsp<P, F, B>(
+        &self,
+        plugin: &mut P,
+        mut set_parameter: F,
+        mut on_block: B,
+    ) -> Result<ReplayReport>
+    where
+        P: DspPlugin + ?Sized,
+        F: FnMut(&mut P, i32, f64),
+        B: FnMut(&mut P, BlockPosition),
+    {
+        let mut timings = Timings::new(self.recording.blocks());
+        let mut buffer = Vec::new();
+        let before = rt_check::thread_violations();
+
+        for record in &self.recording.records {
+            match &record.event {
+                ReplayEvent::Start => DspPlugin::on_start(plugin)?,
+                ReplayEvent::Stop => DspPlugin::on_stop(plugin)?,
+                ReplayEvent::Parameter {
+                    id,
+                    param_type,
+                    value,
+                } => {
+                    if *param_type != ffi::VDJ_REPLAY_PARAMETER_UNKNOWN {
+                        set_parameter(plugin, *id, *value);
+                    }
+                    plugin.on_parameter(*id)?;
+                }
+                ReplayEvent::ProcessSamples { block, samples } => {
+                    buffer.clear();
+                    buffer.extend_from_slice(samples);
+                    on_block(plugin, position_of(block));
+                    let start = Instant::now();
+                    {
+                        let _realtime = RealtimeScope::enter();
+                        plugin.on_process_samples(&mut buffer)?;
+                    }
+                    timings.add(
+                        start.elapsed().as_nanos() as u64,
+                        block.nb,
+                        block.sample_rate,
+                    );
+                }
+                _ => {}
+            }
+        }
+
+        Ok(timings.report(rt_check::thread_violations().since(&before)))
+    }
+
+    /// Replay a position DSP plugin: every recorded `OnTransformPosition`
+    /// call and its following sample block are timed together
+    ///
+    /// `on_block` runs before each of the two calls, with the position
+    /// recorded for it.
+    pub fn run_position_dsp<P, F, B>(
+        &self,
+        plugin: &mut P,
+        mut set_parameter: F,
+        mut on_block: B,
+    ) -> Result<ReplayReport>
+    where
+        P: PositionDspPlugin + ?Sized,
+        F: FnMut(&mut P, i32, f64),
+        B: FnMut(&mut P, BlockPosition),
+    {
+        let mut timings = Timings::new(self.recording.blocks());
+        let mut buffer = Vec::new();
+        let mut transform_ns = 0u64;
+        let before = rt_check::thread_violations();
+
+        for record in &self.recording.records {
+            match &record.event {
+                ReplayEvent::Start => PositionDspPlugin::on_start(plugin)?,
+                ReplayEvent::Stop => PositionDspPlugin::on_stop(plugin)?,
+                ReplayEvent::Parameter {
+                    id,
+                    param_type,
+                    value,
+                } => {
+                    if *param_type != ffi::VDJ_REPLAY_PARAMETER_UNKNOWN {
+                        set_parameter(plugin, *id, *value);
+                    }
+                    plugin.on_parameter(*id)?;
+                }
+                ReplayEvent::TransformPosition(p) => {
+                    let (mut pos, mut video_pos) = (p.song_pos, p.video_pos);
+                    let (mut volume, mut src_volume) = (p.volume, p.src_volume);
+                    on_block(plugin, BlockPosition::new(p.song_pos_beats, p.song_bpm));
+                    let start = Instant::now();
+                    {
+                        let _realtime = RealtimeScope::enter();
+                        plugin.on_transform_position(
+                            &mut pos,
+                            &mut video_pos,
+                            &mut volume,
+                            &mut src_volume,
+                        )?;
+                    }
+                    transform_ns = start.elapsed().as_nanos() as u64;
+                }
+                ReplayEvent::ProcessSamples { block, samples } => {
+                    buffer.clear();
+                    buffer.extend_from_slice(samples);
+                    on_block(plugin, position_of(block));
+                    let start = Instant::now();
+                    {
+                        let _realtime = RealtimeScope::enter();
+                        PositionDspPlugin::on_process_samples(plugin, &mut buffer)?;
+                    }
+                    let ns = start.elapsed().as_nanos() as u64 + transform_ns;
+                    transform_ns = 0;
+                    timings.add(ns, block.nb, block.sample_rate);
+                }
+                _ => {}
+            }
+        }
+
+        Ok(timings.report(rt_check::thread_violations().since(&before)))
+    }
+
+    /// Replay a buffer DSP plugin, timing every `on_get_song_buffer` call
+    ///
+    /// The plugin must read song audio through a context from
+    /// [`Recording::answers`], which returns the recorded blocks in order.
+    /// `set_parameter` and `on_block` work as in [`Replayer::run_dsp`].
+    pub fn run_buffer_dsp<P, F, B>(
+        &self,
+        plugin: &mut P,
+        mut set_parameter: F,
+        mut on_block: B,
+    ) -> Result<ReplayReport>
+    where
+        P: BufferDspPlugin + ?Sized,
+        F: FnMut(&mut P, i32, f64),
+        B: FnMut(&mut P, BlockPosition),
+    {
+        let mut timings = Timings::new(self.recording.blocks());
+        let before = rt_check::thread_violations();
+
+        for record in &self.recording.records {
+            match &record.event {
+                ReplayEvent::Start => BufferDspPlugin::on_start(plugin)?,
+                ReplayEvent::Stop => BufferDspPlugin::on_stop(plugin)?,
+                ReplayEvent::Parameter {
+                    id,
+                    param_type,
+                    value,
+                } => {
+                    if *param_type != ffi::VDJ_REPLAY_PARAMETER_UNKNOWN {
+                        set_parameter(plugin, *id, *value);
+                    }
+                    plugin.on_parameter(*id)?;
+                }
+                ReplayEvent::GetSongBuffer(block) => {
+                    on_block(plugin, position_of(block));
+                    let start = Instant::now();
+                    {
+                        let _realtime = RealtimeScope::enter();
+                        std::hint::black_box(plugin.on_get_song_buffer(block.song_pos, block.nb));
+                    }
+                    timings.add(
+                        start.elapsed().as_nanos() as u64,
+                        block.nb,
+                        block.sample_rate,
+                    );
+                }
+                _ => {}
+            }
+        }
+
+        Ok(timings.report(rt_check::thread_violations().since(&before)))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn block(nb: i32) -> ReplayBlock {
+        ReplayBlock {
+            nb,
+            sample_rate: 44100,
+            song_bpm: 22050,
+            song_pos: 0,
+            song_pos_beats: 1.5,
+        }
+    }
+
+    #[test]
+    fn test_compression_round_trip() {
+        let mut samples: Vec<f32> = (0..512).map(|i| (i as f32 * 0.01).sin() * 0.5).collect();
+        samples[7] = -0.0;
+        samples[8] = f32::MAX;
+        let mut packed = Vec::new();
+        compress_samples(&samples, &mut packed);
+        let unpacked = decompress_samples(&packed, samples.len()).unwrap();
+        assert!(samples
+            .iter()
+            .zip(&unpacked)
+            .all(|(a, b)| a.to_bits() == b.to_bits()));
+
+        // Silence is a handful of zero-run bytes
+        packed.clear();
+        compress_samples(&[0.0f32; 2048], &mut packed);
+        assert!(packed.len() <= 64, "{} bytes", packed.len());
+        assert!(decompress_samples(&packed[..packed.len() - 1], 2048).is_none());
+    }
+
+    #[test]
+    fn test_recording_round_trip_and_answers() {
+        let recording = Recording {
+            instance_id: 3,
+            records: vec![
+                ReplayRecord {
+                    time_ns: 0,
+                    event: ReplayEvent::Start,
+                },
+                ReplayRecord {
+                    time_ns: 10,
+                    event: ReplayEvent::GetInfo {
+                        command: "get_bpm".into(),
+                        hr: ffi::S_OK,
+                        value: 128.0,
+                    },
+                },
+                ReplayRecord {
+                    time_ns: 20,
+                    event: ReplayEvent::ProcessSamples {
+                        block: block(4),
+                        samples: vec![0.1, -0.1, 0.2, -0.2, 0.3, -0.3, 0.4, -0.4],
+                    },
+                },
+                ReplayRecord {
+                    time_ns: 22,
+                    event: ReplayEvent::GetSongBuffer(block(2)),
+                },
+                ReplayRecord {
+                    time_ns: 24,
+                    event: ReplayEvent::SongAudio {
+                        pos: 0,
+                        nb: 2,
+                        hr: ffi::S_OK,
+                        samples: vec![100, -100, i16::MAX, i16::MIN],
+                    },
+                },
+                ReplayRecord {
+                    time_ns: 30,
+                    event: ReplayEvent::GetStringInfo {
+                        command: "deck 1 get_title".into(),
+                        hr: ffi::S_OK,
+                        result: "Track".into(),
+                    },
+                },
+            ],
+        };
+
+        let parsed = Recording::parse(&recording.to_bytes()).unwrap();
+        assert_eq!(parsed, recording);
+        assert_eq!(parsed.blocks(), 2);
+
+        // A truncated tail is ignored
+        let bytes = recording.to_bytes();
+        let cut = Recording::parse(&bytes[..bytes.len() - 3]).unwrap();
+        assert_eq!(cut.records.len(), 5);
+
+        let answers = parsed.answers();
+        let context = answers.context();
+        assert_eq!(context.get_info_double("get_bpm"), Ok(128.0));
+        assert_eq!(context.get_info_double("get_bpm"), Ok(128.0));
+        assert_eq!(
+            context.get_info_string("deck 1 get_title").unwrap(),
+            "Track"
+        );
+        assert!(context.get_info_double("get_key").is_err());
+        assert_eq!(
+            context.get_song_buffer(0, 2).unwrap(),
+            &[100, -100, i16::MAX, i16::MIN]
+        );
+        assert!(context.get_song_buffer(0, 3).is_err());
+    }
+}
@@ -0,0 +1,129 @@
+//! VirtualDJ Rust SDK - Resampler
+//!
+//! Brakes, tape stops, pitch bends and vinyl-style scratches read the song
+//! at a fractional speed that changes every block. [`Resampler`] does this
+//! in the shim with a 32-tap windowed sinc from compile-time polyphase
+//! tables: the read position is kept in fractional frames, the speed ramps
+//! linearly across each block so automation does not step, and the song is
+//! fetched in chunks sized to buffers allocated up front, so processing is
+//! realtime-safe. Above a speed of 1 the filter cutoff drops so the output
+//! does not alias, up to a speed of 2.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // in on_start
+//! self.resampler = Some(Resampler::new(4096)?);
+//! self.resampler.as_mut().unwrap().set_position(song_pos as f64)?;
+//!
+//! // in on_get_song_buffer: slow to a stop over one second
+//! let speed = (self.speed - nb as f32 / sample_rate).max(0.0);
+//! let frames = 2 * nb as usize;
+//! unsafe { resampler.process_song(self.handle, self.speed, speed, &mut self.float_buf[..frames])? };
+//! self.speed = speed;
+//! ```
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// A read head over the song of a buffer DSP plugin
+pub struct Resampler(*mut ffi::VdjResampler);
+
+// SAFETY: the shim object has no thread affinity; &mut self serializes use
+unsafe impl Send for Resampler {}
+
+impl Resampler {
+    /// A resampler for blocks of up to `max_frames`, reading from frame 0.
+    /// Allocates: create it outside the audio thread.
+    pub fn new(max_frames: i32) -> Result<Self> {
+        let resampler = unsafe { ffi::vdj_resampler_create(max_frames) };
+        if resampler.is_null() {
+            return Err(PluginError::Fail);
+        }
+        Ok(Resampler(resampler))
+    }
+
+    /// Move the read position to a fractional song frame
+    pub fn set_position(&mut self, frame: f64) -> Result<()> {
+        match unsafe { ffi::vdj_resampler_set_position(self.0, frame) } {
+            ffi::S_OK => Ok(()),
+            hr => Err(PluginError::from(hr)),
+        }
+    }
+
+    /// The song frame the next output frame is read at
+    pub fn position(&self) -> f64 {
+        unsafe { ffi::vdj_resampler_get_position(self.0) }
+    }
+
+    /// Fill `output` with interleaved stereo frames read at a speed ramping
+    /// from `ratio_start` to `ratio_end`, and advance the position. Negative
+    /// speeds play backwards. Realtime-safe.
+    ///
+    /// # Safety
+    /// `plugin` must be a valid buffer DSP plugin handle.
+    pub unsafe fn process_song(
+        &mut self,
+        plugin: *mut ffi::VdjPluginBufferDsp,
+        ratio_start: f32,
+        ratio_end: f32,
+        output: &mut [f32],
+    ) -> Result<()> {
+        if plugin.is_null() {
+            return Err(PluginError::NullPointer);
+        }
+        let nb = (output.len() / 2) as i32;
+        match ffi::vdj_resampler_process_song(
+            self.0,
+            plugin,
+            ratio_start,
+            ratio_end,
+            output.as_mut_ptr(),
+            nb,
+        ) {
+            ffi::S_OK => Ok(()),
+            hr => Err(PluginError::from(hr)),
+        }
+    }
+}
+
+impl Drop for Resampler {
+    fn drop(&mut self) {
+        unsafe { ffi::vdj_resampler_release(self.0) };
+    }
+}
+
+/// Source frames consumed by `nb` output frames with the speed ramping from
+/// `ratio_start` to `ratio_end`, as [`Resampler::process_song`] advances;
+/// speeds beyond the shim's limit are clamped the same way
+pub fn source_frames(ratio_start: f32, ratio_end: f32, nb: i32) -> f64 {
+    if nb <= 0 {
+        return 0.0;
+    }
+    let clamp = |r: f32| {
+        if r.is_nan() {
+            0.0
+        } else {
+            let max = ffi::VDJ_RESAMPLER_MAX_RATIO as f32;
+            r.clamp(-max, max) as f64
+        }
+    };
+    let (r0, r1) = (clamp(ratio_start), clamp(ratio_end));
+    let nb = nb as f64;
+    nb * r0 + (r1 - r0) * (nb - 1.0) / 2.0
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_source_frames() {
+        assert_eq!(source_frames(1.0, 1.0, 512), 512.0);
+        assert_eq!(source_frames(0.0, 0.0, 512), 0.0);
+        assert_eq!(source_frames(1.0, 0.0, 4), 2.5);
+        assert_eq!(source_frames(-100.0, -100.0, 2), -32.0);
+        assert_eq!(source_frames(f32::NAN, 1.0, 3), 1.0);
+        assert_eq!(source_frames(1.0, 1.0, 0), 0.0);
+    }
+}
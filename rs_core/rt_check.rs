@@ -0,0 +1,288 @@
+//! VirtualDJ Rust SDK - Realtime-Safety Checker
+//!
+//! Audio callbacks must not allocate, lock or make blocking syscalls: any of
+//! them can stall the audio thread for longer than a block lasts. This module
+//! marks code as realtime and catches violations in two ways:
+//!
+//! * [`RtCheckAllocator`], a global allocator for test and CI binaries,
+//!   counts allocations made inside a [`RealtimeScope`] on every platform.
+//!   The stand-in host (`host` module) runs every audio callback in one.
+//! * Shims built with `VDJ_SHIM_RT_CHECK` on Linux interpose malloc, mutex
+//!   locks and blocking syscalls for the whole process while the shim is
+//!   inside an audio entry point ([`enable_shim_checks`]).
+//!
+//! # Example
+//!
+//! ```ignore
+//! #[global_allocator]
+//! static ALLOCATOR: rt_check::RtCheckAllocator = rt_check::RtCheckAllocator;
+//!
+//! let report = StandInHost::new(44100, 512).run_dsp(&mut plugin, &mut buffer)?;
+//! assert!(report.violations.is_clean(), "{:?}", rt_check::first_backtrace());
+//! ```
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::Cell;
+use std::ffi::CString;
+use std::marker::PhantomData;
+use std::sync::atomic::{AtomicU64, AtomicU8, Ordering};
+use std::sync::Mutex;
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Violations counted by [`RtCheckAllocator`]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct RtViolations {
+    pub allocations: u64,
+    pub deallocations: u64,
+    pub reallocations: u64,
+}
+
+impl RtViolations {
+    pub fn total(&self) -> u64 {
+        self.allocations + self.deallocations + self.reallocations
+    }
+
+    pub fn is_clean(&self) -> bool {
+        self.total() == 0
+    }
+
+    /// Violations counted since an earlier snapshot
+    pub fn since(&self, earlier: &RtViolations) -> RtViolations {
+        RtViolations {
+            allocations: self.allocations - earlier.allocations,
+            deallocations: self.deallocations - earlier.deallocations,
+            reallocations: self.reallocations - earlier.reallocations,
+        }
+    }
+}
+
+/// What to do when a violation is detected
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RtCheckMode {
+    /// Count violations only
+    Count,
+    /// Count, and capture a backtrace of the first violation
+    Backtrace,
+    /// Print a backtrace and abort the process (for CI)
+    Abort,
+}
+
+#[derive(Clone, Copy)]
+enum Kind {
+    Allocation,
+    Deallocation,
+    Reallocation,
+}
+
+thread_local! {
+    static REALTIME_DEPTH: Cell<u32> = const { Cell::new(0) };
+    static REPORTING: Cell<bool> = const { Cell::new(false) };
+    static THREAD_VIOLATIONS: Cell<RtViolations> = const {
+        Cell::new(RtViolations {
+            allocations: 0,
+            deallocations: 0,
+            reallocations: 0,
+        })
+    };
+}
+
+static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+static DEALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+static REALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+static MODE: AtomicU8 = AtomicU8::new(0);
+static FIRST_BACKTRACE: Mutex<Option<String>> = Mutex::new(None);
+
+/// Set how violations are reported (counting only by default)
+pub fn set_mode(mode: RtCheckMode) {
+    MODE.store(mode as u8, Ordering::Relaxed);
+}
+
+fn mode() -> RtCheckMode {
+    match MODE.load(Ordering::Relaxed) {
+        1 => RtCheckMode::Backtrace,
+        2 => RtCheckMode::Abort,
+        _ => RtCheckMode::Count,
+    }
+}
+
+/// Marks the current thread as running a realtime callback until dropped
+///
+/// Scopes nest. The guard is tied to its thread (not `Send`).
+pub struct RealtimeScope {
+    _not_send: PhantomData<*const ()>,
+}
+
+impl RealtimeScope {
+    pub fn enter() -> Self {
+        REALTIME_DEPTH.with(|d| d.set(d.get() + 1));
+        RealtimeScope {
+            _not_send: PhantomData,
+        }
+    }
+}
+
+impl Drop for RealtimeScope {
+    fn drop(&mut self) {
+        REALTIME_DEPTH.with(|d| d.set(d.get().saturating_sub(1)));
+    }
+}
+
+/// True while the current thread is inside a [`RealtimeScope`]
+pub fn is_realtime() -> bool {
+    REALTIME_DEPTH.try_with(|d| d.get() > 0).unwrap_or(false)
+}
+
+/// Violations counted on all threads since the last [`reset`]
+pub fn violations() -> RtViolations {
+    RtViolations {
+        allocations: ALLOCATIONS.load(Ordering::Relaxed),
+        deallocations: DEALLOCATIONS.load(Ordering::Relaxed),
+        reallocations: REALLOCATIONS.load(Ordering::Relaxed),
+    }
+}
+
+/// Violations counted on the current thread (never reset)
+pub fn thread_violations() -> RtViolations {
+    THREAD_VIOLATIONS.try_with(|v| v.get()).unwrap_or_default()
+}
+
+/// Clear the global counters and the captured backtrace
+pub fn reset() {
+    ALLOCATIONS.store(0, Ordering::Relaxed);
+    DEALLOCATIONS.store(0, Ordering::Relaxed);
+    REALLOCATIONS.store(0, Ordering::Relaxed);
+    if let Ok(mut bt) = FIRST_BACKTRACE.lock() {
+        *bt = None;
+    }
+}
+
+/// Backtrace of the first violation, in [`RtCheckMode::Backtrace`]
+pub fn first_backtrace() -> Option<String> {
+    FIRST_BACKTRACE.lock().ok().and_then(|bt| bt.clone())
+}
+
+fn record(kind: Kind) {
+    if !is_realtime() {
+        return;
+    }
+    // Reporting allocates (backtraces, strings); those allocations pass through
+    if REPORTING.try_with(|r| r.replace(true)).unwrap_or(true) {
+        return;
+    }
+
+    let _ = THREAD_VIOLATIONS.try_with(|v| {
+        let mut counts = v.get();
+        match kind {
+            Kind::Allocation => counts.allocations += 1,
+            Kind::Deallocation => counts.deallocations += 1,
+            Kind::Reallocation => counts.reallocations += 1,
+        }
+        v.set(counts);
+    });
+    let counter = match kind {
+        Kind::Allocation => &ALLOCATIONS,
+        Kind::Deallocation => &DEALLOCATIONS,
+        Kind::Reallocation => &REALLOCATIONS,
+    };
+    counter.fetch_add(1, Ordering::Relaxed);
+
+    match mode() {
+        RtCheckMode::Count => {}
+        RtCheckMode::Backtrace => {
+            if let Ok(mut bt) = FIRST_BACKTRACE.lock() {
+                if bt.is_none() {
+                    *bt = Some(std::backtrace::Backtrace::force_capture().to_string());
+                }
+            }
+        }
+        RtCheckMode::Abort => {
+            eprintln!(
+                "realtime violation: allocator called inside a realtime callback\n{}",
+                std::backtrace::Backtrace::force_capture()
+            );
+            std::process::abort();
+        }
+    }
+
+    let _ = REPORTING.try_with(|r| r.set(false));
+}
+
+/// Global allocator counting allocations made in realtime scopes
+///
+/// Wraps the system allocator; outside realtime scopes it only adds a
+/// thread-local check. Install it in test or CI binaries, not in plugins.
+pub struct RtCheckAllocator;
+
+unsafe impl GlobalAlloc for RtCheckAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        record(Kind::Allocation);
+        System.alloc(layout)
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        record(Kind::Allocation);
+        System.alloc_zeroed(layout)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        record(Kind::Deallocation);
+        System.dealloc(ptr, layout)
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        record(Kind::Reallocation);
+        System.realloc(ptr, layout, new_size)
+    }
+}
+
+/* ============================================================================
+Shim Checker
+============================================================================ */
+
+/// Enable the shim's process-wide checker
+///
+/// Returns `true` when the shim was built with `VDJ_SHIM_RT_CHECK` hooks,
+/// `false` when it only counts explicitly reported violations.
+///
+/// # Arguments
+/// * `flags` - `VDJ_RT_CHECK_ABORT` and/or `VDJ_RT_CHECK_BACKTRACE`
+pub fn enable_shim_checks(flags: u32) -> Result<bool> {
+    match unsafe { ffi::vdj_plugin_rt_check_enable(1, flags) } {
+        ffi::S_OK => Ok(true),
+        ffi::S_FALSE => Ok(false),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Disable the shim's checker
+pub fn disable_shim_checks() {
+    unsafe {
+        ffi::vdj_plugin_rt_check_enable(0, 0);
+    }
+}
+
+/// Violation counts of the shim's checker, indexed by `VDJ_RT_VIOLATION_*`
+pub fn shim_violations() -> ffi::VdjRtViolations {
+    let mut violations = ffi::VdjRtViolations::default();
+    unsafe {
+        ffi::vdj_plugin_rt_check_get_violations(&mut violations);
+    }
+    violations
+}
+
+/// Write the shim's counts and backtraces to a file, or stderr for `None`
+pub fn dump_shim_report(path: Option<&str>) -> Result<()> {
+    let c_path = match path {
+        Some(p) => Some(CString::new(p).map_err(|_| PluginError::Fail)?),
+        None => None,
+    };
+    let ptr = c_path
+        .as_ref()
+        .map_or(std::ptr::null(), |p| p.as_ptr() as *const u8);
+    match unsafe { ffi::vdj_plugin_rt_check_dump(ptr) } {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
@@ -0,0 +1,196 @@
+//! VirtualDJ Rust SDK - Realtime-Safe Logger
+//!
+//! `println!` locks stdout and can block a callback for as long as the
+//! terminal or pipe takes to drain. This logger only copies a format ID and a
+//! few numbers into a per-thread ring in the shim; a background thread does
+//! the formatting and the I/O. When a ring is full the record is dropped and
+//! counted, never waited for.
+//!
+//! Format strings are printf-style and carry numbers only (`%d`, `%u`, `%x`,
+//! `%c`, `%f`, `%e`, `%g`, with flags, width and precision). Register them
+//! while loading, since registration allocates.
+//!
+//! # Example
+//!
+//! ```ignore
+//! use virtualdj_plugin_sdk::rt_log::{self, LogFormat, LogLevel};
+//!
+//! // in on_load
+//! self.clip_format = LogFormat::register("clipped %d frames, peak %.2f")?;
+//!
+//! // in on_process_samples
+//! rt_log!(LogLevel::Warn, self.clip_format, clipped, peak);
+//! ```
+
+use std::ffi::CString;
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Severity of a record
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord)]
+#[repr(i32)]
+pub enum LogLevel {
+    Error = ffi::VDJ_LOG_ERROR,
+    Warn = ffi::VDJ_LOG_WARN,
+    Info = ffi::VDJ_LOG_INFO,
+    Debug = ffi::VDJ_LOG_DEBUG,
+    Trace = ffi::VDJ_LOG_TRACE,
+}
+
+/// Maximum number of arguments of one record
+pub const MAX_ARGS: usize = ffi::VDJ_LOG_MAX_ARGS;
+
+/// A registered format string
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct LogFormat(i32);
+
+impl LogFormat {
+    /// Register a format string with the shim
+    ///
+    /// Registering the same string again returns the same format, so every
+    /// instance of a plugin can register its formats in `on_load`. Fails for
+    /// `%s`, `%p`, `%n`, `*` widths and formats with more than [`MAX_ARGS`]
+    /// conversions.
+    pub fn register(format: &str) -> Result<Self> {
+        let c_format = CString::new(format).map_err(|_| PluginError::Fail)?;
+        match unsafe { ffi::vdj_plugin_log_register_format(c_format.as_ptr() as *const u8) } {
+            id if id >= 0 => Ok(LogFormat(id)),
+            _ => Err(PluginError::Fail),
+        }
+    }
+
+    /// ID of the format in the shim's table
+    pub fn id(&self) -> i32 {
+        self.0
+    }
+}
+
+/// One numeric record argument
+pub type LogArg = ffi::VdjLogArg;
+
+macro_rules! log_arg_from_int {
+    ($($t:ty),*) => {
+        $(impl From<$t> for LogArg {
+            fn from(v: $t) -> Self {
+                LogArg { i: v as i64 }
+            }
+        })*
+    };
+}
+
+log_arg_from_int!(i8, i16, i32, i64, isize, u8, u16, u32, u64, usize);
+
+impl From<bool> for LogArg {
+    fn from(v: bool) -> Self {
+        LogArg { i: v as i64 }
+    }
+}
+
+impl From<f32> for LogArg {
+    fn from(v: f32) -> Self {
+        LogArg { f: v as f64 }
+    }
+}
+
+impl From<f64> for LogArg {
+    fn from(v: f64) -> Self {
+        LogArg { f: v }
+    }
+}
+
+/// Start the background writer
+///
+/// # Arguments
+/// * `path` - File to append to, or `None` for stderr
+/// * `max_level` - Most verbose level written; others are filtered out
+///   before they reach a ring
+pub fn open(path: Option<&str>, max_level: LogLevel) -> Result<()> {
+    let c_path = match path {
+        Some(p) => Some(CString::new(p).map_err(|_| PluginError::Fail)?),
+        None => None,
+    };
+    let ptr = c_path
+        .as_ref()
+        .map_or(std::ptr::null(), |p| p.as_ptr() as *const u8);
+    match unsafe { ffi::vdj_plugin_log_open(ptr, max_level as i32) } {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Write the queued records and stop the background writer
+pub fn close() -> Result<()> {
+    match unsafe { ffi::vdj_plugin_log_close() } {
+        ffi::S_OK | ffi::S_FALSE => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Queue a record; wait-free and safe on the audio thread
+///
+/// Returns false when the record was not queued: the logger is closed, the
+/// level is filtered out or the thread's ring is full. Prefer the [`rt_log!`]
+/// macro, which converts the arguments.
+///
+/// [`rt_log!`]: crate::rt_log!
+pub fn write(level: LogLevel, format: LogFormat, args: &[LogArg]) -> bool {
+    let count = args.len().min(MAX_ARGS) as i32;
+    unsafe { ffi::vdj_plugin_log_write(level as i32, format.0, args.as_ptr(), count) == ffi::S_OK }
+}
+
+/// Records dropped since the logger opened because a ring was full
+pub fn dropped_records() -> u64 {
+    unsafe { ffi::vdj_plugin_log_dropped_records() }
+}
+
+/// An open logger, closed when dropped
+pub struct LogSession {
+    _private: (),
+}
+
+impl LogSession {
+    pub fn open(path: Option<&str>, max_level: LogLevel) -> Result<Self> {
+        open(path, max_level)?;
+        Ok(LogSession { _private: () })
+    }
+}
+
+impl Drop for LogSession {
+    fn drop(&mut self) {
+        let _ = close();
+    }
+}
+
+/// Queue a log record from any thread without blocking
+///
+/// ```ignore
+/// rt_log!(LogLevel::Info, self.block_format, nb, self.gain);
+/// ```
+#[macro_export]
+macro_rules! rt_log {
+    ($level:expr, $format:expr $(, $arg:expr)* $(,)?) => {
+        $crate::rt_log::write(
+            $level,
+            $format,
+            &[$($crate::rt_log::LogArg::from($arg)),*],
+        )
+    };
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_log_arg_conversions() {
+        unsafe {
+            assert_eq!(LogArg::from(-3i32).i, -3);
+            assert_eq!(LogArg::from(u32::MAX).i, u32::MAX as i64);
+            assert_eq!(LogArg::from(true).i, 1);
+            assert_eq!(LogArg::from(0.5f32).f, 0.5);
+            assert_eq!(LogArg::from(1e300f64).f, 1e300);
+        }
+        assert!(LogLevel::Error < LogLevel::Trace);
+    }
+}
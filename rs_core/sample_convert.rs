@@ -0,0 +1,109 @@
+//! VirtualDJ Rust SDK - Sample Conversion
+//!
+//! Buffer DSP plugins read and return 16-bit stereo buffers but are easier
+//! to write in float. These helpers run the shim's vectorized conversions:
+//! int16 to float, and float to int16 with rounding, saturation and
+//! optional TPDF dither, at close to memory bandwidth instead of a scalar
+//! loop per sample. [`song_buffer_float`] fetches and converts a song
+//! buffer in one call.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // in on_get_song_buffer
+//! let frames = nb as usize;
+//! unsafe { sample_convert::song_buffer_float(self.handle, song_pos, nb, &mut self.float_buf[..2 * frames])? };
+//! self.process(&mut self.float_buf[..2 * frames]);
+//! sample_convert::float_to_int16(&self.float_buf[..2 * frames], &mut self.pcm_buf[..2 * frames], Some(&mut self.dither))?;
+//! Some(&self.pcm_buf[..2 * frames])
+//! ```
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// TPDF dither generator state; keep one per plugin instance
+#[derive(Debug, Clone)]
+pub struct Dither(ffi::VdjDither);
+
+impl Dither {
+    /// A generator seeded with `seed`; give each instance its own so decks
+    /// do not dither in lockstep
+    pub fn new(seed: u32) -> Result<Self> {
+        let mut dither = ffi::VdjDither::default();
+        match unsafe { ffi::vdj_dither_init(&mut dither, seed) } {
+            ffi::S_OK => Ok(Dither(dither)),
+            hr => Err(PluginError::from(hr)),
+        }
+    }
+}
+
+/// Interleaved samples in `nb` stereo frames
+fn stereo_samples(nb: i32) -> Option<usize> {
+    usize::try_from(nb).ok()?.checked_mul(2)
+}
+
+fn check(hr: ffi::HRESULT) -> Result<()> {
+    match hr {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Samples scaled by 1/32768; stops at the shorter slice. Realtime-safe.
+pub fn int16_to_float(input: &[i16], output: &mut [f32]) -> Result<()> {
+    let count = input.len().min(output.len()) as i32;
+    check(unsafe { ffi::vdj_convert_int16_to_float(input.as_ptr(), output.as_mut_ptr(), count) })
+}
+
+/// Samples scaled by 32768, rounded and saturated, with +-1 LSB triangular
+/// dither when `dither` is given; NaN gives 0. Stops at the shorter slice.
+/// Realtime-safe.
+pub fn float_to_int16(
+    input: &[f32],
+    output: &mut [i16],
+    dither: Option<&mut Dither>,
+) -> Result<()> {
+    let count = input.len().min(output.len()) as i32;
+    let dither = dither.map_or(std::ptr::null_mut(), |d| &mut d.0 as *mut ffi::VdjDither);
+    check(unsafe {
+        ffi::vdj_convert_float_to_int16(input.as_ptr(), output.as_mut_ptr(), count, dither)
+    })
+}
+
+/// The song buffer of `nb` stereo frames at `pos`, converted to float into
+/// the first `2 * nb` values of `output`. Realtime-safe.
+///
+/// # Safety
+/// `plugin` must be a valid buffer DSP plugin handle.
+pub unsafe fn song_buffer_float(
+    plugin: *mut ffi::VdjPluginBufferDsp,
+    pos: i32,
+    nb: i32,
+    output: &mut [f32],
+) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match stereo_samples(nb) {
+        Some(samples) if samples <= output.len() => {}
+        _ => return Err(PluginError::Fail),
+    }
+    check(ffi::vdj_plugin_buffer_dsp_get_song_buffer_float(
+        plugin,
+        pos,
+        nb,
+        output.as_mut_ptr(),
+    ))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_stereo_samples() {
+        assert_eq!(stereo_samples(0), Some(0));
+        assert_eq!(stereo_samples(512), Some(1024));
+        assert_eq!(stereo_samples(-1), None);
+    }
+}
@@ -0,0 +1,209 @@
+//! VirtualDJ Rust SDK - Scratch Arena
+//!
+//! Temporary buffers for one audio or render callback, without the global
+//! allocator. The shim gives every instance a bump-pointer arena: an
+//! allocation is an offset increment, and the whole arena is rewound when
+//! `on_process_samples` (or `on_draw` for video plugins) returns.
+//!
+//! The arena starts empty and grows off the audio thread, to the largest
+//! amount any callback asked for, whenever the host starts the effect or
+//! changes a parameter. Requests that do not fit return `None` but are
+//! counted, so reserve the expected size up front to serve the first blocks:
+//!
+//! ```ignore
+//! // when loading
+//! unsafe { scratch::reserve_scratch(handle, 64 * 1024)? };
+//!
+//! // in on_process_samples
+//! let scratch = unsafe { scratch::scratch(handle)? };
+//! let dry = scratch.alloc_copy(buffer).ok_or(PluginError::Fail)?;
+//! let wet = scratch.alloc::<f32>(buffer.len()).ok_or(PluginError::Fail)?;
+//! ```
+//!
+//! All functions take a generic plugin handle: cast DSP, video and other
+//! handles with `handle as *mut ffi::VdjPlugin`.
+
+use std::marker::PhantomData;
+use std::mem::{align_of, size_of};
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Allocator over the instance's arena for the current callback
+///
+/// Slices handed out stay valid for `'a`, which must end before the callback
+/// returns. Not `Send`: the arena belongs to the callback's thread.
+#[derive(Debug)]
+pub struct Scratch<'a> {
+    arena: *mut ffi::VdjScratchArena,
+    _callback: PhantomData<&'a mut [u8]>,
+}
+
+impl<'a> Scratch<'a> {
+    /// Allocate from an arena directly
+    ///
+    /// # Safety
+    /// `arena` must point to a valid arena whose memory is not otherwise used
+    /// during `'a`, and must not be rewound during `'a`.
+    pub unsafe fn from_raw(arena: *mut ffi::VdjScratchArena) -> Self {
+        Scratch {
+            arena,
+            _callback: PhantomData,
+        }
+    }
+
+    /// Bytes handed out in this callback
+    pub fn used(&self) -> usize {
+        unsafe { (*self.arena).used as usize }
+    }
+
+    /// Bytes still free
+    pub fn remaining(&self) -> usize {
+        let arena = unsafe { &*self.arena };
+        arena.capacity.saturating_sub(arena.used) as usize
+    }
+
+    /// `count` values set to `T::default()`, or `None` when the arena is too
+    /// small; the request still counts towards the size it grows to
+    pub fn alloc<T: Copy + Default>(&self, count: usize) -> Option<&'a mut [T]> {
+        let values = self.alloc_uninit::<T>(count)?;
+        // SAFETY: alloc_uninit returns `count` writable, aligned values
+        unsafe {
+            for i in 0..count {
+                values.add(i).write(T::default());
+            }
+            Some(std::slice::from_raw_parts_mut(values, count))
+        }
+    }
+
+    /// A copy of `values`, or `None` when the arena is too small
+    pub fn alloc_copy<T: Copy>(&self, values: &[T]) -> Option<&'a mut [T]> {
+        let copy = self.alloc_uninit::<T>(values.len())?;
+        // SAFETY: the new allocation cannot overlap `values`
+        unsafe {
+            std::ptr::copy_nonoverlapping(values.as_ptr(), copy, values.len());
+            Some(std::slice::from_raw_parts_mut(copy, values.len()))
+        }
+    }
+
+    fn alloc_uninit<T>(&self, count: usize) -> Option<*mut T> {
+        assert!(align_of::<T>() <= ffi::VDJ_SCRATCH_ALIGN);
+        let bytes = count
+            .checked_mul(size_of::<T>())?
+            .checked_add(ffi::VDJ_SCRATCH_ALIGN - 1)?
+            & !(ffi::VDJ_SCRATCH_ALIGN - 1);
+
+        // SAFETY: the arena is valid for 'a and only this thread touches it
+        let arena = unsafe { &mut *self.arena };
+        arena.demand = arena.demand.saturating_add(bytes as u64);
+        if arena.base.is_null() || arena.capacity - arena.used < bytes as u64 {
+            return None;
+        }
+        // Every allocation is a multiple of VDJ_SCRATCH_ALIGN from an aligned
+        // base, so the offset needs no padding
+        let values = unsafe { arena.base.add(arena.used as usize) } as *mut T;
+        arena.used += bytes as u64;
+        Some(values)
+    }
+}
+
+/// The instance's arena, for the callback running now
+///
+/// Call it in `on_process_samples` of DSP and position plugins, or `on_draw`
+/// of video plugins.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type, the call must be made
+/// from that callback, and nothing allocated may be used after it returns.
+pub unsafe fn scratch<'a>(plugin: *mut ffi::VdjPlugin) -> Result<Scratch<'a>> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    let arena = ffi::vdj_plugin_get_scratch(plugin);
+    if arena.is_null() {
+        return Err(PluginError::Fail);
+    }
+    Ok(Scratch::from_raw(arena))
+}
+
+/// Grow the arena to hold at least `bytes` per callback
+///
+/// The memory is allocated and pre-faulted on the calling thread and taken
+/// by the audio thread when its next callback returns. Call it when loading,
+/// or from any non-realtime thread. Fails when `bytes` exceeds
+/// [`ffi::VDJ_SCRATCH_MAX_BYTES`].
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn reserve_scratch(plugin: *mut ffi::VdjPlugin, bytes: usize) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_reserve_scratch(plugin, bytes as u64) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[repr(align(64))]
+    struct Memory([u8; 256]);
+
+    fn arena(memory: &mut Memory) -> ffi::VdjScratchArena {
+        ffi::VdjScratchArena {
+            base: memory.0.as_mut_ptr(),
+            capacity: memory.0.len() as u64,
+            used: 0,
+            demand: 0,
+        }
+    }
+
+    #[test]
+    fn test_alloc_bumps_and_aligns() {
+        let mut memory = Memory([0xff; 256]);
+        let mut raw = arena(&mut memory);
+        let scratch = unsafe { Scratch::from_raw(&mut raw) };
+
+        let a = scratch.alloc::<f32>(3).unwrap();
+        let b = scratch.alloc_copy(&[1i16, 2, 3]).unwrap();
+        assert_eq!(a, &[0.0; 3]);
+        assert_eq!(b, &[1, 2, 3]);
+        assert_eq!(b.as_ptr() as usize - a.as_ptr() as usize, 16);
+        assert_eq!(b.as_ptr() as usize % ffi::VDJ_SCRATCH_ALIGN, 0);
+        a[2] = 1.0;
+        b[0] = -1;
+        assert_eq!(scratch.used(), 32);
+        assert_eq!(scratch.remaining(), 224);
+    }
+
+    #[test]
+    fn test_overflow_counts_demand() {
+        let mut memory = Memory([0; 256]);
+        let mut raw = arena(&mut memory);
+        {
+            let scratch = unsafe { Scratch::from_raw(&mut raw) };
+            assert!(scratch.alloc::<f64>(16).is_some());
+            assert!(scratch.alloc::<f64>(32).is_none());
+            assert!(scratch.alloc::<u8>(usize::MAX).is_none());
+            // A failed request leaves the arena usable for smaller ones
+            assert!(scratch.alloc::<f64>(16).is_some());
+        }
+        assert_eq!(raw.used, 256);
+        assert_eq!(raw.demand, 128 + 256 + 128);
+
+        let mut empty = ffi::VdjScratchArena {
+            base: std::ptr::null_mut(),
+            capacity: 0,
+            used: 0,
+            demand: 0,
+        };
+        {
+            let scratch = unsafe { Scratch::from_raw(&mut empty) };
+            assert!(scratch.alloc::<f32>(1).is_none());
+        }
+        assert_eq!(empty.demand, 16);
+    }
+}
@@ -0,0 +1,166 @@
+//! VirtualDJ Rust SDK - Shared Parameter Blobs
+//!
+//! Custom parameters that carry large payloads (wavetables, step patterns,
+//! sample slices) would otherwise be copied into every instance. The shim
+//! keeps them in a process-wide store instead, addressed by content and
+//! reference-counted: an instance publishing a payload that another one
+//! already holds shares it, and [`edit_shared_blob`] copies the payload
+//! before changing it, so the other instances never see the write. Loading
+//! the same heavy effect on four decks costs the wavetable once.
+//!
+//! The audio thread reads its payload with [`shared_blob`], which does not
+//! lock: a newly published payload is swapped in at the start of the next
+//! block and the one it replaces is released off the audio thread.
+//!
+//! ```ignore
+//! // in on_parameter, for the DeclareParameterCustom buffer
+//! unsafe { shared_blob::set_shared_blob(handle, WAVETABLE, &self.wavetable_param)? };
+//!
+//! // in on_process_samples
+//! let table = unsafe { shared_blob::shared_blob(handle, WAVETABLE) }
+//!     .and_then(shared_blob::as_f32)
+//!     .unwrap_or(&[]);
+//! ```
+//!
+//! All functions take a generic plugin handle: cast DSP, video and other
+//! handles with `handle as *mut ffi::VdjPlugin`.
+
+use std::ffi::c_void;
+use std::mem::{align_of, size_of};
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Process-wide statistics of the shared payloads
+pub type SharedBlobStats = ffi::VdjSharedBlobStats;
+
+impl SharedBlobStats {
+    /// Bytes the payloads would take if every instance held its own copy
+    pub fn unshared_bytes(&self) -> u64 {
+        self.bytes + self.shared_bytes
+    }
+}
+
+/// A payload viewed as `f32` values, or `None` when its length or alignment
+/// does not allow it. Payloads from [`shared_blob`] are cache-line aligned.
+pub fn as_f32(bytes: &[u8]) -> Option<&[f32]> {
+    if bytes.is_empty() {
+        return Some(&[]);
+    }
+    if bytes.len() % size_of::<f32>() != 0 || bytes.as_ptr() as usize % align_of::<f32>() != 0 {
+        return None;
+    }
+    // SAFETY: length and alignment checked above; every bit pattern is a valid f32
+    Some(unsafe {
+        std::slice::from_raw_parts(bytes.as_ptr() as *const f32, bytes.len() / size_of::<f32>())
+    })
+}
+
+/// Publish `data` as the payload of parameter `id`
+///
+/// The bytes are hashed and copied, or shared with an identical payload the
+/// process already holds; the instance sees the new payload from its next
+/// block. Call from a non-realtime thread.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn set_shared_blob(plugin: *mut ffi::VdjPlugin, id: i32, data: &[u8]) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_set_shared_blob(
+        plugin,
+        id,
+        data.as_ptr() as *const c_void,
+        data.len() as u64,
+    ) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Replace `data.len()` bytes at `offset` in the newest payload of `id`
+///
+/// Copies the payload first, so instances sharing it are not affected. Call
+/// from a non-realtime thread.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type.
+pub unsafe fn edit_shared_blob(
+    plugin: *mut ffi::VdjPlugin,
+    id: i32,
+    offset: usize,
+    data: &[u8],
+) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_edit_shared_blob(
+        plugin,
+        id,
+        offset as u64,
+        data.as_ptr() as *const c_void,
+        data.len() as u64,
+    ) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// The payload of `id` for the current callback, if one was swapped in.
+/// Realtime-safe.
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type, called from its audio
+/// or render callbacks, and the payload must not be used after the callback
+/// returns.
+pub unsafe fn shared_blob<'a>(plugin: *mut ffi::VdjPlugin, id: i32) -> Option<&'a [u8]> {
+    if plugin.is_null() {
+        return None;
+    }
+    let mut data: *const c_void = std::ptr::null();
+    let mut size = 0u64;
+    match ffi::vdj_plugin_get_shared_blob(plugin, id, &mut data, &mut size) {
+        ffi::S_OK if size == 0 => Some(&[]),
+        ffi::S_OK if !data.is_null() => {
+            Some(std::slice::from_raw_parts(data as *const u8, size as usize))
+        }
+        _ => None,
+    }
+}
+
+/// Statistics of the payloads held by every instance in the process
+pub fn shared_blob_stats() -> Result<SharedBlobStats> {
+    let mut stats = SharedBlobStats::default();
+    match unsafe { ffi::vdj_plugin_get_shared_blob_stats(&mut stats) } {
+        ffi::S_OK => Ok(stats),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_as_f32_checks_length_and_alignment() {
+        let values = [1.0f32, -2.5, 3.25];
+        let bytes = unsafe { std::slice::from_raw_parts(values.as_ptr() as *const u8, 12) };
+        assert_eq!(as_f32(bytes), Some(&values[..]));
+        assert_eq!(as_f32(&bytes[..8]), Some(&values[..2]));
+        assert_eq!(as_f32(&bytes[..7]), None);
+        assert_eq!(as_f32(&bytes[1..9]), None);
+        assert_eq!(as_f32(&[]), Some(&[][..]));
+    }
+
+    #[test]
+    fn test_unshared_bytes() {
+        let stats = SharedBlobStats {
+            blobs: 1,
+            bytes: 4096,
+            references: 4,
+            shared_bytes: 3 * 4096,
+        };
+        assert_eq!(stats.unshared_bytes(), 4 * 4096);
+    }
+}
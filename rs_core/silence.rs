@@ -0,0 +1,87 @@
+//! VirtualDJ Rust SDK - Silence Bypass
+//!
+//! Effects on idle decks otherwise keep processing blocks of zeros. With the
+//! bypass enabled the shim checks every `OnProcessSamples` block for silence
+//! and stops running the plugin once its tail has rung out, waking on the
+//! first block that carries signal.
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Peak below which a sample counts as silent (about -100 dBFS, matches the shim)
+pub const SILENCE_THRESHOLD: f32 = 1e-5;
+
+/// Enable the silence bypass of a DSP plugin
+///
+/// # Arguments
+/// * `silent_blocks` - Consecutive silent blocks before bypassing (0 disables)
+/// * `tail_ms` - Length of the plugin's tail (reverb, delay feedback) that must
+///   ring out after the last signal
+/// * `plugin_flags` - The `VDJFLAG_*` flags reported in the plugin info;
+///   `VDJFLAG_PROCESSAFTERSTOP` plugins return `E_FAIL` while bypassed so the
+///   host stops calling them
+///
+/// # Safety
+/// `plugin` must be a valid handle returned by `vdj_plugin_dsp_create`.
+pub unsafe fn set_silence_bypass(
+    plugin: *mut ffi::VdjPluginDsp,
+    silent_blocks: i32,
+    tail_ms: f32,
+    plugin_flags: u32,
+) -> Result<()> {
+    if plugin.is_null() {
+        return Err(PluginError::NullPointer);
+    }
+    match ffi::vdj_plugin_dsp_set_silence_bypass(plugin, silent_blocks, tail_ms, plugin_flags) {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// True while the plugin is bypassed for silence
+///
+/// # Safety
+/// `plugin` must be a valid handle returned by `vdj_plugin_dsp_create`.
+pub unsafe fn is_idle(plugin: *mut ffi::VdjPluginDsp) -> bool {
+    !plugin.is_null() && ffi::vdj_plugin_dsp_is_idle(plugin) != 0
+}
+
+/// True when every sample is below [`SILENCE_THRESHOLD`]
+///
+/// For buffers the shim does not see, such as the output of
+/// `get_song_buffer` in buffer DSP plugins.
+pub fn is_silent(samples: &[f32]) -> bool {
+    // Fixed-size chunks reduce to a branch-free max the compiler vectorizes
+    let mut chunks = samples.chunks_exact(16);
+    for chunk in &mut chunks {
+        let peak = chunk.iter().fold(0.0f32, |m, s| m.max(s.abs()));
+        if peak > SILENCE_THRESHOLD {
+            return false;
+        }
+    }
+    chunks
+        .remainder()
+        .iter()
+        .all(|s| s.abs() <= SILENCE_THRESHOLD)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_is_silent() {
+        let mut samples = vec![0.0f32; 37];
+        assert!(is_silent(&samples));
+
+        samples[3] = 2e-6;
+        assert!(is_silent(&samples));
+
+        samples[36] = -0.01;
+        assert!(!is_silent(&samples));
+
+        samples[36] = 0.0;
+        samples[20] = 0.5;
+        assert!(!is_silent(&samples));
+    }
+}
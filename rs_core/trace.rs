@@ -0,0 +1,72 @@
+//! VirtualDJ Rust SDK - Callback Trace Recorder
+//!
+//! Records a timeline of every plugin entry point call (audio, render and UI
+//! callbacks of all instances in the process) as Chrome trace JSON, to see
+//! where callbacks interleave and collide. Open the file in
+//! `chrome://tracing` or <https://ui.perfetto.dev>.
+//!
+//! # Example
+//!
+//! ```ignore
+//! let session = trace::TraceSession::start("/tmp/vdj_trace.json")?;
+//! // ... run the set ...
+//! drop(session); // flushes and closes the file
+//! ```
+
+use std::ffi::CString;
+
+use crate::ffi;
+use crate::{PluginError, Result};
+
+/// Start recording spans to a Chrome trace JSON file
+///
+/// Fails if a trace is already running in this process.
+pub fn start_trace(path: &str) -> Result<()> {
+    let c_path = CString::new(path).map_err(|_| PluginError::Fail)?;
+    match unsafe { ffi::vdj_plugin_trace_start(c_path.as_ptr() as *const u8) } {
+        ffi::S_OK => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Stop recording and close the trace file
+pub fn stop_trace() -> Result<()> {
+    match unsafe { ffi::vdj_plugin_trace_stop() } {
+        ffi::S_OK | ffi::S_FALSE => Ok(()),
+        hr => Err(PluginError::from(hr)),
+    }
+}
+
+/// Spans dropped because a callback thread's ring was full
+pub fn dropped_spans() -> u64 {
+    unsafe { ffi::vdj_plugin_trace_dropped_spans() }
+}
+
+/// Process-unique ID of a plugin instance, as shown in the trace
+///
+/// # Safety
+/// `plugin` must be a valid plugin handle of any type, cast to `VdjPlugin`.
+pub unsafe fn instance_id(plugin: *mut ffi::VdjPlugin) -> u32 {
+    if plugin.is_null() {
+        return 0;
+    }
+    ffi::vdj_plugin_get_instance_id(plugin)
+}
+
+/// A running trace, stopped when dropped
+pub struct TraceSession {
+    _private: (),
+}
+
+impl TraceSession {
+    pub fn start(path: &str) -> Result<Self> {
+        start_trace(path)?;
+        Ok(TraceSession { _private: () })
+    }
+}
+
+impl Drop for TraceSession {
+    fn drop(&mut self) {
+        let _ = stop_trace();
+    }
+}
@@ -67,3 +67,51 @@ fn test_result_type() {
     let failure: Result<i32> = Err(PluginError::Fail);
     assert!(failure.is_err());
 }
+
+#[test]
+fn test_abi_struct_layouts() {
+    // Structs shared with the shim by pointer or read from files in place;
+    // each size must match its C definition in abi/vdj_plugin_abi.h
+    use std::mem::{align_of, size_of};
+    let ptr = size_of::<*const f32>();
+    let layouts: &[(&str, usize, usize)] = &[
+        ("VdjBeatEvent", size_of::<ffi::VdjBeatEvent>(), 16),
+        ("VdjParamRamp", size_of::<ffi::VdjParamRamp>(), if ptr == 8 { 24 } else { 16 }),
+        ("VdjPatternStep", size_of::<ffi::VdjPatternStep>(), 24),
+        ("VdjLatencyStats", size_of::<ffi::VdjLatencyStats>(), 72),
+        ("VdjLogArg", size_of::<ffi::VdjLogArg>(), 8),
+        ("VdjCommandStats", size_of::<ffi::VdjCommandStats>(), 48),
+        ("VdjMemoryStats", size_of::<ffi::VdjMemoryStats>(), 32),
+        ("VdjScratchArena", size_of::<ffi::VdjScratchArena>(), 32),
+        ("VdjSnapshotHeader", size_of::<ffi::VdjSnapshotHeader>(), 40),
+        ("VdjSnapshotParam", size_of::<ffi::VdjSnapshotParam>(), 16),
+        ("VdjMorphChanges", size_of::<ffi::VdjMorphChanges>(), 16),
+        ("VdjSharedBlobStats", size_of::<ffi::VdjSharedBlobStats>(), 32),
+        ("VdjLut", size_of::<ffi::VdjLut>(), 24),
+        ("VdjMathInfo", size_of::<ffi::VdjMathInfo>(), 8),
+        ("VdjDither", size_of::<ffi::VdjDither>(), 32),
+        ("VdjReplayFileHeader", size_of::<ffi::VdjReplayFileHeader>(), 16),
+        ("VdjReplayRecordHeader", size_of::<ffi::VdjReplayRecordHeader>(), 16),
+        ("VdjReplayParameter", size_of::<ffi::VdjReplayParameter>(), 16),
+        ("VdjReplayBlock", size_of::<ffi::VdjReplayBlock>(), 24),
+        ("VdjReplayPosition", size_of::<ffi::VdjReplayPosition>(), 40),
+        ("VdjReplayQuery", size_of::<ffi::VdjReplayQuery>(), 24),
+        ("VdjReplaySongAudio", size_of::<ffi::VdjReplaySongAudio>(), 16),
+    ];
+    for &(name, size, expected) in layouts {
+        assert_eq!(size, expected, "size of {}", name);
+    }
+    assert_eq!(align_of::<ffi::VdjBeatEvent>(), 8);
+    assert_eq!(align_of::<ffi::VdjPatternStep>(), 8);
+}
+
+#[test]
+fn test_abi_constants() {
+    // Constants the shim sizes its tables and arenas with
+    assert_eq!(ffi::VDJ_BEAT_EVENT_BAR, 0x4);
+    assert_eq!(ffi::VDJ_RAMP_ONEPOLE, 2);
+    assert_eq!(ffi::VDJ_PROFILE_CALLBACK_COUNT, 11);
+    assert_eq!(ffi::VDJ_LOG_MAX_ARGS, 6);
+    assert_eq!(ffi::VDJ_CACHE_LINE_SIZE % ffi::VDJ_SCRATCH_ALIGN, 0);
+    assert_eq!(ffi::VDJ_SCRATCH_MAX_BYTES, 1 << 30);
+}
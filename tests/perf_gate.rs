@@ -0,0 +1,389 @@
+//! Performance regression gate
+//!
+//! Runs reference plugins (gain, filter bank, convolution, buffer scratch)
+//! through the stand-in host and compares their throughput and p99 block
+//! latency with `tests/baselines/perf_gate.json`. A metric more than the
+//! tolerance worse than its baseline (and a p99 latency at least double it),
+//! on each of five measurements, fails the test.
+//!
+//! Baselines are per build profile and only meaningful on the machine that
+//! recorded them. Environment variables:
+//!
+//! - `VDJ_PERF_TOLERANCE`: allowed slowdown as a fraction (default 0.5)
+//! - `VDJ_PERF_BASELINE`: baseline file to use instead of the committed one
+//! - `VDJ_PERF_UPDATE=1`: record this run's metrics into the baseline file
+//!   instead of checking them (do this on the CI machine after an intended
+//!   change, in both debug and `--release`)
+
+use std::path::PathBuf;
+use std::time::Instant;
+
+use virtualdj_plugin_sdk::baseline::{Baseline, Metric};
+use virtualdj_plugin_sdk::host::{StandInHost, CHANNELS};
+use virtualdj_plugin_sdk::{BufferDspPlugin, DspPlugin, PluginBase, PluginInfo, Result};
+
+const SAMPLE_RATE: i32 = 44100;
+const BLOCK_FRAMES: usize = 512;
+const BLOCKS: usize = 86;
+const ROUNDS: usize = 5;
+/// Measurements of a plugin before its regression is reported
+const ATTEMPTS: usize = 5;
+
+const PLUGINS: [&str; 4] = ["gain", "filter_bank", "convolution", "buffer_scratch"];
+
+/// Fraction of its baseline a p99 latency may grow by before it counts,
+/// whatever the tolerance: the tail of 86 blocks is noisier than the mean
+const LATENCY_NOISE: f64 = 1.0;
+
+fn info(name: &str) -> PluginInfo {
+    PluginInfo {
+        name: name.to_string(),
+        author: "Test".to_string(),
+        description: "Reference plugin".to_string(),
+        version: "1.0.0".to_string(),
+        flags: 0,
+    }
+}
+
+struct Gain {
+    gain: f32,
+}
+
+impl PluginBase for Gain {
+    fn get_info(&self) -> PluginInfo {
+        info("Gain")
+    }
+}
+
+impl DspPlugin for Gain {
+    fn on_process_samples(&mut self, buffer: &mut [f32]) -> Result<()> {
+        buffer.iter_mut().for_each(|s| *s *= self.gain);
+        Ok(())
+    }
+}
+
+/// Eight parallel band-pass biquads per channel, summed
+struct FilterBank {
+    coefficients: [[f32; 5]; 8],
+    state: [[[f32; 2]; 8]; CHANNELS],
+}
+
+impl FilterBank {
+    fn new() -> Self {
+        let mut coefficients = [[0.0; 5]; 8];
+        for (band, c) in coefficients.iter_mut().enumerate() {
+            let w = std::f32::consts::TAU * 100.0 * 2f32.powi(band as i32) / SAMPLE_RATE as f32;
+            let alpha = w.sin() / (2.0 * 2.0);
+            let a0 = 1.0 + alpha;
+            *c = [
+                alpha / a0,
+                0.0,
+                -alpha / a0,
+                -2.0 * w.cos() / a0,
+                (1.0 - alpha) / a0,
+            ];
+        }
+        FilterBank {
+            coefficients,
+            state: [[[0.0; 2]; 8]; CHANNELS],
+        }
+    }
+}
+
+impl PluginBase for FilterBank {
+    fn get_info(&self) -> PluginInfo {
+        info("Filter bank")
+    }
+}
+
+impl DspPlugin for FilterBank {
+    fn on_process_samples(&mut self, buffer: &mut [f32]) -> Result<()> {
+        for frame in buffer.chunks_exact_mut(CHANNELS) {
+            for (channel, sample) in frame.iter_mut().enumerate() {
+                let x = *sample;
+                let mut sum = 0.0;
+                for (c, s) in self.coefficients.iter().zip(self.state[channel].iter_mut()) {
+                    // Transposed direct form II
+                    let y = c[0] * x + s[0];
+                    s[0] = c[1] * x - c[3] * y + s[1];
+                    s[1] = c[2] * x - c[4] * y;
+                    sum += y;
+                }
+                *sample = sum * 0.125;
+            }
+        }
+        Ok(())
+    }
+}
+
+/// Direct-form FIR convolution with a 128-tap decaying impulse response
+struct Convolution {
+    taps: Vec<f32>,
+    history: Vec<f32>,
+}
+
+impl Convolution {
+    fn new() -> Self {
+        let taps: Vec<f32> = (0..128)
+            .map(|i| (-(i as f32) / 24.0).exp() * if i % 2 == 0 { 1.0 } else { -0.5 })
+            .collect();
+        Convolution {
+            history: vec![0.0; (taps.len() - 1 + BLOCK_FRAMES) * CHANNELS],
+            taps,
+        }
+    }
+}
+
+impl PluginBase for Convolution {
+    fn get_info(&self) -> PluginInfo {
+        info("Convolution")
+    }
+}
+
+impl DspPlugin for Convolution {
+    fn on_process_samples(&mut self, buffer: &mut [f32]) -> Result<()> {
+        let tail = (self.taps.len() - 1) * CHANNELS;
+        let n = buffer.len();
+        self.history[tail..tail + n].copy_from_slice(buffer);
+        for (i, out) in buffer.iter_mut().enumerate() {
+            let channel = i % CHANNELS;
+            let newest = tail + i - channel;
+            let mut acc = 0.0;
+            for (k, tap) in self.taps.iter().enumerate() {
+                acc += tap * self.history[newest - k * CHANNELS + channel];
+            }
+            *out = acc;
+        }
+        self.history.copy_within(n..n + tail, 0);
+        Ok(())
+    }
+}
+
+/// Plays a track at a varying speed, as when scratching
+struct BufferScratch {
+    track: Vec<i16>,
+    out: Vec<i16>,
+    position: f64,
+    block: usize,
+}
+
+impl BufferScratch {
+    fn new() -> Self {
+        let track = (0..SAMPLE_RATE as usize * CHANNELS)
+            .map(|i| ((i as f32 * 0.013).sin() * 12000.0) as i16)
+            .collect();
+        BufferScratch {
+            track,
+            out: vec![0; BLOCK_FRAMES * CHANNELS],
+            position: 0.0,
+            block: 0,
+        }
+    }
+}
+
+impl PluginBase for BufferScratch {
+    fn get_info(&self) -> PluginInfo {
+        info("Buffer scratch")
+    }
+}
+
+impl BufferDspPlugin for BufferScratch {
+    fn on_get_song_buffer(&mut self, _song_pos: i32, nb: i32) -> Option<&[i16]> {
+        let frames = self.track.len() / CHANNELS;
+        let speed = ((self.block as f64) * 0.3).sin() * 1.5;
+        self.block += 1;
+        for frame in self.out.chunks_exact_mut(CHANNELS).take(nb as usize) {
+            let pos = self.position.rem_euclid((frames - 1) as f64);
+            let (i, t) = (pos as usize, (pos.fract()) as f32);
+            for (c, s) in frame.iter_mut().enumerate() {
+                let a = self.track[i * CHANNELS + c] as f32;
+                let b = self.track[(i + 1) * CHANNELS + c] as f32;
+                *s = (a + (b - a) * t) as i16;
+            }
+            self.position += speed;
+        }
+        Some(&self.out[..nb as usize * CHANNELS])
+    }
+}
+
+/// Throughput (realtime multiple) and p99 block latency of one plugin
+///
+/// `prepare` runs before every block, outside the timed region. Both metrics
+/// are the best of the rounds: other load on the machine only ever makes a
+/// round slower, so the best round is the one closest to the code's cost.
+fn measure<S, P, F>(state: &mut S, mut prepare: P, mut block: F) -> (f64, f64)
+where
+    P: FnMut(&mut S),
+    F: FnMut(&mut S) -> Result<()>,
+{
+    let block_ns = BLOCK_FRAMES as f64 * 1e9 / SAMPLE_RATE as f64;
+    let mut throughputs = Vec::with_capacity(ROUNDS);
+    let mut p99s = Vec::with_capacity(ROUNDS);
+    let mut durations = Vec::with_capacity(BLOCKS);
+    for _ in 0..ROUNDS {
+        durations.clear();
+        for _ in 0..BLOCKS {
+            prepare(state);
+            let start = Instant::now();
+            block(state).unwrap();
+            durations.push(start.elapsed().as_nanos() as f64);
+        }
+        let total: f64 = durations.iter().sum();
+        throughputs.push(block_ns * BLOCKS as f64 / total.max(1.0));
+        durations.sort_by(|a, b| a.total_cmp(b));
+        p99s.push(durations[(BLOCKS * 99 / 100).min(BLOCKS - 1)]);
+    }
+    (
+        throughputs.iter().cloned().fold(0.0, f64::max),
+        p99s.iter().cloned().fold(f64::INFINITY, f64::min),
+    )
+}
+
+fn measure_dsp<P: DspPlugin>(host: &StandInHost, plugin: &mut P) -> (f64, f64) {
+    // Plugins process in place, so every block starts again from the source:
+    // fed its own output, a signal decays into denormals and zeros whose
+    // cost has nothing to do with the plugin's
+    let source: Vec<f32> = (0..host.block_samples())
+        .map(|i| ((i as f32) * 0.01).sin() * 0.5)
+        .collect();
+    let mut buffer = source.clone();
+    plugin.on_start().unwrap();
+    let result = measure(
+        &mut buffer,
+        |buffer| buffer.copy_from_slice(&source),
+        |buffer| host.process_dsp_block(plugin, buffer),
+    );
+    plugin.on_stop().unwrap();
+    result
+}
+
+fn baseline_path() -> PathBuf {
+    std::env::var_os("VDJ_PERF_BASELINE")
+        .map(PathBuf::from)
+        .unwrap_or_else(|| {
+            PathBuf::from(env!("CARGO_MANIFEST_DIR")).join("tests/baselines/perf_gate.json")
+        })
+}
+
+/// Measure one reference plugin by name
+fn measure_plugin(host: &StandInHost, name: &str) -> (f64, f64) {
+    match name {
+        "gain" => measure_dsp(host, &mut Gain { gain: 0.5 }),
+        "filter_bank" => measure_dsp(host, &mut FilterBank::new()),
+        "convolution" => measure_dsp(host, &mut Convolution::new()),
+        "buffer_scratch" => {
+            measure(
+                &mut BufferScratch::new(),
+                |_| {},
+                |scratch| {
+                    std::hint::black_box(scratch.on_get_song_buffer(0, BLOCK_FRAMES as i32));
+                    Ok(())
+                },
+            )
+        }
+        _ => unreachable!("unknown reference plugin {}", name),
+    }
+}
+
+/// Names of the metrics of `current` worse than `baseline` by more than
+/// `tolerance`
+fn regressions(current: &Baseline, baseline: &Baseline, tolerance: f64) -> Vec<String> {
+    current
+        .compare(baseline)
+        .into_iter()
+        .filter(|c| {
+            let latency = baseline.get(&c.name).map_or(false, |m| m.lower_is_better());
+            c.regression > if latency { tolerance.max(LATENCY_NOISE) } else { tolerance }
+        })
+        .map(|c| c.name)
+        .collect()
+}
+
+#[test]
+fn test_reference_plugins_meet_baselines() {
+    let profile = if cfg!(debug_assertions) {
+        "debug"
+    } else {
+        "release"
+    };
+    let host = StandInHost::new(SAMPLE_RATE, BLOCK_FRAMES);
+    let metric_name = |plugin: &str, what: &str| format!("{}/{}/{}", profile, plugin, what);
+    let mut current = Baseline::new("perf_gate");
+    for plugin in PLUGINS {
+        let (throughput, p99) = measure_plugin(&host, plugin);
+        current.push(Metric::new(
+            metric_name(plugin, "throughput"),
+            throughput,
+            "x",
+        ));
+        current.push(Metric::new(metric_name(plugin, "p99_block"), p99, "ns"));
+    }
+
+    let path = baseline_path();
+    let mut baseline = Baseline::load(&path).unwrap_or_else(|_| Baseline::new("perf_gate"));
+
+    if std::env::var("VDJ_PERF_UPDATE").map_or(false, |v| v == "1") {
+        baseline.metrics.retain(|m| current.get(&m.name).is_none());
+        baseline.metrics.extend(current.metrics.iter().cloned());
+        baseline.metrics.sort_by(|a, b| a.name.cmp(&b.name));
+        baseline.save(&path).unwrap();
+        println!("updated {}", path.display());
+        return;
+    }
+
+    let tolerance: f64 = std::env::var("VDJ_PERF_TOLERANCE")
+        .ok()
+        .and_then(|v| v.parse().ok())
+        .unwrap_or(0.5);
+
+    // A slow run is usually another process on the machine; a regression is
+    // one that is still there when measured again
+    for _ in 1..ATTEMPTS {
+        let failed = regressions(&current, &baseline, tolerance);
+        if failed.is_empty() {
+            break;
+        }
+        for plugin in PLUGINS {
+            if !failed
+                .iter()
+                .any(|f| f.starts_with(&metric_name(plugin, "")))
+            {
+                continue;
+            }
+            let (throughput, p99) = measure_plugin(&host, plugin);
+            for m in current.metrics.iter_mut() {
+                if m.name == metric_name(plugin, "throughput") {
+                    m.value = m.value.max(throughput);
+                } else if m.name == metric_name(plugin, "p99_block") {
+                    m.value = m.value.min(p99);
+                }
+            }
+        }
+    }
+
+    for metric in &current.metrics {
+        if baseline.get(&metric.name).is_none() {
+            println!(
+                "{:<40} {:>12.1} {} (no baseline)",
+                metric.name, metric.value, metric.unit
+            );
+        }
+    }
+    for c in current.compare(&baseline) {
+        println!(
+            "{:<40} {:>12.1} -> {:>12.1}  {:>+7.1}%",
+            c.name,
+            c.baseline,
+            c.current,
+            c.regression * 100.0
+        );
+    }
+    let failures = regressions(&current, &baseline, tolerance);
+    assert!(
+        failures.is_empty(),
+        "regressed more than {:.0}% against {}: {:?}",
+        tolerance * 100.0,
+        path.display(),
+        failures
+    );
+}
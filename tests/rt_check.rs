@@ -0,0 +1,273 @@
+//! Realtime-safety tests driven through the stand-in host
+//!
+//! Lives in its own test binary because it installs a global allocator.
+
+use virtualdj_plugin_sdk::host::StandInHost;
+use virtualdj_plugin_sdk::presets::StateSwap;
+use virtualdj_plugin_sdk::replay::{Recording, ReplayBlock, ReplayEvent, ReplayRecord, Replayer};
+use virtualdj_plugin_sdk::rt_check::{self, RtCheckAllocator};
+use virtualdj_plugin_sdk::{
+    ffi, BufferDspPlugin, DspPlugin, PluginBase, PluginContext, PluginInfo, Result,
+};
+
+#[global_allocator]
+static ALLOCATOR: RtCheckAllocator = RtCheckAllocator;
+
+struct Gain {
+    gain: f32,
+}
+
+impl PluginBase for Gain {
+    fn get_info(&self) -> PluginInfo {
+        PluginInfo {
+            name: "Gain".to_string(),
+            author: "Test".to_string(),
+            description: "Realtime-safe gain".to_string(),
+            version: "1.0.0".to_string(),
+            flags: 0,
+        }
+    }
+}
+
+impl DspPlugin for Gain {
+    fn on_process_samples(&mut self, buffer: &mut [f32]) -> Result<()> {
+        buffer.iter_mut().for_each(|s| *s *= self.gain);
+        Ok(())
+    }
+}
+
+/// Allocates a scratch buffer on every block
+struct Allocating;
+
+impl PluginBase for Allocating {
+    fn get_info(&self) -> PluginInfo {
+        PluginInfo {
+            name: "Allocating".to_string(),
+            author: "Test".to_string(),
+            description: "Allocates in the audio callback".to_string(),
+            version: "1.0.0".to_string(),
+            flags: 0,
+        }
+    }
+}
+
+impl DspPlugin for Allocating {
+    fn on_process_samples(&mut self, buffer: &mut [f32]) -> Result<()> {
+        let copy = buffer.to_vec();
+        buffer.copy_from_slice(&copy);
+        Ok(())
+    }
+}
+
+#[test]
+fn test_realtime_safe_plugin_is_clean() {
+    let host = StandInHost::new(44100, 256);
+    let mut buffer = vec![0.5f32; 256 * 2 * 8];
+    let report = host.run_dsp(&mut Gain { gain: 0.5 }, &mut buffer).unwrap();
+
+    assert_eq!(report.blocks, 8);
+    assert!(report.violations.is_clean(), "{:?}", report.violations);
+    assert_eq!(buffer[0], 0.25);
+}
+
+#[test]
+fn test_allocation_in_callback_is_reported() {
+    let host = StandInHost::new(44100, 256);
+    let mut buffer = vec![0.0f32; 256 * 2 * 4 + 2];
+    let report = host.run_dsp(&mut Allocating, &mut buffer).unwrap();
+
+    // Four full blocks and one single-frame block, each allocating and freeing
+    assert_eq!(report.blocks, 5);
+    assert_eq!(report.violations.allocations, 5);
+    assert_eq!(report.violations.deallocations, 5);
+
+    // Allocations outside realtime scopes are not violations
+    let before = rt_check::thread_violations();
+    drop(vec![0u8; 64]);
+    assert_eq!(rt_check::thread_violations(), before);
+}
+
+fn recording(blocks: usize) -> Recording {
+    let mut events = vec![
+        ReplayEvent::Start,
+        ReplayEvent::Parameter {
+            id: 1,
+            param_type: ffi::VDJPARAM_SLIDER,
+            value: 0.25,
+        },
+    ];
+    for i in 0..blocks {
+        events.push(ReplayEvent::ProcessSamples {
+            block: ReplayBlock {
+                nb: 256,
+                sample_rate: 44100,
+                song_bpm: 22050,
+                song_pos: (i * 256) as i32,
+                song_pos_beats: i as f64 * 256.0 / 22050.0,
+            },
+            samples: vec![0.5; 512],
+        });
+    }
+    events.push(ReplayEvent::Stop);
+    Recording {
+        instance_id: 1,
+        records: events
+            .into_iter()
+            .enumerate()
+            .map(|(i, event)| ReplayRecord {
+                time_ns: i as u64 * 1000,
+                event,
+            })
+            .collect(),
+    }
+}
+
+#[test]
+fn test_replay_profiles_recorded_blocks() {
+    let recording = Recording::parse(&recording(6).to_bytes()).unwrap();
+    let replayer = Replayer::new(&recording);
+
+    let mut gain = Gain { gain: 1.0 };
+    let mut positions = Vec::new();
+    let report = replayer
+        .run_dsp(
+            &mut gain,
+            |p, _, value| p.gain = value as f32,
+            |_, position| positions.push(position),
+        )
+        .unwrap();
+    assert_eq!(gain.gain, 0.25);
+    assert_eq!(positions.len(), 6);
+    assert_eq!(positions[3].song_pos_beats, 3.0 * 256.0 / 22050.0);
+    assert_eq!(positions[3].samples_per_beat, 22050);
+    assert_eq!(report.blocks, 6);
+    assert_eq!(report.frames, 6 * 256);
+    assert!(report.min_ns <= report.p50_ns && report.p99_ns <= report.max_ns);
+    assert!(report.violations.is_clean(), "{:?}", report.violations);
+
+    let report = replayer
+        .run_dsp(&mut Allocating, |_, _, _| {}, |_, _| {})
+        .unwrap();
+    assert_eq!(report.violations.allocations, 6);
+}
+
+/// Plays the song backwards within each block
+struct Reverse {
+    context: PluginContext,
+    output: Vec<i16>,
+}
+
+impl PluginBase for Reverse {
+    fn get_info(&self) -> PluginInfo {
+        PluginInfo {
+            name: "Reverse".to_string(),
+            author: "Test".to_string(),
+            description: "Reverses each song buffer".to_string(),
+            version: "1.0.0".to_string(),
+            flags: 0,
+        }
+    }
+}
+
+impl BufferDspPlugin for Reverse {
+    fn on_get_song_buffer(&mut self, song_pos: i32, nb: i32) -> Option<&[i16]> {
+        let song = self.context.get_song_buffer(song_pos, nb).ok()?;
+        let output = &mut self.output[..song.len()];
+        for (out, frame) in output.chunks_exact_mut(2).zip(song.chunks_exact(2).rev()) {
+            out.copy_from_slice(frame);
+        }
+        Some(output)
+    }
+}
+
+#[test]
+fn test_replay_feeds_recorded_song_audio() {
+    let mut events = vec![ReplayEvent::Start];
+    for i in 0..4 {
+        let block = ReplayBlock {
+            nb: 128,
+            sample_rate: 44100,
+            song_bpm: 22050,
+            song_pos: i * 128,
+            song_pos_beats: 0.0,
+        };
+        events.push(ReplayEvent::GetSongBuffer(block));
+        events.push(ReplayEvent::SongAudio {
+            pos: block.song_pos,
+            nb: 128,
+            hr: ffi::S_OK,
+            samples: (0..256).map(|s| (i * 256 + s) as i16).collect(),
+        });
+    }
+    let recording = Recording {
+        instance_id: 1,
+        records: events
+            .into_iter()
+            .map(|event| ReplayRecord { time_ns: 0, event })
+            .collect(),
+    };
+    let recording = Recording::parse(&recording.to_bytes()).unwrap();
+
+    let answers = recording.answers();
+    let mut plugin = Reverse {
+        context: answers.context(),
+        output: vec![0; 256],
+    };
+    let report = Replayer::new(&recording)
+        .run_buffer_dsp(&mut plugin, |_, _, _| {}, |_, _| {})
+        .unwrap();
+    assert_eq!(report.blocks, 4);
+    assert_eq!(report.frames, 4 * 128);
+    assert!(report.violations.is_clean(), "{:?}", report.violations);
+    // The last block's last frame comes out first
+    assert_eq!(plugin.output[..2], [3 * 256 + 254, 3 * 256 + 255]);
+}
+
+/// Gain table swapped in from a loader thread at block boundaries
+struct Preset {
+    swap: StateSwap<Vec<f32>>,
+    table: Box<Vec<f32>>,
+}
+
+impl PluginBase for Preset {
+    fn get_info(&self) -> PluginInfo {
+        PluginInfo {
+            name: "Preset".to_string(),
+            author: "Test".to_string(),
+            description: "Swaps its state at block boundaries".to_string(),
+            version: "1.0.0".to_string(),
+            flags: 0,
+        }
+    }
+}
+
+impl DspPlugin for Preset {
+    fn on_process_samples(&mut self, buffer: &mut [f32]) -> Result<()> {
+        self.swap.take(&mut self.table);
+        let gain = self.table[0];
+        buffer.iter_mut().for_each(|s| *s *= gain);
+        Ok(())
+    }
+}
+
+#[test]
+fn test_state_swap_is_realtime_safe() {
+    let mut plugin = Preset {
+        swap: StateSwap::new(),
+        table: Box::new(vec![1.0; 1024]),
+    };
+    plugin.swap.publish(Box::new(vec![0.5; 1024]));
+
+    let host = StandInHost::new(44100, 256);
+    let mut buffer = vec![1.0f32; 256 * 2 * 4];
+    let report = host.run_dsp(&mut plugin, &mut buffer).unwrap();
+    assert!(report.violations.is_clean(), "{:?}", report.violations);
+    assert_eq!(buffer[0], 0.5);
+    assert_eq!(plugin.table[0], 0.5);
+
+    // The table it replaced is dropped here, off the audio thread
+    plugin.swap.publish(Box::new(vec![0.25; 1024]));
+    let report = host.run_dsp(&mut plugin, &mut buffer).unwrap();
+    assert!(report.violations.is_clean(), "{:?}", report.violations);
+    assert_eq!(buffer[0], 0.125);
+}
@@ -0,0 +1,107 @@
+/**
+ * VirtualDJ Rust SDK - Beat Grid Checks
+ *
+ * Computes VdjBeatGrid events for blocks at known song positions and checks
+ * their offsets, grid positions and flags: bars and beats across a bar
+ * boundary, subdivisions, negative positions before the first beat, a split
+ * that does not depend on the block size, and the event cap.
+ */
+
+#include "check.h"
+#include "../../vdj_plugin_shim/beat_grid.h"
+
+/* 120 BPM at 48 kHz */
+static const int samplesPerBeat = 24000;
+
+static void CheckBarBoundary() {
+    VdjBeatGrid grid;
+
+    // From halfway through beat 2 of the first bar to past beat 4 (the
+    // second bar's downbeat)
+    grid.Compute(2.5, samplesPerBeat, 3 * samplesPerBeat);
+    VDJ_CHECK(grid.count == 3);
+    VDJ_CHECK(grid.events[0].offset == 12000 && grid.events[0].beat == 3.0);
+    VDJ_CHECK(grid.events[0].flags == (VDJ_BEAT_EVENT_SUBDIVISION | VDJ_BEAT_EVENT_BEAT));
+    VDJ_CHECK(grid.events[1].offset == 36000 && grid.events[1].beat == 4.0);
+    VDJ_CHECK(grid.events[1].flags == (VDJ_BEAT_EVENT_SUBDIVISION | VDJ_BEAT_EVENT_BEAT | VDJ_BEAT_EVENT_BAR));
+    VDJ_CHECK(grid.events[2].offset == 60000 && grid.events[2].beat == 5.0);
+
+    // A block starting exactly on a downbeat owns it at offset 0
+    grid.Compute(8.0, samplesPerBeat, 512);
+    VDJ_CHECK(grid.count == 1);
+    VDJ_CHECK(grid.events[0].offset == 0 && (grid.events[0].flags & VDJ_BEAT_EVENT_BAR));
+
+    // Three beats to the bar
+    grid.beatsPerBar = 3;
+    grid.Compute(2.5, samplesPerBeat, 3 * samplesPerBeat);
+    VDJ_CHECK(grid.count == 3);
+    VDJ_CHECK((grid.events[0].flags & VDJ_BEAT_EVENT_BAR) && grid.events[0].beat == 3.0);
+    VDJ_CHECK(!(grid.events[1].flags & VDJ_BEAT_EVENT_BAR));
+}
+
+static void CheckSubdivisions() {
+    VdjBeatGrid grid;
+    grid.subdivisions = 4;
+
+    // Sixteenths over one beat before the song's first beat
+    grid.Compute(-1.0, samplesPerBeat, samplesPerBeat + 1);
+    VDJ_CHECK(grid.count == 5);
+    for (int i = 0; i < grid.count; i++) {
+        VDJ_CHECK(grid.events[i].offset == i * samplesPerBeat / 4);
+        VDJ_CHECK(grid.events[i].beat == -1.0 + i * 0.25);
+    }
+    VDJ_CHECK(grid.events[0].flags == (VDJ_BEAT_EVENT_SUBDIVISION | VDJ_BEAT_EVENT_BEAT));
+    VDJ_CHECK(grid.events[2].flags == VDJ_BEAT_EVENT_SUBDIVISION);
+    VDJ_CHECK(grid.events[4].flags & VDJ_BEAT_EVENT_BAR);
+}
+
+/* Events of the first bar played in blocks of nb frames, as absolute frames */
+static int Split(int nb, int64_t *frames, int max) {
+    VdjBeatGrid grid;
+    grid.subdivisions = 3;
+    int found = 0;
+    for (int64_t start = 0; start < 4 * samplesPerBeat; start += nb) {
+        grid.Compute((double)start / samplesPerBeat, samplesPerBeat, nb);
+        for (int i = 0; i < grid.count && found < max; i++) {
+            const int64_t frame = start + grid.events[i].offset;
+            if (frame < 4 * samplesPerBeat) frames[found++] = frame;
+        }
+    }
+    return found;
+}
+
+static void CheckStableSplit() {
+    // Every boundary lands in exactly one block, on the same frame, whatever
+    // the block size
+    int64_t whole[32], blocks[32];
+    const int expected = Split(4 * samplesPerBeat, whole, 32);
+    VDJ_CHECK(expected == 12);
+    static const int sizes[] = { 64, 441, 512, 8000 };
+    for (int nb : sizes) {
+        const int found = Split(nb, blocks, 32);
+        VDJ_CHECK(found == expected);
+        for (int i = 0; i < found && i < expected; i++) VDJ_CHECK(blocks[i] == whole[i]);
+    }
+}
+
+static void CheckCap() {
+    VdjBeatGrid grid;
+    grid.subdivisions = 64;
+    grid.Compute(0.0, 64, 100000);
+    VDJ_CHECK(grid.count == VDJ_BEAT_EVENTS_MAX);
+    VDJ_CHECK(grid.events[VDJ_BEAT_EVENTS_MAX - 1].offset == VDJ_BEAT_EVENTS_MAX - 1);
+
+    // Nothing for an unknown tempo or an empty block
+    grid.Compute(0.0, 0, 512);
+    VDJ_CHECK(grid.count == 0);
+    grid.Compute(0.0, samplesPerBeat, 0);
+    VDJ_CHECK(grid.count == 0);
+}
+
+int main() {
+    CheckBarBoundary();
+    CheckSubdivisions();
+    CheckStableSplit();
+    CheckCap();
+    return CheckResult("beat_grid");
+}
@@ -0,0 +1,53 @@
+/**
+ * VirtualDJ Rust SDK - Shim Check Helpers
+ *
+ * Shared by the check programs in tests/shim. Each program drives one shim
+ * kernel with known input, reports every expectation that does not hold
+ * and exits with 1 when any failed. Cargo does not build the shim, so the
+ * programs are built against all the shim sources like the benches (the
+ * shim sets the VirtualDJ SDK up for Linux itself, see vdj_sdk.h), e.g.:
+ *
+ *     c++ -O1 -g -std=c++17 -fsanitize=address,undefined tests/shim/beat_grid.cpp \
+ *         vdj_plugin_shim/[a-z]*.cpp -o beat_grid
+ *     ./beat_grid
+ */
+
+#ifndef VDJ_SHIM_CHECK_H
+#define VDJ_SHIM_CHECK_H
+
+#include "../../abi/vdj_plugin_abi.h"
+
+#include <cmath>
+#include <cstdio>
+
+static int checkFailures = 0;
+
+#define VDJ_CHECK(condition)                                                            \
+    do {                                                                                \
+        if (!(condition)) {                                                             \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            checkFailures++;                                                            \
+        }                                                                               \
+    } while (0)
+
+#define VDJ_CHECK_NEAR(a, b, tolerance) VDJ_CHECK(std::fabs((double)(a) - (double)(b)) <= (tolerance))
+
+/* Print the outcome and return the exit status */
+static inline int CheckResult(const char *name) {
+    printf("%s: %s\n", name, checkFailures ? "FAILED" : "ok");
+    return checkFailures ? 1 : 0;
+}
+
+/* ===== Stub Host ===== */
+
+static HRESULT StubSendCommand(VdjPlugin*, const char*) { return S_OK; }
+static HRESULT StubGetInfo(VdjPlugin*, const char*, double*) { return E_NOTIMPL; }
+static HRESULT StubGetStringInfo(VdjPlugin*, const char*, char*, int) { return E_NOTIMPL; }
+static HRESULT StubDeclareParameter(VdjPlugin*, void*, int, int, const char*, const char*, float) { return S_OK; }
+static HRESULT StubGetSongBuffer(VdjPlugin*, int, int, int16_t**) { return E_NOTIMPL; }
+
+static const VdjCallbacks stubCallbacks = {
+    StubSendCommand, StubGetInfo, StubGetStringInfo, StubDeclareParameter, StubGetSongBuffer
+};
+
+#endif /* VDJ_SHIM_CHECK_H */
@@ -0,0 +1,116 @@
+/**
+ * VirtualDJ Rust SDK - Parameter Ramp Checks
+ *
+ * Moves declared parameters and runs VdjParamRamps block by block at 48 kHz:
+ * each shape must follow its curve and reach the target after the smoothing
+ * time, whether that falls inside a block, across blocks or past the values
+ * of a block longer than VDJ_RAMP_MAX_FRAMES.
+ */
+
+#include "check.h"
+#include "../../vdj_plugin_shim/param_ramp.h"
+
+#include <cmath>
+
+static const int sampleRate = 48000;
+
+/* 10 ms at 48 kHz */
+static const int rampFrames = 480;
+
+static void CheckLinear() {
+    VdjParamRamps ramps;
+    float slider = 0.0f;
+    VDJ_CHECK(ramps.Declare(1, &slider, VDJ_RAMP_LINEAR, 10.0f) == S_OK);
+    ramps.Process(sampleRate, 256);
+    const VdjParamSmoother *s = ramps.Find(1);
+    VDJ_CHECK(s->ramp.is_static == 1);
+
+    slider = 1.0f;
+    ramps.Process(sampleRate, 256);
+    VDJ_CHECK(s->ramp.is_static == 0 && s->ramp.count == 256);
+    VDJ_CHECK_NEAR(s->ramp.values[0], 1.0f / rampFrames, 1e-6);
+    VDJ_CHECK_NEAR(s->ramp.values[255], 256.0f / rampFrames, 1e-5);
+
+    // Reaches the target on frame 480 and holds it for the rest of the block
+    ramps.Process(sampleRate, 256);
+    VDJ_CHECK_NEAR(s->ramp.values[rampFrames - 256 - 2], (rampFrames - 1.0f) / rampFrames, 1e-5);
+    VDJ_CHECK_NEAR(s->ramp.values[rampFrames - 256 - 1], 1.0, 1e-6);
+    VDJ_CHECK(s->ramp.values[255] == 1.0f);
+    VDJ_CHECK(s->ramp.value == 1.0f);
+
+    ramps.Process(sampleRate, 256);
+    VDJ_CHECK(s->ramp.is_static == 1 && s->ramp.value == 1.0f);
+}
+
+static void CheckExponential() {
+    VdjParamRamps ramps;
+    float gain = 0.1f;
+    VDJ_CHECK(ramps.Declare(1, &gain, VDJ_RAMP_EXPONENTIAL, 10.0f) == S_OK);
+    const VdjParamSmoother *s = ramps.Find(1);
+
+    // Halfway in time is halfway in ratio
+    gain = 1.0f;
+    ramps.Process(sampleRate, 512);
+    VDJ_CHECK_NEAR(s->ramp.values[rampFrames / 2 - 1], std::sqrt(0.1), 1e-3);
+    VDJ_CHECK_NEAR(s->ramp.values[rampFrames - 1], 1.0, 1e-5);
+    VDJ_CHECK(s->ramp.value == 1.0f);
+
+    // Through zero there is no constant ratio, so it falls back to linear
+    gain = -1.0f;
+    ramps.Process(sampleRate, 512);
+    VDJ_CHECK_NEAR(s->ramp.values[rampFrames / 2 - 1], 0.0, 1e-3);
+    VDJ_CHECK(s->ramp.value == -1.0f);
+}
+
+static void CheckOnePole() {
+    VdjParamRamps ramps;
+    float cutoff = 0.0f;
+    VDJ_CHECK(ramps.Declare(1, &cutoff, VDJ_RAMP_ONEPOLE, 10.0f) == S_OK);
+    const VdjParamSmoother *s = ramps.Find(1);
+
+    // One time constant in, 1 - 1/e of the way there
+    cutoff = 1.0f;
+    ramps.Process(sampleRate, 512);
+    VDJ_CHECK_NEAR(s->ramp.values[rampFrames - 1], 1.0 - std::exp(-1.0), 1e-4);
+    VDJ_CHECK(s->ramp.value < 1.0f);
+
+    // It converges and then stops costing anything
+    for (int i = 0; i < 64; i++) ramps.Process(sampleRate, 512);
+    VDJ_CHECK(s->ramp.is_static == 1 && s->ramp.value == 1.0f);
+}
+
+static void CheckLongBlock() {
+    VdjParamRamps ramps;
+    float slider = 0.0f, gain = 0.1f, cutoff = 0.0f;
+    VDJ_CHECK(ramps.Declare(1, &slider, VDJ_RAMP_LINEAR, 200.0f) == S_OK);
+    VDJ_CHECK(ramps.Declare(2, &gain, VDJ_RAMP_EXPONENTIAL, 200.0f) == S_OK);
+    VDJ_CHECK(ramps.Declare(3, &cutoff, VDJ_RAMP_ONEPOLE, 100.0f) == S_OK);
+    const VdjParamSmoother *linear = ramps.Find(1), *exponential = ramps.Find(2), *onePole = ramps.Find(3);
+
+    // 9600 ramp frames in a block of 12000: only the first values exist, but
+    // the ramps end where they would with short blocks
+    slider = 1.0f;
+    gain = 1.0f;
+    cutoff = 1.0f;
+    ramps.Process(sampleRate, 12000);
+    VDJ_CHECK(linear->ramp.count == VDJ_RAMP_MAX_FRAMES);
+    VDJ_CHECK_NEAR(linear->ramp.values[VDJ_RAMP_MAX_FRAMES - 1], 4096.0 / 9600.0, 1e-4);
+    VDJ_CHECK(linear->ramp.value == 1.0f);
+    VDJ_CHECK(exponential->ramp.value == 1.0f);
+    VDJ_CHECK_NEAR(onePole->ramp.value, 1.0 - std::exp(-12000.0 / 4800.0), 1e-4);
+
+    // Stopped halfway through a long block, a ramp goes on from there
+    slider = 0.0f;
+    ramps.Process(sampleRate, 4800);
+    VDJ_CHECK_NEAR(linear->ramp.value, 0.5, 1e-4);
+    ramps.Process(sampleRate, 4800);
+    VDJ_CHECK(linear->ramp.value == 0.0f);
+}
+
+int main() {
+    CheckLinear();
+    CheckExponential();
+    CheckOnePole();
+    CheckLongBlock();
+    return CheckResult("param_ramp");
+}
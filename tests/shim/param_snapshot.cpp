@@ -0,0 +1,128 @@
+/**
+ * VirtualDJ Rust SDK - Parameter Snapshot Checks
+ *
+ * Round-trips a snapshot of declared parameters, then feeds malformed ones
+ * to every entry point that validates them: vdj_plugin_stage_snapshot,
+ * the morph table and VdjSnapshotValid itself. Each must be rejected
+ * without reading past the input, which AddressSanitizer checks when the
+ * program is built with it (see check.h).
+ */
+
+#include "check.h"
+#include "../../vdj_plugin_shim/param_snapshot.h"
+#include "../../vdj_plugin_shim/preset_morph.h"
+#include "../../vdj_plugin_shim/replay_recorder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/* The declared parameters of a small plugin: a gain slider and a switch */
+static float gain = 0.25f;
+static int bypass = 1;
+
+static VdjReplayParameters Declared() {
+    VdjReplayParameters parameters;
+    parameters.Declare(&gain, VDJPARAM_SLIDER, 1, 0.5f);
+    parameters.Declare(&bypass, VDJPARAM_SWITCH, 2, 0.0f);
+    return parameters;
+}
+
+static std::vector<uint8_t> Save(const VdjReplayParameters &parameters, const char *opaque) {
+    const uint64_t size = VdjSnapshotWrite(parameters, opaque, strlen(opaque), nullptr, 0);
+    std::vector<uint8_t> bytes((size_t)size);
+    VdjSnapshotWrite(parameters, opaque, strlen(opaque), bytes.data(), size);
+    return bytes;
+}
+
+static void SetHeader(std::vector<uint8_t> &bytes, uint64_t VdjSnapshotHeader::*field, uint64_t value) {
+    VdjSnapshotHeader header;
+    memcpy(&header, bytes.data(), sizeof(header));
+    header.*field = value;
+    memcpy(bytes.data(), &header, sizeof(header));
+}
+
+/* Exactly `size` bytes on the heap, so a read past them is caught */
+static bool Valid(const std::vector<uint8_t> &bytes, size_t size) {
+    std::vector<uint8_t> exact(bytes.begin(), bytes.begin() + (ptrdiff_t)size);
+    return VdjSnapshotValid(exact.data(), exact.size());
+}
+
+static void CheckRoundTrip() {
+    const VdjReplayParameters parameters = Declared();
+    const std::vector<uint8_t> bytes = Save(parameters, "state");
+    VDJ_CHECK(bytes.size() % 8 == 0);
+    VDJ_CHECK(Valid(bytes, bytes.size()));
+
+    const char *value = VdjSnapshotFind(bytes.data(), 1, VDJPARAM_SLIDER, sizeof(float));
+    VDJ_CHECK(value != nullptr);
+    float saved = 0.0f;
+    if (value) memcpy(&saved, value, sizeof(saved));
+    VDJ_CHECK(saved == 0.25f);
+    VDJ_CHECK(VdjSnapshotFind(bytes.data(), 1, VDJPARAM_SWITCH, sizeof(int)) == nullptr);
+    VDJ_CHECK(VdjSnapshotFind(bytes.data(), 3, VDJPARAM_SLIDER, sizeof(float)) == nullptr);
+}
+
+static void CheckMalformed() {
+    const VdjReplayParameters parameters = Declared();
+    const std::vector<uint8_t> good = Save(parameters, "state");
+
+    // Truncated anywhere, including inside the header
+    VDJ_CHECK(!Valid(good, good.size() - 8));
+    VDJ_CHECK(!Valid(good, sizeof(VdjSnapshotHeader) - 1));
+
+    // A total size inside the header, with parameters still counted: the
+    // bounds checks must not wrap around and walk off the buffer
+    for (uint64_t total : { (uint64_t)0, (uint64_t)8, (uint64_t)sizeof(VdjSnapshotHeader) - 8 }) {
+        std::vector<uint8_t> bytes = good;
+        SetHeader(bytes, &VdjSnapshotHeader::total_size, total);
+        VDJ_CHECK(!Valid(bytes, sizeof(VdjSnapshotHeader)));
+        VDJ_CHECK(!Valid(bytes, bytes.size()));
+    }
+
+    // A parameter claiming more bytes than the snapshot holds
+    {
+        std::vector<uint8_t> bytes = good;
+        const uint32_t huge = UINT32_MAX;
+        memcpy(bytes.data() + sizeof(VdjSnapshotHeader) + offsetof(VdjSnapshotParam, size), &huge, sizeof(huge));
+        VDJ_CHECK(!Valid(bytes, bytes.size()));
+    }
+
+    // Opaque state outside the snapshot, or overlapping the parameters
+    {
+        std::vector<uint8_t> bytes = good;
+        SetHeader(bytes, &VdjSnapshotHeader::opaque_size, 1000);
+        VDJ_CHECK(!Valid(bytes, bytes.size()));
+        bytes = good;
+        SetHeader(bytes, &VdjSnapshotHeader::opaque_offset, sizeof(VdjSnapshotHeader));
+        VDJ_CHECK(!Valid(bytes, bytes.size()));
+    }
+}
+
+static void CheckEntryPoints() {
+    const VdjReplayParameters parameters = Declared();
+    const std::vector<uint8_t> good = Save(parameters, "");
+    std::vector<uint8_t> bad = good;
+    SetHeader(bad, &VdjSnapshotHeader::total_size, 8);
+    bad.resize(sizeof(VdjSnapshotHeader));
+
+    VdjPlugin *plugin = vdj_plugin_create();
+    vdj_plugin_init(plugin, &stubCallbacks);
+    VDJ_CHECK(vdj_plugin_stage_snapshot(plugin, good.data(), good.size()) == S_OK);
+    VDJ_CHECK(vdj_plugin_stage_snapshot(plugin, bad.data(), bad.size()) != S_OK);
+    vdj_plugin_release(plugin);
+
+    VdjPresetMorph morph;
+    const void *snapshots[3] = { good.data(), good.data(), bad.data() };
+    const uint64_t sizes[3] = { good.size(), good.size(), bad.size() };
+    VDJ_CHECK(morph.Set(parameters, 1, snapshots, sizes, 2));
+    VDJ_CHECK(!morph.Set(parameters, 1, snapshots + 1, sizes + 1, 2));
+}
+
+int main() {
+    CheckRoundTrip();
+    CheckMalformed();
+    CheckEntryPoints();
+    return CheckResult("param_snapshot");
+}
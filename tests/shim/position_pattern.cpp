@@ -0,0 +1,150 @@
+/**
+ * VirtualDJ Rust SDK - Position Pattern Checks
+ *
+ * Drives VdjPositionPattern::Transform on a grid of 1000 samples per beat
+ * and checks where each pattern sends the play position: stutters repeat
+ * their slice, reversed steps play backwards, gates close with a fade, and
+ * the pattern restarts every cycle. Then checks that the newest pattern a
+ * control thread publishes is always the one the audio thread ends up
+ * playing, also while the two race.
+ */
+
+#include "check.h"
+#include "../../vdj_plugin_shim/position_pattern.h"
+
+#include <atomic>
+#include <thread>
+
+static const int samplesPerBeat = 1000;
+
+struct Mapped {
+    double beats;   /* source position, in beats */
+    double video;   /* video position, moved by as much as the song position */
+    float volume;
+};
+
+/* Transform the host about to play `beats` into the song, beat 0 at sample 0 */
+static Mapped Map(VdjPositionPattern &pattern, double beats) {
+    const double sample = beats * samplesPerBeat;
+    double songPos = sample, videoPos = sample + 5.0;
+    float volume = 1.0f;
+    pattern.Transform(&songPos, &videoPos, &volume, (int)sample, (double)(int)sample / samplesPerBeat,
+                      samplesPerBeat);
+    return { songPos / samplesPerBeat, videoPos - songPos, volume };
+}
+
+static VdjPatternStep Step(double length, double repeat = 0.0, uint32_t flags = 0, float volume = 1.0f) {
+    VdjPatternStep step = {};
+    step.length_beats = length;
+    step.repeat_beats = repeat;
+    step.volume = volume;
+    step.flags = flags;
+    return step;
+}
+
+static void CheckStutter() {
+    VdjPositionPattern pattern;
+    const VdjPatternStep steps[] = { Step(1.0, 0.25), Step(1.0) };
+    VDJ_CHECK(pattern.Set(steps, 2) == S_OK);
+
+    // The first beat loops its first quarter, the second plays through
+    VDJ_CHECK_NEAR(Map(pattern, 0.1).beats, 0.1, 1e-6);
+    VDJ_CHECK_NEAR(Map(pattern, 0.3).beats, 0.05, 1e-6);
+    VDJ_CHECK_NEAR(Map(pattern, 0.8).beats, 0.05, 1e-6);
+    VDJ_CHECK_NEAR(Map(pattern, 1.5).beats, 1.5, 1e-6);
+
+    // The next cycle repeats it two beats later, and the video follows
+    VDJ_CHECK_NEAR(Map(pattern, 2.3).beats, 2.05, 1e-6);
+    VDJ_CHECK_NEAR(Map(pattern, 2.3).video, 5.0, 1e-6);
+    VDJ_CHECK(Map(pattern, 2.3).volume == 1.0f);
+}
+
+static void CheckReverse() {
+    VdjPositionPattern pattern;
+    const VdjPatternStep steps[] = { Step(1.0, 0.0, VDJ_PATTERN_REVERSE), Step(1.0, 0.5, VDJ_PATTERN_REVERSE) };
+    VDJ_CHECK(pattern.Set(steps, 2) == S_OK);
+
+    // A reversed beat plays from its end back to its start
+    VDJ_CHECK_NEAR(Map(pattern, 0.25).beats, 0.75, 1e-6);
+    VDJ_CHECK_NEAR(Map(pattern, 0.6).beats, 0.4, 1e-6);
+
+    // A reversed stutter plays its half beat backwards, twice
+    VDJ_CHECK_NEAR(Map(pattern, 1.1).beats, 1.4, 1e-6);
+    VDJ_CHECK_NEAR(Map(pattern, 1.6).beats, 1.4, 1e-6);
+}
+
+static void CheckGate() {
+    VdjPositionPattern pattern;
+    const VdjPatternStep steps[] = { Step(1.0), Step(1.0, 0.0, VDJ_PATTERN_MUTE) };
+    VDJ_CHECK(pattern.Set(steps, 2) == S_OK);
+
+    VDJ_CHECK(Map(pattern, 0.5).volume == 1.0f);
+    VDJ_CHECK(Map(pattern, 1.5).volume == 0.0f);
+    VDJ_CHECK_NEAR(Map(pattern, 1.5).beats, 1.5, 1e-6);
+
+    // Both edges fade over the last slot of the step before them
+    const double fade = 1.0 / VDJ_PATTERN_SLOTS_PER_BEAT;
+    VDJ_CHECK_NEAR(Map(pattern, 1.0 - fade / 2).volume, 0.5, 1e-3);
+    VDJ_CHECK_NEAR(Map(pattern, 2.0 - fade / 2).volume, 0.5, 1e-3);
+    VDJ_CHECK(Map(pattern, 2.0).volume == 1.0f);
+
+    // Clearing restores the song as it is
+    VDJ_CHECK(pattern.Set(nullptr, 0) == S_OK);
+    VDJ_CHECK_NEAR(Map(pattern, 1.5).beats, 1.5, 1e-9);
+    VDJ_CHECK(Map(pattern, 1.5).volume == 1.0f);
+}
+
+/* A pattern recognizable from its output: a stutter of `beats` beats */
+static VdjPatternStep Marker(int beats) {
+    return Step(2.0 * beats, (double)beats);
+}
+
+static void CheckHandoff() {
+    VdjPositionPattern pattern;
+
+    // Patterns published between two blocks: only the newest plays
+    VdjPatternStep step = Marker(1);
+    pattern.Set(&step, 1);
+    VDJ_CHECK_NEAR(Map(pattern, 1.5).beats, 0.5, 1e-6);
+    step = Marker(2);
+    pattern.Set(&step, 1);
+    step = Marker(3);
+    pattern.Set(&step, 1);
+    VDJ_CHECK_NEAR(Map(pattern, 3.5).beats, 0.5, 1e-6);
+
+    // Pairs of patterns published back to back while the audio thread takes
+    // tables: once it has run two more blocks, the second of each pair must
+    // be the one playing. Each marker sends beat 7.5 somewhere else.
+    const double expected[] = { 0.0, 6.5, 5.5, 7.5, 3.5 };
+    std::atomic<bool> done { false };
+    std::atomic<int> blocks { 0 };
+    std::atomic<double> played { 0.0 };
+    std::thread audio([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            played.store(Map(pattern, 7.5).beats, std::memory_order_relaxed);
+            blocks.fetch_add(1, std::memory_order_release);
+        }
+    });
+    int stuck = 0;
+    for (int i = 0; i < 500; i++) {
+        const int marker = 1 + i % 4;
+        step = Marker(marker % 4 + 1);
+        pattern.Set(&step, 1);
+        step = Marker(marker);
+        pattern.Set(&step, 1);
+        const int start = blocks.load(std::memory_order_acquire);
+        while (blocks.load(std::memory_order_acquire) < start + 2) std::this_thread::yield();
+        if (std::fabs(played.load(std::memory_order_relaxed) - expected[marker]) > 1e-6) stuck++;
+    }
+    done.store(true, std::memory_order_release);
+    audio.join();
+    VDJ_CHECK(stuck == 0);
+}
+
+int main() {
+    CheckStutter();
+    CheckReverse();
+    CheckGate();
+    CheckHandoff();
+    return CheckResult("position_pattern");
+}
@@ -0,0 +1,54 @@
+/**
+ * VirtualDJ Rust SDK - Scratch Arena Checks
+ *
+ * Grows a VdjScratch from a control thread's point of view and checks that
+ * the audio thread takes the block at the end of its callback, that the
+ * recorded demand is reserved later, and that requests past
+ * VDJ_SCRATCH_MAX_BYTES fail at once instead of spinning on the doubling.
+ */
+
+#include "check.h"
+#include "../../vdj_plugin_shim/scratch_arena.h"
+
+#include <cstdint>
+
+static void CheckGrowth() {
+    VdjScratch scratch;
+    VDJ_CHECK(scratch.Reserve(0));
+    VDJ_CHECK(scratch.reservedBytes.load() == 0);
+
+    // Rounded up to a power of two, and only taken when the block ends
+    VDJ_CHECK(scratch.Reserve(10000));
+    VDJ_CHECK(scratch.reservedBytes.load() == 16384);
+    VDJ_CHECK(scratch.arena.base == nullptr);
+    scratch.EndBlock();
+    VDJ_CHECK(scratch.arena.base != nullptr);
+    VDJ_CHECK(scratch.arena.capacity == 16384);
+
+    // A callback asking for more than it has is served on the next reserve
+    scratch.arena.demand = 40000;
+    scratch.EndBlock();
+    VDJ_CHECK(scratch.arena.demand == 0);
+    VDJ_CHECK(scratch.Reserve(0));
+    scratch.EndBlock();
+    VDJ_CHECK(scratch.arena.capacity == 65536);
+}
+
+static void CheckLimit() {
+    VdjScratch scratch;
+    VDJ_CHECK(!scratch.Reserve(UINT64_MAX));
+    VDJ_CHECK(!scratch.Reserve(VDJ_SCRATCH_MAX_BYTES + 1));
+    VDJ_CHECK(scratch.reservedBytes.load() == 0);
+
+    VdjPlugin *plugin = vdj_plugin_create();
+    vdj_plugin_init(plugin, &stubCallbacks);
+    VDJ_CHECK(vdj_plugin_reserve_scratch(plugin, UINT64_MAX) != S_OK);
+    VDJ_CHECK(vdj_plugin_reserve_scratch(plugin, 1000) == S_OK);
+    vdj_plugin_release(plugin);
+}
+
+int main() {
+    CheckGrowth();
+    CheckLimit();
+    return CheckResult("scratch_arena");
+}
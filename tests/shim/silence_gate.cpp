@@ -0,0 +1,99 @@
+/**
+ * VirtualDJ Rust SDK - Silence Gate Checks
+ *
+ * Feeds VdjSilenceGate silent and loud stereo blocks at 48 kHz and checks
+ * when it engages: after the configured number of silent blocks, not before
+ * the plugin's tail has rung out, and never for a block with one sample over
+ * the threshold. Then drives the same through a DSP instance, where a gate
+ * declaring VDJFLAG_PROCESSAFTERSTOP returns E_FAIL and is_idle follows it.
+ */
+
+#include "check.h"
+#include "../../vdj_plugin_shim/silence_gate.h"
+
+#include <vector>
+
+static const int sampleRate = 48000;
+static const int blockFrames = 512;
+
+static std::vector<float> Silence(int frames = blockFrames) {
+    return std::vector<float>(2 * (size_t)frames, 0.0f);
+}
+
+static bool Feed(VdjSilenceGate &gate, const std::vector<float> &block) {
+    return gate.Process(block.data(), (int)block.size() / 2, sampleRate);
+}
+
+static void CheckBlocks() {
+    VdjSilenceGate gate;
+    const std::vector<float> silent = Silence();
+    std::vector<float> loud = Silence();
+    loud[100] = 0.5f;
+
+    // Disabled until silent blocks are set
+    VDJ_CHECK(!Feed(gate, silent));
+    gate.silentBlocks = 4;
+
+    for (int i = 0; i < 3; i++) VDJ_CHECK(!Feed(gate, silent));
+    VDJ_CHECK(Feed(gate, silent));
+    VDJ_CHECK(gate.idle.load());
+    VDJ_CHECK(Feed(gate, silent));
+
+    // One loud block releases it, and the count starts over
+    VDJ_CHECK(!Feed(gate, loud));
+    VDJ_CHECK(!gate.idle.load());
+    for (int i = 0; i < 3; i++) VDJ_CHECK(!Feed(gate, silent));
+    VDJ_CHECK(Feed(gate, silent));
+}
+
+static void CheckTail() {
+    // A 100 ms tail is 4800 frames: nine blocks are not enough, ten are
+    VdjSilenceGate gate;
+    gate.silentBlocks = 1;
+    gate.tailMs = 100.0f;
+    const std::vector<float> silent = Silence();
+    for (int i = 0; i < 9; i++) VDJ_CHECK(!Feed(gate, silent));
+    VDJ_CHECK(Feed(gate, silent));
+    VDJ_CHECK(gate.idle.load());
+}
+
+static void CheckThreshold() {
+    // 100 stereo frames: 192 samples in the vector loop and 8 in the tail
+    VdjSilenceGate gate;
+    gate.silentBlocks = 1;
+    static const int positions[] = { 0, 37, 191, 192, 199 };
+    for (int position : positions) {
+        std::vector<float> block = Silence(100);
+        block[position] = 0.5f * VDJ_SILENCE_THRESHOLD;
+        VDJ_CHECK(Feed(gate, block));
+        block[position] = -2.0f * VDJ_SILENCE_THRESHOLD;
+        VDJ_CHECK(!Feed(gate, block));
+        VDJ_CHECK(!gate.idle.load());
+    }
+}
+
+static void CheckInstance() {
+    VdjPluginDsp *dsp = vdj_plugin_dsp_create();
+    vdj_plugin_dsp_init(dsp, &stubCallbacks);
+    VDJ_CHECK(vdj_plugin_dsp_set_silence_bypass(dsp, 2, 0.0f, VDJFLAG_PROCESSAFTERSTOP) == S_OK);
+    vdj_plugin_dsp_on_start(dsp);
+
+    std::vector<float> block = Silence();
+    VDJ_CHECK(vdj_plugin_dsp_on_process_samples(dsp, block.data(), blockFrames) == S_OK);
+    VDJ_CHECK(vdj_plugin_dsp_is_idle(dsp) == 0);
+    VDJ_CHECK(vdj_plugin_dsp_on_process_samples(dsp, block.data(), blockFrames) != S_OK);
+    VDJ_CHECK(vdj_plugin_dsp_is_idle(dsp) == 1);
+
+    block[1] = 0.25f;
+    VDJ_CHECK(vdj_plugin_dsp_on_process_samples(dsp, block.data(), blockFrames) == S_OK);
+    VDJ_CHECK(vdj_plugin_dsp_is_idle(dsp) == 0);
+    vdj_plugin_dsp_release(dsp);
+}
+
+int main() {
+    CheckBlocks();
+    CheckTail();
+    CheckThreshold();
+    CheckInstance();
+    return CheckResult("silence_gate");
+}
@@ -5,14 +5,33 @@
  * from the VirtualDJ SDK. It bridges the gap between C++ and C/Rust FFI.
  */
 
-#include "../abi/vdj_plugin_abi.h"
-#include "../header_ref/vdjPlugin8.h"
+// The SDK's video header goes before the C ABI, which then reuses its
+// EVdjVideoEngine instead of declaring a clashing one
+#include "vdj_sdk.h"
 #include "../header_ref/vdjDsp8.h"
 #include "../header_ref/vdjVideo8.h"
 #include "../header_ref/vdjOnlineSource.h"
-
+#include "../abi/vdj_plugin_abi.h"
+#include "beat_grid.h"
+#include "fast_math.h"
+#include "lut.h"
+#include "param_ramp.h"
+#include "param_snapshot.h"
+#include "position_pattern.h"
+#include "replay_recorder.h"
+#include "resampler.h"
+#include "rt_check.h"
+#include "rt_log.h"
+#include "sample_convert.h"
+#include "scratch_arena.h"
+#include "shim_instance.h"
+#include "silence_gate.h"
+
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <memory>
+#include <new>
 
 /* ============================================================================
    Internal Plugin Wrapper Classes
@@ -21,7 +40,7 @@
 /**
  * Wrapper around IVdjPlugin8 that stores Rust callbacks
  */
-struct VdjPluginWrapper : public IVdjPlugin8 {
+struct VdjPluginWrapper : public IVdjPlugin8, public VdjShimInstance {
     HRESULT VDJ_API OnLoad() override { return S_OK; }
     
     HRESULT VDJ_API OnGetPluginInfo(TVdjPluginInfo8 *info) override { 
@@ -50,7 +69,7 @@ struct VdjPluginWrapper : public IVdjPlugin8 {
 /**
  * Wrapper around IVdjPluginDsp8
  */
-struct VdjPluginDspWrapper : public IVdjPluginDsp8 {
+struct VdjPluginDspWrapper : public IVdjPluginDsp8, public VdjShimInstance {
     HRESULT VDJ_API OnLoad() override { return S_OK; }
     
     HRESULT VDJ_API OnGetPluginInfo(TVdjPluginInfo8 *info) override { 
@@ -75,17 +94,31 @@ struct VdjPluginDspWrapper : public IVdjPluginDsp8 {
         return E_NOTIMPL; 
     }
     
-    HRESULT VDJ_API OnStart() override { return S_OK; }
+    HRESULT VDJ_API OnStart() override {
+        silenceGate.Reset();
+        return S_OK;
+    }
     
     HRESULT VDJ_API OnStop() override { return S_OK; }
     
-    HRESULT VDJ_API OnProcessSamples(float *buffer, int nb) override { return S_OK; }
+    HRESULT VDJ_API OnProcessSamples(float *buffer, int nb) override {
+        if (silenceGate.Process(buffer, nb, SampleRate)) {
+            return silenceGate.processAfterStop ? E_FAIL : S_OK;
+        }
+        beatGrid.Compute(SongPosBeats, SongBpm, nb);
+        paramRamps.Process(SampleRate, nb);
+        return S_OK;
+    }
+    
+    VdjBeatGrid beatGrid;
+    VdjParamRamps paramRamps;
+    VdjSilenceGate silenceGate;
 };
 
 /**
  * Wrapper around IVdjPluginBufferDsp8
  */
-struct VdjPluginBufferDspWrapper : public IVdjPluginBufferDsp8 {
+struct VdjPluginBufferDspWrapper : public IVdjPluginBufferDsp8, public VdjShimInstance {
     HRESULT VDJ_API OnLoad() override { return S_OK; }
     
     HRESULT VDJ_API OnGetPluginInfo(TVdjPluginInfo8 *info) override { 
@@ -120,7 +153,7 @@ struct VdjPluginBufferDspWrapper : public IVdjPluginBufferDsp8 {
 /**
  * Wrapper around IVdjPluginPositionDsp8
  */
-struct VdjPluginPositionDspWrapper : public IVdjPluginPositionDsp8 {
+struct VdjPluginPositionDspWrapper : public IVdjPluginPositionDsp8, public VdjShimInstance {
     HRESULT VDJ_API OnLoad() override { return S_OK; }
     
     HRESULT VDJ_API OnGetPluginInfo(TVdjPluginInfo8 *info) override { 
@@ -150,16 +183,19 @@ struct VdjPluginPositionDspWrapper : public IVdjPluginPositionDsp8 {
     HRESULT VDJ_API OnStop() override { return S_OK; }
     
     HRESULT VDJ_API OnTransformPosition(double *songPos, double *videoPos, float *volume, float *srcVolume) override { 
+        pattern.Transform(songPos, videoPos, volume, SongPos, SongPosBeats, SongBpm);
         return S_OK; 
     }
     
     HRESULT VDJ_API OnProcessSamples(float *buffer, int nb) override { return S_OK; }
+    
+    VdjPositionPattern pattern;
 };
 
 /**
  * Wrapper around IVdjPluginVideoFx8
  */
-struct VdjPluginVideoFxWrapper : public IVdjPluginVideoFx8 {
+struct VdjPluginVideoFxWrapper : public IVdjPluginVideoFx8, public VdjShimInstance {
     HRESULT VDJ_API OnLoad() override { return S_OK; }
     
     HRESULT VDJ_API OnGetPluginInfo(TVdjPluginInfo8 *info) override { 
@@ -200,7 +236,7 @@ struct VdjPluginVideoFxWrapper : public IVdjPluginVideoFx8 {
 /**
  * Wrapper around IVdjPluginVideoTransition8
  */
-struct VdjPluginVideoTransitionWrapper : public IVdjPluginVideoTransition8 {
+struct VdjPluginVideoTransitionWrapper : public IVdjPluginVideoTransition8, public VdjShimInstance {
     HRESULT VDJ_API OnLoad() override { return S_OK; }
     
     HRESULT VDJ_API OnGetPluginInfo(TVdjPluginInfo8 *info) override { 
@@ -235,7 +271,7 @@ struct VdjPluginVideoTransitionWrapper : public IVdjPluginVideoTransition8 {
 /**
  * Wrapper around IVdjPluginOnlineSource
  */
-struct VdjPluginOnlineSourceWrapper : public IVdjPluginOnlineSource {
+struct VdjPluginOnlineSourceWrapper : public IVdjPluginOnlineSource, public VdjShimInstance {
     HRESULT VDJ_API OnLoad() override { return S_OK; }
     
     HRESULT VDJ_API OnGetPluginInfo(TVdjPluginInfo8 *info) override { 
@@ -307,6 +343,116 @@ struct VdjPluginOnlineSourceWrapper : public IVdjPluginOnlineSource {
     }
 };
 
+/* ============================================================================
+   Host Callbacks Adapter
+   ============================================================================ */
+
+/**
+ * Exposes the C callbacks as the IVdjCallbacks8 the VirtualDJ interfaces
+ * expect, recording host queries and parameter storage for the recorder
+ */
+struct VdjCallbacksAdapter final : public IVdjCallbacks8 {
+    const VdjCallbacks *c_callbacks;
+    VdjPlugin *plugin;
+
+    HRESULT SendCommand(const char *command) override {
+        return c_callbacks->send_command(plugin, command);
+    }
+    HRESULT GetInfo(const char *command, double *result) override {
+        HRESULT hr = c_callbacks->get_info(plugin, command, result);
+        if (VdjGetShimInstance(plugin)->Recorded() && command) {
+            VdjReplayQuery q = {};
+            q.hr = hr;
+            q.command_size = (uint32_t)strlen(command);
+            q.value = result ? *result : 0.0;
+            VdjReplayRecord(VDJ_REPLAY_GET_INFO, &q, sizeof(q), command, q.command_size);
+        }
+        return hr;
+    }
+    HRESULT GetStringInfo(const char *command, void *result, int size) override {
+        HRESULT hr = c_callbacks->get_string_info(plugin, command, (char*)result, size);
+        if (VdjGetShimInstance(plugin)->Recorded() && command) {
+            // Command and result go in one buffer so the record is a single write
+            char text[1024];
+            VdjReplayQuery q = {};
+            q.hr = hr;
+            q.command_size = (uint32_t)std::min(strlen(command), sizeof(text) / 2);
+            memcpy(text, command, q.command_size);
+            if (result && size > 0) {
+                q.result_size = (uint32_t)std::min(strnlen((const char*)result, (size_t)size), sizeof(text) / 2);
+                memcpy(text + q.command_size, result, q.result_size);
+            }
+            VdjReplayRecord(VDJ_REPLAY_GET_STRING_INFO, &q, sizeof(q), text, q.command_size + q.result_size);
+        }
+        return hr;
+    }
+    HRESULT DeclareParameter(void *parameter, int type, int id, const char *name,
+                            const char *shortName, float defaultvalue) override {
+        VdjGetShimInstance(plugin)->replayParameters.Declare(parameter, type, id, defaultvalue);
+        return c_callbacks->declare_parameter(plugin, parameter, type, id, name, shortName, defaultvalue);
+    }
+    HRESULT GetSongBuffer(int pos, int nb, short **buffer) override {
+        HRESULT hr = c_callbacks->get_song_buffer(plugin, pos, nb, buffer);
+        if (VdjGetShimInstance(plugin)->Recorded()) {
+            VdjReplaySongAudio audio = {};
+            audio.hr = hr;
+            audio.pos = pos;
+            audio.nb = nb;
+            const short *samples = (hr == S_OK && buffer) ? *buffer : nullptr;
+            const uint64_t bytes = (samples && nb > 0) ? (uint64_t)nb * 2 * sizeof(short) : 0;
+            // A block too large for a record is dropped by the recorder
+            VdjReplayRecord(VDJ_REPLAY_SONG_AUDIO, &audio, sizeof(audio), samples,
+                            (uint32_t)std::min<uint64_t>(bytes, UINT32_MAX));
+        }
+        return hr;
+    }
+};
+
+/**
+ * Exposes the C video callbacks as IVdjVideoCallbacks8
+ */
+struct VdjVideoCallbacksAdapter final : public IVdjVideoCallbacks8 {
+    const VdjVideoCallbacks *c_callbacks;
+    VdjPlugin *plugin;
+
+    HRESULT DrawDeck() override {
+        return c_callbacks->draw_deck(plugin);
+    }
+    HRESULT GetDevice(EVdjVideoEngine engine, void **device) override {
+        return c_callbacks->get_device(plugin, engine, device);
+    }
+    HRESULT GetTexture(EVdjVideoEngine engine, void **texture, TVertex **vertices) override {
+        return c_callbacks->get_texture(plugin, engine, texture, reinterpret_cast<void**>(vertices));
+    }
+};
+
+/**
+ * Delete a wrapper, then the callbacks adapter its init created. The adapter
+ * goes last: the command dispatcher may call SendCommand until the wrapper's
+ * queue is destroyed.
+ */
+template <typename Interface>
+static void ReleaseWrapper(Interface *p) {
+    IVdjCallbacks8 *callbacks = p->cb;
+    delete p;
+    delete static_cast<VdjCallbacksAdapter*>(callbacks);
+}
+
+/**
+ * Record a block's inputs (and samples, when given) for the recorder
+ */
+template <typename Plugin>
+static void RecordBlock(const Plugin &p, int kind, int songPos, const float *buffer, int nb) {
+    VdjReplayBlock block = {};
+    block.nb = nb;
+    block.sample_rate = p.SampleRate;
+    block.song_bpm = p.SongBpm;
+    block.song_pos = songPos;
+    block.song_pos_beats = p.SongPosBeats;
+    const uint32_t samples = (buffer && nb > 0) ? (uint32_t)nb * 2 * sizeof(float) : 0;
+    VdjReplayRecord(kind, &block, sizeof(block), buffer, samples);
+}
+
 /* ============================================================================
    Core Plugin C ABI Functions
    ============================================================================ */
@@ -320,7 +466,7 @@ VdjPlugin* vdj_plugin_create(void) {
 void vdj_plugin_release(VdjPlugin *plugin) {
     if (plugin) {
         IVdjPlugin8 *p = reinterpret_cast<IVdjPlugin8*>(plugin);
-        delete p;
+        ReleaseWrapper(p);
     }
 }
 
@@ -329,46 +475,26 @@ HRESULT vdj_plugin_init(VdjPlugin *plugin, const VdjCallbacks *callbacks) {
     
     IVdjPlugin8 *p = reinterpret_cast<IVdjPlugin8*>(plugin);
     
-    // Create a simple IVdjCallbacks8 adapter
-    struct CallbacksAdapter : public IVdjCallbacks8 {
-        const VdjCallbacks *c_callbacks;
-        VdjPlugin *plugin;
-        
-        HRESULT SendCommand(const char *command) override {
-            return c_callbacks->send_command(plugin, command);
-        }
-        HRESULT GetInfo(const char *command, double *result) override {
-            return c_callbacks->get_info(plugin, command, result);
-        }
-        HRESULT GetStringInfo(const char *command, void *result, int size) override {
-            return c_callbacks->get_string_info(plugin, command, (char*)result, size);
-        }
-        HRESULT DeclareParameter(void *parameter, int type, int id, const char *name, 
-                                const char *shortName, float defaultvalue) override {
-            return c_callbacks->declare_parameter(plugin, parameter, type, id, name, shortName, defaultvalue);
-        }
-        HRESULT GetSongBuffer(int pos, int nb, short **buffer) override {
-            return c_callbacks->get_song_buffer(plugin, pos, nb, buffer);
-        }
-    };
-    
-    CallbacksAdapter *adapter = new CallbacksAdapter();
+    VdjCallbacksAdapter *adapter = new VdjCallbacksAdapter();
     adapter->c_callbacks = callbacks;
     adapter->plugin = plugin;
     p->cb = adapter;
     
+    VdjCallbackScope scope(*VdjGetShimInstance(plugin), VDJ_PROFILE_LOAD, __func__);
     return p->OnLoad();
 }
 
 HRESULT vdj_plugin_on_load(VdjPlugin *plugin) {
     if (!plugin) return E_FAIL;
     IVdjPlugin8 *p = reinterpret_cast<IVdjPlugin8*>(plugin);
+    VdjCallbackScope scope(*VdjGetShimInstance(plugin), VDJ_PROFILE_LOAD, __func__);
     return p->OnLoad();
 }
 
 HRESULT vdj_plugin_get_info(VdjPlugin *plugin, VdjPluginInfo *info) {
     if (!plugin || !info) return E_FAIL;
     IVdjPlugin8 *p = reinterpret_cast<IVdjPlugin8*>(plugin);
+    VdjCallbackScope scope(*VdjGetShimInstance(plugin), VDJ_PROFILE_LOAD, __func__);
     
     TVdjPluginInfo8 cpp_info = {};
     HRESULT hr = p->OnGetPluginInfo(&cpp_info);
@@ -386,12 +512,22 @@ HRESULT vdj_plugin_get_info(VdjPlugin *plugin, VdjPluginInfo *info) {
 HRESULT vdj_plugin_on_parameter(VdjPlugin *plugin, int id) {
     if (!plugin) return E_FAIL;
     IVdjPlugin8 *p = reinterpret_cast<IVdjPlugin8*>(plugin);
+    VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    VdjCallbackScope scope(*instance, VDJ_PROFILE_PARAMETER, __func__);
+    // Parameter changes come from the UI thread: grow the scratch arena to
+    // what the audio callbacks asked for so far
+    instance->scratch.Reserve(0);
+    if (instance->Recorded()) {
+        const VdjReplayParameter r = instance->replayParameters.Read(id);
+        VdjReplayRecord(VDJ_REPLAY_PARAMETER, &r, sizeof(r));
+    }
     return p->OnParameter(id);
 }
 
 HRESULT vdj_plugin_on_get_parameter_string(VdjPlugin *plugin, int id, char *out_param, int out_param_size) {
     if (!plugin) return E_FAIL;
     IVdjPlugin8 *p = reinterpret_cast<IVdjPlugin8*>(plugin);
+    VdjCallbackScope scope(*VdjGetShimInstance(plugin), VDJ_PROFILE_PARAMETER, __func__);
     return p->OnGetParameterString(id, out_param, out_param_size);
 }
 
@@ -406,7 +542,7 @@ VdjPluginDsp* vdj_plugin_dsp_create(void) {
 void vdj_plugin_dsp_release(VdjPluginDsp *plugin) {
     if (plugin) {
         IVdjPluginDsp8 *p = reinterpret_cast<IVdjPluginDsp8*>(plugin);
-        delete p;
+        ReleaseWrapper(p);
     }
 }
 
@@ -415,29 +551,7 @@ HRESULT vdj_plugin_dsp_init(VdjPluginDsp *plugin, const VdjCallbacks *callbacks)
     
     IVdjPluginDsp8 *p = reinterpret_cast<IVdjPluginDsp8*>(plugin);
     
-    struct CallbacksAdapter : public IVdjCallbacks8 {
-        const VdjCallbacks *c_callbacks;
-        VdjPlugin *plugin;
-        
-        HRESULT SendCommand(const char *command) override {
-            return c_callbacks->send_command(plugin, command);
-        }
-        HRESULT GetInfo(const char *command, double *result) override {
-            return c_callbacks->get_info(plugin, command, result);
-        }
-        HRESULT GetStringInfo(const char *command, void *result, int size) override {
-            return c_callbacks->get_string_info(plugin, command, (char*)result, size);
-        }
-        HRESULT DeclareParameter(void *parameter, int type, int id, const char *name, 
-                                const char *shortName, float defaultvalue) override {
-            return c_callbacks->declare_parameter(plugin, parameter, type, id, name, shortName, defaultvalue);
-        }
-        HRESULT GetSongBuffer(int pos, int nb, short **buffer) override {
-            return c_callbacks->get_song_buffer(plugin, pos, nb, buffer);
-        }
-    };
-    
-    CallbacksAdapter *adapter = new CallbacksAdapter();
+    VdjCallbacksAdapter *adapter = new VdjCallbacksAdapter();
     adapter->c_callbacks = callbacks;
     adapter->plugin = reinterpret_cast<VdjPlugin*>(plugin);
     p->cb = adapter;
@@ -447,25 +561,38 @@ HRESULT vdj_plugin_dsp_init(VdjPluginDsp *plugin, const VdjCallbacks *callbacks)
 
 HRESULT vdj_plugin_dsp_on_start(VdjPluginDsp *plugin) {
     if (!plugin) return E_FAIL;
-    IVdjPluginDsp8 *p = reinterpret_cast<IVdjPluginDsp8*>(plugin);
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_START, __func__);
+    p->scratch.Reserve(0);
+    if (p->Recorded()) VdjReplayRecord(VDJ_REPLAY_START, nullptr, 0);
     return p->OnStart();
 }
 
 HRESULT vdj_plugin_dsp_on_stop(VdjPluginDsp *plugin) {
     if (!plugin) return E_FAIL;
-    IVdjPluginDsp8 *p = reinterpret_cast<IVdjPluginDsp8*>(plugin);
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_STOP, __func__);
+    if (p->Recorded()) VdjReplayRecord(VDJ_REPLAY_STOP, nullptr, 0);
     return p->OnStop();
 }
 
 HRESULT vdj_plugin_dsp_on_process_samples(VdjPluginDsp *plugin, float *buffer, int nb) {
     if (!plugin) return E_FAIL;
-    IVdjPluginDsp8 *p = reinterpret_cast<IVdjPluginDsp8*>(plugin);
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_PROCESS_SAMPLES, __func__, nb, p->SampleRate);
+    VdjRealtimeScope realtime;
+    VdjScratchScope scratchBlock(p->scratch);
+    p->presets.BeginBlock(p->replayParameters);
+    p->morph.BeginBlock();
+    p->sharedBlobs.BeginBlock();
+    if (p->Recorded()) RecordBlock(*p, VDJ_REPLAY_PROCESS_SAMPLES, 0, buffer, nb);
     return p->OnProcessSamples(buffer, nb);
 }
 
 HRESULT vdj_plugin_dsp_get_info(VdjPluginDsp *plugin, VdjPluginInfo *info) {
     if (!plugin || !info) return E_FAIL;
-    IVdjPluginDsp8 *p = reinterpret_cast<IVdjPluginDsp8*>(plugin);
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_LOAD, __func__);
     
     TVdjPluginInfo8 cpp_info = {};
     HRESULT hr = p->OnGetPluginInfo(&cpp_info);
@@ -498,6 +625,466 @@ double vdj_plugin_dsp_get_song_pos_beats(VdjPluginDsp *plugin) {
     return p->SongPosBeats;
 }
 
+/* ============================================================================
+   DSP Beat Grid Events C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_dsp_set_beat_grid(VdjPluginDsp *plugin, int beats_per_bar, int subdivisions) {
+    if (!plugin || beats_per_bar <= 0 || subdivisions <= 0) return E_FAIL;
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    p->beatGrid.beatsPerBar = beats_per_bar;
+    p->beatGrid.subdivisions = subdivisions;
+    return S_OK;
+}
+
+const VdjBeatEvent* vdj_plugin_dsp_get_beat_events(VdjPluginDsp *plugin, int *count) {
+    if (!plugin) {
+        if (count) *count = 0;
+        return nullptr;
+    }
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    if (count) *count = p->beatGrid.count;
+    return p->beatGrid.events;
+}
+
+/* ============================================================================
+   DSP Parameter Smoothing Ramps C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_dsp_declare_smoothed_parameter(VdjPluginDsp *plugin, int id, const float *parameter,
+                                                  int mode, float time_ms) {
+    if (!plugin || !parameter) return E_FAIL;
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    return p->paramRamps.Declare(id, parameter, mode, time_ms);
+}
+
+HRESULT vdj_plugin_dsp_get_parameter_ramp(VdjPluginDsp *plugin, int id, VdjParamRamp *ramp) {
+    if (!plugin || !ramp) return E_FAIL;
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    const VdjParamSmoother *s = p->paramRamps.Find(id);
+    if (!s) return E_FAIL;
+    *ramp = s->ramp;
+    return S_OK;
+}
+
+/* ============================================================================
+   DSP Silence Bypass C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_dsp_set_silence_bypass(VdjPluginDsp *plugin, int silent_blocks, float tail_ms, uint32_t plugin_flags) {
+    if (!plugin || silent_blocks < 0 || tail_ms < 0.0f) return E_FAIL;
+    VdjPluginDspWrapper *p = reinterpret_cast<VdjPluginDspWrapper*>(plugin);
+    p->silenceGate.silentBlocks = silent_blocks;
+    p->silenceGate.tailMs = tail_ms;
+    p->silenceGate.processAfterStop = (plugin_flags & VDJFLAG_PROCESSAFTERSTOP) != 0;
+    p->silenceGate.Reset();
+    return S_OK;
+}
+
+int vdj_plugin_dsp_is_idle(VdjPluginDsp *plugin) {
+    if (!plugin) return 0;
+    return reinterpret_cast<VdjPluginDspWrapper*>(plugin)->silenceGate.idle.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+/* ============================================================================
+   Callback Latency Histograms C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_set_profiling(VdjPlugin *plugin, int enabled) {
+    VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    if (!instance) return E_FAIL;
+    return instance->profiler.Enable(enabled != 0);
+}
+
+HRESULT vdj_plugin_get_latency_stats(VdjPlugin *plugin, int callback, VdjLatencyStats *stats) {
+    VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    if (!instance) return E_FAIL;
+    return instance->profiler.GetStats(callback, stats);
+}
+
+HRESULT vdj_plugin_reset_latency_stats(VdjPlugin *plugin) {
+    VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    if (!instance) return E_FAIL;
+    return instance->profiler.Reset();
+}
+
+HRESULT vdj_plugin_dump_latency_histograms(VdjPlugin *plugin, const char *path) {
+    VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    if (!instance) return E_FAIL;
+    return instance->profiler.Dump(path);
+}
+
+/* ============================================================================
+   Callback Trace Recorder C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_trace_start(const char *path) {
+    return VdjTraceStart(path);
+}
+
+HRESULT vdj_plugin_trace_stop(void) {
+    return VdjTraceStop();
+}
+
+uint64_t vdj_plugin_trace_dropped_spans(void) {
+    return VdjTraceDroppedSpans();
+}
+
+uint32_t vdj_plugin_get_instance_id(VdjPlugin *plugin) {
+    VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    return instance ? instance->instanceId : 0;
+}
+
+/* ============================================================================
+   Realtime-Safety Checker C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_rt_check_enable(int enabled, uint32_t flags) {
+    return VdjRtCheckEnable(enabled != 0, flags);
+}
+
+void vdj_plugin_rt_enter(void) {
+    VdjRtEnter();
+}
+
+void vdj_plugin_rt_leave(void) {
+    VdjRtLeave();
+}
+
+void vdj_plugin_rt_report_violation(int kind) {
+    VdjRtViolation(kind);
+}
+
+HRESULT vdj_plugin_rt_check_get_violations(VdjRtViolations *violations) {
+    return VdjRtCheckGetViolations(violations);
+}
+
+HRESULT vdj_plugin_rt_check_reset(void) {
+    return VdjRtCheckReset();
+}
+
+HRESULT vdj_plugin_rt_check_dump(const char *path) {
+    return VdjRtCheckDump(path);
+}
+
+/* ============================================================================
+   Realtime-Safe Logger C ABI Functions
+   ============================================================================ */
+
+int vdj_plugin_log_register_format(const char *format) {
+    return VdjLogRegisterFormat(format);
+}
+
+HRESULT vdj_plugin_log_open(const char *path, int max_level) {
+    return VdjLogOpen(path, max_level);
+}
+
+HRESULT vdj_plugin_log_close(void) {
+    return VdjLogClose();
+}
+
+HRESULT vdj_plugin_log_write(int level, int format_id, const VdjLogArg *args, int arg_count) {
+    return VdjLogWrite(level, format_id, args, arg_count);
+}
+
+uint64_t vdj_plugin_log_dropped_records(void) {
+    return VdjLogDroppedRecords();
+}
+
+/* ============================================================================
+   Deferred Command Queue C ABI Functions
+   ============================================================================ */
+
+int vdj_plugin_intern_command(VdjPlugin *plugin, const char *command) {
+    if (!plugin || !command) return -1;
+    return VdjGetShimInstance(plugin)->commands.Intern(reinterpret_cast<IVdjPlugin8*>(plugin), command);
+}
+
+HRESULT vdj_plugin_queue_command(VdjPlugin *plugin, int command_id) {
+    if (!plugin) return E_FAIL;
+    return VdjGetShimInstance(plugin)->commands.Enqueue(command_id);
+}
+
+HRESULT vdj_plugin_flush_commands(VdjPlugin *plugin) {
+    if (!plugin) return E_FAIL;
+    VdjGetShimInstance(plugin)->commands.Flush();
+    return S_OK;
+}
+
+HRESULT vdj_plugin_get_command_stats(VdjPlugin *plugin, VdjCommandStats *stats) {
+    if (!plugin || !stats) return E_FAIL;
+    VdjGetShimInstance(plugin)->commands.GetStats(stats);
+    return S_OK;
+}
+
+/* ============================================================================
+   Callback Recorder C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_replay_record_start(VdjPlugin *plugin, const char *path) {
+    if (!plugin || !path) return E_FAIL;
+    return VdjReplayStart(VdjGetShimInstance(plugin)->instanceId, path);
+}
+
+HRESULT vdj_plugin_replay_record_stop(void) {
+    return VdjReplayStop();
+}
+
+uint64_t vdj_plugin_replay_dropped_records(void) {
+    return VdjReplayDroppedRecords();
+}
+
+/* ============================================================================
+   Instance Memory C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_reserve_state(VdjPlugin *plugin, uint64_t bytes, uint32_t flags, void **region) {
+    if (!plugin || !region || bytes == 0 || bytes > SIZE_MAX) return E_FAIL;
+    VdjStateRegion &state = VdjGetShimInstance(plugin)->state;
+    if (!state.Reserve((size_t)bytes, (flags & VDJ_STATE_LOCK) != 0)) return E_FAIL;
+    *region = state.base;
+    return (flags & VDJ_STATE_LOCK) && !state.lockedBytes ? S_FALSE : S_OK;
+}
+
+HRESULT vdj_plugin_get_memory_stats(VdjPlugin *plugin, VdjMemoryStats *stats) {
+    if (!plugin || !stats) return E_FAIL;
+    const VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    stats->instance_bytes = VdjInstanceBytes(dynamic_cast<const void*>(instance));
+    stats->state_bytes = instance->state.bytes;
+    stats->locked_bytes = instance->state.lockedBytes;
+
+    // The facilities allocate on first use and keep their buffers until release
+    uint64_t facilities = 0;
+    if (instance->profiler.histograms.load(std::memory_order_acquire)) {
+        facilities += VDJ_PROFILE_CALLBACK_COUNT * sizeof(VdjLatencyHistogram);
+    }
+    const int commandCount = instance->commands.commandCount.load(std::memory_order_acquire);
+    if (commandCount > 0) facilities += VDJ_COMMAND_QUEUE_SIZE * sizeof(VdjCommandSlot);
+    facilities += instance->scratch.reservedBytes.load(std::memory_order_relaxed);
+    for (int i = 0; i < commandCount; i++) {
+        facilities += strlen(instance->commands.commands[i].load(std::memory_order_relaxed)) + 1;
+    }
+    stats->facility_bytes = facilities;
+    return S_OK;
+}
+
+/* ============================================================================
+   Scratch Arena C ABI Functions
+   ============================================================================ */
+
+VdjScratchArena* vdj_plugin_get_scratch(VdjPlugin *plugin) {
+    if (!plugin) return nullptr;
+    return &VdjGetShimInstance(plugin)->scratch.arena;
+}
+
+HRESULT vdj_plugin_reserve_scratch(VdjPlugin *plugin, uint64_t bytes) {
+    if (!plugin) return E_FAIL;
+    return VdjGetShimInstance(plugin)->scratch.Reserve(bytes) ? S_OK : E_FAIL;
+}
+
+/* ============================================================================
+   Parameter Snapshot C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_save_snapshot(VdjPlugin *plugin, const void *opaque, uint64_t opaque_size,
+                                 void *out, uint64_t capacity, uint64_t *size) {
+    if (!plugin || !size || (!opaque && opaque_size)) return E_FAIL;
+    const VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    *size = VdjSnapshotWrite(instance->replayParameters, opaque, opaque_size, out, capacity);
+    return out && capacity >= *size ? S_OK : S_FALSE;
+}
+
+HRESULT vdj_plugin_stage_snapshot(VdjPlugin *plugin, const void *data, uint64_t size) {
+    if (!plugin) return E_FAIL;
+    return VdjGetShimInstance(plugin)->presets.Stage(data, size) ? S_OK : E_FAIL;
+}
+
+HRESULT vdj_plugin_applied_snapshot(VdjPlugin *plugin, const void **data, uint64_t *size) {
+    if (!plugin || !data || !size) return E_FAIL;
+    const VdjPresetSwap &presets = VdjGetShimInstance(plugin)->presets;
+    if (!presets.fresh) return S_FALSE;
+    VdjSnapshotHeader header;
+    memcpy(&header, presets.applied, sizeof(header));
+    *data = presets.applied;
+    *size = header.total_size;
+    return S_OK;
+}
+
+/* ============================================================================
+   Preset Morph C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_set_morph(VdjPlugin *plugin, int position_id, const void *const *snapshots,
+                             const uint64_t *sizes, int count) {
+    if (!plugin) return E_FAIL;
+    VdjShimInstance *instance = VdjGetShimInstance(plugin);
+    return instance->morph.Set(instance->replayParameters, position_id, snapshots, sizes, count) ? S_OK : E_FAIL;
+}
+
+HRESULT vdj_plugin_get_morph_changes(VdjPlugin *plugin, VdjMorphChanges *changes) {
+    if (!plugin || !changes) return E_FAIL;
+    *changes = VdjGetShimInstance(plugin)->morph.Changes();
+    return changes->count > 0 ? S_OK : S_FALSE;
+}
+
+/* ============================================================================
+   Shared Parameter Blob C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_set_shared_blob(VdjPlugin *plugin, int id, const void *data, uint64_t size) {
+    if (!plugin || (!data && size)) return E_FAIL;
+    return VdjGetShimInstance(plugin)->sharedBlobs.Set(id, data, size);
+}
+
+HRESULT vdj_plugin_edit_shared_blob(VdjPlugin *plugin, int id, uint64_t offset, const void *data,
+                                    uint64_t size) {
+    if (!plugin || (!data && size)) return E_FAIL;
+    return VdjGetShimInstance(plugin)->sharedBlobs.Edit(id, offset, data, size);
+}
+
+HRESULT vdj_plugin_get_shared_blob(VdjPlugin *plugin, int id, const void **data, uint64_t *size) {
+    if (!plugin || !data || !size) return E_FAIL;
+    const VdjBlob *blob = VdjGetShimInstance(plugin)->sharedBlobs.Get(id);
+    if (!blob) return S_FALSE;
+    *data = blob->Data();
+    *size = blob->size;
+    return S_OK;
+}
+
+HRESULT vdj_plugin_get_shared_blob_stats(VdjSharedBlobStats *stats) {
+    if (!stats) return E_FAIL;
+    VdjBlobGetStats(stats);
+    return S_OK;
+}
+
+/* ============================================================================
+   Lookup Table C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_lut_get(int table, VdjLut *lut) {
+    const VdjLut *found = VdjLutFind(table);
+    if (!found || !lut) return E_FAIL;
+    *lut = *found;
+    return S_OK;
+}
+
+HRESULT vdj_lut_lookup(int table, const float *in, float *out, int count) {
+    const VdjLut *lut = VdjLutFind(table);
+    if (!lut || (count > 0 && (!in || !out))) return E_FAIL;
+    VdjLutLookupBlock(*lut, in, out, count);
+    return S_OK;
+}
+
+/* ============================================================================
+   Fast Math C ABI Functions
+   ============================================================================ */
+
+static HRESULT MathUnary(VdjMathUnary const (&kernels)[2], const float *in, float *out, int count, int tier) {
+    if (tier != VDJ_MATH_FAST && tier != VDJ_MATH_PRECISE) return E_FAIL;
+    if (count <= 0) return S_OK;
+    if (!in || !out) return E_FAIL;
+    kernels[tier](in, out, count);
+    return S_OK;
+}
+
+HRESULT vdj_math_exp(const float *in, float *out, int count, int tier) {
+    return MathUnary(VdjMathActive().exp, in, out, count, tier);
+}
+
+HRESULT vdj_math_log(const float *in, float *out, int count, int tier) {
+    return MathUnary(VdjMathActive().log, in, out, count, tier);
+}
+
+HRESULT vdj_math_sin(const float *in, float *out, int count, int tier) {
+    return MathUnary(VdjMathActive().sin, in, out, count, tier);
+}
+
+HRESULT vdj_math_tanh(const float *in, float *out, int count, int tier) {
+    return MathUnary(VdjMathActive().tanh, in, out, count, tier);
+}
+
+HRESULT vdj_math_pow(const float *base, const float *exponent, float *out, int count, int tier) {
+    if (tier != VDJ_MATH_FAST && tier != VDJ_MATH_PRECISE) return E_FAIL;
+    if (count <= 0) return S_OK;
+    if (!base || !exponent || !out) return E_FAIL;
+    VdjMathActive().pow[tier](base, exponent, out, count);
+    return S_OK;
+}
+
+HRESULT vdj_math_get_info(VdjMathInfo *info) {
+    if (!info) return E_FAIL;
+    const VdjMathKernels &kernels = VdjMathActive();
+    info->isa = kernels.isa;
+    info->width = kernels.width;
+    return S_OK;
+}
+
+HRESULT vdj_math_select_isa(int isa) {
+    return VdjMathSelect(isa) ? S_OK : E_FAIL;
+}
+
+/* ============================================================================
+   Sample Conversion C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_dither_init(VdjDither *dither, uint32_t seed) {
+    if (!dither) return E_FAIL;
+    VdjDitherInit(dither, seed);
+    return S_OK;
+}
+
+HRESULT vdj_convert_int16_to_float(const int16_t *in, float *out, int count) {
+    if (count <= 0) return S_OK;
+    if (!in || !out) return E_FAIL;
+    VdjInt16ToFloat(in, out, count);
+    return S_OK;
+}
+
+HRESULT vdj_convert_float_to_int16(const float *in, int16_t *out, int count, VdjDither *dither) {
+    if (count <= 0) return S_OK;
+    if (!in || !out) return E_FAIL;
+    VdjFloatToInt16(in, out, count, dither);
+    return S_OK;
+}
+
+/* ============================================================================
+   Resampler C ABI Functions
+   ============================================================================ */
+
+VdjResampler* vdj_resampler_create(int max_frames) {
+    VdjResampler *resampler = new (std::nothrow) VdjResampler();
+    if (resampler && !resampler->Init(max_frames)) {
+        delete resampler;
+        return nullptr;
+    }
+    return resampler;
+}
+
+void vdj_resampler_release(VdjResampler *resampler) {
+    delete resampler;
+}
+
+HRESULT vdj_resampler_set_position(VdjResampler *resampler, double frame) {
+    if (!resampler || !std::isfinite(frame)) return E_FAIL;
+    resampler->position = frame;
+    return S_OK;
+}
+
+double vdj_resampler_get_position(const VdjResampler *resampler) {
+    return resampler ? resampler->position : 0.0;
+}
+
+static HRESULT FetchSongBuffer(void *context, int pos, int nb, short **buffer) {
+    return static_cast<IVdjPluginBufferDsp8*>(context)->GetSongBuffer(pos, nb, buffer);
+}
+
+HRESULT vdj_resampler_process_song(VdjResampler *resampler, VdjPluginBufferDsp *plugin, float ratio_start,
+                                   float ratio_end, float *out, int nb) {
+    if (!resampler || !plugin || !out || nb < 0) return E_FAIL;
+    return resampler->Process(FetchSongBuffer, reinterpret_cast<IVdjPluginBufferDsp8*>(plugin),
+                              ratio_start, ratio_end, out, nb);
+}
+
 /* ============================================================================
    Buffer DSP Plugin C ABI Functions
    ============================================================================ */
@@ -509,7 +1096,7 @@ VdjPluginBufferDsp* vdj_plugin_buffer_dsp_create(void) {
 void vdj_plugin_buffer_dsp_release(VdjPluginBufferDsp *plugin) {
     if (plugin) {
         IVdjPluginBufferDsp8 *p = reinterpret_cast<IVdjPluginBufferDsp8*>(plugin);
-        delete p;
+        ReleaseWrapper(p);
     }
 }
 
@@ -518,29 +1105,7 @@ HRESULT vdj_plugin_buffer_dsp_init(VdjPluginBufferDsp *plugin, const VdjCallback
     
     IVdjPluginBufferDsp8 *p = reinterpret_cast<IVdjPluginBufferDsp8*>(plugin);
     
-    struct CallbacksAdapter : public IVdjCallbacks8 {
-        const VdjCallbacks *c_callbacks;
-        VdjPlugin *plugin;
-        
-        HRESULT SendCommand(const char *command) override {
-            return c_callbacks->send_command(plugin, command);
-        }
-        HRESULT GetInfo(const char *command, double *result) override {
-            return c_callbacks->get_info(plugin, command, result);
-        }
-        HRESULT GetStringInfo(const char *command, void *result, int size) override {
-            return c_callbacks->get_string_info(plugin, command, (char*)result, size);
-        }
-        HRESULT DeclareParameter(void *parameter, int type, int id, const char *name, 
-                                const char *shortName, float defaultvalue) override {
-            return c_callbacks->declare_parameter(plugin, parameter, type, id, name, shortName, defaultvalue);
-        }
-        HRESULT GetSongBuffer(int pos, int nb, short **buffer) override {
-            return c_callbacks->get_song_buffer(plugin, pos, nb, buffer);
-        }
-    };
-    
-    CallbacksAdapter *adapter = new CallbacksAdapter();
+    VdjCallbacksAdapter *adapter = new VdjCallbacksAdapter();
     adapter->c_callbacks = callbacks;
     adapter->plugin = reinterpret_cast<VdjPlugin*>(plugin);
     p->cb = adapter;
@@ -550,17 +1115,30 @@ HRESULT vdj_plugin_buffer_dsp_init(VdjPluginBufferDsp *plugin, const VdjCallback
 
 HRESULT vdj_plugin_buffer_dsp_on_start(VdjPluginBufferDsp *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginBufferDsp8*>(plugin)->OnStart();
+    VdjPluginBufferDspWrapper *p = reinterpret_cast<VdjPluginBufferDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_START, __func__);
+    if (p->Recorded()) VdjReplayRecord(VDJ_REPLAY_START, nullptr, 0);
+    return p->OnStart();
 }
 
 HRESULT vdj_plugin_buffer_dsp_on_stop(VdjPluginBufferDsp *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginBufferDsp8*>(plugin)->OnStop();
+    VdjPluginBufferDspWrapper *p = reinterpret_cast<VdjPluginBufferDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_STOP, __func__);
+    if (p->Recorded()) VdjReplayRecord(VDJ_REPLAY_STOP, nullptr, 0);
+    return p->OnStop();
 }
 
 int16_t* vdj_plugin_buffer_dsp_on_get_song_buffer(VdjPluginBufferDsp *plugin, int song_pos, int nb) {
     if (!plugin) return nullptr;
-    return reinterpret_cast<IVdjPluginBufferDsp8*>(plugin)->OnGetSongBuffer(song_pos, nb);
+    VdjPluginBufferDspWrapper *p = reinterpret_cast<VdjPluginBufferDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_GET_SONG_BUFFER, __func__, nb, p->SampleRate);
+    VdjRealtimeScope realtime;
+    p->presets.BeginBlock(p->replayParameters);
+    p->morph.BeginBlock();
+    p->sharedBlobs.BeginBlock();
+    if (p->Recorded()) RecordBlock(*p, VDJ_REPLAY_GET_SONG_BUFFER, song_pos, nullptr, nb);
+    return p->OnGetSongBuffer(song_pos, nb);
 }
 
 HRESULT vdj_plugin_buffer_dsp_get_song_buffer(VdjPluginBufferDsp *plugin, int pos, int nb, int16_t **buffer) {
@@ -568,6 +1146,16 @@ HRESULT vdj_plugin_buffer_dsp_get_song_buffer(VdjPluginBufferDsp *plugin, int po
     return reinterpret_cast<IVdjPluginBufferDsp8*>(plugin)->GetSongBuffer(pos, nb, buffer);
 }
 
+HRESULT vdj_plugin_buffer_dsp_get_song_buffer_float(VdjPluginBufferDsp *plugin, int pos, int nb, float *out) {
+    if (!plugin || !out || nb < 0) return E_FAIL;
+    short *buffer = nullptr;
+    const HRESULT hr = reinterpret_cast<IVdjPluginBufferDsp8*>(plugin)->GetSongBuffer(pos, nb, &buffer);
+    if (hr != S_OK) return hr;
+    if (!buffer) return E_FAIL;
+    VdjInt16ToFloat(buffer, out, 2 * nb);
+    return S_OK;
+}
+
 int vdj_plugin_buffer_dsp_get_sample_rate(VdjPluginBufferDsp *plugin) {
     if (!plugin) return 0;
     return reinterpret_cast<IVdjPluginBufferDsp8*>(plugin)->SampleRate;
@@ -599,7 +1187,7 @@ VdjPluginPositionDsp* vdj_plugin_position_dsp_create(void) {
 void vdj_plugin_position_dsp_release(VdjPluginPositionDsp *plugin) {
     if (plugin) {
         IVdjPluginPositionDsp8 *p = reinterpret_cast<IVdjPluginPositionDsp8*>(plugin);
-        delete p;
+        ReleaseWrapper(p);
     }
 }
 
@@ -608,29 +1196,7 @@ HRESULT vdj_plugin_position_dsp_init(VdjPluginPositionDsp *plugin, const VdjCall
     
     IVdjPluginPositionDsp8 *p = reinterpret_cast<IVdjPluginPositionDsp8*>(plugin);
     
-    struct CallbacksAdapter : public IVdjCallbacks8 {
-        const VdjCallbacks *c_callbacks;
-        VdjPlugin *plugin;
-        
-        HRESULT SendCommand(const char *command) override {
-            return c_callbacks->send_command(plugin, command);
-        }
-        HRESULT GetInfo(const char *command, double *result) override {
-            return c_callbacks->get_info(plugin, command, result);
-        }
-        HRESULT GetStringInfo(const char *command, void *result, int size) override {
-            return c_callbacks->get_string_info(plugin, command, (char*)result, size);
-        }
-        HRESULT DeclareParameter(void *parameter, int type, int id, const char *name, 
-                                const char *shortName, float defaultvalue) override {
-            return c_callbacks->declare_parameter(plugin, parameter, type, id, name, shortName, defaultvalue);
-        }
-        HRESULT GetSongBuffer(int pos, int nb, short **buffer) override {
-            return c_callbacks->get_song_buffer(plugin, pos, nb, buffer);
-        }
-    };
-    
-    CallbacksAdapter *adapter = new CallbacksAdapter();
+    VdjCallbacksAdapter *adapter = new VdjCallbacksAdapter();
     adapter->c_callbacks = callbacks;
     adapter->plugin = reinterpret_cast<VdjPlugin*>(plugin);
     p->cb = adapter;
@@ -640,24 +1206,54 @@ HRESULT vdj_plugin_position_dsp_init(VdjPluginPositionDsp *plugin, const VdjCall
 
 HRESULT vdj_plugin_position_dsp_on_start(VdjPluginPositionDsp *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginPositionDsp8*>(plugin)->OnStart();
+    VdjPluginPositionDspWrapper *p = reinterpret_cast<VdjPluginPositionDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_START, __func__);
+    p->scratch.Reserve(0);
+    if (p->Recorded()) VdjReplayRecord(VDJ_REPLAY_START, nullptr, 0);
+    return p->OnStart();
 }
 
 HRESULT vdj_plugin_position_dsp_on_stop(VdjPluginPositionDsp *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginPositionDsp8*>(plugin)->OnStop();
+    VdjPluginPositionDspWrapper *p = reinterpret_cast<VdjPluginPositionDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_STOP, __func__);
+    if (p->Recorded()) VdjReplayRecord(VDJ_REPLAY_STOP, nullptr, 0);
+    return p->OnStop();
 }
 
 HRESULT vdj_plugin_position_dsp_on_transform_position(VdjPluginPositionDsp *plugin, 
                                                       double *song_pos, double *video_pos, 
                                                       float *volume, float *src_volume) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginPositionDsp8*>(plugin)->OnTransformPosition(song_pos, video_pos, volume, src_volume);
+    VdjPluginPositionDspWrapper *p = reinterpret_cast<VdjPluginPositionDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_TRANSFORM_POSITION, __func__);
+    VdjRealtimeScope realtime;
+    // Called first in every block of a position plugin
+    p->presets.BeginBlock(p->replayParameters);
+    p->morph.BeginBlock();
+    p->sharedBlobs.BeginBlock();
+    if (p->Recorded() && song_pos && video_pos && volume && src_volume) {
+        VdjReplayPosition r = {};
+        r.song_pos = *song_pos;
+        r.video_pos = *video_pos;
+        r.volume = *volume;
+        r.src_volume = *src_volume;
+        r.song_pos_beats = p->SongPosBeats;
+        r.song_bpm = p->SongBpm;
+        r.sample_rate = p->SampleRate;
+        VdjReplayRecord(VDJ_REPLAY_TRANSFORM_POSITION, &r, sizeof(r));
+    }
+    return p->OnTransformPosition(song_pos, video_pos, volume, src_volume);
 }
 
 HRESULT vdj_plugin_position_dsp_on_process_samples(VdjPluginPositionDsp *plugin, float *buffer, int nb) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginPositionDsp8*>(plugin)->OnProcessSamples(buffer, nb);
+    VdjPluginPositionDspWrapper *p = reinterpret_cast<VdjPluginPositionDspWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_PROCESS_SAMPLES, __func__, nb, p->SampleRate);
+    VdjRealtimeScope realtime;
+    VdjScratchScope scratchBlock(p->scratch);
+    if (p->Recorded()) RecordBlock(*p, VDJ_REPLAY_PROCESS_SAMPLES, p->SongPos, buffer, nb);
+    return p->OnProcessSamples(buffer, nb);
 }
 
 int vdj_plugin_position_dsp_get_sample_rate(VdjPluginPositionDsp *plugin) {
@@ -680,6 +1276,16 @@ double vdj_plugin_position_dsp_get_song_pos_beats(VdjPluginPositionDsp *plugin)
     return reinterpret_cast<IVdjPluginPositionDsp8*>(plugin)->SongPosBeats;
 }
 
+/* ============================================================================
+   Position DSP Pattern Engine C ABI Functions
+   ============================================================================ */
+
+HRESULT vdj_plugin_position_dsp_set_pattern(VdjPluginPositionDsp *plugin, const VdjPatternStep *steps, int count) {
+    if (!plugin) return E_FAIL;
+    VdjPluginPositionDspWrapper *p = reinterpret_cast<VdjPluginPositionDspWrapper*>(plugin);
+    return p->pattern.Set(steps, count);
+}
+
 /* ============================================================================
    Video FX Plugin C ABI Functions
    ============================================================================ */
@@ -691,7 +1297,9 @@ VdjPluginVideoFx* vdj_plugin_video_fx_create(void) {
 void vdj_plugin_video_fx_release(VdjPluginVideoFx *plugin) {
     if (plugin) {
         IVdjPluginVideoFx8 *p = reinterpret_cast<IVdjPluginVideoFx8*>(plugin);
-        delete p;
+        IVdjVideoCallbacks8 *videoCallbacks = p->vcb;
+        ReleaseWrapper(p);
+        delete static_cast<VdjVideoCallbacksAdapter*>(videoCallbacks);
     }
 }
 
@@ -701,49 +1309,12 @@ HRESULT vdj_plugin_video_fx_init(VdjPluginVideoFx *plugin, const VdjCallbacks *c
     
     IVdjPluginVideoFx8 *p = reinterpret_cast<IVdjPluginVideoFx8*>(plugin);
     
-    struct CallbacksAdapter : public IVdjCallbacks8 {
-        const VdjCallbacks *c_callbacks;
-        VdjPlugin *plugin;
-        
-        HRESULT SendCommand(const char *command) override {
-            return c_callbacks->send_command(plugin, command);
-        }
-        HRESULT GetInfo(const char *command, double *result) override {
-            return c_callbacks->get_info(plugin, command, result);
-        }
-        HRESULT GetStringInfo(const char *command, void *result, int size) override {
-            return c_callbacks->get_string_info(plugin, command, (char*)result, size);
-        }
-        HRESULT DeclareParameter(void *parameter, int type, int id, const char *name, 
-                                const char *shortName, float defaultvalue) override {
-            return c_callbacks->declare_parameter(plugin, parameter, type, id, name, shortName, defaultvalue);
-        }
-        HRESULT GetSongBuffer(int pos, int nb, short **buffer) override {
-            return c_callbacks->get_song_buffer(plugin, pos, nb, buffer);
-        }
-    };
-    
-    CallbacksAdapter *adapter = new CallbacksAdapter();
+    VdjCallbacksAdapter *adapter = new VdjCallbacksAdapter();
     adapter->c_callbacks = callbacks;
     adapter->plugin = reinterpret_cast<VdjPlugin*>(plugin);
     p->cb = adapter;
     
-    struct VideoCallbacksAdapter : public IVdjVideoCallbacks8 {
-        const VdjVideoCallbacks *c_callbacks;
-        VdjPlugin *plugin;
-        
-        HRESULT DrawDeck() override {
-            return c_callbacks->draw_deck(plugin);
-        }
-        HRESULT GetDevice(EVdjVideoEngine engine, void **device) override {
-            return c_callbacks->get_device(plugin, engine, device);
-        }
-        HRESULT GetTexture(EVdjVideoEngine engine, void **texture, TVertex **vertices) override {
-            return c_callbacks->get_texture(plugin, engine, texture, vertices);
-        }
-    };
-    
-    VideoCallbacksAdapter *video_adapter = new VideoCallbacksAdapter();
+    VdjVideoCallbacksAdapter *video_adapter = new VdjVideoCallbacksAdapter();
     video_adapter->c_callbacks = video_callbacks;
     video_adapter->plugin = reinterpret_cast<VdjPlugin*>(plugin);
     p->vcb = video_adapter;
@@ -753,32 +1324,49 @@ HRESULT vdj_plugin_video_fx_init(VdjPluginVideoFx *plugin, const VdjCallbacks *c
 
 HRESULT vdj_plugin_video_fx_on_start(VdjPluginVideoFx *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoFx8*>(plugin)->OnStart();
+    VdjPluginVideoFxWrapper *p = reinterpret_cast<VdjPluginVideoFxWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_START, __func__);
+    p->scratch.Reserve(0);
+    return p->OnStart();
 }
 
 HRESULT vdj_plugin_video_fx_on_stop(VdjPluginVideoFx *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoFx8*>(plugin)->OnStop();
+    VdjPluginVideoFxWrapper *p = reinterpret_cast<VdjPluginVideoFxWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_STOP, __func__);
+    return p->OnStop();
 }
 
 HRESULT vdj_plugin_video_fx_on_draw(VdjPluginVideoFx *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoFx8*>(plugin)->OnDraw();
+    VdjPluginVideoFxWrapper *p = reinterpret_cast<VdjPluginVideoFxWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_DRAW, __func__);
+    VdjScratchScope scratchBlock(p->scratch);
+    p->presets.BeginBlock(p->replayParameters);
+    p->morph.BeginBlock();
+    p->sharedBlobs.BeginBlock();
+    return p->OnDraw();
 }
 
 HRESULT vdj_plugin_video_fx_on_device_init(VdjPluginVideoFx *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoFx8*>(plugin)->OnDeviceInit();
+    VdjPluginVideoFxWrapper *p = reinterpret_cast<VdjPluginVideoFxWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_DEVICE, __func__);
+    return p->OnDeviceInit();
 }
 
 HRESULT vdj_plugin_video_fx_on_device_close(VdjPluginVideoFx *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoFx8*>(plugin)->OnDeviceClose();
+    VdjPluginVideoFxWrapper *p = reinterpret_cast<VdjPluginVideoFxWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_DEVICE, __func__);
+    return p->OnDeviceClose();
 }
 
 HRESULT vdj_plugin_video_fx_on_audio_samples(VdjPluginVideoFx *plugin, float *buffer, int nb) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoFx8*>(plugin)->OnAudioSamples(buffer, nb);
+    VdjPluginVideoFxWrapper *p = reinterpret_cast<VdjPluginVideoFxWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_AUDIO_SAMPLES, __func__, nb, p->SampleRate);
+    return p->OnAudioSamples(buffer, nb);
 }
 
 int vdj_plugin_video_fx_get_width(VdjPluginVideoFx *plugin) {
@@ -817,7 +1405,7 @@ VdjPluginVideoTransition* vdj_plugin_video_transition_create(void) {
 void vdj_plugin_video_transition_release(VdjPluginVideoTransition *plugin) {
     if (plugin) {
         IVdjPluginVideoTransition8 *p = reinterpret_cast<IVdjPluginVideoTransition8*>(plugin);
-        delete p;
+        ReleaseWrapper(p);
     }
 }
 
@@ -827,29 +1415,7 @@ HRESULT vdj_plugin_video_transition_init(VdjPluginVideoTransition *plugin, const
     
     IVdjPluginVideoTransition8 *p = reinterpret_cast<IVdjPluginVideoTransition8*>(plugin);
     
-    struct CallbacksAdapter : public IVdjCallbacks8 {
-        const VdjCallbacks *c_callbacks;
-        VdjPlugin *plugin;
-        
-        HRESULT SendCommand(const char *command) override {
-            return c_callbacks->send_command(plugin, command);
-        }
-        HRESULT GetInfo(const char *command, double *result) override {
-            return c_callbacks->get_info(plugin, command, result);
-        }
-        HRESULT GetStringInfo(const char *command, void *result, int size) override {
-            return c_callbacks->get_string_info(plugin, command, (char*)result, size);
-        }
-        HRESULT DeclareParameter(void *parameter, int type, int id, const char *name, 
-                                const char *shortName, float defaultvalue) override {
-            return c_callbacks->declare_parameter(plugin, parameter, type, id, name, shortName, defaultvalue);
-        }
-        HRESULT GetSongBuffer(int pos, int nb, short **buffer) override {
-            return c_callbacks->get_song_buffer(plugin, pos, nb, buffer);
-        }
-    };
-    
-    CallbacksAdapter *adapter = new CallbacksAdapter();
+    VdjCallbacksAdapter *adapter = new VdjCallbacksAdapter();
     adapter->c_callbacks = callbacks;
     adapter->plugin = reinterpret_cast<VdjPlugin*>(plugin);
     p->cb = adapter;
@@ -862,17 +1428,27 @@ HRESULT vdj_plugin_video_transition_init(VdjPluginVideoTransition *plugin, const
 
 HRESULT vdj_plugin_video_transition_on_draw(VdjPluginVideoTransition *plugin, float crossfader) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoTransition8*>(plugin)->OnDraw(crossfader);
+    VdjPluginVideoTransitionWrapper *p = reinterpret_cast<VdjPluginVideoTransitionWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_DRAW, __func__);
+    VdjScratchScope scratchBlock(p->scratch);
+    p->presets.BeginBlock(p->replayParameters);
+    p->morph.BeginBlock();
+    p->sharedBlobs.BeginBlock();
+    return p->OnDraw(crossfader);
 }
 
 HRESULT vdj_plugin_video_transition_on_device_init(VdjPluginVideoTransition *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoTransition8*>(plugin)->OnDeviceInit();
+    VdjPluginVideoTransitionWrapper *p = reinterpret_cast<VdjPluginVideoTransitionWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_DEVICE, __func__);
+    return p->OnDeviceInit();
 }
 
 HRESULT vdj_plugin_video_transition_on_device_close(VdjPluginVideoTransition *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginVideoTransition8*>(plugin)->OnDeviceClose();
+    VdjPluginVideoTransitionWrapper *p = reinterpret_cast<VdjPluginVideoTransitionWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_DEVICE, __func__);
+    return p->OnDeviceClose();
 }
 
 int vdj_plugin_video_transition_get_width(VdjPluginVideoTransition *plugin) {
@@ -911,7 +1487,7 @@ VdjPluginOnlineSource* vdj_plugin_online_source_create(void) {
 void vdj_plugin_online_source_release(VdjPluginOnlineSource *plugin) {
     if (plugin) {
         IVdjPluginOnlineSource *p = reinterpret_cast<IVdjPluginOnlineSource*>(plugin);
-        delete p;
+        ReleaseWrapper(p);
     }
 }
 
@@ -920,29 +1496,7 @@ HRESULT vdj_plugin_online_source_init(VdjPluginOnlineSource *plugin, const VdjCa
     
     IVdjPluginOnlineSource *p = reinterpret_cast<IVdjPluginOnlineSource*>(plugin);
     
-    struct CallbacksAdapter : public IVdjCallbacks8 {
-        const VdjCallbacks *c_callbacks;
-        VdjPlugin *plugin;
-        
-        HRESULT SendCommand(const char *command) override {
-            return c_callbacks->send_command(plugin, command);
-        }
-        HRESULT GetInfo(const char *command, double *result) override {
-            return c_callbacks->get_info(plugin, command, result);
-        }
-        HRESULT GetStringInfo(const char *command, void *result, int size) override {
-            return c_callbacks->get_string_info(plugin, command, (char*)result, size);
-        }
-        HRESULT DeclareParameter(void *parameter, int type, int id, const char *name, 
-                                const char *shortName, float defaultvalue) override {
-            return c_callbacks->declare_parameter(plugin, parameter, type, id, name, shortName, defaultvalue);
-        }
-        HRESULT GetSongBuffer(int pos, int nb, short **buffer) override {
-            return c_callbacks->get_song_buffer(plugin, pos, nb, buffer);
-        }
-    };
-    
-    CallbacksAdapter *adapter = new CallbacksAdapter();
+    VdjCallbacksAdapter *adapter = new VdjCallbacksAdapter();
     adapter->c_callbacks = callbacks;
     adapter->plugin = reinterpret_cast<VdjPlugin*>(plugin);
     p->cb = adapter;
@@ -952,27 +1506,37 @@ HRESULT vdj_plugin_online_source_init(VdjPluginOnlineSource *plugin, const VdjCa
 
 HRESULT vdj_plugin_online_source_is_logged(VdjPluginOnlineSource *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginOnlineSource*>(plugin)->IsLogged();
+    VdjPluginOnlineSourceWrapper *p = reinterpret_cast<VdjPluginOnlineSourceWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_ONLINE_SOURCE, __func__);
+    return p->IsLogged();
 }
 
 HRESULT vdj_plugin_online_source_on_login(VdjPluginOnlineSource *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginOnlineSource*>(plugin)->OnLogin();
+    VdjPluginOnlineSourceWrapper *p = reinterpret_cast<VdjPluginOnlineSourceWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_ONLINE_SOURCE, __func__);
+    return p->OnLogin();
 }
 
 HRESULT vdj_plugin_online_source_on_logout(VdjPluginOnlineSource *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginOnlineSource*>(plugin)->OnLogout();
+    VdjPluginOnlineSourceWrapper *p = reinterpret_cast<VdjPluginOnlineSourceWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_ONLINE_SOURCE, __func__);
+    return p->OnLogout();
 }
 
 HRESULT vdj_plugin_online_source_on_search(VdjPluginOnlineSource *plugin, const char *search, void *tracks_list) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginOnlineSource*>(plugin)->OnSearch(search, (IVdjTracksList*)tracks_list);
+    VdjPluginOnlineSourceWrapper *p = reinterpret_cast<VdjPluginOnlineSourceWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_ONLINE_SOURCE, __func__);
+    return p->OnSearch(search, (IVdjTracksList*)tracks_list);
 }
 
 HRESULT vdj_plugin_online_source_on_search_cancel(VdjPluginOnlineSource *plugin) {
     if (!plugin) return E_FAIL;
-    return reinterpret_cast<IVdjPluginOnlineSource*>(plugin)->OnSearchCancel();
+    VdjPluginOnlineSourceWrapper *p = reinterpret_cast<VdjPluginOnlineSourceWrapper*>(plugin);
+    VdjCallbackScope scope(*p, VDJ_PROFILE_ONLINE_SOURCE, __func__);
+    return p->OnSearchCancel();
 }
 
 } // extern "C"
@@ -0,0 +1,58 @@
+/**
+ * VirtualDJ Rust SDK - Beat Grid Events
+ */
+
+#include "beat_grid.h"
+
+#include <cmath>
+
+/* Host positions carry rounding error; a boundary this close past a frame is on it */
+static const double kFrameEpsilon = 1e-6;
+
+static int64_t FloorMod(int64_t a, int64_t n) {
+    int64_t m = a % n;
+    return m < 0 ? m + n : m;
+}
+
+static int64_t FloorDiv(int64_t a, int64_t n) {
+    return (a - FloorMod(a, n)) / n;
+}
+
+void VdjBeatGrid::Compute(double songPosBeats, int samplesPerBeat, int nb) {
+    count = 0;
+    if (samplesPerBeat <= 0 || nb <= 0) return;
+
+    const int subdiv = subdivisions > 0 ? subdivisions : 1;
+    const int perBar = beatsPerBar > 0 ? beatsPerBar : 4;
+    const double samplesPerStep = (double)samplesPerBeat / subdiv;
+
+    // Work in subdivision steps: the first boundary at or after the block
+    // start is ceil(pos), later ones follow at a fixed sample stride.
+    const double pos = songPosBeats * subdiv;
+    const double first = std::ceil(pos - kFrameEpsilon / samplesPerStep);
+    int64_t step = (int64_t)first;
+    double offset = (first - pos) * samplesPerStep;
+
+    // A boundary belongs to the block whose frame range contains it, so the
+    // split is stable across blocks: [0, nb) here, [0, nb) in the next one.
+    // Both ends snap the same way, so a boundary that rounds to the end of
+    // one block is the start of the next instead of in both or neither.
+    for (;;) {
+        const double frame = std::floor(offset + kFrameEpsilon);
+        if (frame >= (double)nb || count >= VDJ_BEAT_EVENTS_MAX) break;
+        VdjBeatEvent &e = events[count++];
+        e.offset = (int32_t)frame;
+        e.flags = VDJ_BEAT_EVENT_SUBDIVISION;
+        e.beat = (double)step / subdiv;
+
+        if (FloorMod(step, subdiv) == 0) {
+            e.flags |= VDJ_BEAT_EVENT_BEAT;
+            if (FloorMod(FloorDiv(step, subdiv), perBar) == 0) {
+                e.flags |= VDJ_BEAT_EVENT_BAR;
+            }
+        }
+
+        ++step;
+        offset += samplesPerStep;
+    }
+}
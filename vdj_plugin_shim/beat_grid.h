@@ -0,0 +1,28 @@
+/**
+ * VirtualDJ Rust SDK - Beat Grid Events
+ *
+ * Precomputes the beat, bar and subdivision boundaries that fall inside an
+ * OnProcessSamples block, so tempo-synced code can branch per event instead
+ * of dividing SongPosBeats/SongBpm for every sample.
+ */
+
+#ifndef VDJ_SHIM_BEAT_GRID_H
+#define VDJ_SHIM_BEAT_GRID_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+struct VdjBeatGrid {
+    int beatsPerBar = 4;
+    int subdivisions = 1;
+
+    VdjBeatEvent events[VDJ_BEAT_EVENTS_MAX];
+    int count = 0;
+
+    /**
+     * Fill events for a block of nb frames starting at songPosBeats.
+     * samplesPerBeat is the host's SongBpm (samples between two beats).
+     */
+    void Compute(double songPosBeats, int samplesPerBeat, int nb);
+};
+
+#endif /* VDJ_SHIM_BEAT_GRID_H */
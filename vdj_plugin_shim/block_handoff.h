@@ -0,0 +1,71 @@
+/**
+ * VirtualDJ Rust SDK - Block Handoff
+ *
+ * Moves blocks built on control threads (grown arenas, staged presets,
+ * pattern tables) to the one thread that uses them, without locking or
+ * freeing on that thread. A control thread publishes a block; the owning
+ * thread takes it between two callbacks and retires the block it replaces,
+ * which the next publish frees.
+ */
+
+#ifndef VDJ_SHIM_BLOCK_HANDOFF_H
+#define VDJ_SHIM_BLOCK_HANDOFF_H
+
+#include <atomic>
+
+struct VdjBlockHandoff {
+    /** `release` frees a block and must accept nullptr */
+    explicit VdjBlockHandoff(void (*release)(void*)) : release(release) {}
+    VdjBlockHandoff(const VdjBlockHandoff&) = delete;
+    VdjBlockHandoff& operator=(const VdjBlockHandoff&) = delete;
+
+    ~VdjBlockHandoff() {
+        release(pending.load(std::memory_order_relaxed));
+        release(retired.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Hand `block` over, replacing a block not taken yet. Control threads
+     * only; callers serialize their calls.
+     */
+    void Publish(void *block) {
+        for (;;) {
+            void *waiting = pending.load(std::memory_order_acquire);
+            if (!waiting) {
+                // The owner only retires a block when it takes a pending one,
+                // so with nothing pending the retired block is ours to free
+                release(retired.exchange(nullptr, std::memory_order_acquire));
+                pending.store(block, std::memory_order_release);
+                return;
+            }
+            // If the owner took the waiting block meanwhile, go round again
+            // and free the block it retired
+            if (pending.compare_exchange_strong(waiting, block, std::memory_order_acq_rel)) {
+                release(waiting);
+                return;
+            }
+        }
+    }
+
+    /** True when a block is waiting; owning thread */
+    bool Waiting() const { return pending.load(std::memory_order_relaxed) != nullptr; }
+
+    /**
+     * The newest published block, retiring `current` in its place, or
+     * nullptr when none is waiting. Owning thread only.
+     */
+    void* Take(void *current) {
+        // Only this thread clears `pending`, so a block seen here is still
+        // there at the exchange. Retiring first means that once a control
+        // thread sees nothing pending, the retired block is published too.
+        if (!pending.load(std::memory_order_acquire)) return nullptr;
+        retired.store(current, std::memory_order_release);
+        return pending.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+    void (*const release)(void*);
+    std::atomic<void*> pending { nullptr };
+    std::atomic<void*> retired { nullptr };
+};
+
+#endif /* VDJ_SHIM_BLOCK_HANDOFF_H */
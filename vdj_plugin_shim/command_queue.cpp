@@ -0,0 +1,180 @@
+/**
+ * VirtualDJ Rust SDK - Deferred Command Queue
+ */
+
+#include "command_queue.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+/* ============================================================================
+   Dispatcher Thread
+   ============================================================================ */
+
+/**
+ * One thread per process polls every registered queue. Audio threads never
+ * signal it: waking a condition variable can take a lock.
+ *
+ * The thread runs while any queue is registered and is joined by the last
+ * Unregister, on the thread releasing the plugin. It is never joined from a
+ * static destructor: on Windows those run under the loader lock, which the
+ * exiting thread needs, so FreeLibrary would deadlock. The dispatcher itself
+ * is never destroyed for the same reason.
+ */
+struct VdjCommandDispatcher {
+    std::mutex mutex;   /* guards queues and serializes all consumers */
+    std::condition_variable wake;
+    std::vector<VdjCommandQueue*> queues;
+    std::thread thread;
+    uint64_t generation = 0;    /* bumped to stop the running thread */
+
+    void Register(VdjCommandQueue *queue) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queues.push_back(queue);
+        if (!thread.joinable()) {
+            const uint64_t current = generation;
+            thread = std::thread([this, current] { Run(current); });
+        }
+        wake.notify_one();
+    }
+
+    void Unregister(VdjCommandQueue *queue) {
+        std::thread stopped;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queues.erase(std::remove(queues.begin(), queues.end(), queue), queues.end());
+            if (!queues.empty() || !thread.joinable()) return;
+            generation++;
+            stopped = std::move(thread);
+        }
+        wake.notify_one();
+        stopped.join();
+    }
+
+    void Run(uint64_t current) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (generation == current) {
+            wake.wait_for(lock, std::chrono::milliseconds(VDJ_COMMAND_POLL_MS));
+            for (VdjCommandQueue *queue : queues) queue->DispatchLocked();
+        }
+    }
+};
+
+static VdjCommandDispatcher& Dispatcher() {
+    static VdjCommandDispatcher *dispatcher = new VdjCommandDispatcher;
+    return *dispatcher;
+}
+
+/* ============================================================================
+   Queue
+   ============================================================================ */
+
+VdjCommandQueue::~VdjCommandQueue() {
+    if (!slots) return;
+    // Waits for a dispatch round in progress, so no command outlives us
+    Dispatcher().Unregister(this);
+    delete[] slots;
+    const int count = commandCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) delete[] commands[i].load(std::memory_order_relaxed);
+}
+
+int VdjCommandQueue::Intern(IVdjPlugin8 *plugin, const char *command) {
+    if (!plugin || !command) return -1;
+
+    const int count = commandCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(commands[i].load(std::memory_order_relaxed), command) == 0) return i;
+    }
+    if (count >= VDJ_COMMAND_MAX_INTERNED) return -1;
+
+    if (!slots) {
+        slots = new (std::nothrow) VdjCommandSlot[VDJ_COMMAND_QUEUE_SIZE];
+        if (!slots) return -1;
+        for (uint64_t i = 0; i < VDJ_COMMAND_QUEUE_SIZE; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        owner = plugin;
+        Dispatcher().Register(this);
+    }
+
+    const size_t len = strlen(command) + 1;
+    char *copy = new (std::nothrow) char[len];
+    if (!copy) return -1;
+    memcpy(copy, command, len);
+    commands[count].store(copy, std::memory_order_release);
+    commandCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+HRESULT VdjCommandQueue::Enqueue(int commandId) {
+    if (commandId < 0 || commandId >= commandCount.load(std::memory_order_acquire)) return E_FAIL;
+
+    // Bounded MPMC ring with per-slot sequence numbers (D. Vyukov): a slot is
+    // free for position p when its sequence equals p
+    uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+    VdjCommandSlot *slot;
+    for (;;) {
+        slot = &slots[pos & (VDJ_COMMAND_QUEUE_SIZE - 1)];
+        const uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        const int64_t diff = (int64_t)(seq - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return S_FALSE;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->commandId = commandId;
+    slot->enqueued = std::chrono::steady_clock::now();
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    queued.fetch_add(1, std::memory_order_relaxed);
+    return S_OK;
+}
+
+int VdjCommandQueue::DispatchLocked() {
+    int count = 0;
+    for (;;) {
+        VdjCommandSlot &slot = slots[dequeuePos & (VDJ_COMMAND_QUEUE_SIZE - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+
+        const int commandId = slot.commandId;
+        const auto enqueued = slot.enqueued;
+        slot.sequence.store(dequeuePos + VDJ_COMMAND_QUEUE_SIZE, std::memory_order_release);
+        dequeuePos++;
+
+        const auto now = std::chrono::steady_clock::now();
+        const uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - enqueued).count();
+        totalLatencyNs.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > maxLatencyNs.load(std::memory_order_relaxed)) maxLatencyNs.store(ns, std::memory_order_relaxed);
+
+        const char *command = commands[commandId].load(std::memory_order_acquire);
+        const HRESULT hr = owner->cb ? owner->cb->SendCommand(command) : E_FAIL;
+        (hr == S_OK ? dispatched : failed).fetch_add(1, std::memory_order_relaxed);
+        count++;
+    }
+    return count;
+}
+
+void VdjCommandQueue::Flush() {
+    if (!slots) return;
+    std::lock_guard<std::mutex> lock(Dispatcher().mutex);
+    DispatchLocked();
+}
+
+void VdjCommandQueue::GetStats(VdjCommandStats *stats) const {
+    stats->queued = queued.load(std::memory_order_relaxed);
+    stats->dropped = dropped.load(std::memory_order_relaxed);
+    stats->dispatched = dispatched.load(std::memory_order_relaxed);
+    stats->failed = failed.load(std::memory_order_relaxed);
+    stats->max_latency_ns = maxLatencyNs.load(std::memory_order_relaxed);
+    const uint64_t sent = stats->dispatched + stats->failed;
+    stats->mean_latency_ns = sent ? totalLatencyNs.load(std::memory_order_relaxed) / sent : 0;
+}
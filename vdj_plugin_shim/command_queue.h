@@ -0,0 +1,69 @@
+/**
+ * VirtualDJ Rust SDK - Deferred Command Queue
+ *
+ * IVdjCallbacks8::SendCommand runs VDJ script and may block, so callbacks
+ * queue preinterned commands instead: enqueuing is a CAS on a bounded
+ * multi-producer ring, and a shim dispatcher thread sends them to the host,
+ * recording how long each one waited.
+ */
+
+#ifndef VDJ_SHIM_COMMAND_QUEUE_H
+#define VDJ_SHIM_COMMAND_QUEUE_H
+
+#include "../abi/vdj_plugin_abi.h"
+#include "vdj_sdk.h"
+
+#include <atomic>
+#include <chrono>
+
+struct VdjCommandSlot {
+    std::atomic<uint64_t> sequence { 0 };
+    int32_t commandId = 0;
+    std::chrono::steady_clock::time_point enqueued;
+};
+
+struct VdjCommandQueue {
+    VdjCommandQueue() = default;
+    VdjCommandQueue(const VdjCommandQueue&) = delete;
+    VdjCommandQueue& operator=(const VdjCommandQueue&) = delete;
+    ~VdjCommandQueue();
+
+    /**
+     * Copy a command string and return its ID, registering the queue with
+     * the dispatcher on first use. Allocates: call it while loading.
+     */
+    int Intern(IVdjPlugin8 *owner, const char *command);
+
+    /**
+     * Queue an interned command from any thread without blocking. Returns
+     * S_FALSE and counts a drop when the queue is full.
+     */
+    HRESULT Enqueue(int commandId);
+
+    /**
+     * Send every queued command to the host now, on the calling thread
+     */
+    void Flush();
+
+    void GetStats(VdjCommandStats *stats) const;
+
+    /* Dispatcher side; the dispatcher lock serializes consumers */
+    int DispatchLocked();
+
+    IVdjPlugin8 *owner = nullptr;
+    VdjCommandSlot *slots = nullptr;    /* VDJ_COMMAND_QUEUE_SIZE, allocated on first Intern */
+    std::atomic<uint64_t> enqueuePos { 0 };
+    uint64_t dequeuePos = 0;
+
+    std::atomic<const char*> commands[VDJ_COMMAND_MAX_INTERNED] = {};
+    std::atomic<int> commandCount { 0 };
+
+    std::atomic<uint64_t> queued { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+    std::atomic<uint64_t> dispatched { 0 };
+    std::atomic<uint64_t> failed { 0 };
+    std::atomic<uint64_t> totalLatencyNs { 0 };
+    std::atomic<uint64_t> maxLatencyNs { 0 };
+};
+
+#endif /* VDJ_SHIM_COMMAND_QUEUE_H */
@@ -0,0 +1,91 @@
+/**
+ * VirtualDJ Rust SDK - Compile-Time Math
+ *
+ * Series evaluations in double precision, accurate well beyond float, for
+ * the tables the shim generates while it is compiled (lookup tables,
+ * resampler filters). Internal to the shim, with internal linkage.
+ */
+
+#ifndef VDJ_SHIM_CONSTEXPR_MATH_H
+#define VDJ_SHIM_CONSTEXPR_MATH_H
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kLn2 = 0.69314718055994530942;
+constexpr double kLn10 = 2.30258509299404568402;
+
+constexpr double Sin(double x) {
+    // Reduce to [-pi/2, pi/2], where the Taylor series converges quickly
+    x -= 2.0 * kPi * (double)(long long)(x / (2.0 * kPi));
+    if (x > kPi) x -= 2.0 * kPi;
+    if (x < -kPi) x += 2.0 * kPi;
+    if (x > kPi / 2.0) x = kPi - x;
+    if (x < -kPi / 2.0) x = -kPi - x;
+    double term = x, sum = x;
+    for (int n = 1; n < 14; n++) {
+        term *= -x * x / (double)((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double Cos(double x) {
+    return Sin(x + kPi / 2.0);
+}
+
+constexpr double Exp(double x) {
+    // e^x = 2^k e^r with |r| <= ln2 / 2
+    long long k = (long long)(x / kLn2 + (x >= 0.0 ? 0.5 : -0.5));
+    const double r = x - (double)k * kLn2;
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 20; n++) {
+        term *= r / (double)n;
+        sum += term;
+    }
+    for (; k > 0; k--) sum *= 2.0;
+    for (; k < 0; k++) sum *= 0.5;
+    return sum;
+}
+
+/* ln x = 2 atanh((x - 1) / (x + 1)); fast for the 1..2 range of the tables */
+constexpr double Log(double x) {
+    const double z = (x - 1.0) / (x + 1.0);
+    double term = z, sum = 0.0;
+    for (int n = 0; n < 30; n++) {
+        sum += term / (double)(2 * n + 1);
+        term *= z * z;
+    }
+    return 2.0 * sum;
+}
+
+constexpr double Tanh(double x) {
+    const double e = Exp(2.0 * x);
+    return (e - 1.0) / (e + 1.0);
+}
+
+/* Newton's method from above; x >= 0 */
+constexpr double Sqrt(double x) {
+    if (x <= 0.0) return 0.0;
+    double r = x > 1.0 ? x : 1.0;
+    for (int n = 0; n < 64; n++) {
+        const double next = 0.5 * (r + x / r);
+        if (next >= r) break;
+        r = next;
+    }
+    return r;
+}
+
+/* Modified Bessel function of the first kind, order 0, for Kaiser windows */
+constexpr double BesselI0(double x) {
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 40 && term > sum * 1e-17; n++) {
+        term *= (x / (2.0 * n)) * (x / (2.0 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+}  // namespace
+
+#endif /* VDJ_SHIM_CONSTEXPR_MATH_H */
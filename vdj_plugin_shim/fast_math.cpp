@@ -0,0 +1,79 @@
+/**
+ * VirtualDJ Rust SDK - Fast Math
+ */
+
+#include "fast_math.h"
+#include "simd.h"
+#include "fast_math_kernels.h"
+
+#include <atomic>
+
+/* ============================================================================
+   Baseline Kernels
+   ============================================================================ */
+
+/* The 4-lane vector of simd.h, as the ops struct of fast_math_kernels.h */
+struct VdjMathF4 {
+    using V = VdjF4;
+    enum { Width = VDJ_SIMD_WIDTH };
+
+    static V Set1(float x) { return VdjF4Set1(x); }
+    static V Load(const float *p) { return VdjF4Load(p); }
+    static void Store(float *p, V a) { VdjF4Store(p, a); }
+    static V Add(V a, V b) { return VdjF4Add(a, b); }
+    static V Sub(V a, V b) { return VdjF4Sub(a, b); }
+    static V Mul(V a, V b) { return VdjF4Mul(a, b); }
+    static V MulAdd(V a, V b, V c) { return VdjF4Add(VdjF4Mul(a, b), c); }
+    static V Div(V a, V b) { return VdjF4Div(a, b); }
+    static V Min(V a, V b) { return VdjF4Min(a, b); }
+    static V Max(V a, V b) { return VdjF4Max(a, b); }
+    static V Abs(V a) { return VdjF4Abs(a); }
+    static V Round(V a) { return VdjF4Round(a); }
+    static V Less(V a, V b) { return VdjF4Less(a, b); }
+    static V Select(V mask, V a, V b) { return VdjF4Select(mask, a, b); }
+    static V Ldexp(V a, V k) { return VdjF4Ldexp(a, k); }
+    static V Exponent(V a) { return VdjF4Exponent(a); }
+    static V Mantissa(V a) { return VdjF4Mantissa(a); }
+};
+
+#if defined(VDJ_SIMD_SSE2)
+#define VDJ_MATH_ISA_BASELINE VDJ_MATH_ISA_SSE2
+#elif defined(VDJ_SIMD_NEON)
+#define VDJ_MATH_ISA_BASELINE VDJ_MATH_ISA_NEON
+#else
+#define VDJ_MATH_ISA_BASELINE VDJ_MATH_ISA_SCALAR
+#endif
+
+static const VdjMathKernels* BaselineKernels() {
+    static const VdjMathKernels kernels = VdjMathApprox<VdjMathF4>::Table(VDJ_MATH_ISA_BASELINE);
+    return &kernels;
+}
+
+/* ============================================================================
+   Dispatch
+   ============================================================================ */
+
+static std::atomic<const VdjMathKernels*> activeKernels { nullptr };
+
+static const VdjMathKernels* Kernels(int isa) {
+    if (isa == VDJ_MATH_ISA_BASELINE) return BaselineKernels();
+    if (isa == VDJ_MATH_ISA_AVX2) return VdjMathAvx2Kernels();
+    return nullptr;
+}
+
+const VdjMathKernels& VdjMathActive() {
+    const VdjMathKernels *kernels = activeKernels.load(std::memory_order_acquire);
+    if (kernels) return *kernels;
+    const VdjMathKernels *detected = VdjMathAvx2Kernels();
+    if (!detected) detected = BaselineKernels();
+    // Keep a selection another thread made meanwhile
+    if (activeKernels.compare_exchange_strong(kernels, detected, std::memory_order_acq_rel)) return *detected;
+    return *kernels;
+}
+
+bool VdjMathSelect(int isa) {
+    const VdjMathKernels *kernels = Kernels(isa);
+    if (!kernels) return false;
+    activeKernels.store(kernels, std::memory_order_release);
+    return true;
+}
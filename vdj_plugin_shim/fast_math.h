@@ -0,0 +1,45 @@
+/**
+ * VirtualDJ Rust SDK - Fast Math
+ *
+ * Vectorized exp, log, pow, sin and tanh over float blocks, in a fast and a
+ * precise tier with the error bounds documented in the ABI header. Each
+ * function is built for the baseline SIMD of the target (SSE2, NEON or
+ * scalar) and, on x86, for AVX2 with FMA; the widest set the CPU supports
+ * is picked on first use.
+ */
+
+#ifndef VDJ_SHIM_FAST_MATH_H
+#define VDJ_SHIM_FAST_MATH_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+typedef void (*VdjMathUnary)(const float *in, float *out, int count);
+typedef void (*VdjMathBinary)(const float *a, const float *b, float *out, int count);
+
+/**
+ * One instruction set's kernels, indexed by tier (VDJ_MATH_FAST or
+ * VDJ_MATH_PRECISE)
+ */
+struct VdjMathKernels {
+    VdjMathUnary exp[2];
+    VdjMathUnary log[2];
+    VdjMathUnary sin[2];
+    VdjMathUnary tanh[2];
+    VdjMathBinary pow[2];
+    int isa;                    /* VDJ_MATH_ISA_* */
+    int width;                  /* floats per vector */
+};
+
+/** The kernels in use; detects the CPU on the first call */
+const VdjMathKernels& VdjMathActive();
+
+/**
+ * Use the kernels for isa (VDJ_MATH_ISA_*) from now on. False, leaving the
+ * selection unchanged, when they are not built or the CPU lacks them.
+ */
+bool VdjMathSelect(int isa);
+
+/** The AVX2 kernels, or nullptr when not built or not supported by the CPU */
+const VdjMathKernels* VdjMathAvx2Kernels();
+
+#endif /* VDJ_SHIM_FAST_MATH_H */
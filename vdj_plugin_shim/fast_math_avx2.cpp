@@ -0,0 +1,121 @@
+/**
+ * VirtualDJ Rust SDK - Fast Math, AVX2 Kernels
+ *
+ * Compiled for AVX2 and FMA whatever flags the shim is built with, and only
+ * called once VdjMathAvx2Kernels has checked the CPU. Standard headers are
+ * included before the target switch so none of their inline code is built
+ * for AVX2 and shared with the rest of the shim.
+ */
+
+#include "fast_math.h"
+
+#include <cfloat>
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define VDJ_MATH_AVX2 1
+#include <immintrin.h>
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+#elif defined(_MSC_VER) && defined(_M_X64)
+/* MSVC accepts AVX2 intrinsics without /arch:AVX2 */
+#define VDJ_MATH_AVX2 1
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#if defined(VDJ_MATH_AVX2)
+
+#include "fast_math_kernels.h"
+
+/* ============================================================================
+   AVX2 Kernels
+   ============================================================================ */
+
+namespace {
+
+struct VdjMathF8 {
+    using V = __m256;
+    enum { Width = 8 };
+
+    static V Set1(float x) { return _mm256_set1_ps(x); }
+    static V Load(const float *p) { return _mm256_loadu_ps(p); }
+    static void Store(float *p, V a) { _mm256_storeu_ps(p, a); }
+    static V Add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V MulAdd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+    static V Div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V Min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V Max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V Abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static V Round(V a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static V Less(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static V Select(V mask, V a, V b) { return _mm256_blendv_ps(b, a, mask); }
+    static V Ldexp(V a, V k) {
+        const __m256i e = _mm256_slli_epi32(_mm256_cvtps_epi32(k), 23);
+        return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(a), e));
+    }
+    static V Exponent(V a) {
+        const __m256i e = _mm256_srli_epi32(_mm256_castps_si256(a), 23);
+        return _mm256_cvtepi32_ps(_mm256_sub_epi32(e, _mm256_set1_epi32(127)));
+    }
+    static V Mantissa(V a) {
+        const __m256i m = _mm256_and_si256(_mm256_castps_si256(a), _mm256_set1_epi32(0x007fffff));
+        return _mm256_castsi256_ps(_mm256_or_si256(m, _mm256_set1_epi32(0x3f800000)));
+    }
+};
+
+void FillAvx2Kernels(VdjMathKernels *kernels) {
+    *kernels = VdjMathApprox<VdjMathF8>::Table(VDJ_MATH_ISA_AVX2);
+}
+
+}  // namespace
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+/* ============================================================================
+   Detection
+   ============================================================================ */
+
+static bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    // The OS must save the YMM registers
+    if (!fma || !osxsave || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+const VdjMathKernels* VdjMathAvx2Kernels() {
+    static const VdjMathKernels *kernels = []() -> const VdjMathKernels* {
+        if (!CpuHasAvx2()) return nullptr;
+        static VdjMathKernels avx2;
+        FillAvx2Kernels(&avx2);
+        return &avx2;
+    }();
+    return kernels;
+}
+
+#else
+
+const VdjMathKernels* VdjMathAvx2Kernels() {
+    return nullptr;
+}
+
+#endif
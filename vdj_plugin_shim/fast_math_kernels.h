@@ -0,0 +1,200 @@
+/**
+ * VirtualDJ Rust SDK - Fast Math Kernels
+ *
+ * The approximations behind fast_math.h, written once against a vector ops
+ * struct O (V, Width, Set1, Load, Store, Add, Sub, Mul, MulAdd, Div, Min,
+ * Max, Abs, Round, Less, Select, Ldexp, Exponent, Mantissa) and compiled
+ * by each instruction set's translation unit. Internal to the shim:
+ * everything here has internal linkage, so a kernel built for AVX2 is never
+ * merged with the baseline one by the linker.
+ */
+
+#ifndef VDJ_SHIM_FAST_MATH_KERNELS_H
+#define VDJ_SHIM_FAST_MATH_KERNELS_H
+
+#include "fast_math.h"
+
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+template <typename O>
+struct VdjMathApprox {
+    using V = typename O::V;
+
+    static V C(float c) { return O::Set1(c); }
+
+    /* e^x = 2^k e^r, |r| <= ln2 / 2, with ln2 split so k ln2 is exact */
+    template <bool Precise>
+    static V Exp(V x) {
+        const V lo = C(-87.0f), hi = C(88.3f);
+        const V xc = O::Min(O::Max(x, lo), hi);
+        const V k = O::Round(O::Mul(xc, C(1.44269504f)));
+        V r = O::MulAdd(k, C(-0.693359375f), xc);
+        r = O::MulAdd(k, C(2.12194440e-4f), r);
+        V p;
+        if (Precise) {
+            // Cephes expf
+            p = O::MulAdd(C(1.9875691500e-4f), r, C(1.3981999507e-3f));
+            p = O::MulAdd(p, r, C(8.3334519073e-3f));
+            p = O::MulAdd(p, r, C(4.1665795894e-2f));
+            p = O::MulAdd(p, r, C(1.6666665459e-1f));
+            p = O::MulAdd(p, r, C(5.0000001201e-1f));
+        } else {
+            // Degree 4, fitted for relative error
+            p = O::MulAdd(C(4.187566893e-2f), r, C(1.674191364e-1f));
+            p = O::MulAdd(p, r, C(4.999949755e-1f));
+        }
+        p = O::Add(O::MulAdd(p, O::Mul(r, r), r), C(1.0f));
+        V y = O::Ldexp(p, k);
+        y = O::Select(O::Less(x, lo), C(0.0f), y);
+        return O::Select(O::Less(hi, x), C(HUGE_VALF), y);
+    }
+
+    /* ln x = k ln2 + ln(1 + t), 1 + t in [sqrt(1/2), sqrt(2)) */
+    template <bool Precise>
+    static V Log(V x) {
+        const V xn = O::Max(x, C(FLT_MIN));
+        V e = O::Exponent(xn);
+        V m = O::Mantissa(xn);
+        const V big = O::Less(C(1.41421356f), m);
+        m = O::Select(big, O::Mul(m, C(0.5f)), m);
+        e = O::Select(big, O::Add(e, C(1.0f)), e);
+        const V t = O::Sub(m, C(1.0f));
+        const V z = O::Mul(t, t);
+        V p;
+        if (Precise) {
+            // Cephes logf
+            p = O::MulAdd(C(7.0376836292e-2f), t, C(-1.1514610310e-1f));
+            p = O::MulAdd(p, t, C(1.1676998740e-1f));
+            p = O::MulAdd(p, t, C(-1.2420140846e-1f));
+            p = O::MulAdd(p, t, C(1.4249322787e-1f));
+            p = O::MulAdd(p, t, C(-1.6668057665e-1f));
+            p = O::MulAdd(p, t, C(2.0000714765e-1f));
+            p = O::MulAdd(p, t, C(-2.4999993993e-1f));
+            p = O::MulAdd(p, t, C(3.3333331174e-1f));
+        } else {
+            // Degree 6, fitted for absolute error
+            p = O::MulAdd(C(-1.553214191e-1f), t, C(2.158572229e-1f));
+            p = O::MulAdd(p, t, C(-2.510995743e-1f));
+            p = O::MulAdd(p, t, C(3.330994581e-1f));
+        }
+        V y = O::Mul(O::Mul(t, z), p);
+        y = O::MulAdd(e, C(-2.12194440e-4f), y);
+        y = O::MulAdd(z, C(-0.5f), y);
+        y = O::MulAdd(e, C(0.693359375f), O::Add(t, y));
+        // Zero and subnormals, negatives, +inf
+        y = O::Select(O::Less(x, C(FLT_MIN)), C(-HUGE_VALF), y);
+        y = O::Select(O::Less(x, C(0.0f)), C(NAN), y);
+        return O::Select(O::Less(C(FLT_MAX), x), C(HUGE_VALF), y);
+    }
+
+    template <bool Precise>
+    static V Pow(V x, V y) {
+        const V r = Exp<Precise>(O::Mul(y, Log<Precise>(x)));
+        return O::Select(O::Less(x, C(0.0f)), C(NAN), r);
+    }
+
+    /* Reduce to [-pi, pi] with 2 pi in three parts, fold to [-pi/2, pi/2] */
+    template <bool Precise>
+    static V Sin(V x) {
+        const V k = O::Round(O::Mul(x, C(0.159154937f)));
+        V r = O::MulAdd(k, C(-6.28125f), x);
+        r = O::MulAdd(k, C(-1.9354820251464844e-3f), r);
+        r = O::MulAdd(k, C(1.7484555314695172e-7f), r);
+        const V piHi = C(3.14159274f), piLo = C(-8.74227801e-8f);
+        r = O::Select(O::Less(C(1.57079637f), r), O::Add(O::Sub(piHi, r), piLo), r);
+        r = O::Select(O::Less(r, C(-1.57079637f)), O::Sub(O::Sub(C(-3.14159274f), r), piLo), r);
+        const V z = O::Mul(r, r);
+        V p;
+        if (Precise) {
+            // Taylor to degree 11
+            p = O::MulAdd(C(-2.50521084e-8f), z, C(2.75573192e-6f));
+            p = O::MulAdd(p, z, C(-1.98412698e-4f));
+            p = O::MulAdd(p, z, C(8.33333333e-3f));
+            p = O::MulAdd(p, z, C(-1.66666667e-1f));
+        } else {
+            // Degree 7, fitted for absolute error
+            p = O::MulAdd(C(-1.884850526e-4f), z, C(8.324241901e-3f));
+            p = O::MulAdd(p, z, C(-1.666654298e-1f));
+        }
+        return O::MulAdd(O::Mul(r, z), p, r);
+    }
+
+    template <bool Precise>
+    static V Tanh(V x) {
+        if (!Precise) {
+            // Pade [7/6], clamped where it reaches 1
+            const V xc = O::Min(O::Max(x, C(-4.97f)), C(4.97f));
+            const V z = O::Mul(xc, xc);
+            V n = O::MulAdd(O::Add(z, C(378.0f)), z, C(17325.0f));
+            n = O::Mul(O::MulAdd(n, z, C(135135.0f)), xc);
+            V d = O::MulAdd(C(28.0f), z, C(3150.0f));
+            d = O::MulAdd(d, z, C(62370.0f));
+            d = O::MulAdd(d, z, C(135135.0f));
+            return O::Min(O::Max(O::Div(n, d), C(-1.0f)), C(1.0f));
+        }
+        // Cephes tanhf near zero, 1 - 2 / (e^2|x| + 1) elsewhere
+        const V a = O::Abs(x);
+        const V z = O::Mul(a, a);
+        V p = O::MulAdd(C(-5.70498872745e-3f), z, C(2.06390887954e-2f));
+        p = O::MulAdd(p, z, C(-5.37397155531e-2f));
+        p = O::MulAdd(p, z, C(1.33314422036e-1f));
+        p = O::MulAdd(p, z, C(-3.33332819422e-1f));
+        const V small = O::MulAdd(O::Mul(p, z), a, a);
+        const V e = Exp<true>(O::Mul(C(2.0f), O::Min(a, C(9.0f))));
+        const V large = O::Sub(C(1.0f), O::Div(C(2.0f), O::Add(e, C(1.0f))));
+        const V r = O::Select(O::Less(a, C(0.625f)), small, large);
+        return O::Select(O::Less(x, C(0.0f)), O::Sub(C(0.0f), r), r);
+    }
+
+    /* Full vectors, then the tail through a zero-padded one */
+    template <V (*Kernel)(V)>
+    static void Map(const float *in, float *out, int count) {
+        int i = 0;
+        for (; i + O::Width <= count; i += O::Width) O::Store(out + i, Kernel(O::Load(in + i)));
+        if (i == count) return;
+        float lanes[O::Width] = {};
+        for (int j = i; j < count; j++) lanes[j - i] = in[j];
+        O::Store(lanes, Kernel(O::Load(lanes)));
+        for (int j = i; j < count; j++) out[j] = lanes[j - i];
+    }
+
+    template <V (*Kernel)(V, V)>
+    static void Map2(const float *a, const float *b, float *out, int count) {
+        int i = 0;
+        for (; i + O::Width <= count; i += O::Width) {
+            O::Store(out + i, Kernel(O::Load(a + i), O::Load(b + i)));
+        }
+        if (i == count) return;
+        float lanesA[O::Width] = {}, lanesB[O::Width] = {};
+        for (int j = i; j < count; j++) {
+            lanesA[j - i] = a[j];
+            lanesB[j - i] = b[j];
+        }
+        O::Store(lanesA, Kernel(O::Load(lanesA), O::Load(lanesB)));
+        for (int j = i; j < count; j++) out[j] = lanesA[j - i];
+    }
+
+    static VdjMathKernels Table(int isa) {
+        VdjMathKernels k;
+        k.exp[VDJ_MATH_FAST] = Map<Exp<false>>;
+        k.exp[VDJ_MATH_PRECISE] = Map<Exp<true>>;
+        k.log[VDJ_MATH_FAST] = Map<Log<false>>;
+        k.log[VDJ_MATH_PRECISE] = Map<Log<true>>;
+        k.sin[VDJ_MATH_FAST] = Map<Sin<false>>;
+        k.sin[VDJ_MATH_PRECISE] = Map<Sin<true>>;
+        k.tanh[VDJ_MATH_FAST] = Map<Tanh<false>>;
+        k.tanh[VDJ_MATH_PRECISE] = Map<Tanh<true>>;
+        k.pow[VDJ_MATH_FAST] = Map2<Pow<false>>;
+        k.pow[VDJ_MATH_PRECISE] = Map2<Pow<true>>;
+        k.isa = isa;
+        k.width = O::Width;
+        return k;
+    }
+};
+
+}  // namespace
+
+#endif /* VDJ_SHIM_FAST_MATH_KERNELS_H */
@@ -0,0 +1,105 @@
+/**
+ * VirtualDJ Rust SDK - Instance Memory
+ */
+
+#include "instance_memory.h"
+
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* Matches VDJ_CACHE_LINE_SIZE in the ABI header */
+static const size_t kCacheLine = 64;
+
+static size_t PageSize() {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwPageSize;
+#else
+    const long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (size_t)size : 4096;
+#endif
+}
+
+static size_t RoundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+/* ============================================================================
+   Instances
+   ============================================================================ */
+
+// The first cache line holds the allocation size; the object starts on the
+// next one
+void* VdjInstanceAllocate(size_t size) {
+    const size_t total = kCacheLine + RoundUp(size, kCacheLine);
+    char *block = static_cast<char*>(::operator new(total, std::align_val_t(kCacheLine), std::nothrow));
+    if (!block) return nullptr;
+
+    // Writing every byte faults all the pages in now, on the creating thread
+    memset(block, 0, total);
+    memcpy(block, &total, sizeof(total));
+    return block + kCacheLine;
+}
+
+void VdjInstanceFree(void *object) {
+    if (!object) return;
+    ::operator delete(static_cast<char*>(object) - kCacheLine, std::align_val_t(kCacheLine));
+}
+
+size_t VdjInstanceBytes(const void *object) {
+    if (!object) return 0;
+    size_t total;
+    memcpy(&total, static_cast<const char*>(object) - kCacheLine, sizeof(total));
+    return total;
+}
+
+/* ============================================================================
+   State Regions
+   ============================================================================ */
+
+VdjStateRegion::~VdjStateRegion() {
+    if (!base) return;
+#if defined(_WIN32)
+    if (lockedBytes) VirtualUnlock(base, lockedBytes);
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    if (lockedBytes) munlock(base, lockedBytes);
+    munmap(base, bytes);
+#endif
+}
+
+bool VdjStateRegion::Reserve(size_t size, bool lock) {
+    if (base || size == 0) return false;
+    const size_t total = RoundUp(size, PageSize());
+
+#if defined(_WIN32)
+    void *region = VirtualAlloc(nullptr, total, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!region) return false;
+#else
+    void *region = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) return false;
+#endif
+
+    // Fresh mappings are zero but not backed yet: one write per page backs them
+    const size_t page = PageSize();
+    for (size_t offset = 0; offset < total; offset += page) {
+        static_cast<volatile char*>(region)[offset] = 0;
+    }
+
+    base = region;
+    bytes = total;
+#if defined(_WIN32)
+    if (lock && VirtualLock(region, total)) lockedBytes = total;
+#else
+    if (lock && mlock(region, total) == 0) lockedBytes = total;
+#endif
+    return true;
+}
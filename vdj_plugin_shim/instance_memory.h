@@ -0,0 +1,54 @@
+/**
+ * VirtualDJ Rust SDK - Instance Memory
+ *
+ * Allocation for shim instances and the plugin state regions they own.
+ * Instances are placed on cache lines of their own, so host-written fields of
+ * neighbouring instances never share a line, and state regions are mapped,
+ * touched and optionally locked when reserved, so the audio thread takes no
+ * page faults in the first blocks after an effect is enabled.
+ *
+ * Kept free of the ABI header so the platform headers can be included next
+ * to it.
+ */
+
+#ifndef VDJ_SHIM_INSTANCE_MEMORY_H
+#define VDJ_SHIM_INSTANCE_MEMORY_H
+
+#include <cstddef>
+
+/**
+ * Allocate `size` zeroed bytes starting on a cache line and spanning whole
+ * cache lines, every page touched. Returns nullptr when out of memory.
+ */
+void* VdjInstanceAllocate(size_t size);
+
+void VdjInstanceFree(void *object);
+
+/**
+ * Bytes reserved for an object returned by VdjInstanceAllocate, its
+ * bookkeeping line included
+ */
+size_t VdjInstanceBytes(const void *object);
+
+/**
+ * Page-aligned memory owned by one instance for the plugin's own state
+ */
+struct VdjStateRegion {
+    VdjStateRegion() = default;
+    VdjStateRegion(const VdjStateRegion&) = delete;
+    VdjStateRegion& operator=(const VdjStateRegion&) = delete;
+    ~VdjStateRegion();
+
+    /**
+     * Map at least `size` zeroed bytes and touch every page, then lock them
+     * in RAM when asked; lockedBytes stays 0 if the OS refuses. Returns false
+     * when out of memory or already reserved. Control thread only.
+     */
+    bool Reserve(size_t size, bool lock);
+
+    void *base = nullptr;
+    size_t bytes = 0;
+    size_t lockedBytes = 0;
+};
+
+#endif /* VDJ_SHIM_INSTANCE_MEMORY_H */
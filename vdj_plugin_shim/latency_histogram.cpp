@@ -0,0 +1,185 @@
+/**
+ * VirtualDJ Rust SDK - Callback Latency Histograms
+ */
+
+#include "latency_histogram.h"
+
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const char *const kCallbackNames[VDJ_PROFILE_CALLBACK_COUNT] = {
+    "process_samples",
+    "get_song_buffer",
+    "transform_position",
+    "draw",
+    "audio_samples",
+    "parameter",
+    "start",
+    "stop",
+    "device",
+    "online_source",
+    "load",
+};
+
+static int HighestBit(uint64_t v) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return (int)index;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanReverse(&index, (unsigned long)(v >> 32))) return (int)index + 32;
+    _BitScanReverse(&index, (unsigned long)v);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+static int BucketIndex(uint64_t ns) {
+    if (ns < VDJ_LATENCY_SUB_BUCKETS) return (int)ns;
+    const int msb = HighestBit(ns);
+    const int index = (msb - 3) * VDJ_LATENCY_SUB_BUCKETS + (int)((ns >> (msb - 4)) & (VDJ_LATENCY_SUB_BUCKETS - 1));
+    return index < VDJ_LATENCY_BUCKETS ? index : VDJ_LATENCY_BUCKETS - 1;
+}
+
+/* Smallest value falling into a bucket */
+static uint64_t BucketLow(int index) {
+    if (index < VDJ_LATENCY_SUB_BUCKETS) return (uint64_t)index;
+    const int msb = index / VDJ_LATENCY_SUB_BUCKETS + 3;
+    return (uint64_t)(VDJ_LATENCY_SUB_BUCKETS + index % VDJ_LATENCY_SUB_BUCKETS) << (msb - 4);
+}
+
+/* ============================================================================
+   VdjLatencyHistogram
+   ============================================================================ */
+
+void VdjLatencyHistogram::Record(uint64_t ns, bool overrun) {
+    buckets[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(ns, std::memory_order_relaxed);
+    if (overrun) overruns.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t lo = minNs.load(std::memory_order_relaxed);
+    while (ns < lo && !minNs.compare_exchange_weak(lo, ns, std::memory_order_relaxed)) {}
+    uint64_t hi = maxNs.load(std::memory_order_relaxed);
+    while (ns > hi && !maxNs.compare_exchange_weak(hi, ns, std::memory_order_relaxed)) {}
+}
+
+void VdjLatencyHistogram::Snapshot(VdjLatencyStats *stats) const {
+    // Copy the buckets first so percentiles are computed from one consistent
+    // total even while the audio thread keeps recording
+    uint64_t copy[VDJ_LATENCY_BUCKETS];
+    uint64_t total = 0;
+    for (int i = 0; i < VDJ_LATENCY_BUCKETS; i++) {
+        copy[i] = buckets[i].load(std::memory_order_relaxed);
+        total += copy[i];
+    }
+
+    *stats = VdjLatencyStats();
+    stats->count = total;
+    stats->overruns = overruns.load(std::memory_order_relaxed);
+    if (total == 0) return;
+
+    const uint64_t recorded = count.load(std::memory_order_relaxed);
+    stats->min_ns = minNs.load(std::memory_order_relaxed);
+    stats->max_ns = maxNs.load(std::memory_order_relaxed);
+    stats->mean_ns = recorded ? sumNs.load(std::memory_order_relaxed) / recorded : 0;
+
+    const double quantiles[4] = { 0.5, 0.9, 0.99, 0.999 };
+    uint64_t *results[4] = { &stats->p50_ns, &stats->p90_ns, &stats->p99_ns, &stats->p999_ns };
+    uint64_t seen = 0;
+    int q = 0;
+    for (int i = 0; i < VDJ_LATENCY_BUCKETS && q < 4; i++) {
+        seen += copy[i];
+        // Report the bucket's upper edge, capped at the largest value seen
+        while (q < 4 && (double)seen >= quantiles[q] * (double)total) {
+            const uint64_t high = BucketLow(i + 1) - 1;
+            *results[q++] = high < stats->max_ns ? high : stats->max_ns;
+        }
+    }
+}
+
+void VdjLatencyHistogram::Dump(FILE *file, const char *name) const {
+    for (int i = 0; i < VDJ_LATENCY_BUCKETS; i++) {
+        const uint64_t n = buckets[i].load(std::memory_order_relaxed);
+        if (n == 0) continue;
+        fprintf(file, "%s %llu %llu %llu\n", name,
+                (unsigned long long)BucketLow(i), (unsigned long long)(BucketLow(i + 1) - 1),
+                (unsigned long long)n);
+    }
+}
+
+void VdjLatencyHistogram::Reset() {
+    for (int i = 0; i < VDJ_LATENCY_BUCKETS; i++) buckets[i].store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+    sumNs.store(0, std::memory_order_relaxed);
+    minNs.store(UINT64_MAX, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+/* ============================================================================
+   VdjProfiler
+   ============================================================================ */
+
+VdjProfiler::~VdjProfiler() {
+    delete[] histograms.load();
+}
+
+HRESULT VdjProfiler::Enable(bool enable) {
+    if (enable && !histograms.load(std::memory_order_acquire)) {
+        VdjLatencyHistogram *h = new (std::nothrow) VdjLatencyHistogram[VDJ_PROFILE_CALLBACK_COUNT];
+        if (!h) return E_FAIL;
+        VdjLatencyHistogram *expected = nullptr;
+        if (!histograms.compare_exchange_strong(expected, h, std::memory_order_acq_rel)) delete[] h;
+    }
+    enabled.store(enable, std::memory_order_relaxed);
+    return S_OK;
+}
+
+HRESULT VdjProfiler::GetStats(int callback, VdjLatencyStats *stats) const {
+    if (!stats || callback < 0 || callback >= VDJ_PROFILE_CALLBACK_COUNT) return E_FAIL;
+    const VdjLatencyHistogram *h = histograms.load(std::memory_order_acquire);
+    if (!h) {
+        *stats = VdjLatencyStats();
+        return S_FALSE;
+    }
+    h[callback].Snapshot(stats);
+    return S_OK;
+}
+
+HRESULT VdjProfiler::Reset() {
+    VdjLatencyHistogram *h = histograms.load(std::memory_order_acquire);
+    if (!h) return S_FALSE;
+    for (int i = 0; i < VDJ_PROFILE_CALLBACK_COUNT; i++) h[i].Reset();
+    return S_OK;
+}
+
+HRESULT VdjProfiler::Dump(const char *path) const {
+    const VdjLatencyHistogram *h = histograms.load(std::memory_order_acquire);
+    if (!path || !h) return E_FAIL;
+    FILE *file = fopen(path, "w");
+    if (!file) return E_FAIL;
+
+    fprintf(file, "# callback count overruns min_ns mean_ns p50_ns p90_ns p99_ns p99.9_ns max_ns\n");
+    for (int i = 0; i < VDJ_PROFILE_CALLBACK_COUNT; i++) {
+        VdjLatencyStats s;
+        h[i].Snapshot(&s);
+        if (s.count == 0) continue;
+        fprintf(file, "%s %llu %llu %llu %llu %llu %llu %llu %llu %llu\n", kCallbackNames[i],
+                (unsigned long long)s.count, (unsigned long long)s.overruns,
+                (unsigned long long)s.min_ns, (unsigned long long)s.mean_ns,
+                (unsigned long long)s.p50_ns, (unsigned long long)s.p90_ns,
+                (unsigned long long)s.p99_ns, (unsigned long long)s.p999_ns,
+                (unsigned long long)s.max_ns);
+    }
+
+    fprintf(file, "# callback bucket_low_ns bucket_high_ns count\n");
+    for (int i = 0; i < VDJ_PROFILE_CALLBACK_COUNT; i++) h[i].Dump(file, kCallbackNames[i]);
+
+    return fclose(file) == 0 ? S_OK : E_FAIL;
+}
@@ -0,0 +1,66 @@
+/**
+ * VirtualDJ Rust SDK - Callback Latency Histograms
+ *
+ * Per-instance, lock-free latency histograms for the plugin entry points.
+ * Buckets are log-linear (16 sub-buckets per power of two, about 6% wide),
+ * HDR-histogram style, so tail percentiles stay accurate from tens of
+ * nanoseconds to seconds without storing samples. The audio thread only
+ * does relaxed atomic adds; readers take a snapshot from any thread.
+ */
+
+#ifndef VDJ_SHIM_LATENCY_HISTOGRAM_H
+#define VDJ_SHIM_LATENCY_HISTOGRAM_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <atomic>
+#include <cstdio>
+
+#define VDJ_LATENCY_SUB_BUCKETS 16
+#define VDJ_LATENCY_BUCKETS     592     /* up to 2^40 ns (about 18 minutes) */
+
+struct VdjLatencyHistogram {
+    std::atomic<uint64_t> buckets[VDJ_LATENCY_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> overruns;
+    std::atomic<uint64_t> sumNs;
+    std::atomic<uint64_t> minNs;
+    std::atomic<uint64_t> maxNs;
+
+    VdjLatencyHistogram() { Reset(); }
+
+    void Record(uint64_t ns, bool overrun);
+    void Snapshot(VdjLatencyStats *stats) const;
+    void Dump(FILE *file, const char *name) const;
+    void Reset();
+};
+
+struct VdjProfiler {
+    VdjProfiler() = default;
+    VdjProfiler(const VdjProfiler&) = delete;
+    VdjProfiler& operator=(const VdjProfiler&) = delete;
+    ~VdjProfiler();
+
+    /**
+     * Start or stop recording. The histograms are allocated on first use and
+     * kept until the instance is released, so a callback recording while
+     * profiling is turned off never touches freed memory.
+     */
+    HRESULT Enable(bool enable);
+
+    /** Histogram of a callback, or nullptr while profiling is off */
+    VdjLatencyHistogram* Active(int callback) const {
+        if (!enabled.load(std::memory_order_relaxed)) return nullptr;
+        VdjLatencyHistogram *h = histograms.load(std::memory_order_acquire);
+        return h ? h + callback : nullptr;
+    }
+
+    HRESULT GetStats(int callback, VdjLatencyStats *stats) const;
+    HRESULT Reset();
+    HRESULT Dump(const char *path) const;
+
+    std::atomic<bool> enabled { false };
+    std::atomic<VdjLatencyHistogram*> histograms { nullptr };   /* VDJ_PROFILE_CALLBACK_COUNT */
+};
+
+#endif /* VDJ_SHIM_LATENCY_HISTOGRAM_H */
@@ -0,0 +1,78 @@
+/**
+ * VirtualDJ Rust SDK - Lookup Tables
+ */
+
+#include "lut.h"
+#include "constexpr_math.h"
+
+#include <array>
+
+/* ============================================================================
+   Table Generation
+   ============================================================================ */
+
+namespace {
+
+using VdjLutValues = std::array<float, VDJ_LUT_SIZE>;
+
+template <typename Function>
+constexpr VdjLutValues Generate(double min, double max, Function f) {
+    VdjLutValues values {};
+    for (int i = 0; i < VDJ_LUT_SIZE; i++) {
+        values[i] = (float)f(min + (max - min) * (double)i / (double)(VDJ_LUT_SIZE - 1));
+    }
+    return values;
+}
+
+}  // namespace
+
+/* ============================================================================
+   Tables
+   ============================================================================ */
+
+alignas(VDJ_CACHE_LINE_SIZE) static constexpr VdjLutValues sineValues =
+    Generate(0.0, 1.0, [](double x) { return Sin(2.0 * kPi * x); });
+alignas(VDJ_CACHE_LINE_SIZE) static constexpr VdjLutValues dbToGainValues =
+    Generate(-144.0, 24.0, [](double x) { return Exp(x * kLn10 / 20.0); });
+alignas(VDJ_CACHE_LINE_SIZE) static constexpr VdjLutValues log2Values =
+    Generate(1.0, 2.0, [](double x) { return Log(x) / kLn2; });
+alignas(VDJ_CACHE_LINE_SIZE) static constexpr VdjLutValues tanhValues =
+    Generate(-8.0, 8.0, [](double x) { return Tanh(x); });
+alignas(VDJ_CACHE_LINE_SIZE) static constexpr VdjLutValues hannValues =
+    Generate(0.0, 1.0, [](double x) { return Sin(kPi * x) * Sin(kPi * x); });
+alignas(VDJ_CACHE_LINE_SIZE) static constexpr VdjLutValues blackmanValues =
+    Generate(0.0, 1.0, [](double x) { return 0.42 - 0.5 * Cos(2.0 * kPi * x) + 0.08 * Cos(4.0 * kPi * x); });
+alignas(VDJ_CACHE_LINE_SIZE) static constexpr VdjLutValues noteToFreqValues =
+    Generate(0.0, 128.0, [](double x) { return 440.0 * Exp((x - 69.0) / 12.0 * kLn2); });
+
+/* Evaluated by the compiler: a table that fails these never builds */
+static_assert(sineValues[256] == 1.0f && sineValues[768] == -1.0f, "sine table");
+static_assert(log2Values[0] == 0.0f && log2Values[VDJ_LUT_SIZE - 1] == 1.0f, "log2 table");
+static_assert(hannValues[512] == 1.0f && hannValues[0] == 0.0f, "Hann table");
+static_assert(noteToFreqValues[69 * 8] == 440.0f && noteToFreqValues[81 * 8] == 880.0f, "note table");
+
+static constexpr VdjLut MakeLut(const VdjLutValues &values, float min, float max, uint32_t flags) {
+    return { values.data(), min, max, (float)(VDJ_LUT_SIZE - 1) / (max - min), flags };
+}
+
+static constexpr VdjLut luts[VDJ_LUT_COUNT] = {
+    MakeLut(sineValues, 0.0f, 1.0f, VDJ_LUT_WRAP),
+    MakeLut(dbToGainValues, -144.0f, 24.0f, 0),
+    MakeLut(log2Values, 1.0f, 2.0f, 0),
+    MakeLut(tanhValues, -8.0f, 8.0f, 0),
+    MakeLut(hannValues, 0.0f, 1.0f, 0),
+    MakeLut(blackmanValues, 0.0f, 1.0f, 0),
+    MakeLut(noteToFreqValues, 0.0f, 128.0f, 0),
+};
+
+/* ============================================================================
+   Lookups
+   ============================================================================ */
+
+const VdjLut* VdjLutFind(int table) {
+    return table >= 0 && table < VDJ_LUT_COUNT ? &luts[table] : nullptr;
+}
+
+void VdjLutLookupBlock(const VdjLut &lut, const float *in, float *out, int count) {
+    for (int i = 0; i < count; i++) out[i] = VdjLutLookup(lut, in[i]);
+}
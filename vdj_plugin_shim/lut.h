@@ -0,0 +1,34 @@
+/**
+ * VirtualDJ Rust SDK - Lookup Tables
+ *
+ * Sine, dB to gain, log2, tanh, window and note to frequency tables,
+ * generated by constexpr code when the shim is compiled, so they live in
+ * read-only data shared by every instance and cost nothing at startup.
+ * Lookups interpolate linearly between the table points.
+ */
+
+#ifndef VDJ_SHIM_LUT_H
+#define VDJ_SHIM_LUT_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <cmath>
+
+/** Table VDJ_LUT_*, or nullptr for an unknown one */
+const VdjLut* VdjLutFind(int table);
+
+static inline float VdjLutLookup(const VdjLut &lut, float x) {
+    const float last = (float)(VDJ_LUT_SIZE - 1);
+    float pos = (x - lut.min) * lut.scale;
+    if (lut.flags & VDJ_LUT_WRAP) pos -= floorf(pos / last) * last;
+    // Clamp, sending NaN to the first point
+    pos = pos > 0.0f ? (pos < last ? pos : last) : 0.0f;
+    int i = (int)pos;
+    if (i > VDJ_LUT_SIZE - 2) i = VDJ_LUT_SIZE - 2;
+    const float a = lut.values[i];
+    return a + (lut.values[i + 1] - a) * (pos - (float)i);
+}
+
+void VdjLutLookupBlock(const VdjLut &lut, const float *in, float *out, int count);
+
+#endif /* VDJ_SHIM_LUT_H */
@@ -0,0 +1,201 @@
+/**
+ * VirtualDJ Rust SDK - Parameter Smoothing Ramps
+ */
+
+#include "param_ramp.h"
+#include "simd.h"
+
+#include <cmath>
+#include <new>
+
+static const std::align_val_t kRampAlignment = std::align_val_t(64);
+
+VdjParamRamps::~VdjParamRamps() {
+    for (VdjParamSmoother &s : smoothers) {
+        ::operator delete(s.values, kRampAlignment);
+    }
+}
+
+HRESULT VdjParamRamps::Declare(int id, const float *parameter, int mode, float timeMs) {
+    if (!parameter || mode < VDJ_RAMP_LINEAR || mode > VDJ_RAMP_ONEPOLE) return E_FAIL;
+    if (Find(id) || (int)smoothers.size() >= VDJ_RAMP_MAX_PARAMETERS) return E_FAIL;
+
+    // Reserve everything up front so the audio thread never sees a reallocation
+    if (smoothers.capacity() < VDJ_RAMP_MAX_PARAMETERS) smoothers.reserve(VDJ_RAMP_MAX_PARAMETERS);
+
+    VdjParamSmoother s;
+    s.id = id;
+    s.parameter = parameter;
+    s.mode = mode;
+    s.timeMs = timeMs > 0.0f ? timeMs : 0.0f;
+    s.current = s.target = *parameter;
+    s.values = static_cast<float*>(::operator new(VDJ_RAMP_MAX_FRAMES * sizeof(float), kRampAlignment));
+    s.ramp.is_static = 1;
+    s.ramp.value = s.current;
+    smoothers.push_back(s);
+    return S_OK;
+}
+
+const VdjParamSmoother* VdjParamRamps::Find(int id) const {
+    for (const VdjParamSmoother &s : smoothers) {
+        if (s.id == id) return &s;
+    }
+    return nullptr;
+}
+
+/* ============================================================================
+   Ramp Kernels
+   ============================================================================ */
+
+static void Retarget(VdjParamSmoother &s, float target, int sampleRate) {
+    s.target = target;
+    const float frames = s.timeMs * 0.001f * (float)sampleRate;
+    if (frames < 1.0f) {
+        s.current = target;
+        s.remaining = 0;
+        return;
+    }
+
+    // Geometric steps only make sense between two positive values
+    s.shape = s.mode;
+    if (s.shape == VDJ_RAMP_EXPONENTIAL && !(s.current > 0.0f && target > 0.0f)) {
+        s.shape = VDJ_RAMP_LINEAR;
+    }
+
+    switch (s.shape) {
+    case VDJ_RAMP_EXPONENTIAL:
+        s.remaining = (int)frames;
+        s.rate = std::pow(target / s.current, 1.0f / (float)s.remaining);
+        break;
+    case VDJ_RAMP_ONEPOLE:
+        s.remaining = 0;
+        s.rate = std::exp(-1.0f / frames);
+        break;
+    default:
+        s.remaining = (int)frames;
+        s.rate = (target - s.current) / (float)s.remaining;
+        break;
+    }
+}
+
+/* Values move monotonically toward the target, so clamping each vector to the
+   target ends a ramp mid-vector without a scalar tail loop. */
+static inline VdjF4 ClampToTarget(VdjF4 v, VdjF4 target, bool rising) {
+    return rising ? VdjF4Min(v, target) : VdjF4Max(v, target);
+}
+
+static void RampLinear(VdjParamSmoother &s, int n) {
+    const int ramped = s.remaining < n ? s.remaining : n;
+    const bool rising = s.target > s.current;
+    const VdjF4 target = VdjF4Set1(s.target);
+    const VdjF4 inc = VdjF4Set1(4.0f * s.rate);
+    VdjF4 v = VdjF4Add(VdjF4Set1(s.current), VdjF4Mul(VdjF4Set1(s.rate), VdjF4Set(1.0f, 2.0f, 3.0f, 4.0f)));
+
+    int i = 0;
+    for (; i < ramped; i += VDJ_SIMD_WIDTH) {
+        VdjF4Store(s.values + i, ClampToTarget(v, target, rising));
+        v = VdjF4Add(v, inc);
+    }
+    for (; i < n; i += VDJ_SIMD_WIDTH) {
+        VdjF4Store(s.values + i, target);
+    }
+
+    s.remaining -= ramped;
+    s.current = s.remaining == 0 ? s.target : s.values[n - 1];
+}
+
+static void RampExponential(VdjParamSmoother &s, int n) {
+    const int ramped = s.remaining < n ? s.remaining : n;
+    const bool rising = s.target > s.current;
+    const float r = s.rate, r2 = r * r;
+    const VdjF4 target = VdjF4Set1(s.target);
+    const VdjF4 inc = VdjF4Set1(r2 * r2);
+    VdjF4 v = VdjF4Mul(VdjF4Set1(s.current), VdjF4Set(r, r2, r2 * r, r2 * r2));
+
+    int i = 0;
+    for (; i < ramped; i += VDJ_SIMD_WIDTH) {
+        VdjF4Store(s.values + i, ClampToTarget(v, target, rising));
+        v = VdjF4Mul(v, inc);
+    }
+    for (; i < n; i += VDJ_SIMD_WIDTH) {
+        VdjF4Store(s.values + i, target);
+    }
+
+    s.remaining -= ramped;
+    s.current = s.remaining == 0 ? s.target : s.values[n - 1];
+}
+
+static void RampOnePole(VdjParamSmoother &s, int n) {
+    // y[i] = target + (current - target) * a^(i+1)
+    const float a = s.rate, a2 = a * a;
+    const VdjF4 target = VdjF4Set1(s.target);
+    const VdjF4 decay = VdjF4Set1(a2 * a2);
+    VdjF4 e = VdjF4Mul(VdjF4Set1(s.current - s.target), VdjF4Set(a, a2, a2 * a, a2 * a2));
+
+    for (int i = 0; i < n; i += VDJ_SIMD_WIDTH) {
+        VdjF4Store(s.values + i, VdjF4Add(target, e));
+        e = VdjF4Mul(e, decay);
+    }
+
+    s.current = s.values[n - 1];
+    const float scale = std::fabs(s.target) > 1.0f ? std::fabs(s.target) : 1.0f;
+    if (std::fabs(s.current - s.target) < 1e-6f * scale) s.current = s.target;
+}
+
+/* Move the ramp on by frames that get no values, past the end of a long block */
+static void Skip(VdjParamSmoother &s, int frames) {
+    if (s.current == s.target) return;
+    if (s.shape == VDJ_RAMP_ONEPOLE) {
+        s.current = s.target + (s.current - s.target) * std::pow(s.rate, (float)frames);
+        const float scale = std::fabs(s.target) > 1.0f ? std::fabs(s.target) : 1.0f;
+        if (std::fabs(s.current - s.target) < 1e-6f * scale) s.current = s.target;
+        return;
+    }
+
+    const int skipped = s.remaining < frames ? s.remaining : frames;
+    s.remaining -= skipped;
+    if (s.remaining == 0) {
+        s.current = s.target;
+    } else if (s.shape == VDJ_RAMP_EXPONENTIAL) {
+        s.current *= std::pow(s.rate, (float)skipped);
+    } else {
+        s.current += s.rate * (float)skipped;
+    }
+}
+
+void VdjParamRamps::Process(int sampleRate, int nb) {
+    const int n = nb < VDJ_RAMP_MAX_FRAMES ? nb : VDJ_RAMP_MAX_FRAMES;
+
+    for (VdjParamSmoother &s : smoothers) {
+        // The host writes the declared storage from its UI thread; one read
+        // per block is all the synchronization the VDJ SDK offers.
+        const float target = *s.parameter;
+        if (target != s.target) Retarget(s, target, sampleRate);
+
+        if (s.current == s.target || n <= 0) {
+            s.ramp.values = nullptr;
+            s.ramp.count = 0;
+            s.ramp.is_static = 1;
+            s.ramp.value = s.current;
+            continue;
+        }
+
+        switch (s.shape) {
+        case VDJ_RAMP_EXPONENTIAL:
+            RampExponential(s, n);
+            break;
+        case VDJ_RAMP_ONEPOLE:
+            RampOnePole(s, n);
+            break;
+        default:
+            RampLinear(s, n);
+            break;
+        }
+        if (nb > n) Skip(s, nb - n);
+
+        s.ramp.values = s.values;
+        s.ramp.count = n;
+        s.ramp.is_static = 0;
+        s.ramp.value = s.current;
+    }
+}
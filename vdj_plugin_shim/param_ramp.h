@@ -0,0 +1,54 @@
+/**
+ * VirtualDJ Rust SDK - Parameter Smoothing Ramps
+ *
+ * Generates per-frame smoothed values for declared slider and ColorFX
+ * parameters once per block, so Rust reads a slice instead of running its own
+ * per-sample smoother for every parameter. Static parameters cost a compare.
+ */
+
+#ifndef VDJ_SHIM_PARAM_RAMP_H
+#define VDJ_SHIM_PARAM_RAMP_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <vector>
+
+struct VdjParamSmoother {
+    int id = 0;
+    const float *parameter = nullptr;   /* storage passed to DeclareParameter */
+    int mode = VDJ_RAMP_LINEAR;
+    float timeMs = 0.0f;
+
+    int shape = VDJ_RAMP_LINEAR;    /* kernel of the running ramp */
+    float current = 0.0f;   /* smoothed value at the end of the last block */
+    float target = 0.0f;    /* target of the running ramp */
+    float rate = 0.0f;      /* per-frame increment, ratio or pole */
+    int remaining = 0;      /* frames left for linear/exponential ramps */
+
+    float *values = nullptr;    /* VDJ_RAMP_MAX_FRAMES, cache-line aligned */
+    VdjParamRamp ramp = {};
+};
+
+struct VdjParamRamps {
+    VdjParamRamps() = default;
+    VdjParamRamps(const VdjParamRamps&) = delete;
+    VdjParamRamps& operator=(const VdjParamRamps&) = delete;
+    ~VdjParamRamps();
+
+    /**
+     * Register a parameter for smoothing. Allocates, so call it while
+     * declaring parameters, not from the audio thread.
+     */
+    HRESULT Declare(int id, const float *parameter, int mode, float timeMs);
+
+    /**
+     * Generate the ramps of all declared parameters for a block of nb frames
+     */
+    void Process(int sampleRate, int nb);
+
+    const VdjParamSmoother* Find(int id) const;
+
+    std::vector<VdjParamSmoother> smoothers;
+};
+
+#endif /* VDJ_SHIM_PARAM_RAMP_H */
@@ -0,0 +1,148 @@
+/**
+ * VirtualDJ Rust SDK - Parameter Snapshots
+ */
+
+#include "param_snapshot.h"
+
+#include <cstring>
+
+static uint64_t Pad8(uint64_t size) {
+    return (size + 7) & ~(uint64_t)7;
+}
+
+/* Buttons are momentary: restoring one would replay a press */
+static bool Saved(const VdjReplayParameters::Entry &e) {
+    return e.type != VDJPARAM_BUTTON && e.size > 0;
+}
+
+/* ============================================================================
+   Format
+   ============================================================================ */
+
+uint64_t VdjSnapshotWrite(const VdjReplayParameters &parameters, const void *opaque, uint64_t opaqueSize,
+                          void *out, uint64_t capacity) {
+    VdjSnapshotHeader header = {};
+    header.magic = VDJ_SNAPSHOT_MAGIC;
+    header.version = VDJ_SNAPSHOT_VERSION;
+
+    uint64_t offset = sizeof(VdjSnapshotHeader);
+    for (const VdjReplayParameters::Entry &e : parameters.entries) {
+        if (!Saved(e)) continue;
+        header.param_count++;
+        offset += sizeof(VdjSnapshotParam) + Pad8(e.size);
+    }
+    header.opaque_offset = offset;
+    header.opaque_size = opaque ? opaqueSize : 0;
+    header.total_size = offset + Pad8(header.opaque_size);
+    if (!out || capacity < header.total_size) return header.total_size;
+
+    char *bytes = static_cast<char*>(out);
+    memset(bytes, 0, (size_t)header.total_size);
+    memcpy(bytes, &header, sizeof(header));
+    offset = sizeof(VdjSnapshotHeader);
+    for (const VdjReplayParameters::Entry &e : parameters.entries) {
+        if (!Saved(e)) continue;
+        VdjSnapshotParam param = {};
+        param.id = e.id;
+        param.type = e.type;
+        param.size = e.size;
+        memcpy(bytes + offset, &param, sizeof(param));
+        memcpy(bytes + offset + sizeof(param), e.storage, e.size);
+        offset += sizeof(VdjSnapshotParam) + Pad8(e.size);
+    }
+    if (header.opaque_size) memcpy(bytes + header.opaque_offset, opaque, (size_t)header.opaque_size);
+    return header.total_size;
+}
+
+bool VdjSnapshotValid(const void *data, uint64_t size) {
+    if (!data || size < sizeof(VdjSnapshotHeader)) return false;
+    VdjSnapshotHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != VDJ_SNAPSHOT_MAGIC || header.version == 0 || header.version > VDJ_SNAPSHOT_VERSION) {
+        return false;
+    }
+    if (header.total_size < sizeof(VdjSnapshotHeader) || header.total_size > size || header.total_size % 8 != 0) {
+        return false;
+    }
+
+    const char *bytes = static_cast<const char*>(data);
+    uint64_t offset = sizeof(VdjSnapshotHeader);
+    for (uint32_t i = 0; i < header.param_count; i++) {
+        if (offset > header.total_size || header.total_size - offset < sizeof(VdjSnapshotParam)) return false;
+        VdjSnapshotParam param;
+        memcpy(&param, bytes + offset, sizeof(param));
+        offset += sizeof(VdjSnapshotParam);
+        if (offset > header.total_size || header.total_size - offset < Pad8(param.size)) return false;
+        offset += Pad8(param.size);
+    }
+    return header.opaque_offset >= offset && header.opaque_offset % 8 == 0 &&
+           header.opaque_offset <= header.total_size &&
+           header.opaque_size <= header.total_size - header.opaque_offset;
+}
+
+const char* VdjSnapshotFind(const void *snapshot, int id, int type, uint32_t size) {
+    const char *bytes = static_cast<const char*>(snapshot);
+    VdjSnapshotHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    uint64_t offset = sizeof(VdjSnapshotHeader);
+    for (uint32_t i = 0; i < header.param_count; i++) {
+        VdjSnapshotParam param;
+        memcpy(&param, bytes + offset, sizeof(param));
+        if (param.id == id) {
+            return param.type == type && param.size == size ? bytes + offset + sizeof(param) : nullptr;
+        }
+        offset += sizeof(VdjSnapshotParam) + Pad8(param.size);
+    }
+    return nullptr;
+}
+
+/* ============================================================================
+   Preset Swap
+   ============================================================================ */
+
+bool VdjPresetSwap::Stage(const void *data, uint64_t size) {
+    if (!VdjSnapshotValid(data, size)) return false;
+    VdjSnapshotHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.total_size > SIZE_MAX) return false;
+
+    // malloc alignment keeps the opaque state 8-aligned in the copy
+    void *copy = malloc((size_t)header.total_size);
+    if (!copy) return false;
+    memcpy(copy, data, (size_t)header.total_size);
+
+    std::lock_guard<std::mutex> lock(stageLock);
+    snapshots.Publish(copy);
+    return true;
+}
+
+void VdjPresetSwap::Apply(const VdjReplayParameters &parameters) {
+    void *snapshot = snapshots.Take(applied);
+    if (!snapshot) return;
+    applied = snapshot;
+    fresh = true;
+
+    const char *bytes = static_cast<const char*>(snapshot);
+    VdjSnapshotHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    uint64_t offset = sizeof(VdjSnapshotHeader);
+    for (uint32_t i = 0; i < header.param_count; i++) {
+        VdjSnapshotParam param;
+        memcpy(&param, bytes + offset, sizeof(param));
+        const char *value = bytes + offset + sizeof(param);
+        offset += sizeof(VdjSnapshotParam) + Pad8(param.size);
+
+        for (const VdjReplayParameters::Entry &e : parameters.entries) {
+            if (e.id != param.id || e.type != param.type || !Saved(e)) continue;
+            if (e.type == VDJPARAM_STRING || e.type == VDJPARAM_COMMAND) {
+                // Text may have been saved from a buffer of another size
+                const uint32_t n = param.size < e.size ? param.size : e.size - 1;
+                memcpy(e.storage, value, n);
+                static_cast<char*>(e.storage)[n] = '\0';
+            } else if (e.size == param.size) {
+                memcpy(e.storage, value, e.size);
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * VirtualDJ Rust SDK - Parameter Snapshots
+ *
+ * Saves the declared parameters of an instance, with the plugin's opaque
+ * state, in the snapshot format of the ABI header, and recalls staged
+ * snapshots at block boundaries: a control thread validates and copies the
+ * snapshot, and the audio thread swaps it in at the start of its next
+ * callback, writing parameter values in place and nothing else.
+ */
+
+#ifndef VDJ_SHIM_PARAM_SNAPSHOT_H
+#define VDJ_SHIM_PARAM_SNAPSHOT_H
+
+#include "../abi/vdj_plugin_abi.h"
+#include "block_handoff.h"
+#include "replay_recorder.h"
+
+#include <cstdlib>
+#include <mutex>
+
+/**
+ * Bytes needed for a snapshot of `parameters` with `opaqueSize` bytes of
+ * opaque state; the snapshot is written to `out` only if that fits in
+ * `capacity`
+ */
+uint64_t VdjSnapshotWrite(const VdjReplayParameters &parameters, const void *opaque, uint64_t opaqueSize,
+                          void *out, uint64_t capacity);
+
+/** True when `data` holds a well-formed snapshot of at most `size` bytes */
+bool VdjSnapshotValid(const void *data, uint64_t size);
+
+/**
+ * Value bytes of parameter `id` in a valid snapshot, or nullptr when it is
+ * not there with that type and size
+ */
+const char* VdjSnapshotFind(const void *snapshot, int id, int type, uint32_t size);
+
+struct VdjPresetSwap {
+    VdjPresetSwap() = default;
+    VdjPresetSwap(const VdjPresetSwap&) = delete;
+    VdjPresetSwap& operator=(const VdjPresetSwap&) = delete;
+    ~VdjPresetSwap() { free(applied); }
+
+    /**
+     * Validate and copy a snapshot and hand it to the owning thread.
+     * Returns false when it is invalid or out of memory. Control threads.
+     */
+    bool Stage(const void *data, uint64_t size);
+
+    /**
+     * At the start of a callback: apply the newest staged snapshot to the
+     * declared parameters, if one is waiting. Owning thread only.
+     */
+    void BeginBlock(const VdjReplayParameters &parameters) {
+        fresh = false;
+        if (snapshots.Waiting()) Apply(parameters);
+    }
+
+    void Apply(const VdjReplayParameters &parameters);
+
+    VdjBlockHandoff snapshots { free };
+    std::mutex stageLock;
+
+    /* Owning thread */
+    void *applied = nullptr;    /* last snapshot applied */
+    bool fresh = false;         /* applied at the start of the current callback */
+};
+
+#endif /* VDJ_SHIM_PARAM_SNAPSHOT_H */
@@ -0,0 +1,138 @@
+/**
+ * VirtualDJ Rust SDK - Position Pattern Engine
+ */
+
+#include "position_pattern.h"
+
+#include <cmath>
+#include <new>
+
+VdjPositionPattern::~VdjPositionPattern() {
+    Release(active);
+}
+
+void VdjPositionPattern::Release(void *table) {
+    delete static_cast<VdjPatternTable*>(table);
+}
+
+/* Step lengths are quantized to whole slots so no slot straddles a jump */
+static int ToSlots(double beats) {
+    if (!(beats > 0.0)) return 0;
+    const double slots = std::floor(beats * VDJ_PATTERN_SLOTS_PER_BEAT + 0.5);
+    return slots < 1.0 ? 1 : (int)slots;
+}
+
+static float StepVolume(const VdjPatternStep &step) {
+    if (step.flags & VDJ_PATTERN_MUTE) return 0.0f;
+    return step.volume > 0.0f ? step.volume : 0.0f;
+}
+
+/* Volume of the step played after step i, wrapping to the start of the pattern */
+static float NextVolume(const VdjPatternStep *steps, int count, int i) {
+    for (int k = 1; k <= count; k++) {
+        const VdjPatternStep &next = steps[(i + k) % count];
+        if (ToSlots(next.length_beats) > 0) return StepVolume(next);
+    }
+    return StepVolume(steps[i]);
+}
+
+static VdjPatternTable* Compile(const VdjPatternStep *steps, int count) {
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        total += ToSlots(steps[i].length_beats);
+        if (total > VDJ_PATTERN_MAX_BEATS * VDJ_PATTERN_SLOTS_PER_BEAT) return nullptr;
+    }
+    if (total == 0) return nullptr;
+
+    VdjPatternTable *table = new (std::nothrow) VdjPatternTable();
+    if (!table) return nullptr;
+    table->slots = new (std::nothrow) VdjPatternSlot[total];
+    if (!table->slots) {
+        delete table;
+        return nullptr;
+    }
+    table->count = total;
+
+    const float slotBeats = 1.0f / VDJ_PATTERN_SLOTS_PER_BEAT;
+    int start = 0;
+
+    for (int i = 0; i < count; i++) {
+        const VdjPatternStep &step = steps[i];
+        const int length = ToSlots(step.length_beats);
+        if (length == 0) continue;
+
+        int repeat = ToSlots(step.repeat_beats);
+        if (repeat >= length) repeat = 0;
+        const int span = repeat ? repeat : length;
+        const bool reverse = (step.flags & VDJ_PATTERN_REVERSE) != 0;
+        const float volume = StepVolume(step);
+        const float nextVolume = NextVolume(steps, count, i);
+
+        for (int j = 0; j < length; j++) {
+            VdjPatternSlot &slot = table->slots[start + j];
+            const int t = repeat ? j % repeat : j;
+
+            // Reversed segments start at the end of their span and play back
+            slot.position = (float)(reverse ? start + span - t : start + t) * slotBeats;
+            slot.positionSlope = reverse ? -1.0f : 1.0f;
+
+            // Fade gate edges over the last slot of a step instead of clicking,
+            // so the next step starts on the grid at its own volume
+            slot.volume = volume;
+            slot.volumeSlope = j == length - 1 ? (nextVolume - volume) * VDJ_PATTERN_SLOTS_PER_BEAT : 0.0f;
+        }
+
+        start += length;
+    }
+
+    return table;
+}
+
+HRESULT VdjPositionPattern::Set(const VdjPatternStep *steps, int count) {
+    if (count < 0 || count > VDJ_PATTERN_MAX_STEPS || (count > 0 && !steps)) return E_FAIL;
+
+    // An empty table is published to clear the pattern, so the audio thread
+    // never frees anything
+    VdjPatternTable *table = nullptr;
+    if (count > 0) {
+        table = Compile(steps, count);
+        if (!table) return E_FAIL;
+    } else {
+        table = new (std::nothrow) VdjPatternTable();
+        if (!table) return E_FAIL;
+    }
+
+    std::lock_guard<std::mutex> lock(setLock);
+    tables.Publish(table);
+    return S_OK;
+}
+
+void VdjPositionPattern::Transform(double *songPos, double *videoPos, float *volume,
+                                   int hostSongPos, double songPosBeats, int samplesPerBeat) {
+    if (tables.Waiting()) active = static_cast<VdjPatternTable*>(tables.Take(active));
+
+    const VdjPatternTable *table = active;
+    if (!table || table->count == 0 || !songPos || samplesPerBeat <= 0) return;
+
+    // Beat 0 of the grid, in samples
+    const double spb = (double)samplesPerBeat;
+    const double firstBeat = (double)hostSongPos - songPosBeats * spb;
+    const double beats = (*songPos - firstBeat) / spb;
+
+    const double cycle = (double)table->count / VDJ_PATTERN_SLOTS_PER_BEAT;
+    const double cycleStart = std::floor(beats / cycle) * cycle;
+    const double phase = beats - cycleStart;
+
+    int index = (int)(phase * VDJ_PATTERN_SLOTS_PER_BEAT);
+    if (index < 0) index = 0;
+    if (index >= table->count) index = table->count - 1;
+
+    const VdjPatternSlot &slot = table->slots[index];
+    const double offset = phase - (double)index / VDJ_PATTERN_SLOTS_PER_BEAT;
+    const double source = cycleStart + slot.position + slot.positionSlope * offset;
+    const double target = firstBeat + source * spb;
+
+    if (videoPos) *videoPos += target - *songPos;
+    *songPos = target;
+    if (volume) *volume *= slot.volume + slot.volumeSlope * (float)offset;
+}
@@ -0,0 +1,64 @@
+/**
+ * VirtualDJ Rust SDK - Position Pattern Engine
+ *
+ * Compiles a declarative beat pattern (repeats, reversals, gates) into a
+ * table of piecewise-linear position and volume segments keyed by beat phase,
+ * so OnTransformPosition is a single table lookup however short the host
+ * blocks are. The pattern is aligned to the song's beat grid and restarts
+ * every pattern length, which keeps it deterministic across seeks and loops.
+ */
+
+#ifndef VDJ_SHIM_POSITION_PATTERN_H
+#define VDJ_SHIM_POSITION_PATTERN_H
+
+#include "../abi/vdj_plugin_abi.h"
+#include "block_handoff.h"
+
+#include <mutex>
+
+/**
+ * One slot of VDJ_PATTERN_SLOTS_PER_BEAT; values are linear inside a slot
+ */
+struct VdjPatternSlot {
+    float position;     /* source position at the slot start, in beats from the pattern start */
+    float positionSlope;    /* source beats per played beat: 1, -1 */
+    float volume;       /* volume at the slot start */
+    float volumeSlope;  /* volume change per beat (gate declick) */
+};
+
+struct VdjPatternTable {
+    VdjPatternSlot *slots = nullptr;
+    int count = 0;      /* slots in one pattern cycle */
+
+    ~VdjPatternTable() { delete[] slots; }
+};
+
+struct VdjPositionPattern {
+    VdjPositionPattern() = default;
+    VdjPositionPattern(const VdjPositionPattern&) = delete;
+    VdjPositionPattern& operator=(const VdjPositionPattern&) = delete;
+    ~VdjPositionPattern();
+
+    /**
+     * Compile and publish a pattern; count 0 clears it. Allocates, so call it
+     * from a UI or worker thread.
+     */
+    HRESULT Set(const VdjPatternStep *steps, int count);
+
+    /**
+     * Map the position the host is about to play through the active pattern.
+     * songPos/songPosBeats/samplesPerBeat are the host's SongPos, SongPosBeats
+     * and SongBpm, used to place *songPos on the beat grid.
+     */
+    void Transform(double *songPos, double *videoPos, float *volume,
+                   int hostSongPos, double songPosBeats, int samplesPerBeat);
+
+private:
+    static void Release(void *table);
+
+    VdjBlockHandoff tables { Release };
+    std::mutex setLock;
+    VdjPatternTable *active = nullptr;  /* audio thread only */
+};
+
+#endif /* VDJ_SHIM_POSITION_PATTERN_H */
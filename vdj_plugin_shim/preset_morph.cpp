@@ -0,0 +1,180 @@
+/**
+ * VirtualDJ Rust SDK - Preset Morphing
+ */
+
+#include "preset_morph.h"
+#include "param_snapshot.h"
+#include "simd.h"
+
+#include <cstring>
+#include <new>
+
+/* Parameters stored as one float are interpolated; everything else snaps */
+static bool Continuous(const VdjReplayParameters::Entry &e) {
+    switch (e.type) {
+    case VDJPARAM_SLIDER:
+    case VDJPARAM_COLORFX:
+    case VDJPARAM_BEATS:
+    case VDJPARAM_RELEASEFX:
+    case VDJPARAM_TRANSITIONFX:
+        return e.size == sizeof(float);
+    default:
+        return false;
+    }
+}
+
+/* ============================================================================
+   Compilation
+   ============================================================================ */
+
+static bool Compile(VdjMorphTable &table, const VdjReplayParameters &parameters, int positionId,
+                    const void *const *snapshots, const uint64_t *sizes, int count) {
+    const VdjReplayParameters::Entry *position = nullptr;
+    for (const VdjReplayParameters::Entry &e : parameters.entries) {
+        if (e.id == positionId && Continuous(e)) position = &e;
+    }
+    if (!position) return false;
+
+    // Copy the snapshots so the table does not depend on the caller's memory
+    uint64_t total = 0;
+    for (int i = 0; i < count; i++) {
+        if (!VdjSnapshotValid(snapshots[i], sizes[i])) return false;
+        VdjSnapshotHeader header;
+        memcpy(&header, snapshots[i], sizeof(header));
+        total += header.total_size;
+    }
+    if (total > SIZE_MAX) return false;
+    table.snapshots.resize((size_t)total);
+    const char *copies[VDJ_MORPH_MAX_SNAPSHOTS];
+    size_t offset = 0;
+    for (int i = 0; i < count; i++) {
+        VdjSnapshotHeader header;
+        memcpy(&header, snapshots[i], sizeof(header));
+        memcpy(table.snapshots.data() + offset, snapshots[i], (size_t)header.total_size);
+        copies[i] = table.snapshots.data() + offset;
+        offset += (size_t)header.total_size;
+    }
+
+    // Only parameters every snapshot holds take part; the position never does
+    std::vector<const char*> continuous;
+    for (const VdjReplayParameters::Entry &e : parameters.entries) {
+        if (e.id == positionId || e.type == VDJPARAM_BUTTON || e.size == 0) continue;
+        const char *found[VDJ_MORPH_MAX_SNAPSHOTS];
+        bool shared = true;
+        for (int i = 0; i < count && shared; i++) {
+            found[i] = VdjSnapshotFind(copies[i], e.id, e.type, e.size);
+            shared = found[i] != nullptr;
+        }
+        if (!shared) continue;
+
+        if (Continuous(e)) {
+            table.continuousIds.push_back(e.id);
+            table.targets.push_back(static_cast<float*>(e.storage));
+            continuous.insert(continuous.end(), found, found + count);
+        } else {
+            table.discrete.push_back({ e.id, e.size, e.storage, -1 });
+            table.values.insert(table.values.end(), found, found + count);
+        }
+    }
+
+    const int n = (int)table.continuousIds.size();
+    table.stride = (n + VDJ_SIMD_WIDTH - 1) / VDJ_SIMD_WIDTH * VDJ_SIMD_WIDTH;
+    table.rows.assign((size_t)table.stride * count, 0.0f);
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i < count; i++) {
+            memcpy(&table.rows[(size_t)i * table.stride + j], continuous[(size_t)j * count + i], sizeof(float));
+        }
+    }
+    table.mixed.assign(table.stride, 0.0f);
+    table.changes.assign(n + table.discrete.size(), 0);
+    table.position = static_cast<const float*>(position->storage);
+    table.snapshotCount = count;
+    return true;
+}
+
+/* ============================================================================
+   Preset Morph
+   ============================================================================ */
+
+VdjPresetMorph::~VdjPresetMorph() {
+    Release(table);
+}
+
+void VdjPresetMorph::Release(void *table) {
+    delete static_cast<VdjMorphTable*>(table);
+}
+
+bool VdjPresetMorph::Set(const VdjReplayParameters &parameters, int positionId,
+                         const void *const *snapshots, const uint64_t *sizes, int count) {
+    if (count < 0 || count > VDJ_MORPH_MAX_SNAPSHOTS) return false;
+    if (count > 0 && (!snapshots || !sizes)) return false;
+
+    VdjMorphTable *compiled = new (std::nothrow) VdjMorphTable();
+    if (!compiled) return false;
+    if (count > 0 && !Compile(*compiled, parameters, positionId, snapshots, sizes, count)) {
+        delete compiled;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(setLock);
+    tables.Publish(compiled);
+    return true;
+}
+
+void VdjPresetMorph::BeginBlock() {
+    changeCount = 0;
+    if (tables.Waiting()) {
+        table = static_cast<VdjMorphTable*>(tables.Take(table));
+        moved = false;
+    }
+    if (!table || table->snapshotCount == 0) return;
+
+    // Clamp, sending NaN to the first snapshot
+    float p = *table->position;
+    p = p > 0.0f ? (p < 1.0f ? p : 1.0f) : 0.0f;
+    if (moved && p == position) return;
+    moved = true;
+    position = p;
+
+    // Snapshots sit evenly over 0..1; the ends land exactly on a snapshot
+    VdjMorphTable &t = *table;
+    const int last = t.snapshotCount - 1;
+    const float x = p * (float)last;
+    int k = (int)x;
+    if (k > last) k = last;
+    const int next = k < last ? k + 1 : k;
+    const float f = x - (float)k;
+
+    const float *a = t.rows.data() + (size_t)k * t.stride;
+    const float *b = t.rows.data() + (size_t)next * t.stride;
+    const VdjF4 vf = VdjF4Set1(f);
+    for (int i = 0; i < t.stride; i += VDJ_SIMD_WIDTH) {
+        const VdjF4 va = VdjF4Load(a + i);
+        VdjF4Store(t.mixed.data() + i, VdjF4Add(va, VdjF4Mul(VdjF4Sub(VdjF4Load(b + i), va), vf)));
+    }
+    const int n = (int)t.continuousIds.size();
+    for (int j = 0; j < n; j++) {
+        if (*t.targets[j] == t.mixed[j]) continue;
+        *t.targets[j] = t.mixed[j];
+        t.changes[changeCount++] = t.continuousIds[j];
+    }
+
+    const int side = f < 0.5f ? k : next;
+    for (size_t d = 0; d < t.discrete.size(); d++) {
+        VdjMorphTable::Discrete &e = t.discrete[d];
+        if (e.selected == side) continue;
+        e.selected = side;
+        const char *value = t.values[d * t.snapshotCount + side];
+        if (memcmp(e.storage, value, e.size) == 0) continue;
+        memcpy(e.storage, value, e.size);
+        t.changes[changeCount++] = e.id;
+    }
+}
+
+VdjMorphChanges VdjPresetMorph::Changes() const {
+    VdjMorphChanges changes = {};
+    changes.ids = table ? table->changes.data() : nullptr;
+    changes.count = changeCount;
+    changes.position = position;
+    return changes;
+}
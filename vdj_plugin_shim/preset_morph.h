@@ -0,0 +1,85 @@
+/**
+ * VirtualDJ Rust SDK - Preset Morphing
+ *
+ * Sweeps the declared parameters of an instance between two or more
+ * snapshots with one morph position parameter. A control thread compiles
+ * the snapshots into a table of the parameters they share; at the start of
+ * each block the owning thread interpolates the continuous ones, snaps the
+ * discrete ones at the midpoint of the segment, writes them in place and
+ * keeps the ids it changed as the block's change set, so a macro knob over
+ * dozens of parameters costs one pass instead of one callback per parameter.
+ */
+
+#ifndef VDJ_SHIM_PRESET_MORPH_H
+#define VDJ_SHIM_PRESET_MORPH_H
+
+#include "../abi/vdj_plugin_abi.h"
+#include "block_handoff.h"
+#include "replay_recorder.h"
+
+#include <mutex>
+#include <vector>
+
+struct VdjMorphTable {
+    const float *position = nullptr;    /* storage of the morph position parameter */
+    int snapshotCount = 0;              /* 0 when morphing is off */
+
+    /* Continuous parameters, one row of `stride` values per snapshot */
+    int stride = 0;                     /* continuous count rounded up to VDJ_SIMD_WIDTH */
+    std::vector<float> rows;
+    std::vector<float*> targets;
+    std::vector<int32_t> continuousIds;
+    std::vector<float> mixed;           /* interpolated values of the current block */
+
+    /* Discrete parameters, snapped to the nearer snapshot of the segment */
+    struct Discrete {
+        int32_t id;
+        uint32_t size;
+        void *storage;
+        int selected;                   /* snapshot last written, -1 before the first block */
+    };
+    std::vector<Discrete> discrete;
+    std::vector<const char*> values;    /* snapshotCount per discrete parameter */
+    std::vector<char> snapshots;        /* copies the values point into */
+
+    std::vector<int32_t> changes;       /* one slot per parameter */
+};
+
+struct VdjPresetMorph {
+    VdjPresetMorph() = default;
+    VdjPresetMorph(const VdjPresetMorph&) = delete;
+    VdjPresetMorph& operator=(const VdjPresetMorph&) = delete;
+    ~VdjPresetMorph();
+
+    /**
+     * Compile `count` snapshots into a morph driven by parameter
+     * `positionId` and hand it to the owning thread; a count of 0 turns
+     * morphing off. Returns false when the position is not a declared float
+     * parameter, a snapshot is invalid or memory runs out. Control threads.
+     */
+    bool Set(const VdjReplayParameters &parameters, int positionId,
+             const void *const *snapshots, const uint64_t *sizes, int count);
+
+    /**
+     * At the start of a callback, after a staged snapshot is applied: take a
+     * newly set morph and, when the position moved, write the morphed values
+     * and record the change set. Owning thread only.
+     */
+    void BeginBlock();
+
+    VdjMorphChanges Changes() const;
+
+    VdjBlockHandoff tables { Release };
+    std::mutex setLock;
+
+    /* Owning thread */
+    VdjMorphTable *table = nullptr;
+    float position = 0.0f;      /* position of the last morph */
+    bool moved = false;         /* false until the first morph of a table */
+    int changeCount = 0;        /* ids in table->changes for the current callback */
+
+private:
+    static void Release(void *table);
+};
+
+#endif /* VDJ_SHIM_PRESET_MORPH_H */
@@ -0,0 +1,353 @@
+/**
+ * VirtualDJ Rust SDK - Callback Recorder
+ */
+
+#include "replay_recorder.h"
+#include "thread_rings.h"
+#include "vdj_sdk.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+/**
+ * Single-producer/single-consumer byte ring owned by one callback thread.
+ * Records are a RingHeader and its payload, padded to 8 bytes, and may wrap.
+ */
+struct VdjReplayRing {
+    uint8_t *data = nullptr;
+    std::atomic<uint64_t> writeIndex { 0 };
+    std::atomic<uint64_t> readIndex { 0 };
+};
+
+struct VdjReplayRingHeader {
+    uint64_t seq;       /* global order across threads */
+    uint64_t timeNs;
+    uint32_t size;
+    uint16_t kind;
+    uint16_t reserved;
+};
+
+/* A drained record; its payload lives in VdjReplayRecorder::bytes */
+struct VdjReplayPending {
+    VdjReplayRingHeader header;
+    size_t offset;
+};
+
+struct VdjReplayRecorder {
+    // Rings are allocated by the first recording and live until the process
+    // exits, so a callback still writing after a stop is safe
+    VdjReplayRing rings[VDJ_REPLAY_MAX_THREADS];
+    std::atomic<bool> ownedRings[VDJ_REPLAY_MAX_THREADS] = {};
+    std::atomic<uint32_t> target { 0 };
+    std::atomic<uint64_t> sequence { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+    std::chrono::steady_clock::time_point origin;
+
+    std::mutex mutex;   /* control and writer thread only */
+    std::condition_variable wake;
+    std::thread writer;
+    bool stopRequested = false;
+    FILE *file = nullptr;
+    std::vector<VdjReplayPending> pending;
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> compressed;
+
+    HRESULT Stop();
+    void Flush();
+    void WriteLoop();
+};
+
+/* Never destroyed: a static destructor would join the writer under the
+   Windows loader lock. Releasing the recorded instance stops the recording. */
+static VdjReplayRecorder& Recorder() {
+    static VdjReplayRecorder *recorder = new VdjReplayRecorder;
+    return *recorder;
+}
+
+static thread_local VdjRingClaim tlsRingClaim;
+
+static void CopyIn(uint8_t *ring, uint64_t pos, const void *src, size_t n) {
+    const size_t offset = (size_t)(pos & (VDJ_REPLAY_RING_BYTES - 1));
+    const size_t first = std::min(n, (size_t)VDJ_REPLAY_RING_BYTES - offset);
+    memcpy(ring + offset, src, first);
+    memcpy(ring, (const uint8_t*)src + first, n - first);
+}
+
+static void CopyOut(void *dst, const uint8_t *ring, uint64_t pos, size_t n) {
+    if (!n) return;     /* dst is null for an empty payload */
+    const size_t offset = (size_t)(pos & (VDJ_REPLAY_RING_BYTES - 1));
+    const size_t first = std::min(n, (size_t)VDJ_REPLAY_RING_BYTES - offset);
+    memcpy(dst, ring + offset, first);
+    memcpy((uint8_t*)dst + first, ring, n - first);
+}
+
+static inline uint64_t Padded(uint64_t n) {
+    return (n + 7) & ~(uint64_t)7;
+}
+
+uint32_t VdjReplayTarget() {
+    return Recorder().target.load(std::memory_order_relaxed);
+}
+
+void VdjReplayRecord(int kind, const void *head, uint32_t headSize, const void *tail, uint32_t tailSize) {
+    VdjReplayRecorder &r = Recorder();
+    if (!r.target.load(std::memory_order_acquire)) return;
+
+    const int index = VdjClaimRing(tlsRingClaim, r.ownedRings);
+    if (index < 0) {
+        r.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    VdjReplayRing &ring = r.rings[index];
+    const uint64_t size = (uint64_t)headSize + tailSize;
+    const uint64_t total = sizeof(VdjReplayRingHeader) + Padded(size);
+    const uint64_t w = ring.writeIndex.load(std::memory_order_relaxed);
+    if (!ring.data || total > VDJ_REPLAY_RING_BYTES / 2 ||
+        w + total - ring.readIndex.load(std::memory_order_acquire) > VDJ_REPLAY_RING_BYTES) {
+        r.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    VdjReplayRingHeader header = {};
+    header.seq = r.sequence.fetch_add(1, std::memory_order_relaxed);
+    const auto now = std::chrono::steady_clock::now();
+    header.timeNs = now > r.origin
+        ? (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - r.origin).count() : 0;
+    header.size = (uint32_t)size;
+    header.kind = (uint16_t)kind;
+
+    CopyIn(ring.data, w, &header, sizeof(header));
+    if (headSize) CopyIn(ring.data, w + sizeof(header), head, headSize);
+    if (tailSize) CopyIn(ring.data, w + sizeof(header) + headSize, tail, tailSize);
+    ring.writeIndex.store(w + total, std::memory_order_release);
+}
+
+/* ============================================================================
+   Sample Compression
+   ============================================================================ */
+
+void VdjReplayCompressSamples(const float *samples, size_t count, std::vector<uint8_t> &out) {
+    // XOR against the previous sample of the same channel leaves the sign and
+    // exponent bytes mostly zero; grouping bytes by significance turns them
+    // into long zero runs
+    static thread_local std::vector<uint8_t> planes;
+    const size_t n = count * 4;
+    planes.resize(n);
+    uint32_t previous[2] = { 0, 0 };
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits;
+        memcpy(&bits, &samples[i], sizeof(bits));
+        const uint32_t x = bits ^ previous[i & 1];
+        previous[i & 1] = bits;
+        for (size_t b = 0; b < 4; b++) planes[b * count + i] = (uint8_t)(x >> (24 - 8 * b));
+    }
+
+    size_t i = 0;
+    while (i < n) {
+        if (planes[i] == 0) {
+            size_t run = 1;
+            while (i + run < n && planes[i + run] == 0 && run < 128) run++;
+            out.push_back((uint8_t)(127 + run));
+            i += run;
+            continue;
+        }
+        // Literals end where a run of two zeros starts
+        const size_t start = i;
+        while (i < n && i - start < 128 && !(planes[i] == 0 && i + 1 < n && planes[i + 1] == 0)) i++;
+        out.push_back((uint8_t)(i - start - 1));
+        out.insert(out.end(), planes.begin() + start, planes.begin() + i);
+    }
+}
+
+/* ============================================================================
+   Writer Thread
+   ============================================================================ */
+
+void VdjReplayRecorder::Flush() {
+    pending.clear();
+    bytes.clear();
+
+    for (VdjReplayRing &ring : rings) {
+        if (!ring.data) continue;
+        uint64_t r = ring.readIndex.load(std::memory_order_relaxed);
+        const uint64_t w = ring.writeIndex.load(std::memory_order_acquire);
+        while (r != w) {
+            VdjReplayPending p;
+            CopyOut(&p.header, ring.data, r, sizeof(p.header));
+            p.offset = bytes.size();
+            bytes.resize(bytes.size() + p.header.size);
+            CopyOut(bytes.data() + p.offset, ring.data, r + sizeof(p.header), p.header.size);
+            pending.push_back(p);
+            r += sizeof(p.header) + Padded(p.header.size);
+        }
+        ring.readIndex.store(r, std::memory_order_release);
+    }
+
+    std::sort(pending.begin(), pending.end(), [](const VdjReplayPending &a, const VdjReplayPending &b) {
+        return a.header.seq < b.header.seq;
+    });
+
+    for (const VdjReplayPending &p : pending) {
+        const uint8_t *payload = bytes.data() + p.offset;
+        VdjReplayRecordHeader header = {};
+        header.kind = p.header.kind;
+        header.time_ns = p.header.timeNs;
+
+        if (p.header.kind == VDJ_REPLAY_PROCESS_SAMPLES && p.header.size >= sizeof(VdjReplayBlock)) {
+            const size_t samples = (p.header.size - sizeof(VdjReplayBlock)) / sizeof(float);
+            compressed.assign(payload, payload + sizeof(VdjReplayBlock));
+            VdjReplayCompressSamples(reinterpret_cast<const float*>(payload + sizeof(VdjReplayBlock)),
+                                     samples, compressed);
+            header.flags = VDJ_REPLAY_FLAG_COMPRESSED;
+            header.size = (uint32_t)compressed.size();
+            fwrite(&header, sizeof(header), 1, file);
+            fwrite(compressed.data(), 1, compressed.size(), file);
+        } else {
+            header.size = p.header.size;
+            fwrite(&header, sizeof(header), 1, file);
+            fwrite(payload, 1, p.header.size, file);
+        }
+    }
+    fflush(file);
+}
+
+void VdjReplayRecorder::WriteLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopRequested) {
+        wake.wait_for(lock, std::chrono::milliseconds(20));
+        Flush();
+    }
+}
+
+/* ============================================================================
+   Control
+   ============================================================================ */
+
+HRESULT VdjReplayStart(uint32_t instanceId, const char *path) {
+    if (!instanceId || !path) return E_FAIL;
+    VdjReplayRecorder &r = Recorder();
+    std::unique_lock<std::mutex> lock(r.mutex);
+    if (r.file) return E_FAIL;
+
+    for (VdjReplayRing &ring : r.rings) {
+        if (!ring.data) {
+            ring.data = new (std::nothrow) uint8_t[VDJ_REPLAY_RING_BYTES];
+            if (!ring.data) return E_FAIL;
+        }
+        // Discard records left over from a previous recording
+        ring.readIndex.store(ring.writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    r.file = fopen(path, "wb");
+    if (!r.file) return E_FAIL;
+    VdjReplayFileHeader header = { VDJ_REPLAY_MAGIC, VDJ_REPLAY_VERSION, instanceId, 0 };
+    fwrite(&header, sizeof(header), 1, r.file);
+
+    r.stopRequested = false;
+    r.dropped.store(0, std::memory_order_relaxed);
+    r.origin = std::chrono::steady_clock::now();
+    r.target.store(instanceId, std::memory_order_release);
+    lock.unlock();
+
+    r.writer = std::thread([&r] { r.WriteLoop(); });
+    return S_OK;
+}
+
+HRESULT VdjReplayRecorder::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!file) return S_FALSE;
+        target.store(0, std::memory_order_release);
+        stopRequested = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) writer.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Flush();
+    const bool ok = fclose(file) == 0;
+    file = nullptr;
+    return ok ? S_OK : E_FAIL;
+}
+
+HRESULT VdjReplayStop() {
+    return Recorder().Stop();
+}
+
+uint64_t VdjReplayDroppedRecords() {
+    return Recorder().dropped.load(std::memory_order_relaxed);
+}
+
+/* ============================================================================
+   Declared Parameters
+   ============================================================================ */
+
+void VdjReplayParameters::Declare(void *storage, int type, int id, float defaultValue) {
+    if (!storage) return;
+    uint32_t size;
+    switch (type) {
+    case VDJPARAM_STRING:
+    case VDJPARAM_COMMAND:
+    case VDJPARAM_CUSTOM:
+        size = defaultValue > 0.0f ? (uint32_t)defaultValue : 0;
+        break;
+    case VDJPARAM_POSITION:
+        size = 4 * sizeof(float);
+        break;
+    case VDJPARAM_SLIDER:
+    case VDJPARAM_COLORFX:
+    case VDJPARAM_BEATS:
+    case VDJPARAM_RELEASEFX:
+    case VDJPARAM_TRANSITIONFX:
+        size = sizeof(float);
+        break;
+    default:
+        size = sizeof(int);
+        break;
+    }
+    for (Entry &e : entries) {
+        if (e.id == id) {
+            e.type = type;
+            e.size = size;
+            e.storage = storage;
+            return;
+        }
+    }
+    entries.push_back({ id, type, size, storage });
+}
+
+VdjReplayParameter VdjReplayParameters::Read(int id) const {
+    VdjReplayParameter p = { id, VDJ_REPLAY_PARAMETER_UNKNOWN, 0.0 };
+    for (const Entry &e : entries) {
+        if (e.id != id) continue;
+        switch (e.type) {
+        case VDJPARAM_SLIDER:
+        case VDJPARAM_COLORFX:
+        case VDJPARAM_BEATS:
+        case VDJPARAM_RELEASEFX:
+        case VDJPARAM_TRANSITIONFX:
+            p.type = e.type;
+            p.value = *static_cast<const float*>(e.storage);
+            break;
+        case VDJPARAM_BUTTON:
+        case VDJPARAM_SWITCH:
+        case VDJPARAM_RADIO:
+        case VDJPARAM_BEATS_RELATIVE:
+            p.type = e.type;
+            p.value = *static_cast<const int*>(e.storage);
+            break;
+        default:
+            break;  /* strings, commands and custom blobs are not recorded */
+        }
+        break;
+    }
+    return p;
+}
@@ -0,0 +1,67 @@
+/**
+ * VirtualDJ Rust SDK - Callback Recorder
+ *
+ * Captures the inbound calls of one plugin instance (start/stop, parameter
+ * changes, sample blocks with their beat position, position transforms and
+ * host query results) so a live set can be replayed offline. Callbacks copy
+ * records into per-thread byte rings; a background thread orders them,
+ * compresses sample blocks and writes the file described in the ABI header.
+ */
+
+#ifndef VDJ_SHIM_REPLAY_RECORDER_H
+#define VDJ_SHIM_REPLAY_RECORDER_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <vector>
+
+#define VDJ_REPLAY_MAX_THREADS  8
+#define VDJ_REPLAY_RING_BYTES   (1 << 20)   /* power of two */
+
+/**
+ * Instance being recorded, 0 when idle (one relaxed load)
+ */
+uint32_t VdjReplayTarget();
+
+/**
+ * Queue a record whose payload is two consecutive parts (either may be
+ * empty). Drops the record when the calling thread's ring is full.
+ */
+void VdjReplayRecord(int kind, const void *head, uint32_t headSize,
+                     const void *tail = nullptr, uint32_t tailSize = 0);
+
+HRESULT VdjReplayStart(uint32_t instanceId, const char *path);
+HRESULT VdjReplayStop();
+uint64_t VdjReplayDroppedRecords();
+
+/**
+ * Compress interleaved stereo samples as described for
+ * VDJ_REPLAY_FLAG_COMPRESSED, appending to out
+ */
+void VdjReplayCompressSamples(const float *samples, size_t count, std::vector<uint8_t> &out);
+
+/**
+ * Storage of the parameters an instance declared, so parameter changes can
+ * be recorded with their value
+ */
+struct VdjReplayParameters {
+    struct Entry {
+        int id;
+        int type;
+        uint32_t size;      /* bytes of storage */
+        void *storage;
+    };
+
+    /**
+     * Called from DeclareParameter while loading; string, command and custom
+     * parameters pass their storage size as the default value
+     */
+    void Declare(void *storage, int type, int id, float defaultValue);
+
+    /** Current value of a parameter; type is VDJ_REPLAY_PARAMETER_UNKNOWN if undeclared */
+    VdjReplayParameter Read(int id) const;
+
+    std::vector<Entry> entries;
+};
+
+#endif /* VDJ_SHIM_REPLAY_RECORDER_H */
@@ -0,0 +1,196 @@
+/**
+ * VirtualDJ Rust SDK - Resampler
+ */
+
+#include "resampler.h"
+#include "constexpr_math.h"
+#include "instance_memory.h"
+#include "simd.h"
+
+#include <array>
+#include <cmath>
+#include <climits>
+
+/* ============================================================================
+   Filter Tables
+   ============================================================================ */
+
+namespace {
+
+constexpr int kTaps = VDJ_RESAMPLER_TAPS;
+constexpr int kPhases = VDJ_RESAMPLER_PHASES;
+constexpr int kHalf = kTaps / 2;
+
+/* Speed limit of each band; faster reads use a lower cutoff so they do not alias */
+constexpr int kBands = 4;
+constexpr double kBandRatio[kBands] = { 1.0, 1.26, 1.59, 2.0 };
+
+/* Kaiser beta for about 80 dB of stopband, and the passband edge as a fraction of Nyquist */
+constexpr double kBeta = 7.86;
+constexpr double kCutoff = 0.91;
+constexpr double kWindowScale = 1.0 / BesselI0(kBeta);
+
+/* One extra row for phase 1.0, so adjacent phases can always be interpolated */
+using VdjResamplerBand = std::array<float, (kPhases + 1) * kTaps>;
+
+/* Kaiser window at x source frames from the output point */
+constexpr double Window(double x) {
+    const double w = x / kHalf;
+    return BesselI0(kBeta * Sqrt(1.0 - w * w)) * kWindowScale;
+}
+
+constexpr double Sinc(double x, double cutoff) {
+    const double arg = kPi * cutoff * x;
+    return arg == 0.0 ? cutoff : cutoff * Sin(arg) / arg;
+}
+
+/*
+ * Row k of each band holds tap t at offset t - (kHalf - 1) - k / kPhases,
+ * normalized to unit gain. The bands share the window, evaluated once.
+ */
+constexpr std::array<VdjResamplerBand, kBands> GenerateBands() {
+    std::array<VdjResamplerBand, kBands> bands {};
+    for (int k = 0; k <= kPhases; k++) {
+        double row[kBands][kTaps] {};
+        double sum[kBands] {};
+        for (int t = 0; t < kTaps; t++) {
+            const double x = (double)(t - (kHalf - 1)) - (double)k / kPhases;
+            if (x <= -kHalf || x >= kHalf) continue;
+            const double window = Window(x);
+            for (int b = 0; b < kBands; b++) {
+                row[b][t] = Sinc(x, kCutoff / kBandRatio[b]) * window;
+                sum[b] += row[b][t];
+            }
+        }
+        for (int b = 0; b < kBands; b++) {
+            for (int t = 0; t < kTaps; t++) bands[b][k * kTaps + t] = (float)(row[b][t] / sum[b]);
+        }
+    }
+    return bands;
+}
+
+}  // namespace
+
+alignas(VDJ_CACHE_LINE_SIZE) static constexpr std::array<VdjResamplerBand, kBands> bands = GenerateBands();
+
+static constexpr double RowGain(const VdjResamplerBand &band, int k) {
+    double sum = 0.0;
+    for (int t = 0; t < kTaps; t++) sum += band[k * kTaps + t];
+    return sum;
+}
+
+/* Evaluated by the compiler: unit gain, and the peak under the output point */
+static_assert(RowGain(bands[0], 0) > 0.999999 && RowGain(bands[0], 0) < 1.000001, "resampler gain");
+static_assert(RowGain(bands[3], kPhases / 2) > 0.999999 && RowGain(bands[3], kPhases / 2) < 1.000001, "resampler gain");
+static_assert(bands[0][kHalf - 1] > 0.9f && bands[0][kPhases * kTaps + kHalf] > 0.9f, "resampler peak");
+
+static const float* BandFor(float speed) {
+    for (int i = 0; i < kBands - 1; i++) {
+        if (speed <= (float)kBandRatio[i]) return bands[i].data();
+    }
+    return bands[kBands - 1].data();
+}
+
+/* ============================================================================
+   Resampler
+   ============================================================================ */
+
+VdjResampler::~VdjResampler() {
+    VdjInstanceFree(left);
+    VdjInstanceFree(right);
+}
+
+bool VdjResampler::Init(int maxFrames) {
+    if (maxFrames <= 0 || maxFrames > INT_MAX / 8) return false;
+    // Room for at least one output frame at the top speed, so chunks never shrink to nothing
+    const int frames = (maxFrames > VDJ_RESAMPLER_MAX_RATIO / 4 ? 4 * maxFrames : VDJ_RESAMPLER_MAX_RATIO) + kTaps + 2;
+    float *newLeft = static_cast<float*>(VdjInstanceAllocate(sizeof(float) * (size_t)frames));
+    float *newRight = static_cast<float*>(VdjInstanceAllocate(sizeof(float) * (size_t)frames));
+    if (!newLeft || !newRight) {
+        VdjInstanceFree(newLeft);
+        VdjInstanceFree(newRight);
+        return false;
+    }
+    VdjInstanceFree(left);
+    VdjInstanceFree(right);
+    left = newLeft;
+    right = newRight;
+    capacity = frames;
+    return true;
+}
+
+static float ClampRatio(float ratio) {
+    if (!(ratio == ratio)) return 0.0f;
+    return std::fmin(std::fmax(ratio, -(float)VDJ_RESAMPLER_MAX_RATIO), (float)VDJ_RESAMPLER_MAX_RATIO);
+}
+
+/* One output frame at source frame base + frac from the planar window */
+static inline void Interpolate(const float *band, const float *left, const float *right,
+                               double frac, float *out) {
+    const float x = (float)frac * (float)kPhases;
+    int k = (int)x;
+    if (k >= kPhases) k = kPhases - 1;
+    const VdjF4 f = VdjF4Set1(x - (float)k);
+    const float *a = band + k * kTaps;
+    const float *b = a + kTaps;
+    VdjF4 sumLeft = VdjF4Set1(0.0f), sumRight = VdjF4Set1(0.0f);
+    for (int t = 0; t < kTaps; t += 4) {
+        const VdjF4 ca = VdjF4Load(a + t);
+        const VdjF4 c = VdjF4Add(ca, VdjF4Mul(f, VdjF4Sub(VdjF4Load(b + t), ca)));
+        sumLeft = VdjF4Add(sumLeft, VdjF4Mul(c, VdjF4Load(left + t)));
+        sumRight = VdjF4Add(sumRight, VdjF4Mul(c, VdjF4Load(right + t)));
+    }
+    out[0] = VdjF4Sum(sumLeft);
+    out[1] = VdjF4Sum(sumRight);
+}
+
+HRESULT VdjResampler::Process(VdjResamplerFetch fetch, void *context, float ratioStart, float ratioEnd,
+                              float *out, int nb) {
+    if (!left || nb <= 0) return nb == 0 ? S_OK : E_FAIL;
+    const double r0 = ClampRatio(ratioStart);
+    const double slope = ((double)ClampRatio(ratioEnd) - r0) / (double)nb;
+    const float speed = (float)std::fmax(std::fabs(r0), std::fabs(r0 + slope * nb));
+    const float *band = BandFor(speed);
+
+    // Output frames per chunk so the source span fits the buffers at this speed
+    const int chunk = (int)((double)(capacity - kTaps - 2) / std::fmax(1.0, (double)speed));
+
+    for (int done = 0; done < nb;) {
+        const int n = nb - done < chunk ? nb - done : chunk;
+
+        // Source span the chunk reads; the ramp can turn around inside it
+        double p = position, lo = p, hi = p;
+        for (int i = 0; i < n; i++) {
+            lo = p < lo ? p : lo;
+            hi = p > hi ? p : hi;
+            p += r0 + slope * (double)(done + i);
+        }
+        const double first = std::floor(lo) - (kHalf - 1);
+        const double last = std::floor(hi) + kHalf;
+        short *buffer = nullptr;
+        HRESULT hr = E_FAIL;
+        if (first >= (double)INT_MIN && last <= (double)INT_MAX) {
+            hr = fetch(context, (int)first, (int)(last - first) + 1, &buffer);
+        }
+        if (hr != S_OK || !buffer) {
+            for (int i = 2 * done; i < 2 * nb; i++) out[i] = 0.0f;
+            for (int i = done; i < nb; i++) position += r0 + slope * (double)i;
+            return hr != S_OK ? hr : E_FAIL;
+        }
+
+        const int count = (int)(last - first) + 1;
+        for (int i = 0; i < count; i++) {
+            left[i] = (float)buffer[2 * i] * (1.0f / 32768.0f);
+            right[i] = (float)buffer[2 * i + 1] * (1.0f / 32768.0f);
+        }
+
+        for (int i = 0; i < n; i++) {
+            const double base = std::floor(position);
+            const int offset = (int)(base - first) - (kHalf - 1);
+            Interpolate(band, left + offset, right + offset, position - base, out + 2 * (done + i));
+            position += r0 + slope * (double)(done + i);
+        }
+        done += n;
+    }
+    return S_OK;
+}
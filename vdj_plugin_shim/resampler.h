@@ -0,0 +1,42 @@
+/**
+ * VirtualDJ Rust SDK - Resampler
+ *
+ * Varispeed reading of the song for buffer DSP effects (brakes, tape stops,
+ * pitch bends): a 32-tap Kaiser-windowed sinc evaluated from polyphase
+ * tables generated at compile time, interpolating between adjacent phases.
+ * The read position is a double in source frames and the ratio ramps
+ * linearly across each block, so time-varying speeds stay smooth; song
+ * chunks are fetched as the position advances, sized to preallocated
+ * buffers, so processing never allocates.
+ */
+
+#ifndef VDJ_SHIM_RESAMPLER_H
+#define VDJ_SHIM_RESAMPLER_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+/** Fetch nb interleaved stereo frames of the song from frame pos */
+typedef HRESULT (*VdjResamplerFetch)(void *context, int pos, int nb, short **buffer);
+
+struct VdjResampler {
+    VdjResampler() = default;
+    VdjResampler(const VdjResampler&) = delete;
+    VdjResampler& operator=(const VdjResampler&) = delete;
+    ~VdjResampler();
+
+    double position = 0.0;          /* next read position, in source frames */
+    int capacity = 0;               /* source frames the planar buffers hold */
+    float *left = nullptr;
+    float *right = nullptr;
+
+    /** Allocate for blocks of up to maxFrames at up to 4x speed; larger ones are split */
+    bool Init(int maxFrames);
+
+    /**
+     * nb interleaved stereo frames into out, reading at a ratio ramping from
+     * ratioStart to ratioEnd. On a failed fetch the rest of out is silent.
+     */
+    HRESULT Process(VdjResamplerFetch fetch, void *context, float ratioStart, float ratioEnd, float *out, int nb);
+};
+
+#endif /* VDJ_SHIM_RESAMPLER_H */
@@ -0,0 +1,263 @@
+/**
+ * VirtualDJ Rust SDK - Realtime-Safety Checker
+ */
+
+#include "rt_check.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(VDJ_SHIM_RT_CHECK) && defined(__linux__) && defined(__GLIBC__)
+#define VDJ_RT_HOOKS 1
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+static const char *const kViolationNames[VDJ_RT_VIOLATION_KINDS] = {
+    "allocation",
+    "free",
+    "lock",
+    "syscall",
+};
+
+static std::atomic<bool> rtEnabled { false };
+static std::atomic<uint32_t> rtFlags { 0 };
+static std::atomic<uint64_t> rtCounts[VDJ_RT_VIOLATION_KINDS];
+
+#if defined(VDJ_RT_HOOKS)
+/* Backtraces are only taken where the hooks are */
+struct VdjRtReport {
+    int kind;
+    int depth;
+    void *frames[VDJ_RT_BACKTRACE_DEPTH];
+};
+
+static std::atomic<int> rtReportCount { 0 };
+static VdjRtReport rtReports[VDJ_RT_MAX_REPORTS];
+#endif
+
+/* The hooks read these on every allocation. With the default TLS model the
+   first access on a thread from a dlopen'ed shim goes through
+   __tls_get_addr, which can call malloc and recurse into the hook; the
+   initial-exec model is a fixed offset from the thread pointer. */
+#if defined(__GNUC__)
+#define VDJ_RT_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+#define VDJ_RT_TLS_MODEL
+#endif
+
+static thread_local int rtDepth VDJ_RT_TLS_MODEL = 0;
+static thread_local bool rtReporting VDJ_RT_TLS_MODEL = false;
+
+void VdjRtEnter() {
+    rtDepth++;
+}
+
+void VdjRtLeave() {
+    if (rtDepth > 0) rtDepth--;
+}
+
+void VdjRtViolation(int kind) {
+    if (rtDepth == 0 || rtReporting || !rtEnabled.load(std::memory_order_relaxed)) return;
+    if (kind < 0 || kind >= VDJ_RT_VIOLATION_KINDS) return;
+
+    // Reporting may itself allocate (backtrace) or write; don't recurse
+    rtReporting = true;
+    rtCounts[kind].fetch_add(1, std::memory_order_relaxed);
+    const uint32_t flags = rtFlags.load(std::memory_order_relaxed);
+
+#if defined(VDJ_RT_HOOKS)
+    if (flags & VDJ_RT_CHECK_BACKTRACE) {
+        const int index = rtReportCount.fetch_add(1, std::memory_order_relaxed);
+        if (index < VDJ_RT_MAX_REPORTS) {
+            rtReports[index].kind = kind;
+            rtReports[index].depth = backtrace(rtReports[index].frames, VDJ_RT_BACKTRACE_DEPTH);
+        }
+    }
+#endif
+
+    if (flags & VDJ_RT_CHECK_ABORT) {
+        fprintf(stderr, "vdj rt check: %s inside a realtime callback\n", kViolationNames[kind]);
+#if defined(VDJ_RT_HOOKS)
+        void *frames[VDJ_RT_BACKTRACE_DEPTH];
+        backtrace_symbols_fd(frames, backtrace(frames, VDJ_RT_BACKTRACE_DEPTH), 2);
+#endif
+        abort();
+    }
+    rtReporting = false;
+}
+
+HRESULT VdjRtCheckEnable(bool enable, uint32_t flags) {
+#if defined(VDJ_RT_HOOKS)
+    // The first backtrace() loads libgcc_s and allocates; do it off the audio thread
+    if (enable && (flags & (VDJ_RT_CHECK_BACKTRACE | VDJ_RT_CHECK_ABORT))) {
+        void *frames[2];
+        backtrace(frames, 2);
+    }
+#endif
+    rtFlags.store(flags, std::memory_order_relaxed);
+    rtEnabled.store(enable, std::memory_order_release);
+#if defined(VDJ_RT_HOOKS)
+    return S_OK;
+#else
+    // Without hooks only explicitly reported violations are counted
+    return S_FALSE;
+#endif
+}
+
+HRESULT VdjRtCheckGetViolations(VdjRtViolations *violations) {
+    if (!violations) return E_FAIL;
+    for (int i = 0; i < VDJ_RT_VIOLATION_KINDS; i++) {
+        violations->counts[i] = rtCounts[i].load(std::memory_order_relaxed);
+    }
+    return S_OK;
+}
+
+HRESULT VdjRtCheckReset() {
+    for (int i = 0; i < VDJ_RT_VIOLATION_KINDS; i++) rtCounts[i].store(0, std::memory_order_relaxed);
+#if defined(VDJ_RT_HOOKS)
+    rtReportCount.store(0, std::memory_order_relaxed);
+#endif
+    return S_OK;
+}
+
+HRESULT VdjRtCheckDump(const char *path) {
+    FILE *file = path ? fopen(path, "w") : stderr;
+    if (!file) return E_FAIL;
+
+    for (int i = 0; i < VDJ_RT_VIOLATION_KINDS; i++) {
+        fprintf(file, "%s: %llu\n", kViolationNames[i],
+                (unsigned long long)rtCounts[i].load(std::memory_order_relaxed));
+    }
+
+#if defined(VDJ_RT_HOOKS)
+    int reports = rtReportCount.load(std::memory_order_relaxed);
+    if (reports > VDJ_RT_MAX_REPORTS) reports = VDJ_RT_MAX_REPORTS;
+    for (int i = 0; i < reports; i++) {
+        fprintf(file, "\n%s #%d:\n", kViolationNames[rtReports[i].kind], i + 1);
+        fflush(file);
+        backtrace_symbols_fd(rtReports[i].frames, rtReports[i].depth, fileno(file));
+    }
+#endif
+
+    if (file == stderr) return S_OK;
+    return fclose(file) == 0 ? S_OK : E_FAIL;
+}
+
+/* ============================================================================
+   Interposed Functions (VDJ_SHIM_RT_CHECK builds on glibc)
+   ============================================================================ */
+
+#if defined(VDJ_RT_HOOKS)
+
+/* Null if no later object defines name; the hooks then fail with ENOSYS */
+template <typename Fn>
+static Fn RtNext(const char *name) {
+    return reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+}
+
+extern "C" {
+
+// glibc exports its allocator under __libc_* names, so the allocation hooks
+// need no dlsym (which can itself allocate)
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size) {
+    VdjRtViolation(VDJ_RT_VIOLATION_ALLOC);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    VdjRtViolation(VDJ_RT_VIOLATION_ALLOC);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    VdjRtViolation(VDJ_RT_VIOLATION_ALLOC);
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) {
+    VdjRtViolation(VDJ_RT_VIOLATION_ALLOC);
+    // A power of two at least the size of a pointer is a multiple of it
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void *p = __libc_memalign(alignment, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    VdjRtViolation(VDJ_RT_VIOLATION_ALLOC);
+    return __libc_memalign(alignment, size);
+}
+
+void free(void *ptr) {
+    if (ptr) VdjRtViolation(VDJ_RT_VIOLATION_FREE);
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) {
+    static auto next = RtNext<int (*)(pthread_mutex_t*)>("pthread_mutex_lock");
+    VdjRtViolation(VDJ_RT_VIOLATION_LOCK);
+    return next ? next(mutex) : ENOSYS;
+}
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+    static auto next = RtNext<int (*)(pthread_cond_t*, pthread_mutex_t*)>("pthread_cond_wait");
+    VdjRtViolation(VDJ_RT_VIOLATION_LOCK);
+    return next ? next(cond, mutex) : ENOSYS;
+}
+
+ssize_t write(int fd, const void *buf, size_t count) {
+    static auto next = RtNext<ssize_t (*)(int, const void*, size_t)>("write");
+    VdjRtViolation(VDJ_RT_VIOLATION_SYSCALL);
+    if (!next) {
+        errno = ENOSYS;
+        return -1;
+    }
+    return next(fd, buf, count);
+}
+
+ssize_t read(int fd, void *buf, size_t count) {
+    static auto next = RtNext<ssize_t (*)(int, void*, size_t)>("read");
+    VdjRtViolation(VDJ_RT_VIOLATION_SYSCALL);
+    if (!next) {
+        errno = ENOSYS;
+        return -1;
+    }
+    return next(fd, buf, count);
+}
+
+int nanosleep(const struct timespec *req, struct timespec *rem) {
+    static auto next = RtNext<int (*)(const struct timespec*, struct timespec*)>("nanosleep");
+    VdjRtViolation(VDJ_RT_VIOLATION_SYSCALL);
+    if (!next) {
+        errno = ENOSYS;
+        return -1;
+    }
+    return next(req, rem);
+}
+
+int usleep(useconds_t usec) {
+    static auto next = RtNext<int (*)(useconds_t)>("usleep");
+    VdjRtViolation(VDJ_RT_VIOLATION_SYSCALL);
+    if (!next) {
+        errno = ENOSYS;
+        return -1;
+    }
+    return next(usec);
+}
+
+} // extern "C"
+
+#endif /* VDJ_RT_HOOKS */
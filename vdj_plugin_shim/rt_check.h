@@ -0,0 +1,43 @@
+/**
+ * VirtualDJ Rust SDK - Realtime-Safety Checker
+ *
+ * Marks the calling thread as running a realtime callback while the shim is
+ * inside OnProcessSamples, OnGetSongBuffer or OnTransformPosition. Builds
+ * with VDJ_SHIM_RT_CHECK defined on Linux/glibc also interpose malloc/free,
+ * mutex locks and blocking syscalls, and count every call made from a marked
+ * thread as a violation, optionally with a backtrace. Debug and CI only.
+ */
+
+#ifndef VDJ_SHIM_RT_CHECK_H
+#define VDJ_SHIM_RT_CHECK_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+#define VDJ_RT_MAX_REPORTS      16
+#define VDJ_RT_BACKTRACE_DEPTH  32
+
+void VdjRtEnter();
+void VdjRtLeave();
+
+/**
+ * Count a violation if the calling thread is inside a realtime callback
+ */
+void VdjRtViolation(int kind);
+
+/**
+ * Marks the enclosing audio entry point as realtime
+ */
+struct VdjRealtimeScope {
+    VdjRealtimeScope() { VdjRtEnter(); }
+    ~VdjRealtimeScope() { VdjRtLeave(); }
+
+    VdjRealtimeScope(const VdjRealtimeScope&) = delete;
+    VdjRealtimeScope& operator=(const VdjRealtimeScope&) = delete;
+};
+
+HRESULT VdjRtCheckEnable(bool enable, uint32_t flags);
+HRESULT VdjRtCheckGetViolations(VdjRtViolations *violations);
+HRESULT VdjRtCheckReset();
+HRESULT VdjRtCheckDump(const char *path);
+
+#endif /* VDJ_SHIM_RT_CHECK_H */
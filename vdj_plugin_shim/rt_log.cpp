@@ -0,0 +1,352 @@
+/**
+ * VirtualDJ Rust SDK - Realtime-Safe Logger
+ */
+
+#include "rt_log.h"
+#include "thread_rings.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const char *const kLevelNames[] = { "ERROR", "WARN", "INFO", "DEBUG", "TRACE" };
+
+typedef VdjThreadRings<VdjLogRecord, VDJ_LOG_MAX_THREADS, VDJ_LOG_RING_RECORDS> VdjLogRings;
+
+struct VdjQueuedRecord {
+    VdjLogRecord record;
+    int thread;
+};
+
+struct VdjLogger {
+    VdjLogRings rings;
+    std::atomic<bool> active { false };
+    std::atomic<int> maxLevel { VDJ_LOG_INFO };
+    std::atomic<uint64_t> dropped { 0 };
+    std::chrono::steady_clock::time_point origin;
+
+    // Registered strings are never freed: the writer reads them without a lock
+    std::atomic<const char*> formats[VDJ_LOG_MAX_FORMATS] = {};
+    std::atomic<int> formatCount { 0 };
+    std::mutex registerMutex;
+
+    std::mutex mutex;   /* control and writer thread only */
+    std::condition_variable wake;
+    std::thread writer;
+    uint64_t writerGeneration = 0;      /* bumped to stop the running writer */
+    uint32_t liveInstances = 0;         /* the writer runs only while one lives */
+    FILE *file = nullptr;
+    uint64_t reportedDrops = 0;
+    std::vector<VdjQueuedRecord> batch;
+
+    HRESULT Close();
+    void StartWriter();
+    void StopWriter(std::unique_lock<std::mutex> &lock);
+    void Flush();
+    void WriteLoop(uint64_t generation);
+};
+
+/* Never destroyed: a static destructor would join the writer under the
+   Windows loader lock. The writer runs only while an instance lives. */
+static VdjLogger& Logger() {
+    static VdjLogger *logger = new VdjLogger;
+    return *logger;
+}
+
+/* ============================================================================
+   Format Strings
+   ============================================================================ */
+
+enum VdjLogConversion { kConvNone, kConvSigned, kConvUnsigned, kConvChar, kConvFloat };
+
+/**
+ * Parse the conversion starting after a '%'. Writes a printf spec for the
+ * widened argument type to spec and returns the end of the conversion, or
+ * nullptr for conversions a record cannot carry.
+ */
+static const char* ParseConversion(const char *f, char *spec, VdjLogConversion *conv) {
+    char *s = spec;
+    *s++ = '%';
+    while (*f && strchr("-+ #0", *f) && s - spec < 8) *s++ = *f++;
+    while (*f >= '0' && *f <= '9' && s - spec < 16) *s++ = *f++;
+    if (*f == '.') {
+        *s++ = *f++;
+        while (*f >= '0' && *f <= '9' && s - spec < 24) *s++ = *f++;
+    }
+    if (*f == '*' || (*f >= '0' && *f <= '9')) return nullptr;
+    while (*f && strchr("hlLqjzt", *f)) f++;
+
+    const char c = *f;
+    if (c == 'd' || c == 'i') {
+        *conv = kConvSigned;
+        *s++ = 'l';
+        *s++ = 'l';
+    } else if (c == 'u' || c == 'o' || c == 'x' || c == 'X') {
+        *conv = kConvUnsigned;
+        *s++ = 'l';
+        *s++ = 'l';
+    } else if (c == 'c') {
+        *conv = kConvChar;
+    } else if (c && strchr("fFeEgGaA", c)) {
+        *conv = kConvFloat;
+    } else {
+        return nullptr;
+    }
+    *s++ = c;
+    *s = '\0';
+    return f + 1;
+}
+
+/** Number of arguments a format consumes, or -1 if it is unsupported */
+static int CountConversions(const char *format) {
+    char spec[32];
+    int count = 0;
+    for (const char *f = format; *f; ) {
+        if (*f++ != '%') continue;
+        if (*f == '%') {
+            f++;
+            continue;
+        }
+        VdjLogConversion conv = kConvNone;
+        f = ParseConversion(f, spec, &conv);
+        if (!f) return -1;
+        count++;
+    }
+    return count;
+}
+
+size_t VdjLogFormat(char *out, size_t size, const char *format, const VdjLogArg *args, int argCount) {
+    if (!out || size == 0) return 0;
+    size_t n = 0;
+    auto append = [&](int written) {
+        if (written > 0) n = std::min(n + (size_t)written, size - 1);
+    };
+
+    char spec[32];
+    int arg = 0;
+    for (const char *f = format; *f && n < size - 1; ) {
+        if (*f != '%') {
+            out[n++] = *f++;
+            continue;
+        }
+        f++;
+        if (*f == '%') {
+            out[n++] = *f++;
+            continue;
+        }
+
+        VdjLogConversion conv = kConvNone;
+        const char *end = ParseConversion(f, spec, &conv);
+        if (!end) {
+            append(snprintf(out + n, size - n, "<bad format>"));
+            break;
+        }
+        f = end;
+        if (arg >= argCount) {
+            append(snprintf(out + n, size - n, "<?>"));
+            continue;
+        }
+
+        const VdjLogArg a = args[arg++];
+        switch (conv) {
+        case kConvSigned:
+            append(snprintf(out + n, size - n, spec, (long long)a.i));
+            break;
+        case kConvUnsigned:
+            append(snprintf(out + n, size - n, spec, (unsigned long long)a.i));
+            break;
+        case kConvChar:
+            append(snprintf(out + n, size - n, spec, (int)a.i));
+            break;
+        default:
+            append(snprintf(out + n, size - n, spec, a.f));
+            break;
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+int VdjLogRegisterFormat(const char *format) {
+    if (!format) return -1;
+    const int count = CountConversions(format);
+    if (count < 0 || count > VDJ_LOG_MAX_ARGS) return -1;
+
+    VdjLogger &l = Logger();
+    std::lock_guard<std::mutex> lock(l.registerMutex);
+    const int registered = l.formatCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < registered; i++) {
+        if (strcmp(l.formats[i].load(std::memory_order_relaxed), format) == 0) return i;
+    }
+    if (registered >= VDJ_LOG_MAX_FORMATS) return -1;
+
+    const size_t len = strlen(format) + 1;
+    char *copy = new (std::nothrow) char[len];
+    if (!copy) return -1;
+    memcpy(copy, format, len);
+    l.formats[registered].store(copy, std::memory_order_release);
+    l.formatCount.store(registered + 1, std::memory_order_release);
+    return registered;
+}
+
+/* ============================================================================
+   Writing
+   ============================================================================ */
+
+HRESULT VdjLogWrite(int level, int formatId, const VdjLogArg *args, int argCount) {
+    VdjLogger &l = Logger();
+    if (!l.active.load(std::memory_order_acquire)) return S_FALSE;
+    if (level > l.maxLevel.load(std::memory_order_relaxed)) return S_FALSE;
+    if (formatId < 0 || formatId >= VDJ_LOG_MAX_FORMATS || argCount < 0 || (argCount > 0 && !args)) return E_FAIL;
+
+    int thread = 0;
+    VdjLogRecord *record = l.rings.Claim(&thread);
+    if (!record) {
+        l.dropped.fetch_add(1, std::memory_order_relaxed);
+        return S_FALSE;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    record->timeNs = now > l.origin
+        ? (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - l.origin).count() : 0;
+    record->formatId = formatId;
+    record->level = (int16_t)level;
+    record->argCount = (int16_t)std::min(argCount, VDJ_LOG_MAX_ARGS);
+    for (int i = 0; i < record->argCount; i++) record->args[i] = args[i];
+    l.rings.Publish(thread);
+    return S_OK;
+}
+
+/* ============================================================================
+   Writer Thread
+   ============================================================================ */
+
+void VdjLogger::Flush() {
+    batch.clear();
+    rings.Drain([this](int thread, const VdjLogRecord &r) {
+        batch.push_back({ r, thread });
+    });
+
+    // Rings are drained one after the other; restore the global order
+    std::stable_sort(batch.begin(), batch.end(), [](const VdjQueuedRecord &a, const VdjQueuedRecord &b) {
+        return a.record.timeNs < b.record.timeNs;
+    });
+
+    char message[512];
+    for (const VdjQueuedRecord &q : batch) {
+        const VdjLogRecord &r = q.record;
+        const int registered = formatCount.load(std::memory_order_acquire);
+        const char *format = r.formatId < registered ? formats[r.formatId].load(std::memory_order_acquire) : nullptr;
+        if (format) {
+            VdjLogFormat(message, sizeof(message), format, r.args, r.argCount);
+        } else {
+            snprintf(message, sizeof(message), "<unregistered format %d>", r.formatId);
+        }
+        const char *level = (r.level >= 0 && r.level <= VDJ_LOG_TRACE) ? kLevelNames[r.level] : "?";
+        fprintf(file, "[%12.6f] %-5s t%-2d %s\n", (double)r.timeNs / 1e9, level, q.thread + 1, message);
+    }
+
+    const uint64_t drops = dropped.load(std::memory_order_relaxed);
+    if (drops != reportedDrops) {
+        fprintf(file, "[%12.6f] WARN  log: %llu records dropped\n",
+                (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - origin).count() / 1e9,
+                (unsigned long long)(drops - reportedDrops));
+        reportedDrops = drops;
+    }
+    fflush(file);
+}
+
+void VdjLogger::WriteLoop(uint64_t generation) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (writerGeneration == generation) {
+        wake.wait_for(lock, std::chrono::milliseconds(50));
+        Flush();
+    }
+}
+
+/* Called with the mutex held */
+void VdjLogger::StartWriter() {
+    if (!file || !liveInstances || writer.joinable()) return;
+    const uint64_t generation = writerGeneration;
+    writer = std::thread([this, generation] { WriteLoop(generation); });
+}
+
+/* Called with the mutex held; unlocks it while joining */
+void VdjLogger::StopWriter(std::unique_lock<std::mutex> &lock) {
+    if (!writer.joinable()) return;
+    writerGeneration++;
+    std::thread stopped = std::move(writer);
+    lock.unlock();
+    wake.notify_one();
+    stopped.join();
+    lock.lock();
+}
+
+/* ============================================================================
+   Control
+   ============================================================================ */
+
+HRESULT VdjLogOpen(const char *path, int maxLevel) {
+    VdjLogger &l = Logger();
+    std::unique_lock<std::mutex> lock(l.mutex);
+    if (l.file) return E_FAIL;
+
+    if (!l.rings.Allocate()) return E_FAIL;
+    l.rings.Discard();
+    l.batch.reserve(VDJ_LOG_RING_RECORDS);
+
+    l.file = path ? fopen(path, "a") : stderr;
+    if (!l.file) return E_FAIL;
+
+    l.dropped.store(0, std::memory_order_relaxed);
+    l.reportedDrops = 0;
+    l.maxLevel.store(maxLevel, std::memory_order_relaxed);
+    l.origin = std::chrono::steady_clock::now();
+    l.active.store(true, std::memory_order_release);
+    l.StartWriter();
+    return S_OK;
+}
+
+HRESULT VdjLogger::Close() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!file) return S_FALSE;
+    active.store(false, std::memory_order_release);
+    StopWriter(lock);
+    // A concurrent Close finished the log while we waited
+    if (!file) return S_FALSE;
+
+    Flush();
+    const bool ok = file == stderr || fclose(file) == 0;
+    file = nullptr;
+    return ok ? S_OK : E_FAIL;
+}
+
+HRESULT VdjLogClose() {
+    return Logger().Close();
+}
+
+void VdjLogInstanceCreated() {
+    VdjLogger &l = Logger();
+    std::lock_guard<std::mutex> lock(l.mutex);
+    l.liveInstances++;
+    l.StartWriter();
+}
+
+void VdjLogInstanceReleased() {
+    VdjLogger &l = Logger();
+    std::unique_lock<std::mutex> lock(l.mutex);
+    if (--l.liveInstances) return;
+    l.StopWriter(lock);
+    if (l.file) l.Flush();
+}
+
+uint64_t VdjLogDroppedRecords() {
+    return Logger().dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,52 @@
+/**
+ * VirtualDJ Rust SDK - Realtime-Safe Logger
+ *
+ * Callbacks log fixed-size binary records (format ID, level, timestamp and up
+ * to VDJ_LOG_MAX_ARGS numbers) into per-thread rings without locking,
+ * allocating or formatting. A background thread formats them with the
+ * registered printf-style strings and writes them to a file or stderr.
+ */
+
+#ifndef VDJ_SHIM_RT_LOG_H
+#define VDJ_SHIM_RT_LOG_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <cstddef>
+
+#define VDJ_LOG_MAX_THREADS     32
+#define VDJ_LOG_RING_RECORDS    1024    /* power of two */
+
+struct VdjLogRecord {
+    uint64_t timeNs;    /* since the logger opened */
+    int32_t formatId;
+    int16_t level;
+    int16_t argCount;
+    VdjLogArg args[VDJ_LOG_MAX_ARGS];
+};
+
+/**
+ * Register a format string, returning the existing ID for a string that is
+ * already registered. Returns -1 for unsupported formats.
+ */
+int VdjLogRegisterFormat(const char *format);
+
+HRESULT VdjLogOpen(const char *path, int maxLevel);
+HRESULT VdjLogClose();
+HRESULT VdjLogWrite(int level, int formatId, const VdjLogArg *args, int argCount);
+uint64_t VdjLogDroppedRecords();
+
+/**
+ * Count live plugin instances. The writer thread runs only while a log is
+ * open and an instance lives, as the trace flusher does; releasing the last
+ * instance joins it and writes out the records so far.
+ */
+void VdjLogInstanceCreated();
+void VdjLogInstanceReleased();
+
+/**
+ * Format a message into out (always NUL-terminated); returns its length
+ */
+size_t VdjLogFormat(char *out, size_t size, const char *format, const VdjLogArg *args, int argCount);
+
+#endif /* VDJ_SHIM_RT_LOG_H */
@@ -0,0 +1,226 @@
+/**
+ * VirtualDJ Rust SDK - Sample Conversion
+ */
+
+#include "sample_convert.h"
+#include "simd.h"
+
+#include <cstring>
+
+/* ============================================================================
+   Vector Kernels
+   ============================================================================ */
+
+/*
+ * Per instruction set: the dither generator lanes, 8 int16 samples to
+ * float, 8 rounded floats already in int16 range to int16, and NaN to 0.
+ * The generator is xorshift32 in each lane; each draw gives two 16-bit
+ * uniforms in [1, 2) whose sum, less 3, is triangular over +-1 LSB. The
+ * two halves of a block draw from separate lanes, which keeps their dither
+ * sequences independent.
+ */
+
+#if defined(VDJ_SIMD_SSE2)
+
+typedef __m128i VdjDitherLanes;
+
+static inline VdjDitherLanes LoadLanes(const uint32_t *state) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+}
+
+static inline void StoreLanes(uint32_t *state, VdjDitherLanes lanes) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), lanes);
+}
+
+static inline VdjF4 Triangular(VdjDitherLanes &lanes) {
+    __m128i x = lanes;
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    lanes = x;
+    const __m128i one = _mm_set1_epi32(0x3f800000);
+    const __m128i high = _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(x, 16), 7), one);
+    const __m128i low = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(x, _mm_set1_epi32(0xffff)), 7), one);
+    return { _mm_sub_ps(_mm_add_ps(_mm_castsi128_ps(high), _mm_castsi128_ps(low)), _mm_set1_ps(3.0f)) };
+}
+
+static inline VdjF4 ZeroNan(VdjF4 a) {
+    return { _mm_and_ps(a.v, _mm_cmpord_ps(a.v, a.v)) };
+}
+
+static inline void Int16ToFloat8(const int16_t *in, float *out) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    // Sign-extend by unpacking each sample into a high half and shifting down
+    _mm_storeu_ps(out, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)), scale));
+    _mm_storeu_ps(out + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)), scale));
+}
+
+static inline void Pack8(VdjF4 a, VdjF4 b, int16_t *out) {
+    const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a.v), _mm_cvtps_epi32(b.v));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+}
+
+#elif defined(VDJ_SIMD_NEON)
+
+typedef uint32x4_t VdjDitherLanes;
+
+static inline VdjDitherLanes LoadLanes(const uint32_t *state) {
+    return vld1q_u32(state);
+}
+
+static inline void StoreLanes(uint32_t *state, VdjDitherLanes lanes) {
+    vst1q_u32(state, lanes);
+}
+
+static inline VdjF4 Triangular(VdjDitherLanes &lanes) {
+    uint32x4_t x = lanes;
+    x = veorq_u32(x, vshlq_n_u32(x, 13));
+    x = veorq_u32(x, vshrq_n_u32(x, 17));
+    x = veorq_u32(x, vshlq_n_u32(x, 5));
+    lanes = x;
+    const uint32x4_t one = vdupq_n_u32(0x3f800000u);
+    const uint32x4_t high = vorrq_u32(vshlq_n_u32(vshrq_n_u32(x, 16), 7), one);
+    const uint32x4_t low = vorrq_u32(vshlq_n_u32(vandq_u32(x, vdupq_n_u32(0xffffu)), 7), one);
+    const float32x4_t sum = vaddq_f32(vreinterpretq_f32_u32(high), vreinterpretq_f32_u32(low));
+    return { vsubq_f32(sum, vdupq_n_f32(3.0f)) };
+}
+
+static inline VdjF4 ZeroNan(VdjF4 a) {
+    return { vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vceqq_f32(a.v, a.v))) };
+}
+
+static inline void Int16ToFloat8(const int16_t *in, float *out) {
+    const int16x8_t x = vld1q_s16(in);
+    vst1q_f32(out, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), 1.0f / 32768.0f));
+    vst1q_f32(out + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), 1.0f / 32768.0f));
+}
+
+static inline void Pack8(VdjF4 a, VdjF4 b, int16_t *out) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+    const int32x4_t ia = vcvtnq_s32_f32(a.v), ib = vcvtnq_s32_f32(b.v);
+#else
+    const int32x4_t ia = vcvtq_s32_f32(VdjF4Round(a).v), ib = vcvtq_s32_f32(VdjF4Round(b).v);
+#endif
+    vst1q_s16(out, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+}
+
+#else
+
+struct VdjDitherLanes {
+    uint32_t v[4];
+};
+
+static inline VdjDitherLanes LoadLanes(const uint32_t *state) {
+    VdjDitherLanes lanes;
+    memcpy(lanes.v, state, sizeof(lanes.v));
+    return lanes;
+}
+
+static inline void StoreLanes(uint32_t *state, VdjDitherLanes lanes) {
+    memcpy(state, lanes.v, sizeof(lanes.v));
+}
+
+static inline VdjF4 Triangular(VdjDitherLanes &lanes) {
+    VdjF4 r;
+    for (int i = 0; i < 4; i++) {
+        uint32_t x = lanes.v[i];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        lanes.v[i] = x;
+        const uint32_t highBits = ((x >> 16) << 7) | 0x3f800000u;
+        const uint32_t lowBits = ((x & 0xffffu) << 7) | 0x3f800000u;
+        float high, low;
+        memcpy(&high, &highBits, sizeof(high));
+        memcpy(&low, &lowBits, sizeof(low));
+        r.v[i] = high + low - 3.0f;
+    }
+    return r;
+}
+
+static inline VdjF4 ZeroNan(VdjF4 a) {
+    for (int i = 0; i < 4; i++) a.v[i] = a.v[i] == a.v[i] ? a.v[i] : 0.0f;
+    return a;
+}
+
+static inline void Int16ToFloat8(const int16_t *in, float *out) {
+    for (int i = 0; i < 8; i++) out[i] = (float)in[i] * (1.0f / 32768.0f);
+}
+
+static inline void Pack8(VdjF4 a, VdjF4 b, int16_t *out) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (int16_t)nearbyintf(a.v[i]);
+        out[i + 4] = (int16_t)nearbyintf(b.v[i]);
+    }
+}
+
+#endif
+
+/* ============================================================================
+   Conversion
+   ============================================================================ */
+
+void VdjDitherInit(VdjDither *dither, uint32_t seed) {
+    for (int i = 0; i < 8; i++) {
+        // splitmix32 of seed and lane; xorshift must not start at zero
+        uint32_t z = seed + 0x9e3779b9u * (uint32_t)(i + 1);
+        z = (z ^ (z >> 16)) * 0x85ebca6bu;
+        z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+        z ^= z >> 16;
+        dither->state[i] = z ? z : 0x6d2b79f5u;
+    }
+}
+
+void VdjInt16ToFloat(const int16_t *in, float *out, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) Int16ToFloat8(in + i, out + i);
+    for (; i < count; i++) out[i] = (float)in[i] * (1.0f / 32768.0f);
+}
+
+template <bool Dithered>
+static void FloatToInt16Blocks(const float *in, int16_t *out, int blocks, VdjDitherLanes (&lanes)[2]) {
+    const VdjF4 scale = VdjF4Set1(32768.0f);
+    const VdjF4 lo = VdjF4Set1(-32768.0f), hi = VdjF4Set1(32767.0f);
+    for (int b = 0; b < blocks; b++, in += 8, out += 8) {
+        VdjF4 x0 = VdjF4Mul(ZeroNan(VdjF4Load(in)), scale);
+        VdjF4 x1 = VdjF4Mul(ZeroNan(VdjF4Load(in + 4)), scale);
+        if (Dithered) {
+            x0 = VdjF4Add(x0, Triangular(lanes[0]));
+            x1 = VdjF4Add(x1, Triangular(lanes[1]));
+        }
+        Pack8(VdjF4Min(VdjF4Max(x0, lo), hi), VdjF4Min(VdjF4Max(x1, lo), hi), out);
+    }
+}
+
+void VdjFloatToInt16(const float *in, int16_t *out, int count, VdjDither *dither) {
+    VdjDitherLanes lanes[2] {};
+    if (dither) {
+        lanes[0] = LoadLanes(dither->state);
+        lanes[1] = LoadLanes(dither->state + 4);
+    }
+    const int blocks = count / 8;
+    if (dither) {
+        FloatToInt16Blocks<true>(in, out, blocks, lanes);
+    } else {
+        FloatToInt16Blocks<false>(in, out, blocks, lanes);
+    }
+
+    // The tail through a zero-padded block, so it is dithered the same way
+    const int done = blocks * 8;
+    if (done < count) {
+        float padded[8] = {};
+        int16_t converted[8];
+        memcpy(padded, in + done, sizeof(float) * (size_t)(count - done));
+        if (dither) {
+            FloatToInt16Blocks<true>(padded, converted, 1, lanes);
+        } else {
+            FloatToInt16Blocks<false>(padded, converted, 1, lanes);
+        }
+        memcpy(out + done, converted, sizeof(int16_t) * (size_t)(count - done));
+    }
+    if (dither) {
+        StoreLanes(dither->state, lanes[0]);
+        StoreLanes(dither->state + 4, lanes[1]);
+    }
+}
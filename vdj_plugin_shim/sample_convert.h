@@ -0,0 +1,27 @@
+/**
+ * VirtualDJ Rust SDK - Sample Conversion
+ *
+ * int16 to float and float to int16 kernels for buffer DSP plugins, which
+ * read and return 16-bit stereo buffers but process in float. Float to
+ * int16 rounds, saturates and can add TPDF dither from a per-caller
+ * generator; both directions are vectorized with SSE2 or NEON.
+ */
+
+#ifndef VDJ_SHIM_SAMPLE_CONVERT_H
+#define VDJ_SHIM_SAMPLE_CONVERT_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+/** Seed the generator lanes from seed; any seed gives nonzero lanes */
+void VdjDitherInit(VdjDither *dither, uint32_t seed);
+
+/** count samples scaled by 1/32768 */
+void VdjInt16ToFloat(const int16_t *in, float *out, int count);
+
+/**
+ * count samples scaled by 32768, rounded to nearest and saturated, with
+ * +-1 LSB TPDF dither when dither is not null. NaN gives 0.
+ */
+void VdjFloatToInt16(const float *in, int16_t *out, int count, VdjDither *dither);
+
+#endif /* VDJ_SHIM_SAMPLE_CONVERT_H */
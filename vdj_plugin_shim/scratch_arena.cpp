@@ -0,0 +1,51 @@
+/**
+ * VirtualDJ Rust SDK - Scratch Arena
+ */
+
+#include "scratch_arena.h"
+
+/* Smallest block worth allocating */
+static const uint64_t kMinScratchBytes = 4096;
+
+static_assert(VDJ_SCRATCH_MAX_BYTES <= SIZE_MAX, "scratch limit must fit size_t");
+
+/* Usable bytes of a block from VdjInstanceAllocate, its bookkeeping line excluded */
+static uint64_t BlockCapacity(const void *block) {
+    return block ? (uint64_t)VdjInstanceBytes(block) - VDJ_CACHE_LINE_SIZE : 0;
+}
+
+VdjScratch::~VdjScratch() {
+    VdjInstanceFree(arena.base);
+}
+
+bool VdjScratch::Reserve(uint64_t bytes) {
+    if (bytes > VDJ_SCRATCH_MAX_BYTES) return false;
+    std::lock_guard<std::mutex> lock(growLock);
+    // The plugin writes demand, so a runaway one is only served up to the limit
+    uint64_t demand = peakDemand.load(std::memory_order_relaxed);
+    if (demand > VDJ_SCRATCH_MAX_BYTES) demand = VDJ_SCRATCH_MAX_BYTES;
+    const uint64_t target = bytes > demand ? bytes : demand;
+    if (target == 0 || target <= reservedBytes.load(std::memory_order_relaxed)) return true;
+
+    // Both are powers of two, so this stops at the limit at the latest
+    uint64_t size = kMinScratchBytes;
+    while (size < target) size *= 2;
+    void *block = VdjInstanceAllocate((size_t)size);
+    if (!block) return false;
+    reservedBytes.store(BlockCapacity(block), std::memory_order_relaxed);
+    blocks.Publish(block);
+    return true;
+}
+
+void VdjScratch::EndBlock() {
+    if (arena.demand > peakDemand.load(std::memory_order_relaxed)) {
+        peakDemand.store(arena.demand, std::memory_order_relaxed);
+    }
+    arena.used = 0;
+    arena.demand = 0;
+
+    void *block = blocks.Take(arena.base);
+    if (!block) return;
+    arena.base = static_cast<uint8_t*>(block);
+    arena.capacity = BlockCapacity(block);
+}
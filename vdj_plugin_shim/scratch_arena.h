@@ -0,0 +1,64 @@
+/**
+ * VirtualDJ Rust SDK - Scratch Arena
+ *
+ * Per-instance bump allocator for temporary buffers of one audio or render
+ * callback. The plugin allocates by advancing an offset in a shared
+ * VdjScratchArena, and the shim rewinds it when the callback returns. The
+ * arena never allocates on the audio thread: control threads grow it to the
+ * largest demand seen so far, and the audio thread swaps the grown block in
+ * between two callbacks.
+ */
+
+#ifndef VDJ_SHIM_SCRATCH_ARENA_H
+#define VDJ_SHIM_SCRATCH_ARENA_H
+
+#include "../abi/vdj_plugin_abi.h"
+#include "block_handoff.h"
+#include "instance_memory.h"
+
+#include <atomic>
+#include <mutex>
+
+struct VdjScratch {
+    VdjScratch() = default;
+    VdjScratch(const VdjScratch&) = delete;
+    VdjScratch& operator=(const VdjScratch&) = delete;
+    ~VdjScratch();
+
+    /**
+     * Make sure the arena can hold `bytes` and the largest demand of any
+     * block so far, rounded up to a power of two. A grown block is taken by
+     * the end of the next callback. Returns false when out of memory.
+     * Control threads only.
+     */
+    bool Reserve(uint64_t bytes);
+
+    /**
+     * Rewind the arena after the callback that owns it, record its demand and
+     * swap in a grown block if one is waiting. Owning thread only.
+     */
+    void EndBlock();
+
+    /* Owned by the thread of the callback the arena belongs to */
+    VdjScratchArena arena = {};
+
+    std::atomic<uint64_t> peakDemand { 0 };
+    std::atomic<uint64_t> reservedBytes { 0 };     /* capacity of the newest block */
+    VdjBlockHandoff blocks { VdjInstanceFree };     /* grown blocks on their way to the owner */
+    std::mutex growLock;
+};
+
+/**
+ * Ends the arena's block when the enclosing callback returns
+ */
+struct VdjScratchScope {
+    explicit VdjScratchScope(VdjScratch &scratch) : scratch(scratch) {}
+    ~VdjScratchScope() { scratch.EndBlock(); }
+
+    VdjScratchScope(const VdjScratchScope&) = delete;
+    VdjScratchScope& operator=(const VdjScratchScope&) = delete;
+
+    VdjScratch &scratch;
+};
+
+#endif /* VDJ_SHIM_SCRATCH_ARENA_H */
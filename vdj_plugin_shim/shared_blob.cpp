@@ -0,0 +1,195 @@
+/**
+ * VirtualDJ Rust SDK - Shared Parameter Blobs
+ */
+
+#include "shared_blob.h"
+#include "instance_memory.h"
+
+#include <cstring>
+#include <new>
+#include <unordered_map>
+
+/* ============================================================================
+   Blob Store
+   ============================================================================ */
+
+struct VdjBlobStore {
+    std::mutex lock;
+    std::unordered_multimap<uint64_t, VdjBlob*> blobs;
+    uint64_t bytes = 0;
+    uint64_t references = 0;
+    uint64_t sharedBytes = 0;
+};
+
+static VdjBlobStore& Store() {
+    static VdjBlobStore store;
+    return store;
+}
+
+/* FNV-1a; collisions only cost a compare */
+static uint64_t Hash(const void *data, uint64_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (uint64_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+static VdjBlob* NewBlob(uint64_t size) {
+    if (size > SIZE_MAX - sizeof(VdjBlob)) return nullptr;
+    void *memory = VdjInstanceAllocate(sizeof(VdjBlob) + (size_t)size);
+    if (!memory) return nullptr;
+    VdjBlob *blob = new (memory) VdjBlob();
+    blob->size = size;
+    blob->references = 1;
+    return blob;
+}
+
+static void FreeBlob(VdjBlob *blob) {
+    blob->~VdjBlob();
+    VdjInstanceFree(blob);
+}
+
+/* A new reference to a held blob with these contents, or nullptr */
+static VdjBlob* FindLocked(VdjBlobStore &store, uint64_t hash, const void *data, uint64_t size) {
+    auto range = store.blobs.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        VdjBlob *blob = it->second;
+        if (blob->size != size || (size && memcmp(blob->Data(), data, (size_t)size) != 0)) continue;
+        blob->references++;
+        store.references++;
+        store.sharedBytes += size;
+        return blob;
+    }
+    return nullptr;
+}
+
+/* Hand a filled blob to the store, or share an identical one in its place */
+static VdjBlob* Adopt(VdjBlob *blob) {
+    VdjBlobStore &store = Store();
+    VdjBlob *held;
+    {
+        std::lock_guard<std::mutex> guard(store.lock);
+        held = FindLocked(store, blob->hash, blob->Data(), blob->size);
+        if (!held) {
+            store.blobs.emplace(blob->hash, blob);
+            store.bytes += blob->size;
+            store.references++;
+            return blob;
+        }
+    }
+    FreeBlob(blob);
+    return held;
+}
+
+VdjBlob* VdjBlobIntern(const void *data, uint64_t size) {
+    const uint64_t hash = Hash(data, size);
+    VdjBlobStore &store = Store();
+    {
+        std::lock_guard<std::mutex> guard(store.lock);
+        if (VdjBlob *held = FindLocked(store, hash, data, size)) return held;
+    }
+
+    // Copy outside the lock; Adopt shares the blob another thread may have
+    // interned meanwhile
+    VdjBlob *blob = NewBlob(size);
+    if (!blob) return nullptr;
+    blob->hash = hash;
+    if (size) memcpy(blob + 1, data, (size_t)size);
+    return Adopt(blob);
+}
+
+void VdjBlobRelease(void *released) {
+    if (!released) return;
+    VdjBlob *blob = static_cast<VdjBlob*>(released);
+
+    VdjBlobStore &store = Store();
+    {
+        std::lock_guard<std::mutex> guard(store.lock);
+        store.references--;
+        if (--blob->references > 0) {
+            store.sharedBytes -= blob->size;
+            return;
+        }
+        auto range = store.blobs.equal_range(blob->hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second != blob) continue;
+            store.blobs.erase(it);
+            break;
+        }
+        store.bytes -= blob->size;
+    }
+    FreeBlob(blob);
+}
+
+void VdjBlobGetStats(VdjSharedBlobStats *stats) {
+    VdjBlobStore &store = Store();
+    std::lock_guard<std::mutex> guard(store.lock);
+    stats->blobs = store.blobs.size();
+    stats->bytes = store.bytes;
+    stats->references = store.references;
+    stats->shared_bytes = store.sharedBytes;
+}
+
+/* ============================================================================
+   Instance Slots
+   ============================================================================ */
+
+VdjSharedBlobs::~VdjSharedBlobs() {
+    const int n = count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; i++) VdjBlobRelease(slots[i].current);
+}
+
+HRESULT VdjSharedBlobs::PublishLocked(int id, VdjBlob *blob) {
+    const int n = count.load(std::memory_order_relaxed);
+    int i = 0;
+    while (i < n && slots[i].id != id) i++;
+    if (i == n) {
+        if (n == VDJ_SHARED_BLOB_SLOTS) {
+            VdjBlobRelease(blob);
+            return E_FAIL;
+        }
+        slots[i].id = id;
+        count.store(n + 1, std::memory_order_release);
+    }
+    slots[i].latest = blob;
+    slots[i].blobs.Publish(blob);
+    return S_OK;
+}
+
+HRESULT VdjSharedBlobs::Set(int id, const void *data, uint64_t size) {
+    VdjBlob *blob = VdjBlobIntern(data, size);
+    if (!blob) return E_FAIL;
+    std::lock_guard<std::mutex> guard(lock);
+    return PublishLocked(id, blob);
+}
+
+HRESULT VdjSharedBlobs::Edit(int id, uint64_t offset, const void *data, uint64_t size) {
+    std::lock_guard<std::mutex> guard(lock);
+    const VdjBlob *latest = nullptr;
+    const int n = count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; i++) {
+        if (slots[i].id == id) latest = slots[i].latest;
+    }
+    if (!latest || offset > latest->size || size > latest->size - offset) return E_FAIL;
+
+    // The newest blob stays alive while the lock is held: only a later
+    // publish can retire it. Other instances keep reading it unchanged.
+    VdjBlob *blob = NewBlob(latest->size);
+    if (!blob) return E_FAIL;
+    char *bytes = reinterpret_cast<char*>(blob + 1);
+    memcpy(bytes, latest->Data(), (size_t)latest->size);
+    if (size) memcpy(bytes + offset, data, (size_t)size);
+    blob->hash = Hash(bytes, blob->size);
+    return PublishLocked(id, Adopt(blob));
+}
+
+const VdjBlob* VdjSharedBlobs::Get(int id) const {
+    const int n = count.load(std::memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        if (slots[i].id == id) return slots[i].current;
+    }
+    return nullptr;
+}
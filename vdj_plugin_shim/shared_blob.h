@@ -0,0 +1,91 @@
+/**
+ * VirtualDJ Rust SDK - Shared Parameter Blobs
+ *
+ * Large custom parameter payloads (wavetables, step patterns, sample
+ * slices) kept once per process instead of once per instance. Blobs are
+ * content-addressed and reference-counted: an instance publishing a payload
+ * identical to one already held shares it, and an edit copies the payload
+ * before changing it, so other instances never see a write. Each instance
+ * swaps a newly published blob in at the start of its next block; the blob
+ * it replaces is released on a control thread.
+ */
+
+#ifndef VDJ_SHIM_SHARED_BLOB_H
+#define VDJ_SHIM_SHARED_BLOB_H
+
+#include "../abi/vdj_plugin_abi.h"
+#include "block_handoff.h"
+
+#include <atomic>
+#include <mutex>
+
+/* Payload follows the header, which fills a cache line */
+struct alignas(64) VdjBlob {
+    uint64_t hash;
+    uint64_t size;
+    uint64_t references;    /* under the store lock */
+
+    const void* Data() const { return this + 1; }
+};
+
+/**
+ * Reference to a blob holding `size` bytes of `data`, sharing an identical
+ * one when the store has it. Returns nullptr when out of memory.
+ */
+VdjBlob* VdjBlobIntern(const void *data, uint64_t size);
+
+/** Drop a reference from VdjBlobIntern; accepts nullptr */
+void VdjBlobRelease(void *blob);
+
+void VdjBlobGetStats(VdjSharedBlobStats *stats);
+
+struct VdjSharedSlot {
+    int id = 0;
+    VdjBlob *current = nullptr;     /* owning thread */
+    VdjBlob *latest = nullptr;      /* newest published, under the instance lock */
+    VdjBlockHandoff blobs { VdjBlobRelease };
+};
+
+struct VdjSharedBlobs {
+    VdjSharedBlobs() = default;
+    VdjSharedBlobs(const VdjSharedBlobs&) = delete;
+    VdjSharedBlobs& operator=(const VdjSharedBlobs&) = delete;
+    ~VdjSharedBlobs();
+
+    /**
+     * Publish `size` bytes of `data` as the payload of parameter `id`.
+     * E_FAIL when out of memory or slots. Control threads.
+     */
+    HRESULT Set(int id, const void *data, uint64_t size);
+
+    /**
+     * Publish a copy of the newest payload of `id` with `size` bytes at
+     * `offset` replaced by `data`. E_FAIL when nothing was published for
+     * `id` or the range does not fit in it. Control threads.
+     */
+    HRESULT Edit(int id, uint64_t offset, const void *data, uint64_t size);
+
+    /**
+     * At the start of a callback: swap in the blobs published since the
+     * last one. Owning thread only.
+     */
+    void BeginBlock() {
+        const int n = count.load(std::memory_order_acquire);
+        for (int i = 0; i < n; i++) {
+            VdjSharedSlot &slot = slots[i];
+            if (slot.blobs.Waiting()) slot.current = static_cast<VdjBlob*>(slot.blobs.Take(slot.current));
+        }
+    }
+
+    /** Blob of `id` for the current block, or nullptr. Owning thread only. */
+    const VdjBlob* Get(int id) const;
+
+    VdjSharedSlot slots[VDJ_SHARED_BLOB_SLOTS];
+    std::atomic<int> count { 0 };   /* slots with an id, published in order */
+    std::mutex lock;
+
+private:
+    HRESULT PublishLocked(int id, VdjBlob *blob);
+};
+
+#endif /* VDJ_SHIM_SHARED_BLOB_H */
@@ -0,0 +1,121 @@
+/**
+ * VirtualDJ Rust SDK - Shim Instance State
+ *
+ * State the shim keeps for every plugin instance, whatever its type. Each
+ * wrapper derives from VdjShimInstance next to its VirtualDJ interface, so
+ * C ABI functions taking a generic VdjPlugin handle can reach it.
+ */
+
+#ifndef VDJ_SHIM_INSTANCE_H
+#define VDJ_SHIM_INSTANCE_H
+
+#include "../abi/vdj_plugin_abi.h"
+#include "command_queue.h"
+#include "instance_memory.h"
+#include "latency_histogram.h"
+#include "param_snapshot.h"
+#include "preset_morph.h"
+#include "replay_recorder.h"
+#include "rt_log.h"
+#include "scratch_arena.h"
+#include "shared_blob.h"
+#include "trace.h"
+#include "vdj_sdk.h"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+
+struct VdjShimInstance {
+    VdjShimInstance() : instanceId(NextInstanceId()) {
+        VdjTraceInstanceCreated();
+        VdjLogInstanceCreated();
+    }
+
+    /* Background threads are joined here, on the thread releasing the
+       plugin, and never from static destructors: on Windows those run under
+       the loader lock, which an exiting thread needs. With no instance left
+       the library may be unloaded, so no shim thread may outlive the last. */
+    virtual ~VdjShimInstance() {
+        if (Recorded()) VdjReplayStop();
+        VdjTraceInstanceReleased();
+        VdjLogInstanceReleased();
+    }
+
+    /* Wrappers are allocated on cache lines of their own, pages touched */
+    static void* operator new(size_t size) {
+        void *object = VdjInstanceAllocate(size);
+        if (!object) throw std::bad_alloc();
+        return object;
+    }
+    static void operator delete(void *object) { VdjInstanceFree(object); }
+
+    const uint32_t instanceId;  /* unique per process, starts at 1 */
+    VdjStateRegion state;
+    VdjScratch scratch;
+    VdjProfiler profiler;
+    VdjCommandQueue commands;
+    VdjReplayParameters replayParameters;
+    VdjPresetSwap presets;
+    VdjPresetMorph morph;
+    VdjSharedBlobs sharedBlobs;
+
+    /** True while this instance's calls are being recorded */
+    bool Recorded() const { return VdjReplayTarget() == instanceId; }
+
+private:
+    static uint32_t NextInstanceId() {
+        static std::atomic<uint32_t> next { 1 };
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+};
+
+/**
+ * Shim state of any plugin handle. Every handle points at a wrapper whose
+ * first base is an IVdjPlugin8, so the cross-cast works for all plugin types.
+ */
+static inline VdjShimInstance* VdjGetShimInstance(VdjPlugin *plugin) {
+    if (!plugin) return nullptr;
+    return dynamic_cast<VdjShimInstance*>(reinterpret_cast<IVdjPlugin8*>(plugin));
+}
+
+/**
+ * Instruments the enclosing C ABI entry point: records its duration into the
+ * instance's latency histogram and a span into the trace, when enabled. For
+ * audio callbacks, pass the block length and sample rate to count calls that
+ * took longer than the block lasts.
+ */
+struct VdjCallbackScope {
+    VdjCallbackScope(const VdjShimInstance &instance, int callback, const char *name,
+                     int nb = 0, int sampleRate = 0)
+        : histogram(instance.profiler.Active(callback)), tracing(VdjTraceActive()),
+          name(name), callback(callback), instanceId(instance.instanceId) {
+        if (!histogram && !tracing) return;
+        budgetNs = (nb > 0 && sampleRate > 0) ? (uint64_t)nb * 1000000000ull / (uint64_t)sampleRate : 0;
+        start = std::chrono::steady_clock::now();
+    }
+
+    ~VdjCallbackScope() {
+        if (!histogram && !tracing) return;
+        const auto end = std::chrono::steady_clock::now();
+        if (histogram) {
+            const uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            histogram->Record(ns, budgetNs != 0 && ns > budgetNs);
+        }
+        if (tracing) VdjTraceRecord(name, callback, instanceId, start, end);
+    }
+
+    VdjCallbackScope(const VdjCallbackScope&) = delete;
+    VdjCallbackScope& operator=(const VdjCallbackScope&) = delete;
+
+    VdjLatencyHistogram *histogram;
+    bool tracing;
+    const char *name;
+    int callback;
+    uint32_t instanceId;
+    uint64_t budgetNs = 0;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif /* VDJ_SHIM_INSTANCE_H */
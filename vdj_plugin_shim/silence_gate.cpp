@@ -0,0 +1,47 @@
+/**
+ * VirtualDJ Rust SDK - Silence Detection
+ */
+
+#include "silence_gate.h"
+#include "simd.h"
+
+bool VdjIsSilent(const float *samples, int count) {
+    int i = 0;
+
+    // Check 16 samples per iteration and stop at the first loud chunk, so a
+    // block carrying signal costs almost nothing to classify
+    for (; i + 16 <= count; i += 16) {
+        VdjF4 peak = VdjF4Max(VdjF4Abs(VdjF4Load(samples + i)), VdjF4Abs(VdjF4Load(samples + i + 4)));
+        peak = VdjF4Max(peak, VdjF4Abs(VdjF4Load(samples + i + 8)));
+        peak = VdjF4Max(peak, VdjF4Abs(VdjF4Load(samples + i + 12)));
+        if (VdjF4MaxLane(peak) > VDJ_SILENCE_THRESHOLD) return false;
+    }
+    for (; i < count; i++) {
+        const float s = samples[i];
+        if (s > VDJ_SILENCE_THRESHOLD || s < -VDJ_SILENCE_THRESHOLD) return false;
+    }
+    return true;
+}
+
+bool VdjSilenceGate::Process(const float *buffer, int nb, int sampleRate) {
+    if (silentBlocks <= 0 || !buffer || nb <= 0) return false;
+
+    if (!VdjIsSilent(buffer, nb * 2)) {
+        Reset();
+        return false;
+    }
+
+    const long long tailFrames = (long long)(tailMs * 0.001f * (float)sampleRate);
+    if (silentFrames < tailFrames) silentFrames += nb;
+    if (silentCount < silentBlocks) silentCount++;
+
+    const bool bypass = silentCount >= silentBlocks && silentFrames >= tailFrames;
+    idle.store(bypass, std::memory_order_relaxed);
+    return bypass;
+}
+
+void VdjSilenceGate::Reset() {
+    silentCount = 0;
+    silentFrames = 0;
+    idle.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,42 @@
+/**
+ * VirtualDJ Rust SDK - Silence Detection
+ *
+ * Detects silent input blocks in OnProcessSamples so idle decks stop running
+ * effect code. Once a plugin has seen enough silent blocks and its declared
+ * tail has rung out, the shim bypasses it until the next non-silent block.
+ */
+
+#ifndef VDJ_SHIM_SILENCE_GATE_H
+#define VDJ_SHIM_SILENCE_GATE_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <atomic>
+
+/* Peak below which a sample counts as silent (about -100 dBFS) */
+#define VDJ_SILENCE_THRESHOLD 1e-5f
+
+struct VdjSilenceGate {
+    int silentBlocks = 0;       /* silent blocks before bypassing, 0 disables the gate */
+    float tailMs = 0.0f;        /* plugin tail that must ring out after the last signal */
+    bool processAfterStop = false;
+
+    int silentCount = 0;        /* consecutive silent blocks */
+    long long silentFrames = 0; /* frames since the last signal, saturating */
+    std::atomic<bool> idle { false };   /* written by the audio thread, read from any */
+
+    /**
+     * Returns true when the block can be bypassed. Wakes on the first block
+     * holding any sample above VDJ_SILENCE_THRESHOLD.
+     */
+    bool Process(const float *buffer, int nb, int sampleRate);
+
+    void Reset();
+};
+
+/**
+ * True when all count samples are below VDJ_SILENCE_THRESHOLD
+ */
+bool VdjIsSilent(const float *samples, int count);
+
+#endif /* VDJ_SHIM_SILENCE_GATE_H */
@@ -0,0 +1,221 @@
+/**
+ * VirtualDJ Rust SDK - SIMD Helpers
+ *
+ * Minimal 4-lane float vector used by the shim's block kernels. Maps to SSE2
+ * on x86/x64 and NEON on ARM, with a scalar fallback for other targets.
+ */
+
+#ifndef VDJ_SHIM_SIMD_H
+#define VDJ_SHIM_SIMD_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VDJ_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VDJ_SIMD_NEON 1
+#else
+#include <cmath>
+#endif
+
+#define VDJ_SIMD_WIDTH 4
+
+/**
+ * Four float lanes
+ */
+struct VdjF4 {
+#if defined(VDJ_SIMD_SSE2)
+    __m128 v;
+#elif defined(VDJ_SIMD_NEON)
+    float32x4_t v;
+#else
+    float v[4];
+#endif
+};
+
+#if defined(VDJ_SIMD_SSE2)
+
+static inline VdjF4 VdjF4Set1(float x) { return { _mm_set1_ps(x) }; }
+static inline VdjF4 VdjF4Set(float a, float b, float c, float d) { return { _mm_setr_ps(a, b, c, d) }; }
+static inline VdjF4 VdjF4Load(const float *p) { return { _mm_loadu_ps(p) }; }
+static inline void VdjF4Store(float *p, VdjF4 a) { _mm_storeu_ps(p, a.v); }
+static inline VdjF4 VdjF4Add(VdjF4 a, VdjF4 b) { return { _mm_add_ps(a.v, b.v) }; }
+static inline VdjF4 VdjF4Sub(VdjF4 a, VdjF4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+static inline VdjF4 VdjF4Mul(VdjF4 a, VdjF4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+static inline VdjF4 VdjF4Min(VdjF4 a, VdjF4 b) { return { _mm_min_ps(a.v, b.v) }; }
+static inline VdjF4 VdjF4Max(VdjF4 a, VdjF4 b) { return { _mm_max_ps(a.v, b.v) }; }
+static inline VdjF4 VdjF4Abs(VdjF4 a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+static inline VdjF4 VdjF4Div(VdjF4 a, VdjF4 b) { return { _mm_div_ps(a.v, b.v) }; }
+
+/** Nearest integer, ties to even; |a| must be below 2^31 */
+static inline VdjF4 VdjF4Round(VdjF4 a) { return { _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)) }; }
+
+/** Lane mask of a < b, for VdjF4Select */
+static inline VdjF4 VdjF4Less(VdjF4 a, VdjF4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+/** a where the mask is set, b elsewhere */
+static inline VdjF4 VdjF4Select(VdjF4 mask, VdjF4 a, VdjF4 b) {
+    return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+}
+
+/** a * 2^k for integral k; the result must be a normal float */
+static inline VdjF4 VdjF4Ldexp(VdjF4 a, VdjF4 k) {
+    const __m128i e = _mm_slli_epi32(_mm_cvtps_epi32(k.v), 23);
+    return { _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(a.v), e)) };
+}
+/** Unbiased exponent of a positive normal float */
+static inline VdjF4 VdjF4Exponent(VdjF4 a) {
+    const __m128i e = _mm_srli_epi32(_mm_castps_si128(a.v), 23);
+    return { _mm_cvtepi32_ps(_mm_sub_epi32(e, _mm_set1_epi32(127))) };
+}
+/** Mantissa of a positive normal float, in [1, 2) */
+static inline VdjF4 VdjF4Mantissa(VdjF4 a) {
+    const __m128i m = _mm_and_si128(_mm_castps_si128(a.v), _mm_set1_epi32(0x007fffff));
+    return { _mm_castsi128_ps(_mm_or_si128(m, _mm_set1_epi32(0x3f800000))) };
+}
+
+/** Horizontal maximum of the four lanes */
+static inline float VdjF4MaxLane(VdjF4 a) {
+    __m128 m = _mm_max_ps(a.v, _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(m);
+}
+
+/** Horizontal sum of the four lanes */
+static inline float VdjF4Sum(VdjF4 a) {
+    __m128 s = _mm_add_ps(a.v, _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(s);
+}
+
+#elif defined(VDJ_SIMD_NEON)
+
+static inline VdjF4 VdjF4Set1(float x) { return { vdupq_n_f32(x) }; }
+static inline VdjF4 VdjF4Set(float a, float b, float c, float d) {
+    const float lanes[4] = { a, b, c, d };
+    return { vld1q_f32(lanes) };
+}
+static inline VdjF4 VdjF4Load(const float *p) { return { vld1q_f32(p) }; }
+static inline void VdjF4Store(float *p, VdjF4 a) { vst1q_f32(p, a.v); }
+static inline VdjF4 VdjF4Add(VdjF4 a, VdjF4 b) { return { vaddq_f32(a.v, b.v) }; }
+static inline VdjF4 VdjF4Sub(VdjF4 a, VdjF4 b) { return { vsubq_f32(a.v, b.v) }; }
+static inline VdjF4 VdjF4Mul(VdjF4 a, VdjF4 b) { return { vmulq_f32(a.v, b.v) }; }
+static inline VdjF4 VdjF4Min(VdjF4 a, VdjF4 b) { return { vminq_f32(a.v, b.v) }; }
+static inline VdjF4 VdjF4Max(VdjF4 a, VdjF4 b) { return { vmaxq_f32(a.v, b.v) }; }
+static inline VdjF4 VdjF4Abs(VdjF4 a) { return { vabsq_f32(a.v) }; }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+static inline VdjF4 VdjF4Div(VdjF4 a, VdjF4 b) { return { vdivq_f32(a.v, b.v) }; }
+static inline VdjF4 VdjF4Round(VdjF4 a) { return { vrndnq_f32(a.v) }; }
+#else
+/* ARMv7 has no divide: reciprocal estimate refined twice */
+static inline VdjF4 VdjF4Div(VdjF4 a, VdjF4 b) {
+    float32x4_t r = vrecpeq_f32(b.v);
+    r = vmulq_f32(r, vrecpsq_f32(b.v, r));
+    r = vmulq_f32(r, vrecpsq_f32(b.v, r));
+    return { vmulq_f32(a.v, r) };
+}
+/* Ties away from zero */
+static inline VdjF4 VdjF4Round(VdjF4 a) {
+    const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(a.v), vdupq_n_u32(0x80000000u));
+    const float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+    return { vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(a.v, half))) };
+}
+#endif
+
+static inline VdjF4 VdjF4Less(VdjF4 a, VdjF4 b) { return { vreinterpretq_f32_u32(vcltq_f32(a.v, b.v)) }; }
+static inline VdjF4 VdjF4Select(VdjF4 mask, VdjF4 a, VdjF4 b) {
+    return { vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v) };
+}
+
+static inline VdjF4 VdjF4Ldexp(VdjF4 a, VdjF4 k) {
+    const int32x4_t e = vshlq_n_s32(vcvtq_s32_f32(k.v), 23);
+    return { vreinterpretq_f32_s32(vaddq_s32(vreinterpretq_s32_f32(a.v), e)) };
+}
+static inline VdjF4 VdjF4Exponent(VdjF4 a) {
+    const int32x4_t e = vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_f32(a.v), 23));
+    return { vcvtq_f32_s32(vsubq_s32(e, vdupq_n_s32(127))) };
+}
+static inline VdjF4 VdjF4Mantissa(VdjF4 a) {
+    const uint32x4_t m = vandq_u32(vreinterpretq_u32_f32(a.v), vdupq_n_u32(0x007fffffu));
+    return { vreinterpretq_f32_u32(vorrq_u32(m, vdupq_n_u32(0x3f800000u))) };
+}
+
+static inline float VdjF4MaxLane(VdjF4 a) {
+    float32x2_t m = vpmax_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+    m = vpmax_f32(m, m);
+    return vget_lane_f32(m, 0);
+}
+
+static inline float VdjF4Sum(VdjF4 a) {
+    float32x2_t s = vadd_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+    s = vpadd_f32(s, s);
+    return vget_lane_f32(s, 0);
+}
+
+#else
+
+static inline VdjF4 VdjF4Set1(float x) { return { { x, x, x, x } }; }
+static inline VdjF4 VdjF4Set(float a, float b, float c, float d) { return { { a, b, c, d } }; }
+static inline VdjF4 VdjF4Load(const float *p) { return { { p[0], p[1], p[2], p[3] } }; }
+static inline void VdjF4Store(float *p, VdjF4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+
+#define VDJ_F4_LANEWISE(name, expr) \
+    static inline VdjF4 name(VdjF4 a, VdjF4 b) { \
+        VdjF4 r; \
+        for (int i = 0; i < 4; i++) { float x = a.v[i], y = b.v[i]; r.v[i] = (expr); } \
+        return r; \
+    }
+VDJ_F4_LANEWISE(VdjF4Add, x + y)
+VDJ_F4_LANEWISE(VdjF4Sub, x - y)
+VDJ_F4_LANEWISE(VdjF4Mul, x * y)
+VDJ_F4_LANEWISE(VdjF4Min, x < y ? x : y)
+VDJ_F4_LANEWISE(VdjF4Max, x > y ? x : y)
+VDJ_F4_LANEWISE(VdjF4Div, x / y)
+/* Masks are 1 or 0 per lane here */
+VDJ_F4_LANEWISE(VdjF4Less, x < y ? 1.0f : 0.0f)
+VDJ_F4_LANEWISE(VdjF4Ldexp, ldexpf(x, (int)y))
+#undef VDJ_F4_LANEWISE
+
+static inline VdjF4 VdjF4Abs(VdjF4 a) {
+    VdjF4 r;
+    for (int i = 0; i < 4; i++) r.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i];
+    return r;
+}
+
+static inline VdjF4 VdjF4Round(VdjF4 a) {
+    VdjF4 r;
+    for (int i = 0; i < 4; i++) r.v[i] = nearbyintf(a.v[i]);
+    return r;
+}
+
+static inline VdjF4 VdjF4Select(VdjF4 mask, VdjF4 a, VdjF4 b) {
+    VdjF4 r;
+    for (int i = 0; i < 4; i++) r.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+    return r;
+}
+
+static inline VdjF4 VdjF4Exponent(VdjF4 a) {
+    VdjF4 r;
+    for (int i = 0; i < 4; i++) { int e; frexpf(a.v[i], &e); r.v[i] = (float)(e - 1); }
+    return r;
+}
+
+static inline VdjF4 VdjF4Mantissa(VdjF4 a) {
+    VdjF4 r;
+    for (int i = 0; i < 4; i++) { int e; r.v[i] = 2.0f * frexpf(a.v[i], &e); }
+    return r;
+}
+
+static inline float VdjF4MaxLane(VdjF4 a) {
+    float m = a.v[0];
+    for (int i = 1; i < 4; i++) m = a.v[i] > m ? a.v[i] : m;
+    return m;
+}
+
+static inline float VdjF4Sum(VdjF4 a) {
+    return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]);
+}
+
+#endif
+
+#endif /* VDJ_SHIM_SIMD_H */
@@ -0,0 +1,144 @@
+/**
+ * VirtualDJ Rust SDK - Per-Thread Record Rings
+ *
+ * Fixed pool of single-producer/single-consumer rings used by the shim
+ * facilities that move records off callback threads (trace spans, log
+ * records). A thread claims a ring on its first push and gives it back when
+ * it exits; pushing never locks or allocates, and a full ring rejects the
+ * record so the caller can count it.
+ */
+
+#ifndef VDJ_SHIM_THREAD_RINGS_H
+#define VDJ_SHIM_THREAD_RINGS_H
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+/**
+ * A thread's claim on one ring of a pool, given back by its thread_local
+ * destructor when the thread exits. A thread that found every ring taken
+ * remembers it and does not try again.
+ */
+struct VdjRingClaim {
+    std::atomic<bool> *owned = nullptr;     /* flag of the claimed ring */
+    int index = -1;
+    bool rejected = false;
+
+    ~VdjRingClaim() {
+        if (owned) owned->store(false, std::memory_order_release);
+    }
+};
+
+/**
+ * Index of the calling thread's ring in a pool whose rings are flagged by
+ * owned, claiming a free one on the first call; -1 if there was none. The
+ * release/acquire pair on the flag hands the ring's write index from the
+ * thread that gave it back to the next owner.
+ */
+template <int Threads>
+static inline int VdjClaimRing(VdjRingClaim &claim, std::atomic<bool> (&owned)[Threads]) {
+    if (claim.index >= 0) return claim.index;
+    if (claim.rejected) return -1;
+    for (int i = 0; i < Threads; i++) {
+        bool expected = false;
+        if (!owned[i].load(std::memory_order_relaxed) &&
+            owned[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            claim.owned = &owned[i];
+            claim.index = i;
+            return i;
+        }
+    }
+    claim.rejected = true;
+    return -1;
+}
+
+/**
+ * The calling thread's ring index is cached in a thread_local per template
+ * instantiation, so each record type must have a single pool (a singleton),
+ * and the pool must outlive every producer thread. A ring given back keeps
+ * its unconsumed records and its index, so records of two threads that held
+ * it one after the other share a thread index.
+ */
+template <typename T, int Threads, int Capacity>
+struct VdjThreadRings {
+    static_assert((Capacity & (Capacity - 1)) == 0, "ring capacity must be a power of two");
+
+    struct Ring {
+        T *items = nullptr;
+        std::atomic<uint64_t> writeIndex { 0 };
+        std::atomic<uint64_t> readIndex { 0 };
+    };
+
+    // Rings live until the process exits, so a producer still holding one
+    // after its facility stopped is safe
+    Ring rings[Threads];
+    std::atomic<bool> owned[Threads] = {};
+
+    /**
+     * Allocate every ring up front (control thread). Returns false when out
+     * of memory.
+     */
+    bool Allocate() {
+        for (Ring &ring : rings) {
+            if (!ring.items) {
+                ring.items = new (std::nothrow) T[Capacity];
+                if (!ring.items) return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Discard records nobody consumed yet (consumer thread)
+     */
+    void Discard() {
+        for (Ring &ring : rings) {
+            ring.readIndex.store(ring.writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    }
+
+    /**
+     * Reserve the next record of the calling thread's ring. Returns nullptr
+     * when the ring is full or every ring is taken; otherwise fill the record
+     * and call Publish with the returned thread index.
+     */
+    T* Claim(int *thread) {
+        thread_local VdjRingClaim claim;
+        const int slot = VdjClaimRing(claim, owned);
+        if (slot < 0) return nullptr;
+
+        Ring &ring = rings[slot];
+        if (!ring.items) return nullptr;
+        const uint64_t w = ring.writeIndex.load(std::memory_order_relaxed);
+        if (w - ring.readIndex.load(std::memory_order_acquire) >= (uint64_t)Capacity) return nullptr;
+
+        *thread = slot;
+        return &ring.items[w & (Capacity - 1)];
+    }
+
+    void Publish(int thread) {
+        Ring &ring = rings[thread];
+        ring.writeIndex.store(ring.writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Hand every published record to consume(thread, record) and release it
+     * (consumer thread)
+     */
+    template <typename F>
+    void Drain(F &&consume) {
+        for (int i = 0; i < Threads; i++) {
+            Ring &ring = rings[i];
+            if (!ring.items) continue;
+            uint64_t r = ring.readIndex.load(std::memory_order_relaxed);
+            const uint64_t w = ring.writeIndex.load(std::memory_order_acquire);
+            for (; r != w; r++) {
+                consume(i, ring.items[r & (Capacity - 1)]);
+            }
+            ring.readIndex.store(r, std::memory_order_release);
+        }
+    }
+};
+
+#endif /* VDJ_SHIM_THREAD_RINGS_H */
@@ -0,0 +1,182 @@
+/**
+ * VirtualDJ Rust SDK - Callback Trace Recorder
+ */
+
+#include "trace.h"
+#include "thread_rings.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+static const char *const kCallbackCategories[VDJ_PROFILE_CALLBACK_COUNT] = {
+    "audio", "audio", "audio", "render", "render",
+    "ui", "control", "control", "render", "ui", "control",
+};
+
+typedef VdjThreadRings<VdjTraceSpan, VDJ_TRACE_MAX_THREADS, VDJ_TRACE_RING_SPANS> VdjTraceRings;
+
+struct VdjTracer {
+    // Rings are allocated by the first VdjTraceStart
+    VdjTraceRings rings;
+    std::atomic<bool> active { false };
+    std::atomic<uint32_t> generation { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+    std::chrono::steady_clock::time_point origin;
+
+    std::mutex mutex;   /* control and flush thread only */
+    std::condition_variable wake;
+    std::thread flusher;
+    uint64_t flusherGeneration = 0;     /* bumped to stop the running flusher */
+    uint32_t liveInstances = 0;         /* the flusher runs only while one lives */
+    FILE *file = nullptr;
+    bool firstEvent = true;
+
+    HRESULT Stop();
+    void StartFlusher();
+    void StopFlusher(std::unique_lock<std::mutex> &lock);
+    void Flush();
+    void FlushLoop(uint64_t generation);
+};
+
+/* Never destroyed: a static destructor would join the flusher under the
+   Windows loader lock. The flusher runs only while an instance lives. */
+static VdjTracer& Tracer() {
+    static VdjTracer *tracer = new VdjTracer;
+    return *tracer;
+}
+
+bool VdjTraceActive() {
+    return Tracer().active.load(std::memory_order_relaxed);
+}
+
+void VdjTraceRecord(const char *name, int callback, uint32_t instanceId,
+                    std::chrono::steady_clock::time_point begin,
+                    std::chrono::steady_clock::time_point end) {
+    VdjTracer &t = Tracer();
+    if (!t.active.load(std::memory_order_acquire)) return;
+
+    int thread = 0;
+    VdjTraceSpan *slot = t.rings.Claim(&thread);
+    if (!slot) {
+        t.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    VdjTraceSpan &span = *slot;
+    span.name = name;
+    span.beginNs = begin > t.origin
+        ? (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(begin - t.origin).count() : 0;
+    span.durationNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    span.instanceId = instanceId;
+    span.callback = callback;
+    t.rings.Publish(thread);
+}
+
+/* ============================================================================
+   Flush Thread
+   ============================================================================ */
+
+void VdjTracer::Flush() {
+    rings.Drain([this](int thread, const VdjTraceSpan &s) {
+        const char *category = (s.callback >= 0 && s.callback < VDJ_PROFILE_CALLBACK_COUNT)
+            ? kCallbackCategories[s.callback] : "other";
+        fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                      "\"pid\":1,\"tid\":%d,\"args\":{\"instance\":%u}}",
+                firstEvent ? "" : ",\n", s.name, category,
+                (double)s.beginNs / 1000.0, (double)s.durationNs / 1000.0, thread + 1, s.instanceId);
+        firstEvent = false;
+    });
+    fflush(file);
+}
+
+void VdjTracer::FlushLoop(uint64_t generation) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (flusherGeneration == generation) {
+        wake.wait_for(lock, std::chrono::milliseconds(50));
+        Flush();
+    }
+}
+
+/* Called with the mutex held */
+void VdjTracer::StartFlusher() {
+    if (!file || !liveInstances || flusher.joinable()) return;
+    const uint64_t generation = flusherGeneration;
+    flusher = std::thread([this, generation] { FlushLoop(generation); });
+}
+
+/* Called with the mutex held; unlocks it while joining */
+void VdjTracer::StopFlusher(std::unique_lock<std::mutex> &lock) {
+    if (!flusher.joinable()) return;
+    flusherGeneration++;
+    std::thread stopped = std::move(flusher);
+    lock.unlock();
+    wake.notify_one();
+    stopped.join();
+    lock.lock();
+}
+
+/* ============================================================================
+   Control
+   ============================================================================ */
+
+HRESULT VdjTraceStart(const char *path) {
+    if (!path) return E_FAIL;
+    VdjTracer &t = Tracer();
+    std::unique_lock<std::mutex> lock(t.mutex);
+    if (t.file) return E_FAIL;
+
+    if (!t.rings.Allocate()) return E_FAIL;
+    // Discard spans left over from a previous trace
+    t.rings.Discard();
+
+    t.file = fopen(path, "w");
+    if (!t.file) return E_FAIL;
+    fprintf(t.file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    t.firstEvent = true;
+    t.dropped.store(0, std::memory_order_relaxed);
+    t.origin = std::chrono::steady_clock::now();
+    t.active.store(true, std::memory_order_release);
+    t.StartFlusher();
+    return S_OK;
+}
+
+HRESULT VdjTracer::Stop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!file) return S_FALSE;
+    active.store(false, std::memory_order_release);
+    StopFlusher(lock);
+    // A concurrent Stop finished the trace while we waited
+    if (!file) return S_FALSE;
+
+    Flush();
+    fprintf(file, "\n]}\n");
+    const bool ok = fclose(file) == 0;
+    file = nullptr;
+    return ok ? S_OK : E_FAIL;
+}
+
+HRESULT VdjTraceStop() {
+    return Tracer().Stop();
+}
+
+void VdjTraceInstanceCreated() {
+    VdjTracer &t = Tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.liveInstances++;
+    t.StartFlusher();
+}
+
+void VdjTraceInstanceReleased() {
+    VdjTracer &t = Tracer();
+    std::unique_lock<std::mutex> lock(t.mutex);
+    if (--t.liveInstances) return;
+    t.StopFlusher(lock);
+    if (t.file) t.Flush();
+}
+
+uint64_t VdjTraceDroppedSpans() {
+    return Tracer().dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,55 @@
+/**
+ * VirtualDJ Rust SDK - Callback Trace Recorder
+ *
+ * Records one span per plugin entry point call (name, thread, instance,
+ * begin, duration) into per-thread single-producer rings, and a background
+ * thread writes them out as Chrome trace JSON (chrome://tracing, Perfetto).
+ * Callbacks never lock or allocate: a thread claims a preallocated ring on
+ * its first span and a full ring drops spans instead of waiting.
+ */
+
+#ifndef VDJ_SHIM_TRACE_H
+#define VDJ_SHIM_TRACE_H
+
+#include "../abi/vdj_plugin_abi.h"
+
+#include <atomic>
+#include <chrono>
+
+#define VDJ_TRACE_MAX_THREADS   32
+#define VDJ_TRACE_RING_SPANS    4096    /* power of two */
+
+struct VdjTraceSpan {
+    const char *name;   /* static string: the C ABI function name */
+    uint64_t beginNs;   /* since the trace started */
+    uint64_t durationNs;
+    uint32_t instanceId;
+    int32_t callback;   /* VDJ_PROFILE_* */
+};
+
+/**
+ * True while a trace is being recorded (one relaxed load)
+ */
+bool VdjTraceActive();
+
+/**
+ * Record a finished span on the calling thread's ring
+ */
+void VdjTraceRecord(const char *name, int callback, uint32_t instanceId,
+                    std::chrono::steady_clock::time_point begin,
+                    std::chrono::steady_clock::time_point end);
+
+HRESULT VdjTraceStart(const char *path);
+HRESULT VdjTraceStop();
+
+/**
+ * Count live plugin instances. The flush thread runs only while a trace is
+ * open and an instance lives: releasing the last one joins it and writes
+ * out the spans so far, so no shim thread outlives the instances and the
+ * library can be unloaded. The trace stays open across the gap.
+ */
+void VdjTraceInstanceCreated();
+void VdjTraceInstanceReleased();
+uint64_t VdjTraceDroppedSpans();
+
+#endif /* VDJ_SHIM_TRACE_H */
@@ -0,0 +1,48 @@
+/**
+ * VirtualDJ Rust SDK - VirtualDJ SDK Platform Setup
+ *
+ * The SDK headers in header_ref set up Windows, macOS and Android only. On
+ * other platforms (Linux builds of the benches and check programs) this
+ * gives them the Android definitions, the C ABI's integer types and the
+ * GUID type the macOS branch declares. Shim sources include the SDK
+ * through this header.
+ */
+
+#ifndef VDJ_SHIM_VDJ_SDK_H
+#define VDJ_SHIM_VDJ_SDK_H
+
+#if !defined(VDJ_NOEXPORT) && !(defined(WIN32) || defined(_WIN32) || defined(__WIN32_)) && \
+    !(defined(__APPLE__) || defined(MACOSX) || defined(__MACOSX__)) && !defined(__ANDROID__)
+#include <stddef.h>
+#include <stdint.h>
+
+/* Same as the C ABI, which may be included before or after */
+typedef int32_t HRESULT;
+typedef uint32_t DWORD;
+typedef uint32_t ULONG;
+
+#define S_OK            0x00000000L
+#define S_FALSE         0x00000001L
+#define E_NOTIMPL       0x80004001L
+#define E_FAIL          0x80004005L
+
+#define VDJ_EXPORT      __attribute__ ((visibility ("default")))
+#define VDJ_BITMAP      char *
+#define VDJ_WINDOW      void *
+#define VDJ_HINSTANCE   void *
+#define VDJ_API
+
+#ifndef GUID_DEFINED
+#define GUID_DEFINED
+typedef struct _GUID {
+    unsigned long Data1;
+    unsigned short Data2;
+    unsigned short Data3;
+    unsigned char Data4[8];
+} GUID;
+#endif
+#endif
+
+#include "../header_ref/vdjPlugin8.h"
+
+#endif /* VDJ_SHIM_VDJ_SDK_H */